@@ -184,7 +184,8 @@ void asynchronousReadExample(I2C_Interface& i2c) {
 
     // Create transaction
     I2C_Transaction_Message transaction = createTempReadTransaction();
-    transaction.m_transactionDelayUsec = 1000000; // Read every 1 second
+    transaction.setPeriod(1000000); // Read every 1 second
+    transaction.setPriority(I2C_PRIORITY_BACKGROUND); // Yield to on-demand commands
 
     // Register callback
     transaction.registerEventHandle((void*)i2cTransactionCallback, nullptr);
@@ -12,22 +12,57 @@
 #ifndef INCLUDES_APRAUTILS_H_
 #define INCLUDES_APRAUTILS_H_
 #include "constants/EventCallbacks.h"
+#include "constants/I2CAdmissionMode.h"
+#include "constants/I2CBrokerSlotState.h"
+#include "constants/I2CByteOrder.h"
 #include "constants/I2CMessageType.h"
+#include "constants/I2CPriority.h"
+#include "constants/I2CProgramOpcode.h"
+#include "constants/I2CPublishFilter.h"
 #include "constants/MessageType.h"
 #include "constants/StorageState.h"
 #include "constants/StorageType.h"
 #include "constants/ThreadType.h"
+#include "controllers/I2CBroker.h"
+#include "controllers/I2CBrokerClient.h"
+#include "controllers/I2CCallbackDispatcher.h"
 #include "controllers/I2CInterface.h"
+#include "controllers/I2CTraceReplayer.h"
 #include "models/GenericError.h"
+#include "models/I2CBusStatistics.h"
+#include "models/I2CCapacityReport.h"
 #include "models/I2CError.h"
 #include "models/I2CMessage.h"
+#include "models/I2CRegisteredEvent.h"
+#include "models/I2CTraceRecord.h"
 #include "models/I2CTransactionMessage.h"
+#include "models/I2CTransactionProgram.h"
 #include "models/Message.h"
 #include "models/Range.h"
 #include "models/StorageMinimalInfo.h"
 #include "utils/FileIO.h"
 #include "utils/GPIO.h"
+#include "utils/I2CBrokerRing.h"
 #include "utils/I2CBus.h"
+#include "utils/I2CBusArbiter.h"
+#include "utils/I2CBusHealth.h"
+#include "utils/I2CCapacityPlanner.h"
+#include "utils/I2CCompletionQueue.h"
+#include "utils/I2CDevTransport.h"
+#include "utils/I2CDeviceSnapshot.h"
+#include "utils/I2CEepromWriter.h"
+#include "utils/I2CEventRegistry.h"
+#include "utils/I2CEventScheduler.h"
+#include "utils/I2CMuxTopology.h"
+#include "utils/I2CPhaseStagger.h"
+#include "utils/I2CPreparedTransfer.h"
+#include "utils/I2CReadCache.h"
+#include "utils/I2CRegisterMap.h"
+#include "utils/I2CSampleRing.h"
+#include "utils/I2CSimulatedTransport.h"
+#include "utils/I2CTraceRecorder.h"
+#include "utils/I2CTransport.h"
+#include "utils/LockFreeQueue.h"
 #include "utils/Macro.h"
 #include "utils/Mutex.h"
 #include "utils/ProcessThread.h"
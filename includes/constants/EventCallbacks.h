@@ -21,5 +21,7 @@ class I2C_Transaction_Message;
 
 typedef void* I2CEventCallback(void *context,
 		apra::I2C_Transaction_Message message);
+typedef void* I2CEventConstCallback(void *context,
+		const apra::I2C_Transaction_Message &message);
 
 #endif /* INCLUDES_CALLBACK_EVENTCALLBACKS_H_ */
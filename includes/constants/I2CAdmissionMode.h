@@ -0,0 +1,25 @@
+/*
+ * I2CAdmissionMode.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_CONSTANTS_I2CADMISSIONMODE_H_
+#define INCLUDES_APRA_CONSTANTS_I2CADMISSIONMODE_H_
+
+namespace apra
+{
+
+enum I2C_ADMISSION_MODE
+{
+	I2C_ADMIT_ALL, I2C_ADMIT_WARN, I2C_ADMIT_REJECT
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_CONSTANTS_I2CADMISSIONMODE_H_ */
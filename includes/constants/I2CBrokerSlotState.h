@@ -0,0 +1,30 @@
+/*
+ * I2CBrokerSlotState.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_CONSTANTS_I2CBROKERSLOTSTATE_H_
+#define INCLUDES_APRA_CONSTANTS_I2CBROKERSLOTSTATE_H_
+
+namespace apra
+{
+
+enum I2C_BROKER_SLOT_STATE
+{
+	I2C_SLOT_FREE,
+	I2C_SLOT_CLAIMED,
+	I2C_SLOT_SUBMITTED,
+	I2C_SLOT_QUEUED,
+	I2C_SLOT_COMPLETE,
+	I2C_SLOT_ABANDONED
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_CONSTANTS_I2CBROKERSLOTSTATE_H_ */
@@ -0,0 +1,25 @@
+/*
+ * I2CByteOrder.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_CONSTANTS_I2CBYTEORDER_H_
+#define INCLUDES_APRA_CONSTANTS_I2CBYTEORDER_H_
+
+namespace apra
+{
+
+enum I2C_BYTE_ORDER
+{
+	I2C_BIG_ENDIAN, I2C_LITTLE_ENDIAN
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_CONSTANTS_I2CBYTEORDER_H_ */
@@ -0,0 +1,27 @@
+/*
+ * I2CPriority.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_CONSTANTS_I2CPRIORITY_H_
+#define INCLUDES_APRA_CONSTANTS_I2CPRIORITY_H_
+
+namespace apra
+{
+
+enum I2C_PRIORITY
+{
+	I2C_PRIORITY_URGENT, I2C_PRIORITY_NORMAL, I2C_PRIORITY_BACKGROUND
+};
+
+#define I2C_PRIORITY_COUNT 3
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_CONSTANTS_I2CPRIORITY_H_ */
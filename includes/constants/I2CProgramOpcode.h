@@ -0,0 +1,37 @@
+/*
+ * I2CProgramOpcode.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_CONSTANTS_I2CPROGRAMOPCODE_H_
+#define INCLUDES_APRA_CONSTANTS_I2CPROGRAMOPCODE_H_
+
+namespace apra
+{
+
+enum I2C_PROGRAM_OPCODE
+{
+	I2C_OP_READ,
+	I2C_OP_READ_VARIABLE,
+	I2C_OP_WRITE,
+	I2C_OP_LOAD,
+	I2C_OP_AND,
+	I2C_OP_SHIFT_RIGHT,
+	I2C_OP_MULTIPLY,
+	I2C_OP_ADD,
+	I2C_OP_JUMP,
+	I2C_OP_JUMP_IF_ZERO,
+	I2C_OP_JUMP_IF_NOT_ZERO,
+	I2C_OP_DELAY,
+	I2C_OP_END
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_CONSTANTS_I2CPROGRAMOPCODE_H_ */
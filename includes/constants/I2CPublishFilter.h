@@ -0,0 +1,28 @@
+/*
+ * I2CPublishFilter.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_CONSTANTS_I2CPUBLISHFILTER_H_
+#define INCLUDES_APRA_CONSTANTS_I2CPUBLISHFILTER_H_
+
+namespace apra
+{
+
+enum I2C_PUBLISH_FILTER
+{
+	I2C_PUBLISH_ALWAYS,
+	I2C_PUBLISH_ON_CHANGE,
+	I2C_PUBLISH_DEADBAND,
+	I2C_PUBLISH_EVERY_NTH
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_CONSTANTS_I2CPUBLISHFILTER_H_ */
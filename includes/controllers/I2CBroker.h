@@ -0,0 +1,76 @@
+/*
+ * I2CBroker.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_CONTROLLERS_I2CBROKER_H_
+#define INCLUDES_APRA_CONTROLLERS_I2CBROKER_H_
+
+#include <poll.h>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+#include "controllers/I2CInterface.h"
+#include "utils/I2CBrokerRing.h"
+
+using namespace std;
+
+namespace apra
+{
+
+/*
+ * I2C_Interface that also serves other processes. Clients connect to a unix
+ * socket and receive the shared slot region and an eventfd doorbell; their
+ * transactions join the same arbiter as local requests and registered
+ * events, so one thread orders all traffic on the bus. Requests are admitted
+ * in submission order and their results are written back into the slots.
+ * The broker is opened and closed only while its thread is stopped; closing
+ * fails the client transactions still queued.
+ */
+class I2C_Broker: public I2C_Interface
+{
+public:
+	I2C_Broker(string i2cPath, string socketPath, string processName,
+			uint64_t processFpsHz, bool shouldPrint);
+	I2C_Broker(I2C_Transport *transport, string socketPath, string processName,
+			uint64_t processFpsHz, bool shouldPrint);
+	virtual ~I2C_Broker();
+	I2CError openBroker();
+	bool closeBroker();
+	bool isBrokerOpen();
+	size_t getClientCount();
+	uint64_t getBrokeredCount();
+	virtual void process(Message *obj);
+protected:
+	virtual void waitForNextCycle(uint64_t timeoutUsec);
+	virtual void admitRequests(int64_t timeNow);
+	virtual void completeRequest(I2C_Transaction_Message *txMessage);
+	void serviceClients(uint64_t timeoutUsec);
+	void acceptClients();
+	bool sendHandles(int clientFd, uint32_t clientId);
+	void dropClient(int clientFd);
+
+	string m_socketPath;
+	int m_listenFd;
+	int m_regionFd;
+	int m_doorbellFd;
+	I2C_Broker_Ring m_ring;
+	vector<I2C_Transaction_Message> m_requests;
+	vector<uint32_t> m_submittedSlots;
+	map<int, uint32_t> m_clients;
+	uint32_t m_nextClientId;
+	Mutex m_clientLock;
+	vector<struct pollfd> m_pollFds;
+	std::atomic<uint64_t> m_brokeredCount;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_CONTROLLERS_I2CBROKER_H_ */
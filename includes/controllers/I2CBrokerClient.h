@@ -0,0 +1,62 @@
+/*
+ * I2CBrokerClient.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_CONTROLLERS_I2CBROKERCLIENT_H_
+#define INCLUDES_APRA_CONTROLLERS_I2CBROKERCLIENT_H_
+
+#include <stdint.h>
+#include <sys/socket.h>
+#include <string>
+#include "models/I2CError.h"
+#include "models/I2CTransactionMessage.h"
+#include "utils/I2CBrokerRing.h"
+
+#define I2C_BROKER_CONNECT_TIMEOUT_USEC 2000000
+
+using namespace std;
+
+namespace apra
+{
+
+/*
+ * Process side of an I2C_Broker. transact() runs one transaction and copies
+ * its results back; submit(), wait() and getResult() let a caller read the
+ * results straight from the shared slot before releasing it. Safe to use
+ * from several threads of the same process.
+ */
+class I2C_Broker_Client
+{
+public:
+	I2C_Broker_Client();
+	virtual ~I2C_Broker_Client();
+	I2CError connectBroker(string socketPath);
+	void disconnectBroker();
+	bool isConnected();
+	uint32_t getClientId();
+	I2CError transact(I2C_Transaction_Message &message, uint64_t timeoutUsec);
+	int32_t submit(const I2C_Transaction_Message &message);
+	bool wait(int32_t slot, uint64_t timeoutUsec);
+	const I2C_Broker_Slot& getResult(int32_t slot);
+	void release(int32_t slot);
+	void abandon(int32_t slot);
+protected:
+	bool receiveHandles(int &regionFd);
+	static void closeHandles(struct msghdr &header);
+
+	int m_socketFd;
+	int m_doorbellFd;
+	uint32_t m_clientId;
+	I2C_Broker_Ring m_ring;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_CONTROLLERS_I2CBROKERCLIENT_H_ */
@@ -0,0 +1,48 @@
+/*
+ * I2CCallbackDispatcher.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_CONTROLLERS_I2CCALLBACKDISPATCHER_H_
+#define INCLUDES_APRA_CONTROLLERS_I2CCALLBACKDISPATCHER_H_
+
+#include <pthread.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include "models/I2CTransactionMessage.h"
+#include "utils/LockFreeQueue.h"
+#include "utils/ProcessThread.h"
+
+#define I2C_DISPATCH_WAIT_USEC 50000
+
+namespace apra
+{
+
+class I2C_Callback_Dispatcher: public ProcessThread
+{
+public:
+	I2C_Callback_Dispatcher(string name, size_t queueDepth);
+	virtual ~I2C_Callback_Dispatcher();
+	virtual void process(Message *obj);
+	bool dispatch(shared_ptr<const I2C_Transaction_Message> message);
+	uint64_t getDispatchedCount();
+	uint64_t getDroppedCount();
+protected:
+	LockFreeQueue<shared_ptr<const I2C_Transaction_Message> > m_queue;
+	pthread_mutex_t m_pendingLock;
+	pthread_cond_t m_pendingCondition;
+	uint64_t m_pendingCount;
+	std::atomic<uint64_t> m_dispatchedCount;
+	std::atomic<uint64_t> m_droppedCount;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_CONTROLLERS_I2CCALLBACKDISPATCHER_H_ */
@@ -12,11 +12,27 @@
 #ifndef SRC_APRA_CONTROLLERS_I2CINTERFACE_H_
 #define SRC_APRA_CONTROLLERS_I2CINTERFACE_H_
 
+#include <poll.h>
+#include <atomic>
 #include <map>
 #include <string>
+#include <vector>
 #include <utils/ProcessThread.h>
 #include <models/I2CTransactionMessage.h>
+#include "controllers/I2CCallbackDispatcher.h"
 #include "utils/I2CBus.h"
+#include "utils/I2CBusArbiter.h"
+#include "utils/I2CBusHealth.h"
+#include "utils/I2CCapacityPlanner.h"
+#include "utils/I2CDeviceSnapshot.h"
+#include "utils/I2CEepromWriter.h"
+#include "utils/I2CEventRegistry.h"
+#include "utils/I2CEventScheduler.h"
+#include "utils/I2CMuxTopology.h"
+#include "utils/I2CPhaseStagger.h"
+#include "utils/I2CReadCache.h"
+#include "utils/I2CTraceRecorder.h"
+#include "utils/GPIO.h"
 #include "utils/Mutex.h"
 
 namespace apra
@@ -27,33 +43,150 @@ class I2C_Interface: public ProcessThread
 public:
 	I2C_Interface(string i2cPath, string processName, uint64_t processFpsHz,
 			bool shouldPrint);
+	I2C_Interface(I2C_Transport *transport, string processName,
+			uint64_t processFpsHz, bool shouldPrint);
 	virtual ~I2C_Interface();
 	virtual void process(Message *obj);
 	uint64_t registerEvent(I2C_Transaction_Message message);
+	uint64_t registerStream(I2C_Transaction_Message message,
+			shared_ptr<I2C_Sample_Ring> sampleRing);
+	uint64_t registerTriggeredEvent(I2C_Transaction_Message message,
+			int triggerFd, short pollEvents = POLLPRI | POLLERR,
+			shared_ptr<I2C_Sample_Ring> sampleRing = shared_ptr<I2C_Sample_Ring>());
+	uint64_t registerEdgeEvent(I2C_Transaction_Message message, GPIO &gpio,
+			GPIO_EDGES edge,
+			shared_ptr<I2C_Sample_Ring> sampleRing = shared_ptr<I2C_Sample_Ring>());
+	uint64_t getMissedTriggerCount();
+	uint64_t getEventPeriodUsec(uint64_t messageHandle);
+	uint64_t getSuppressedCount(uint64_t messageHandle);
 	void unregisterEvent(uint64_t messageHandle);
 	I2CError reSetupI2CBus();
 	bool isSuccessfullSetup();
+	bool enableAsyncCallbacks(size_t queueDepth);
+	I2C_Callback_Dispatcher* getCallbackDispatcher();
+	void setBusClock(uint64_t busClockHz);
+	I2C_Bus_Statistics getStatistics();
+	void resetStatistics();
+	bool startTrace(string path);
+	void stopTrace();
+	bool isTracing();
+	uint64_t getExecutedCount(I2C_PRIORITY priority);
+	uint64_t getMaxWaitUsec(I2C_PRIORITY priority);
+	uint64_t getDeadlineMissCount(I2C_PRIORITY priority);
+	void setHealthPolicy(const I2C_Health_Policy &policy);
+	I2C_Bus_Health& getBusHealth();
+	uint64_t getDroppedCount(I2C_PRIORITY priority);
+	I2CError writeEeprom(const I2C_Eeprom_Config &config, uint64_t address,
+			const vector<uint8_t> &data, I2C_Eeprom_Report &report);
+	I2CError readEeprom(const I2C_Eeprom_Config &config, uint64_t address,
+			size_t size, vector<uint8_t> &data);
+	bool addMuxDevice(uint8_t chipAddress, uint8_t muxAddress,
+			uint8_t channel);
+	void removeMuxDevice(uint8_t chipAddress);
+	uint64_t getMuxSelectCount();
+	uint64_t getMuxSkippedCount();
+	void setCapacityPolicy(const I2C_Capacity_Policy &policy);
+	I2C_Capacity_Planner& getCapacityPlanner();
+	I2C_Capacity_Report getCapacityReport();
+	void setPhaseStaggering(bool enable);
+	uint64_t getEventPhaseUsec(uint64_t messageHandle);
+	void setReadCoalescing(bool enable, uint64_t freshnessUsec = 0);
+	uint64_t getCoalescedReadCount();
+	bool loadDeviceSnapshot(string path);
+	bool saveDeviceSnapshot();
+	I2CError initDevice(const I2C_Device_Init &device);
+	I2CError initDevice(const I2C_Device_Init &device,
+			I2C_Init_Report &report);
+	I2C_Device_Snapshot& getDeviceSnapshot();
 protected:
-	virtual void processEvents();
+	struct Due_Event
+	{
+		int32_t m_group;
+		int64_t m_deadlineTs;
+		shared_ptr<I2C_Registered_Event> m_event;
+		bool operator<(const Due_Event &other) const;
+	};
+	void setupI2CBus();
+	uint64_t admitEvent(shared_ptr<I2C_Registered_Event> event);
+	virtual void waitForNextCycle(uint64_t timeoutUsec);
+	bool pollTriggers(uint64_t timeoutUsec);
+	void rebuildTriggers();
+	virtual void admitRequests(int64_t timeNow);
+	virtual void completeRequest(I2C_Transaction_Message *txMessage);
+	void admitDueEvents(int64_t timeNow);
+	void orderByMuxChannel();
+	void executeEntry(I2C_Arbiter_Entry &entry);
+	void dropEntry(I2C_Arbiter_Entry &entry);
+	bool processIdleWork(int64_t timeNow);
+	void recoverBusIfDue(int64_t timeNow);
+	void recordBusResult(uint8_t chipNumber, I2CError &response);
 	virtual void processSingleEvent();
-	void processMessage(I2C_Transaction_Message *txMessage);
-	void processI2CTransaction(I2C_Transaction_Message *txMessage);
+	void processMessage(I2C_Transaction_Message *txMessage, int64_t requestTs);
+	void processI2CTransaction(I2C_Transaction_Message *txMessage,
+			int64_t requestTs, bool isEvent = false,
+			I2C_Prepared_Transfer *preparedTransfers = NULL);
+	void runProgram(I2C_Transaction_Message *txMessage, bool isEvent,
+			int64_t requestTs);
+	I2CError readSignature(const I2C_Device_Init &device,
+			vector<I2C_Message> &signature, I2C_Init_Report &report);
+	I2CError applyInitMessage(uint8_t chipNumber, I2C_Message &message,
+			I2C_Init_Report &report);
+	I2CError performInitMessage(uint8_t chipNumber, I2C_Message &message);
+	I2CError applyWriteRun(const I2C_Device_Init &device, size_t begin,
+			size_t end, I2C_Init_Report &report);
+	I2CError readWriteRun(const I2C_Device_Init &device, size_t begin,
+			size_t end, vector<uint8_t> &data, I2C_Init_Report &report);
+	void traceMessage(uint64_t transactionId, uint16_t chipNumber,
+			bool isEvent, const I2C_Message &message, int64_t startTs);
 
-	I2CError performRead(uint8_t chipNumber, I2C_Message &message);
+	I2CError performRead(uint8_t chipNumber, I2C_Message &message,
+			int64_t requestTs, I2C_Prepared_Transfer *prepared = NULL);
 	I2CError performCompareRead(uint8_t chipNumber, I2C_Message &message,
-			bool compareEquals);
-	I2CError performWrite(uint8_t chipNumber, I2C_Message &message);
+			bool compareEquals, I2C_Prepared_Transfer *prepared = NULL);
+	I2CError performWrite(uint8_t chipNumber, I2C_Message &message,
+			I2C_Prepared_Transfer *prepared = NULL);
+	I2CError transferMessage(uint8_t chipNumber, I2C_Message &message,
+			bool isRead, I2C_Prepared_Transfer *prepared);
+	void prepareEvent(I2C_Registered_Event &event);
 	void performTransactionDelay(const uint64_t timeDelay);
 	uint64_t getNormalizedDelay(int64_t largerTime, int64_t smallerTime, uint64_t timeDelay);
+	uint64_t getEventPeriod(const I2C_Transaction_Message &message);
+	uint64_t getEventPeriod(const I2C_Registered_Event &event);
+	void syncRegisteredEvents(int64_t timeNow);
+	uint64_t getEventPhase(uint64_t handle, const I2C_Registered_Event &event);
+	shared_ptr<I2C_Registered_Event> popDueEvent(int64_t timeNow,
+			int64_t &releaseTs);
+	void executeEvent(shared_ptr<I2C_Registered_Event> event,
+			int64_t requestTs);
+	bool isEventDue(int64_t timeNow);
 
 	string m_i2cPath;
 	I2C_Bus m_i2cBus;
-	map<uint64_t, I2C_Transaction_Message> m_registeredEvents;
-	vector<uint64_t> m_processedEvents;
-	apra::Mutex m_eventMessageLock;
+	I2C_Event_Registry m_eventRegistry;
+	shared_ptr<const I2C_Event_Map> m_eventSnapshot;
+	uint64_t m_eventSnapshotVersion;
+	I2C_Event_Scheduler m_eventScheduler;
+	int64_t m_scheduleEpoch;
 	int64_t m_lastProcessedEventTs;
 	bool m_setupSuccess;
 	apra::Mutex m_processLock;
+	I2C_Callback_Dispatcher *m_callbackDispatcher;
+	I2C_Trace_Recorder m_traceRecorder;
+	std::atomic<uint64_t> m_traceTransactionId;
+	I2C_Bus_Arbiter m_busArbiter;
+	I2C_Bus_Health m_busHealth;
+	I2C_Mux_Topology m_muxTopology;
+	vector<Due_Event> m_dueEvents;
+	I2C_Capacity_Planner m_capacityPlanner;
+	I2C_Phase_Stagger m_phaseStagger;
+	std::atomic<bool> m_isStaggering;
+	I2C_Read_Cache m_readCache;
+	std::atomic<bool> m_isCoalescing;
+	I2C_Device_Snapshot m_deviceSnapshot;
+	string m_snapshotPath;
+	vector<struct pollfd> m_triggerFds;
+	vector<shared_ptr<I2C_Registered_Event> > m_triggerEvents;
+	std::atomic<uint64_t> m_missedTriggerCount;
 };
 
 } /* namespace apra */
@@ -0,0 +1,95 @@
+/*
+ * I2CTraceReplayer.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_CONTROLLERS_I2CTRACEREPLAYER_H_
+#define INCLUDES_APRA_CONTROLLERS_I2CTRACEREPLAYER_H_
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "controllers/I2CInterface.h"
+#include "models/I2CTraceRecord.h"
+#include "utils/I2CCompletionQueue.h"
+#include "utils/I2CSimulatedTransport.h"
+
+#define I2C_REPLAY_POLL_USEC 100
+#define I2C_REPLAY_DRAIN_TIMEOUT_USEC 1000000
+#define I2C_REPLAY_MAX_PENDING 256
+
+using namespace std;
+
+namespace apra
+{
+
+class I2C_Replay_Report
+{
+public:
+	I2C_Replay_Report();
+	virtual ~I2C_Replay_Report();
+	double getAverageLatencyUsec() const;
+	uint64_t m_transactionCount;
+	uint64_t m_completedCount;
+	uint64_t m_errorCount;
+	uint64_t m_mismatchCount;
+	int64_t m_recordedDurationUsec;
+	int64_t m_replayDurationUsec;
+	uint64_t m_totalLatencyUsec;
+	uint64_t m_maxLatencyUsec;
+};
+
+/*
+ * Feeds a recorded trace back through a running I2C_Interface as on-demand
+ * REQUEST_RESPONSE transactions, paced by the recorded timestamps divided by
+ * the speed factor (0 submits as fast as possible). With a simulated
+ * transport the recorded read data is loaded into the devices before each
+ * transaction, so replayed reads return what the field bus returned; a read
+ * waits for the pending read of the same register so its data is not
+ * overwritten early. Replayed transactions complete into the replayer's own
+ * queue, so other clients of the interface keep their responses; at most
+ * I2C_REPLAY_MAX_PENDING are outstanding at a time. Transactions still
+ * pending after the drain timeout are freed by the interface once the
+ * replayer is gone.
+ */
+class I2C_Trace_Replayer
+{
+public:
+	I2C_Trace_Replayer();
+	I2C_Trace_Replayer(const vector<I2C_Trace_Record> &records);
+	virtual ~I2C_Trace_Replayer();
+	bool load(string path);
+	void setRecords(const vector<I2C_Trace_Record> &records);
+	size_t getTransactionCount();
+	uint64_t getBusClock();
+	void primeTransport(I2C_Simulated_Transport &transport);
+	I2C_Replay_Report replay(I2C_Interface &interface, double speedFactor,
+			I2C_Simulated_Transport *transport = NULL,
+			uint64_t drainTimeoutUsec = I2C_REPLAY_DRAIN_TIMEOUT_USEC);
+protected:
+	I2C_Transaction_Message* buildTransaction(
+			const vector<I2C_Trace_Record> &records);
+	void loadReadData(const vector<I2C_Trace_Record> &records,
+			I2C_Simulated_Transport &transport);
+	void collectResponses(map<Message*, pair<size_t, int64_t> > &pending,
+			I2C_Replay_Report &report);
+	bool isReadPending(const vector<I2C_Trace_Record> &records);
+	void trackReads(const vector<I2C_Trace_Record> &records, bool isPending);
+	static uint64_t getRegisterAddress(const vector<uint8_t> &registerNumber);
+	vector<vector<I2C_Trace_Record> > m_transactions;
+	uint64_t m_busClockHz;
+	shared_ptr<I2C_Completion_Queue> m_completions;
+	map<pair<uint16_t, uint64_t>, size_t> m_pendingReads;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_CONTROLLERS_I2CTRACEREPLAYER_H_ */
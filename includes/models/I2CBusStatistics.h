@@ -0,0 +1,86 @@
+/*
+ * I2CBusStatistics.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_MODELS_I2CBUSSTATISTICS_H_
+#define INCLUDES_APRA_MODELS_I2CBUSSTATISTICS_H_
+
+#include <stdint.h>
+#include <map>
+#include <models/I2CError.h>
+
+#define I2C_DEFAULT_BUS_CLOCK_HZ 100000
+#define I2C_LATENCY_BUCKET_COUNT 16
+
+using namespace std;
+
+namespace apra
+{
+
+class I2C_Register_Statistics
+{
+public:
+	I2C_Register_Statistics();
+	virtual ~I2C_Register_Statistics();
+	void recordTransfer(bool isRead, uint64_t byteCount, uint64_t latencyUsec,
+			uint64_t busTimeUsec, I2C_ERROR_CODE code);
+	void recordRetry();
+	void merge(const I2C_Register_Statistics &other);
+	uint64_t getOperationCount() const;
+	uint64_t getAverageLatencyUsec() const;
+	static size_t getLatencyBucket(uint64_t latencyUsec);
+	static uint64_t getLatencyBucketLimitUsec(size_t bucket);
+
+	uint64_t m_readCount;
+	uint64_t m_writeCount;
+	uint64_t m_bytesRead;
+	uint64_t m_bytesWritten;
+	uint64_t m_retryCount;
+	uint64_t m_errorCount;
+	uint64_t m_totalLatencyUsec;
+	uint64_t m_maxLatencyUsec;
+	uint64_t m_busTimeUsec;
+	uint64_t m_latencyHistogram[I2C_LATENCY_BUCKET_COUNT];
+	map<I2C_ERROR_CODE, uint64_t> m_errorCodes;
+};
+
+class I2C_Chip_Statistics
+{
+public:
+	I2C_Chip_Statistics();
+	virtual ~I2C_Chip_Statistics();
+	I2C_Register_Statistics m_total;
+	map<uint64_t, I2C_Register_Statistics> m_registers;
+};
+
+class I2C_Bus_Statistics
+{
+public:
+	I2C_Bus_Statistics();
+	virtual ~I2C_Bus_Statistics();
+	void recordTransfer(uint8_t chipAddress, uint64_t registerAddress,
+			bool isRead, uint64_t byteCount, uint64_t latencyUsec,
+			uint64_t busTimeUsec, I2C_ERROR_CODE code);
+	void recordRetry(uint8_t chipAddress, uint64_t registerAddress);
+	void reset(int64_t timeNow);
+	double getBusOccupancy() const;
+	static uint64_t estimateTransferUsec(uint64_t busClockHz,
+			uint64_t writeBytes, uint64_t readBytes);
+
+	uint64_t m_busClockHz;
+	int64_t m_collectionStartTs;
+	int64_t m_snapshotTs;
+	I2C_Register_Statistics m_total;
+	map<uint8_t, I2C_Chip_Statistics> m_chips;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_MODELS_I2CBUSSTATISTICS_H_ */
@@ -0,0 +1,66 @@
+/*
+ * I2CCapacityReport.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_MODELS_I2CCAPACITYREPORT_H_
+#define INCLUDES_APRA_MODELS_I2CCAPACITYREPORT_H_
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace apra
+{
+
+/*
+ * Projected load of one registered event: the bus transfers of a single
+ * execution as (write bytes, read bytes), the blocking delays between them
+ * and the period it is planned at. The measured side is filled in from the
+ * running event when a report is taken.
+ */
+class I2C_Capacity_Entry
+{
+public:
+	I2C_Capacity_Entry();
+	virtual ~I2C_Capacity_Entry();
+	double getProjectedUtilisation() const;
+	double getMeasuredUtilisation() const;
+
+	uint64_t m_handle;
+	uint16_t m_chipNumber;
+	uint64_t m_periodUsec;
+	vector<pair<uint64_t, uint64_t> > m_transfers;
+	uint64_t m_delayUsec;
+	uint64_t m_busTimeUsec;
+	uint64_t m_executionCount;
+	double m_measuredPeriodUsec;
+	double m_measuredExecutionUsec;
+};
+
+class I2C_Capacity_Report
+{
+public:
+	I2C_Capacity_Report();
+	virtual ~I2C_Capacity_Report();
+	bool isOversubscribed() const;
+
+	uint64_t m_busClockHz;
+	double m_budget;
+	double m_projectedUtilisation;
+	double m_measuredUtilisation;
+	double m_measuredBusOccupancy;
+	vector<I2C_Capacity_Entry> m_entries;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_MODELS_I2CCAPACITYREPORT_H_ */
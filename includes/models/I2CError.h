@@ -19,7 +19,9 @@ namespace apra
 
 enum I2C_ERROR_CODE
 {
-	NO_ERROR, OPEN_BUS_ERROR, WRITE_ERROR, READ_ERROR, BUS_UNOPENED
+	NO_ERROR, OPEN_BUS_ERROR, WRITE_ERROR, READ_ERROR, BUS_UNOPENED,
+	DEADLINE_EXPIRED, CHIP_QUARANTINED, VERIFY_ERROR, MUX_SELECT_ERROR,
+	BROKER_ERROR, PROGRAM_ERROR
 };
 
 class I2CError: public GenericError
@@ -43,7 +43,7 @@ public:
 	void setRetries(uint64_t retryCount);
 	uint64_t getCombinedData();
 	uint64_t getCombinedRegister();
-	uint64_t getDataSize();
+	uint64_t getDataSize() const;
 
 	I2CError m_error;
 	I2C_MESSAGE_TYPE m_type;
@@ -54,6 +54,7 @@ public:
 	uint64_t m_delayInUsec;
 	uint64_t m_retryDelayInUsec;
 	bool m_allowOtherProcessOnIdle;
+	bool m_allowCoalescing;
 protected:
 	uint64_t m_registerSize;
 	uint64_t m_dataSize;
@@ -0,0 +1,73 @@
+/*
+ * I2CRegisteredEvent.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_MODELS_I2CREGISTEREDEVENT_H_
+#define INCLUDES_APRA_MODELS_I2CREGISTEREDEVENT_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <models/I2CTransactionMessage.h>
+#include "utils/I2CPreparedTransfer.h"
+
+namespace apra
+{
+
+class I2C_Sample_Ring;
+
+/*
+ * Registry entry of a periodic transaction. The message is the working copy
+ * executed in place by the I2C_Interface thread; everything below is owned
+ * by that thread once the entry is published. A streamed event deposits
+ * its results in the sample ring instead of publishing the transaction.
+ * The prepared transfers, one per message, are built by the interface when
+ * the event is first scheduled. An event with a trigger descriptor is not
+ * polled periodically but runs whenever the descriptor signals. An adaptive
+ * event keeps its current period here, readable from any thread, and the
+ * last read values it compares each result against. The publish filter
+ * state decides on the bus thread whether a result reaches the callback.
+ * The execution counters feed the measured side of the capacity report.
+ */
+class I2C_Registered_Event
+{
+public:
+	I2C_Registered_Event(const I2C_Transaction_Message &message);
+	I2C_Registered_Event(const I2C_Transaction_Message &message,
+			std::shared_ptr<I2C_Sample_Ring> sampleRing);
+	virtual ~I2C_Registered_Event();
+	bool adaptPeriod();
+	bool shouldPublish();
+	I2C_Transaction_Message m_message;
+	bool m_isScheduled;
+	bool m_isExecuting;
+	int64_t m_lastExecutionTs;
+	std::atomic<uint64_t> m_executionCount;
+	std::atomic<int64_t> m_firstExecutionTs;
+	std::atomic<int64_t> m_lastStartTs;
+	std::atomic<uint64_t> m_executionUsec;
+	std::shared_ptr<I2C_Sample_Ring> m_sampleRing;
+	std::vector<I2C_Prepared_Transfer> m_preparedTransfers;
+	int m_triggerFd;
+	short m_triggerEvents;
+	std::atomic<uint64_t> m_currentPeriodUsec;
+	std::vector<uint64_t> m_lastValues;
+	std::vector<std::vector<uint8_t> > m_publishedData;
+	uint64_t m_filteredCount;
+	std::atomic<uint64_t> m_suppressedCount;
+protected:
+	void initPeriod();
+	bool hasDataChanged();
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_MODELS_I2CREGISTEREDEVENT_H_ */
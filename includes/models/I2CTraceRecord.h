@@ -0,0 +1,57 @@
+/*
+ * I2CTraceRecord.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_MODELS_I2CTRACERECORD_H_
+#define INCLUDES_APRA_MODELS_I2CTRACERECORD_H_
+
+#include <stdint.h>
+#include <vector>
+#include "constants/I2CMessageType.h"
+#include "models/I2CError.h"
+
+using namespace std;
+
+namespace apra
+{
+
+/*
+ * One executed I2C_Message of a traced transaction. Records of the same
+ * transaction share m_transactionId. On disk every integer is a varint and
+ * the timestamp is stored as a delta to the previous record; compare reads
+ * also carry their compare data.
+ */
+class I2C_Trace_Record
+{
+public:
+	I2C_Trace_Record();
+	virtual ~I2C_Trace_Record();
+	void encode(vector<uint8_t> &buffer, int64_t previousTimestampUsec) const;
+	bool decode(const vector<uint8_t> &buffer, size_t &offset,
+			int64_t previousTimestampUsec);
+	bool isCompare() const;
+	static void putVarint(vector<uint8_t> &buffer, uint64_t value);
+	static bool getVarint(const vector<uint8_t> &buffer, size_t &offset,
+			uint64_t &value);
+	int64_t m_timestampUsec;
+	uint64_t m_transactionId;
+	uint16_t m_chipNumber;
+	I2C_MESSAGE_TYPE m_type;
+	bool m_isEvent;
+	I2C_ERROR_CODE m_errorCode;
+	uint64_t m_latencyUsec;
+	vector<uint8_t> m_registerNumber;
+	vector<uint8_t> m_data;
+	vector<uint8_t> m_compareData;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_MODELS_I2CTRACERECORD_H_ */
@@ -12,10 +12,15 @@
 #ifndef INCLUDES_APRA_MODELS_I2CTRANSACTIONMESSAGE_H_
 #define INCLUDES_APRA_MODELS_I2CTRANSACTIONMESSAGE_H_
 
+#include <memory>
 #include <models/Message.h>
 #include <models/I2CMessage.h>
 #include <models/I2CError.h>
+#include <models/I2CTransactionProgram.h>
 #include "constants/EventCallbacks.h"
+#include "constants/I2CPriority.h"
+#include "constants/I2CPublishFilter.h"
+#include "utils/I2CCompletionQueue.h"
 
 namespace apra
 {
@@ -32,14 +37,43 @@ public:
 	void setError(I2CError error);
 	vector<I2C_Message>& getAllMessages();
 	void registerEventHandle(void *callback, void *context);
-	void publishTransaction();
+	void registerConstEventHandle(void *callback, void *context);
+	bool hasEventHandle() const;
+	void publishTransaction() const;
+	void setPeriod(uint64_t periodUsec, uint64_t phaseUsec = 0);
+	void pinPhase(uint64_t phaseUsec);
+	void setPriority(I2C_PRIORITY priority);
+	void setDeadline(uint64_t deadlineUsec, bool dropIfStale = false);
+	void setAdaptivePeriod(uint64_t minPeriodUsec, uint64_t maxPeriodUsec,
+			uint64_t changeThreshold);
+	bool isAdaptive() const;
+	void setPublishFilter(I2C_PUBLISH_FILTER filter, uint64_t parameter = 0);
+	void setProgram(shared_ptr<const I2C_Transaction_Program> program);
+	void setCompletionQueue(
+			shared_ptr<I2C_Completion_Queue> completionQueue);
 	uint16_t m_chipNumber;
 	bool m_stopOnAnyTransactionFailure;
 	uint64_t m_transactionDelayUsec;
 	vector<I2C_Message> m_messages;
+	uint64_t m_periodUsec;
+	uint64_t m_phaseUsec;
+	bool m_isPhasePinned;
+	I2C_PRIORITY m_priority;
+	uint64_t m_deadlineUsec;
+	int64_t m_deadlineTs;
+	bool m_dropIfStale;
+	int64_t m_triggerTs;
+	uint64_t m_minPeriodUsec;
+	uint64_t m_maxPeriodUsec;
+	uint64_t m_changeThreshold;
+	I2C_PUBLISH_FILTER m_publishFilter;
+	uint64_t m_publishParameter;
+	shared_ptr<const I2C_Transaction_Program> m_program;
+	shared_ptr<I2C_Completion_Queue> m_completionQueue;
 protected:
 	void *m_callbackContext;
 	I2CEventCallback *m_callback;
+	I2CEventConstCallback *m_constCallback;
 	I2CError m_error;
 };
 
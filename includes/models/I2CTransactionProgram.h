@@ -0,0 +1,94 @@
+/*
+ * I2CTransactionProgram.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_MODELS_I2CTRANSACTIONPROGRAM_H_
+#define INCLUDES_APRA_MODELS_I2CTRANSACTIONPROGRAM_H_
+
+#include <stdint.h>
+#include <vector>
+#include "constants/I2CProgramOpcode.h"
+
+#define I2C_PROGRAM_VARIABLE_COUNT 8
+#define I2C_PROGRAM_NO_VARIABLE 0xFF
+#define I2C_PROGRAM_MAX_STEPS 1024
+#define I2C_PROGRAM_MAX_READ_SIZE 4096
+
+using namespace std;
+
+namespace apra
+{
+
+class I2C_Program_Instruction
+{
+public:
+	I2C_Program_Instruction();
+	I2C_Program_Instruction(I2C_PROGRAM_OPCODE opcode, uint8_t variable,
+			uint64_t value);
+	virtual ~I2C_Program_Instruction();
+	I2C_PROGRAM_OPCODE m_opcode;
+	uint8_t m_variable;
+	uint64_t m_value;
+	vector<uint8_t> m_registerNumber;
+	vector<uint8_t> m_data;
+};
+
+/*
+ * Short branching transaction run by the I2C_Interface thread in a single
+ * scheduling slot. Reads of up to eight bytes may load their big endian
+ * value into one of a few variables; later instructions test, mask and count those to pick the next
+ * instruction or the size of a read. Every bus operation executed is
+ * appended to the transaction's messages, in order, with its data and
+ * error. Jumps take instruction indexes: label() is the index the next
+ * instruction will get and setTarget() patches a forward jump. A run stops
+ * on the first bus error or after I2C_PROGRAM_MAX_STEPS instructions.
+ *
+ *   // Drain the FIFO when status bit 3 is set, 6 bytes per sample
+ *   program.read({ STATUS }, 1, 0);
+ *   program.andValue(0, 0x08);
+ *   size_t skip = program.jumpIfZero(0, 0);
+ *   program.read({ FIFO_COUNT }, 1, 1);
+ *   program.multiply(1, 6);
+ *   program.readVariable({ FIFO_DATA }, 1, 192);
+ *   program.setTarget(skip, program.label());
+ */
+class I2C_Transaction_Program
+{
+public:
+	I2C_Transaction_Program();
+	virtual ~I2C_Transaction_Program();
+	size_t read(vector<uint8_t> registerNumber, uint64_t size,
+			uint8_t variable = I2C_PROGRAM_NO_VARIABLE);
+	size_t readVariable(vector<uint8_t> registerNumber, uint8_t sizeVariable,
+			uint64_t maxSize);
+	size_t write(vector<uint8_t> registerNumber, vector<uint8_t> data);
+	size_t load(uint8_t variable, uint64_t value);
+	size_t andValue(uint8_t variable, uint64_t mask);
+	size_t shiftRight(uint8_t variable, uint64_t bits);
+	size_t multiply(uint8_t variable, uint64_t factor);
+	size_t add(uint8_t variable, int64_t value);
+	size_t jump(size_t target);
+	size_t jumpIfZero(uint8_t variable, size_t target);
+	size_t jumpIfNotZero(uint8_t variable, size_t target);
+	size_t delay(uint64_t delayUsec);
+	size_t end();
+	size_t label() const;
+	void setTarget(size_t instruction, size_t target);
+	void setRetries(uint64_t retryCount);
+	bool isValid() const;
+	vector<I2C_Program_Instruction> m_instructions;
+	uint64_t m_retryCount;
+protected:
+	size_t append(const I2C_Program_Instruction &instruction);
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_MODELS_I2CTRANSACTIONPROGRAM_H_ */
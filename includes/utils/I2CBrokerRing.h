@@ -0,0 +1,124 @@
+/*
+ * I2CBrokerRing.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CBROKERRING_H_
+#define INCLUDES_APRA_UTILS_I2CBROKERRING_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include "constants/I2CBrokerSlotState.h"
+#include "models/I2CError.h"
+#include "models/I2CTransactionMessage.h"
+
+#define I2C_BROKER_MAGIC 0x49324342
+#define I2C_BROKER_VERSION 1
+#define I2C_BROKER_SLOT_COUNT 64
+#define I2C_BROKER_MAX_MESSAGES 8
+#define I2C_BROKER_MAX_REGISTER_SIZE 8
+#define I2C_BROKER_MAX_DATA_SIZE 64
+
+using namespace std;
+
+namespace apra
+{
+
+struct I2C_Broker_Message
+{
+	uint8_t m_type;
+	uint8_t m_registerSize;
+	uint8_t m_allowOtherProcessOnIdle;
+	uint8_t m_allowCoalescing;
+	uint16_t m_dataSize;
+	uint16_t m_compareSize;
+	uint32_t m_errorCode;
+	uint32_t m_retryCount;
+	uint32_t m_delayUsec;
+	uint32_t m_retryDelayUsec;
+	uint8_t m_registerNumber[I2C_BROKER_MAX_REGISTER_SIZE];
+	uint8_t m_data[I2C_BROKER_MAX_DATA_SIZE];
+	uint8_t m_compareData[I2C_BROKER_MAX_DATA_SIZE];
+};
+
+struct I2C_Broker_Slot
+{
+	std::atomic<uint32_t> m_state;
+	uint32_t m_clientId;
+	uint64_t m_sequence;
+	uint16_t m_chipNumber;
+	uint8_t m_priority;
+	uint8_t m_stopOnAnyFailure;
+	uint8_t m_dropIfStale;
+	uint8_t m_messageCount;
+	uint16_t m_reserved;
+	uint32_t m_errorCode;
+	uint32_t m_transactionDelayUsec;
+	int64_t m_deadlineTs;
+	I2C_Broker_Message m_messages[I2C_BROKER_MAX_MESSAGES];
+};
+
+struct I2C_Broker_Header
+{
+	uint32_t m_magic;
+	uint32_t m_version;
+	uint32_t m_slotCount;
+	uint32_t m_slotSize;
+	std::atomic<uint64_t> m_sequence;
+};
+
+/*
+ * Fixed layout of the shared memory a broker and its clients map. A client
+ * claims a free slot, writes its transaction into it and submits it; the
+ * broker writes the results into the same slot and wakes the client with a
+ * futex on the slot state, so results are read in place. Slots move
+ * FREE -> CLAIMED -> SUBMITTED -> QUEUED -> COMPLETE -> FREE; a client that
+ * stops waiting marks its slot ABANDONED and the broker frees it instead.
+ * Clients are not trusted: a slot whose counts or sizes overrun its arrays
+ * is failed with BROKER_ERROR instead of being decoded.
+ */
+class I2C_Broker_Ring
+{
+public:
+	I2C_Broker_Ring();
+	virtual ~I2C_Broker_Ring();
+	I2CError create(int regionFd);
+	I2CError attach(int regionFd);
+	void detach();
+	bool isAttached();
+	I2C_Broker_Slot& getSlot(uint32_t slot);
+	int32_t claim(uint32_t clientId);
+	bool encode(uint32_t slot, const I2C_Transaction_Message &message);
+	void submit(uint32_t slot);
+	bool wait(uint32_t slot, uint64_t timeoutUsec);
+	void decode(uint32_t slot, I2C_Transaction_Message &message);
+	void release(uint32_t slot);
+	void abandon(uint32_t slot);
+	size_t collectSubmitted(vector<uint32_t> &slots);
+	bool toMessage(uint32_t slot, I2C_Transaction_Message &message);
+	void complete(uint32_t slot, I2C_Transaction_Message &message);
+	void releaseClient(uint32_t clientId);
+	size_t getFreeCount();
+	static size_t getRegionSize();
+protected:
+	I2CError mapRegion(int regionFd);
+	static bool encodeMessage(const I2C_Message &message,
+			I2C_Broker_Message &slotMessage);
+	static bool isValidMessage(const I2C_Broker_Message &slotMessage);
+	static void wake(std::atomic<uint32_t> &state);
+
+	void *m_region;
+	I2C_Broker_Header *m_header;
+	I2C_Broker_Slot *m_slots;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CBROKERRING_H_ */
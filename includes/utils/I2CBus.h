@@ -11,12 +11,18 @@
 
 #ifndef SRC_APRA_UTILS_I2CBUS_H_
 #define SRC_APRA_UTILS_I2CBUS_H_
+#include <stdint.h>
 #include <string>
 #include <vector>
+#include "models/I2CBusStatistics.h"
+#include "utils/I2CPreparedTransfer.h"
+#include "utils/I2CTransport.h"
+#include "utils/Mutex.h"
 
 using namespace std;
 
 #define CONSEQUENT_I2C_TIME_LIMIT_US 1000
+#define I2C_SMBUS_MAX_BLOCK_SIZE 32
 namespace apra
 {
 class I2CError;
@@ -24,9 +30,12 @@ class I2C_Bus
 {
 public:
 	I2C_Bus(string i2cPath, bool shouldPrint);
+	I2C_Bus(I2C_Transport *transport, bool shouldPrint);
 	virtual ~I2C_Bus();
 	I2CError openBus();
 	void closeBus();
+	bool isOpen();
+	I2C_Transport* getTransport();
 	void setSize(uint8_t registerSize, uint8_t dataSize);
 	I2CError writeOnce(uint8_t chipAddress, uint64_t registerAddress,
 			uint64_t data);
@@ -40,14 +49,42 @@ public:
 			vector<uint8_t> data);
 	I2CError genericRead(uint8_t chipAddress, vector<uint8_t> registerAddress,
 			vector<uint8_t> &readData);
+	void prepare(I2C_Prepared_Transfer &prepared, uint8_t chipAddress,
+			const vector<uint8_t> &registerAddress, size_t dataSize,
+			bool isRead);
+	I2CError execute(I2C_Prepared_Transfer &prepared, vector<uint8_t> &data);
 	bool isI2CExecRecommended();
+	void setSMBusEnabled(bool enable);
+	uint64_t getFunctionality();
+	void setBusClock(uint64_t busClockHz);
+	uint64_t getBusClock();
+	void setStatisticsEnabled(bool enable);
+	I2C_Bus_Statistics getStatistics();
+	void resetStatistics();
+	void recordRetry(uint8_t chipAddress, const vector<uint8_t> &registerAddress);
+	static uint64_t getRegisterKey(const vector<uint8_t> &registerAddress);
 private:
+	void recordTransfer(uint8_t chipAddress,
+			const vector<uint8_t> &registerAddress, bool isRead,
+			size_t dataSize, int64_t startTs, I2CError &error);
+	int32_t getSMBusTransaction(bool isRead, size_t registerSize,
+			size_t dataSize);
+	int32_t smbusAccess(bool isRead, int32_t transaction, uint8_t command,
+			vector<uint8_t> &data, size_t dataSize);
+	string getDebugString(const char *function,
+			const vector<uint8_t> &registerAddress);
 	string m_i2cPath;
 	bool m_shouldPrint;
-	int32_t m_i2cFileDescriptor;
+	I2C_Transport *m_transport;
+	bool m_ownsTransport;
 	uint8_t m_registerSize;
 	uint8_t m_dataSize;
 	uint64_t m_lastI2COperationTs;
+	bool m_smbusEnabled;
+	uint64_t m_prepareGeneration;
+	bool m_statisticsEnabled;
+	I2C_Bus_Statistics m_statistics;
+	apra::Mutex m_statisticsLock;
 };
 }
 
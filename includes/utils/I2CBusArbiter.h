@@ -0,0 +1,92 @@
+/*
+ * I2CBusArbiter.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CBUSARBITER_H_
+#define INCLUDES_APRA_UTILS_I2CBUSARBITER_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include "constants/I2CPriority.h"
+#include "models/I2CRegisteredEvent.h"
+#include "models/I2CTransactionMessage.h"
+
+using namespace std;
+
+namespace apra
+{
+
+class I2C_Arbiter_Entry
+{
+public:
+	I2C_Arbiter_Entry();
+	virtual ~I2C_Arbiter_Entry();
+	bool isStale(int64_t timeNow) const;
+	I2C_PRIORITY m_priority;
+	int64_t m_admitTs;
+	int64_t m_deadlineTs;
+	bool m_dropIfStale;
+	uint64_t m_sequence;
+	I2C_Transaction_Message *m_request;
+	bool m_ownsRequest;
+	shared_ptr<I2C_Registered_Event> m_event;
+};
+
+/*
+ * Pending work of the I2C_Interface thread, one queue per priority class.
+ * The thread pops the most urgent entry at every transaction boundary, so an
+ * urgent request waits for at most the transaction already on the bus.
+ * Within a class entries run earliest deadline first; entries without a
+ * deadline follow in FIFO order. Only the interface thread touches the
+ * queues; the counters may be read from any thread.
+ */
+class I2C_Bus_Arbiter
+{
+public:
+	I2C_Bus_Arbiter();
+	virtual ~I2C_Bus_Arbiter();
+	void pushRequest(I2C_Transaction_Message *request, bool ownsRequest,
+			int64_t timeNow);
+	void pushEvent(shared_ptr<I2C_Registered_Event> event, int64_t timeNow,
+			int64_t deadlineTs);
+	bool pop(I2C_Arbiter_Entry &entry, int64_t timeNow,
+			I2C_PRIORITY lowestPriority = I2C_PRIORITY_BACKGROUND);
+	bool removeRequest(const I2C_Transaction_Message *request);
+	bool hasPending(I2C_PRIORITY lowestPriority = I2C_PRIORITY_BACKGROUND);
+	size_t size();
+	uint64_t getExecutedCount(I2C_PRIORITY priority);
+	uint64_t getMaxWaitUsec(I2C_PRIORITY priority);
+	uint64_t getDeadlineMissCount(I2C_PRIORITY priority);
+	uint64_t getDroppedCount(I2C_PRIORITY priority);
+	void recordCompletion(const I2C_Arbiter_Entry &entry, int64_t timeNow);
+	void recordDrop(const I2C_Arbiter_Entry &entry);
+	void resetStatistics();
+	static I2C_PRIORITY getPriority(const I2C_Transaction_Message &message);
+protected:
+	class EntryCompare
+	{
+	public:
+		bool operator()(const I2C_Arbiter_Entry &first,
+				const I2C_Arbiter_Entry &second) const;
+	};
+	void push(I2C_Arbiter_Entry &entry);
+	vector<I2C_Arbiter_Entry> m_queues[I2C_PRIORITY_COUNT];
+	uint64_t m_sequence;
+	std::atomic<uint64_t> m_executedCount[I2C_PRIORITY_COUNT];
+	std::atomic<uint64_t> m_maxWaitUsec[I2C_PRIORITY_COUNT];
+	std::atomic<uint64_t> m_deadlineMissCount[I2C_PRIORITY_COUNT];
+	std::atomic<uint64_t> m_droppedCount[I2C_PRIORITY_COUNT];
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CBUSARBITER_H_ */
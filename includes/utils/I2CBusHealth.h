@@ -0,0 +1,93 @@
+/*
+ * I2CBusHealth.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CBUSHEALTH_H_
+#define INCLUDES_APRA_UTILS_I2CBUSHEALTH_H_
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include "utils/Mutex.h"
+
+using namespace std;
+
+namespace apra
+{
+
+class I2C_Health_Policy
+{
+public:
+	I2C_Health_Policy();
+	virtual ~I2C_Health_Policy();
+	bool m_enabled;
+	uint32_t m_quarantineThreshold;
+	uint64_t m_quarantineBaseUsec;
+	uint64_t m_quarantineMaxUsec;
+	uint32_t m_stuckChipThreshold;
+	uint32_t m_stuckErrorThreshold;
+	uint64_t m_stuckTimeoutUsec;
+	uint64_t m_recoveryBaseUsec;
+	uint64_t m_recoveryMaxUsec;
+};
+
+class I2C_Chip_Health
+{
+public:
+	I2C_Chip_Health();
+	virtual ~I2C_Chip_Health();
+	uint32_t m_consecutiveFailures;
+	uint32_t m_quarantineLevel;
+	int64_t m_quarantineUntilTs;
+	uint64_t m_quarantineCount;
+};
+
+/*
+ * Tracks message results per chip, one result per message once its retries
+ * are used up; off unless the policy enables it. A chip failing
+ * m_quarantineThreshold times in a row is quarantined, doubling the quarantine on every relapse,
+ * so its traffic stops reaching the bus. Failures on several chips with no
+ * success in between, or no success for m_stuckTimeoutUsec, mark the bus as
+ * stuck; the adapter is then reopened with exponential backoff until a
+ * transfer succeeds again.
+ */
+class I2C_Bus_Health
+{
+public:
+	I2C_Bus_Health();
+	virtual ~I2C_Bus_Health();
+	void setPolicy(const I2C_Health_Policy &policy);
+	I2C_Health_Policy getPolicy();
+	bool isChipAvailable(uint8_t chipAddress, int64_t timeNow);
+	void recordResult(uint8_t chipAddress, bool success, int64_t timeNow);
+	bool isBusStuck();
+	bool isRecoveryDue(int64_t timeNow);
+	void recordRecovery(bool success, int64_t timeNow);
+	uint64_t getRecoveryCount();
+	uint64_t getQuarantineCount(uint8_t chipAddress);
+	void reset();
+	static uint64_t getBackoffUsec(uint64_t baseUsec, uint64_t maxUsec,
+			uint32_t level);
+protected:
+	Mutex m_lock;
+	I2C_Health_Policy m_policy;
+	map<uint8_t, I2C_Chip_Health> m_chips;
+	set<uint8_t> m_failingChips;
+	uint32_t m_consecutiveBusFailures;
+	int64_t m_firstFailureTs;
+	bool m_isBusStuck;
+	uint32_t m_recoveryLevel;
+	int64_t m_nextRecoveryTs;
+	uint64_t m_recoveryCount;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CBUSHEALTH_H_ */
@@ -0,0 +1,76 @@
+/*
+ * I2CCapacityPlanner.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CCAPACITYPLANNER_H_
+#define INCLUDES_APRA_UTILS_I2CCAPACITYPLANNER_H_
+
+#include <stdint.h>
+#include <map>
+#include "constants/I2CAdmissionMode.h"
+#include "models/I2CCapacityReport.h"
+#include "models/I2CTransactionMessage.h"
+#include "utils/Mutex.h"
+
+using namespace std;
+
+namespace apra
+{
+
+class I2C_Capacity_Policy
+{
+public:
+	I2C_Capacity_Policy();
+	virtual ~I2C_Capacity_Policy();
+	I2C_ADMISSION_MODE m_mode;
+	double m_budget;
+	uint64_t m_transferOverheadUsec;
+};
+
+/*
+ * Utilisation budget of the registered events on one bus. Each event is
+ * costed from its byte counts at the bus clock, plus a per-transfer
+ * overhead for the driver and the delays that block the bus thread, over
+ * the shortest period it can run at. An event that would push the total
+ * past the budget is refused or only counted and reported, depending on
+ * the admission mode. Retries are not budgeted.
+ */
+class I2C_Capacity_Planner
+{
+public:
+	I2C_Capacity_Planner();
+	virtual ~I2C_Capacity_Planner();
+	void setPolicy(const I2C_Capacity_Policy &policy);
+	I2C_Capacity_Policy getPolicy();
+	void setBusClock(uint64_t busClockHz);
+	bool admit(I2C_Capacity_Entry entry);
+	void remove(uint64_t handle);
+	double getUtilisation();
+	uint64_t getCostUsec(uint64_t handle);
+	uint64_t getRejectedCount();
+	uint64_t getWarningCount();
+	I2C_Capacity_Report getReport();
+	static I2C_Capacity_Entry estimate(uint64_t handle,
+			const I2C_Transaction_Message &message, uint64_t periodUsec);
+protected:
+	void updateBusTime(I2C_Capacity_Entry &entry);
+	double getTotalUtilisation();
+
+	Mutex m_lock;
+	I2C_Capacity_Policy m_policy;
+	uint64_t m_busClockHz;
+	map<uint64_t, I2C_Capacity_Entry> m_entries;
+	uint64_t m_rejectedCount;
+	uint64_t m_warningCount;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CCAPACITYPLANNER_H_ */
@@ -0,0 +1,48 @@
+/*
+ * I2CCompletionQueue.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CCOMPLETIONQUEUE_H_
+#define INCLUDES_APRA_UTILS_I2CCOMPLETIONQUEUE_H_
+
+#include <queue>
+#include "utils/Mutex.h"
+
+using namespace std;
+
+namespace apra
+{
+
+class I2C_Transaction_Message;
+
+/*
+ * Private response path for one owner's transactions, kept away from the
+ * interface's response queue. Each transaction holds a shared reference, so
+ * the queue outlives an owner that stops waiting: once the owner closes it,
+ * pushes fail and the interface frees the late transactions itself.
+ */
+class I2C_Completion_Queue
+{
+public:
+	I2C_Completion_Queue();
+	virtual ~I2C_Completion_Queue();
+	bool push(I2C_Transaction_Message *message);
+	bool pop(I2C_Transaction_Message *&message);
+	void close();
+	bool isOpen();
+protected:
+	Mutex m_lock;
+	bool m_isOpen;
+	queue<I2C_Transaction_Message*> m_messages;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CCOMPLETIONQUEUE_H_ */
@@ -0,0 +1,45 @@
+/*
+ * I2CDevTransport.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CDEVTRANSPORT_H_
+#define INCLUDES_APRA_UTILS_I2CDEVTRANSPORT_H_
+
+#include <string>
+#include "utils/I2CTransport.h"
+
+using namespace std;
+
+namespace apra
+{
+
+class I2C_Dev_Transport: public I2C_Transport
+{
+public:
+	I2C_Dev_Transport(string i2cPath, bool shouldPrint);
+	virtual ~I2C_Dev_Transport();
+	virtual I2CError openBus();
+	virtual void closeBus();
+	virtual bool isOpen();
+	virtual uint64_t getFunctionality();
+	virtual bool selectChip(uint8_t chipAddress);
+	virtual int32_t transfer(struct i2c_msg *messages, uint32_t count);
+	virtual int32_t smbusTransfer(struct i2c_smbus_ioctl_data &args);
+protected:
+	string m_i2cPath;
+	bool m_shouldPrint;
+	int32_t m_i2cFileDescriptor;
+	uint64_t m_functionality;
+	int32_t m_slaveAddress;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CDEVTRANSPORT_H_ */
@@ -0,0 +1,123 @@
+/*
+ * I2CDeviceSnapshot.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CDEVICESNAPSHOT_H_
+#define INCLUDES_APRA_UTILS_I2CDEVICESNAPSHOT_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+#include "models/I2CMessage.h"
+#include "utils/Mutex.h"
+
+#define I2C_SNAPSHOT_MAGIC "API2CSNP"
+#define I2C_SNAPSHOT_VERSION 1
+#define I2C_INIT_MAX_BURST_SIZE 32
+
+using namespace std;
+
+namespace apra
+{
+
+/*
+ * Init sequence of one chip and the signature registers that prove it is
+ * still applied. Signature registers should hold values the init sequence
+ * sets and a reset clears; a device without signature registers is never
+ * trusted and always gets the full sequence.
+ *
+ * With m_writeChangedOnly, consecutive writes to contiguous registers are
+ * burst-read first and only the writes that differ from the chip go out;
+ * m_verify reads such runs back afterwards. Writes with side effects (resets,
+ * FIFO or command registers) opt out by clearing m_allowCoalescing.
+ */
+class I2C_Device_Init
+{
+public:
+	I2C_Device_Init();
+	I2C_Device_Init(uint8_t chipAddress, vector<I2C_Message> initMessages);
+	virtual ~I2C_Device_Init();
+	void addSignature(vector<uint8_t> registerNumber, uint64_t dataSize);
+	uint64_t getInitHash() const;
+	bool isWriteRunMember(size_t index) const;
+	size_t getWriteRunEnd(size_t begin) const;
+	uint8_t m_chipAddress;
+	vector<I2C_Message> m_initMessages;
+	vector<I2C_Message> m_signature;
+	bool m_writeChangedOnly;
+	bool m_verify;
+protected:
+	static void hashValue(uint64_t &hash, uint64_t value);
+	static void hashBytes(uint64_t &hash, const vector<uint8_t> &bytes);
+	static uint64_t getRegisterValue(const vector<uint8_t> &registerNumber);
+};
+
+class I2C_Init_Report
+{
+public:
+	I2C_Init_Report();
+	virtual ~I2C_Init_Report();
+	bool m_isWarm;
+	uint64_t m_readCount;
+	uint64_t m_writeCount;
+	uint64_t m_skippedWriteCount;
+	uint64_t m_mismatchCount;
+};
+
+/*
+ * Shadow of the signature registers of initialised devices, kept across
+ * restarts in a compact file. An entry is trusted only while the stored hash
+ * of the init sequence matches the one in use and every signature register
+ * reads back as it did after the last full init. Only devices confirmed in
+ * the current run, warm or cold, are written back by save().
+ */
+class I2C_Device_Snapshot
+{
+public:
+	I2C_Device_Snapshot();
+	virtual ~I2C_Device_Snapshot();
+	bool load(string path);
+	bool save(string path);
+	bool isCurrent(const I2C_Device_Init &device);
+	bool verify(const I2C_Device_Init &device,
+			const vector<I2C_Message> &signature);
+	void record(const I2C_Device_Init &device,
+			const vector<I2C_Message> &signature);
+	void remove(uint8_t chipAddress);
+	void clear();
+	size_t size();
+	uint64_t getWarmCount();
+	uint64_t getColdCount();
+	void countCold();
+protected:
+	struct Entry
+	{
+		uint64_t m_initHash;
+		vector<vector<uint8_t> > m_signatureData;
+		bool m_isConfirmed;
+	};
+	static bool decode(const vector<uint8_t> &buffer,
+			map<uint8_t, Entry> &entries);
+	static void putBytes(vector<uint8_t> &buffer,
+			const vector<uint8_t> &bytes);
+	static bool getBytes(const vector<uint8_t> &buffer, size_t &offset,
+			vector<uint8_t> &bytes);
+
+	Mutex m_lock;
+	map<uint8_t, Entry> m_entries;
+	std::atomic<uint64_t> m_warmCount;
+	std::atomic<uint64_t> m_coldCount;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CDEVICESNAPSHOT_H_ */
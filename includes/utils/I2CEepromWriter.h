@@ -0,0 +1,113 @@
+/*
+ * I2CEepromWriter.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CEEPROMWRITER_H_
+#define INCLUDES_APRA_UTILS_I2CEEPROMWRITER_H_
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+#include "models/I2CError.h"
+#include "utils/I2CBus.h"
+#include "utils/I2CMuxTopology.h"
+#include "utils/Mutex.h"
+
+using namespace std;
+
+namespace apra
+{
+
+class I2C_Eeprom_Config
+{
+public:
+	I2C_Eeprom_Config();
+	I2C_Eeprom_Config(uint8_t chipAddress, uint8_t addressBytes,
+			uint64_t pageSize, uint64_t capacity);
+	virtual ~I2C_Eeprom_Config();
+	uint8_t m_chipAddress;
+	uint8_t m_addressBytes;
+	uint64_t m_pageSize;
+	uint64_t m_capacity;
+	uint64_t m_writeCycleTimeoutUsec;
+	uint64_t m_pollIntervalUsec;
+	uint64_t m_readChunkSize;
+	bool m_verify;
+};
+
+class I2C_Eeprom_Report
+{
+public:
+	I2C_Eeprom_Report();
+	virtual ~I2C_Eeprom_Report();
+	double getThroughputBytesPerSec() const;
+	uint64_t m_bytesWritten;
+	uint64_t m_pageCount;
+	uint64_t m_pollCount;
+	uint64_t m_maxWriteCycleUsec;
+	int64_t m_writeTimeUsec;
+	int64_t m_verifyTimeUsec;
+	uint64_t m_mismatchCount;
+	uint64_t m_firstMismatchAddress;
+};
+
+/*
+ * Writes a buffer to a page-organised EEPROM or flash. The buffer is split
+ * at page boundaries and each page goes out as one burst. Instead of a fixed
+ * write-cycle delay the next page is offered as soon as the previous one is
+ * handed over: the chip NACKs while it is busy, so the retried page write is
+ * the acknowledge poll. The final page is followed by an address-only poll
+ * and, when enabled, a burst read-back. Address bits beyond m_addressBytes
+ * are carried in the low bits of the chip address, as on 24C04-24C16 parts.
+ * The bus lock is held per transfer only, so other traffic on a shared
+ * interface keeps flowing between pages; with a mux topology each transfer
+ * selects its route under that lock.
+ */
+class I2C_Eeprom_Writer
+{
+public:
+	I2C_Eeprom_Writer(I2C_Bus &bus, Mutex *busLock = NULL,
+			I2C_Mux_Topology *muxTopology = NULL);
+	virtual ~I2C_Eeprom_Writer();
+	I2CError write(const I2C_Eeprom_Config &config, uint64_t address,
+			const vector<uint8_t> &data, I2C_Eeprom_Report &report);
+	I2CError read(const I2C_Eeprom_Config &config, uint64_t address,
+			size_t size, vector<uint8_t> &data);
+	I2CError verify(const I2C_Eeprom_Config &config, uint64_t address,
+			const vector<uint8_t> &data, I2C_Eeprom_Report &report);
+	vector<uint8_t> getChipAddresses(const I2C_Eeprom_Config &config,
+			uint64_t address, size_t size);
+	static vector<pair<uint64_t, size_t> > getPageSpans(uint64_t address,
+			size_t size, uint64_t pageSize);
+protected:
+	I2CError checkRange(const I2C_Eeprom_Config &config, uint64_t address,
+			size_t size);
+	I2CError writePage(const I2C_Eeprom_Config &config, uint64_t address,
+			const vector<uint8_t> &data, I2C_Eeprom_Report &report);
+	I2CError waitWriteCycle(const I2C_Eeprom_Config &config,
+			uint64_t address, I2C_Eeprom_Report &report);
+	I2CError transfer(const I2C_Eeprom_Config &config, uint64_t address,
+			const vector<uint8_t> &data);
+	I2CError selectRoute(uint8_t chipAddress);
+	uint8_t getChipAddress(const I2C_Eeprom_Config &config, uint64_t address);
+	vector<uint8_t> getRegisterAddress(const I2C_Eeprom_Config &config,
+			uint64_t address);
+	uint64_t getBlockSize(const I2C_Eeprom_Config &config);
+
+	I2C_Bus &m_bus;
+	Mutex m_ownLock;
+	Mutex *m_busLock;
+	I2C_Mux_Topology *m_muxTopology;
+	int64_t m_lastWriteTs;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CEEPROMWRITER_H_ */
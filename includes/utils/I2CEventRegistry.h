@@ -0,0 +1,56 @@
+/*
+ * I2CEventRegistry.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CEVENTREGISTRY_H_
+#define INCLUDES_APRA_UTILS_I2CEVENTREGISTRY_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include "models/I2CRegisteredEvent.h"
+#include "utils/I2CSampleRing.h"
+#include "utils/Mutex.h"
+
+using namespace std;
+
+namespace apra
+{
+
+typedef map<uint64_t, shared_ptr<I2C_Registered_Event> > I2C_Event_Map;
+
+/*
+ * Copy-on-write registry of periodic events. Writers rebuild and publish a
+ * new immutable map; the reader keeps using its snapshot until the version
+ * changes, so a tick never takes a lock or copies a message.
+ */
+class I2C_Event_Registry
+{
+public:
+	I2C_Event_Registry();
+	virtual ~I2C_Event_Registry();
+	uint64_t add(const I2C_Transaction_Message &message,
+			shared_ptr<I2C_Sample_Ring> sampleRing = shared_ptr<I2C_Sample_Ring>());
+	uint64_t add(shared_ptr<I2C_Registered_Event> event);
+	bool remove(uint64_t handle);
+	shared_ptr<const I2C_Event_Map> getSnapshot();
+	uint64_t getVersion();
+	size_t size();
+protected:
+	void publish(shared_ptr<const I2C_Event_Map> snapshot);
+	Mutex m_writeLock;
+	shared_ptr<const I2C_Event_Map> m_snapshot;
+	std::atomic<uint64_t> m_version;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CEVENTREGISTRY_H_ */
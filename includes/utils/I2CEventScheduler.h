@@ -0,0 +1,70 @@
+/*
+ * I2CEventScheduler.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CEVENTSCHEDULER_H_
+#define INCLUDES_APRA_UTILS_I2CEVENTSCHEDULER_H_
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+#define I2C_ADAPTIVE_SPEEDUP_DIVISOR 2
+#define I2C_ADAPTIVE_BACKOFF_DIVISOR 4
+
+using namespace std;
+
+namespace apra
+{
+
+/*
+ * Deadline min-heap of registered event handles. Removal and rescheduling
+ * are lazy: superseded heap entries are discarded when they reach the top.
+ * Adaptive periods halve while a value changes and grow by a quarter while
+ * it is stable, so a burst is caught quickly and idle polling decays slowly.
+ */
+class I2C_Event_Scheduler
+{
+public:
+	I2C_Event_Scheduler();
+	virtual ~I2C_Event_Scheduler();
+	void schedule(uint64_t handle, int64_t deadline);
+	void remove(uint64_t handle);
+	bool popDue(int64_t timeNow, uint64_t &handle, int64_t &deadline);
+	bool isDue(int64_t timeNow);
+	bool getNextDeadline(int64_t &deadline);
+	size_t size();
+	void clear();
+	static int64_t getFirstDeadline(int64_t epoch, int64_t timeNow,
+			uint64_t periodUsec, uint64_t phaseUsec);
+	static int64_t getNextDeadline(int64_t lastDeadline, int64_t timeNow,
+			uint64_t periodUsec);
+	static uint64_t getAdaptivePeriod(uint64_t periodUsec, bool isChanging,
+			uint64_t minPeriodUsec, uint64_t maxPeriodUsec);
+protected:
+	struct Entry
+	{
+		int64_t m_deadline;
+		uint64_t m_handle;
+		uint64_t m_generation;
+	};
+	struct EntryCompare
+	{
+		bool operator()(const Entry &first, const Entry &second) const;
+	};
+	void discardStale();
+	vector<Entry> m_heap;
+	map<uint64_t, uint64_t> m_generations;
+	uint64_t m_generationCounter;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CEVENTSCHEDULER_H_ */
@@ -0,0 +1,73 @@
+/*
+ * I2CMuxTopology.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CMUXTOPOLOGY_H_
+#define INCLUDES_APRA_UTILS_I2CMUXTOPOLOGY_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include "models/I2CError.h"
+#include "utils/I2CBus.h"
+
+#define I2C_MUX_CHANNEL_COUNT 8
+#define I2C_MUX_UNKNOWN_CHANNEL -1
+
+using namespace std;
+
+namespace apra
+{
+
+class I2C_Mux_Route
+{
+public:
+	I2C_Mux_Route();
+	I2C_Mux_Route(uint8_t muxAddress, uint8_t channel);
+	virtual ~I2C_Mux_Route();
+	uint8_t m_muxAddress;
+	uint8_t m_channel;
+};
+
+/*
+ * Which chips sit behind which channel of a PCA954x-style multiplexer. The
+ * channel each mux is switched to is cached, so a select write only goes
+ * out when a chip on another channel is addressed; a mux may itself sit
+ * behind another mux. Chip addresses must be unique across channels. The
+ * cache is invalidated when the bus is reopened or a routed transfer fails,
+ * since the mux may have been reset. Callers serialise access; only the
+ * counters may be read from any thread.
+ */
+class I2C_Mux_Topology
+{
+public:
+	I2C_Mux_Topology();
+	virtual ~I2C_Mux_Topology();
+	bool addDevice(uint8_t chipAddress, uint8_t muxAddress, uint8_t channel);
+	void removeDevice(uint8_t chipAddress);
+	bool isRouted(uint8_t chipAddress) const;
+	bool isSelected(uint8_t chipAddress) const;
+	int32_t getGroup(uint8_t chipAddress) const;
+	I2CError select(uint8_t chipAddress, I2C_Bus &bus);
+	void invalidate();
+	void invalidate(uint8_t chipAddress);
+	uint64_t getSelectCount();
+	uint64_t getSkippedCount();
+	static uint8_t getControlByte(uint8_t channel);
+protected:
+	map<uint8_t, I2C_Mux_Route> m_routes;
+	map<uint8_t, int32_t> m_selectedChannels;
+	std::atomic<uint64_t> m_selectCount;
+	std::atomic<uint64_t> m_skippedCount;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CMUXTOPOLOGY_H_ */
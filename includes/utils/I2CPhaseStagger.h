@@ -0,0 +1,67 @@
+/*
+ * I2CPhaseStagger.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CPHASESTAGGER_H_
+#define INCLUDES_APRA_UTILS_I2CPHASESTAGGER_H_
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include "utils/Mutex.h"
+
+#define I2C_STAGGER_MAX_SLOTS 4096
+
+using namespace std;
+
+namespace apra
+{
+
+/*
+ * Spreads periodic events over time slots, one slot per interface tick.
+ * Each event is placed at the phase whose releases meet the least bus time
+ * already planned in the same slots, over the common hyperperiod of all
+ * events (capped at I2C_STAGGER_MAX_SLOTS slots). An event with a longer
+ * period is placed within the other events' hyperperiod, so neither the
+ * timeline nor the phases searched grow with it. Pinned events keep their
+ * phase but still count as load for the events placed after them.
+ */
+class I2C_Phase_Stagger
+{
+public:
+	I2C_Phase_Stagger(uint64_t slotUsec);
+	virtual ~I2C_Phase_Stagger();
+	uint64_t assign(uint64_t handle, uint64_t periodUsec, uint64_t costUsec);
+	void reserve(uint64_t handle, uint64_t periodUsec, uint64_t phaseUsec,
+			uint64_t costUsec);
+	void remove(uint64_t handle);
+	bool getPhase(uint64_t handle, uint64_t &phaseUsec);
+	uint64_t getPeakLoadUsec();
+	void clear();
+protected:
+	struct Load
+	{
+		uint64_t m_periodSlots;
+		uint64_t m_phaseSlot;
+		uint64_t m_costUsec;
+	};
+	uint64_t getPeriodSlots(uint64_t periodUsec);
+	uint64_t getHyperperiodSlots(uint64_t periodSlots);
+	void fillTimeline(uint64_t slotCount);
+
+	Mutex m_lock;
+	uint64_t m_slotUsec;
+	map<uint64_t, Load> m_loads;
+	vector<uint64_t> m_timeline;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CPHASESTAGGER_H_ */
@@ -0,0 +1,53 @@
+/*
+ * I2CPreparedTransfer.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CPREPAREDTRANSFER_H_
+#define INCLUDES_APRA_UTILS_I2CPREPAREDTRANSFER_H_
+
+#include <stdint.h>
+#include <vector>
+#include "utils/I2CTransport.h"
+
+using namespace std;
+
+namespace apra
+{
+
+/*
+ * A register access resolved once by I2C_Bus::prepare: the SMBus transaction
+ * or the i2c_msg array and its transfer buffer are built up front, so
+ * executing it again only fills in data and issues the ioctl. It is rebuilt
+ * automatically when the bus is reopened or a write changes length.
+ */
+class I2C_Prepared_Transfer
+{
+public:
+	I2C_Prepared_Transfer();
+	I2C_Prepared_Transfer(const I2C_Prepared_Transfer &other);
+	virtual ~I2C_Prepared_Transfer();
+	I2C_Prepared_Transfer& operator=(const I2C_Prepared_Transfer &other);
+	bool isPrepared() const;
+	void bindMessages();
+
+	uint64_t m_generation;
+	uint8_t m_chipAddress;
+	bool m_isRead;
+	int32_t m_smbusTransaction;
+	size_t m_dataSize;
+	vector<uint8_t> m_registerAddress;
+	vector<uint8_t> m_buffer;
+	struct i2c_msg m_messages[2];
+	uint32_t m_messageCount;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CPREPAREDTRANSFER_H_ */
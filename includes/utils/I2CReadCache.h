@@ -0,0 +1,75 @@
+/*
+ * I2CReadCache.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CREADCACHE_H_
+#define INCLUDES_APRA_UTILS_I2CREADCACHE_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <vector>
+#include "utils/Mutex.h"
+
+#define I2C_READ_CACHE_MAX_ENTRIES 256
+
+using namespace std;
+
+namespace apra
+{
+
+/*
+ * Last result of each (chip, register, size) read. A result is shared with
+ * a request admitted before the read started, so identical requests queued
+ * together cost one bus read, and with any request for a freshness window
+ * after it. Writes to a chip drop its results.
+ */
+class I2C_Read_Cache
+{
+public:
+	I2C_Read_Cache();
+	virtual ~I2C_Read_Cache();
+	void setFreshness(uint64_t freshnessUsec);
+	uint64_t getFreshness();
+	bool lookup(uint8_t chipNumber, const vector<uint8_t> &registerNumber,
+			uint64_t dataSize, int64_t requestTs, int64_t timeNow,
+			vector<uint8_t> &data);
+	void store(uint8_t chipNumber, const vector<uint8_t> &registerNumber,
+			const vector<uint8_t> &data, int64_t readTs);
+	void invalidate();
+	void invalidate(uint8_t chipNumber);
+	size_t size();
+	uint64_t getHitCount();
+	uint64_t getMissCount();
+protected:
+	struct Key
+	{
+		uint8_t m_chipNumber;
+		vector<uint8_t> m_registerNumber;
+		uint64_t m_dataSize;
+		bool operator<(const Key &other) const;
+	};
+	struct Entry
+	{
+		int64_t m_readTs;
+		vector<uint8_t> m_data;
+	};
+	void evictExpired(int64_t timeNow);
+
+	Mutex m_lock;
+	uint64_t m_freshnessUsec;
+	map<Key, Entry> m_entries;
+	std::atomic<uint64_t> m_hitCount;
+	std::atomic<uint64_t> m_missCount;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CREADCACHE_H_ */
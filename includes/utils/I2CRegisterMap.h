@@ -0,0 +1,273 @@
+/*
+ * I2CRegisterMap.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CREGISTERMAP_H_
+#define INCLUDES_APRA_UTILS_I2CREGISTERMAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <vector>
+#include "constants/I2CByteOrder.h"
+#include "controllers/I2CInterface.h"
+#include "models/I2CMessage.h"
+#include "models/I2CTransactionMessage.h"
+
+using namespace std;
+
+namespace apra
+{
+
+template<size_t Bytes>
+struct I2C_Register_Value
+{
+	typedef uint64_t type;
+};
+
+template<>
+struct I2C_Register_Value<1>
+{
+	typedef uint8_t type;
+};
+
+template<>
+struct I2C_Register_Value<2>
+{
+	typedef uint16_t type;
+};
+
+template<>
+struct I2C_Register_Value<3>
+{
+	typedef uint32_t type;
+};
+
+template<>
+struct I2C_Register_Value<4>
+{
+	typedef uint32_t type;
+};
+
+/*
+ * Compile-time register declaration. Address bytes are always sent most
+ * significant first; Order applies to the data bytes. Encode and decode work
+ * on fixed-size arrays, so they never allocate.
+ *
+ *   typedef I2C_Register<0x01, 1, 2> Tmp102Config;
+ *   typedef I2C_Field<Tmp102Config, 13, 2> Tmp102Resolution;
+ */
+template<uint64_t Address, size_t AddressBytes, size_t DataBytes,
+		I2C_BYTE_ORDER Order = I2C_BIG_ENDIAN, bool Volatile = true>
+class I2C_Register
+{
+	static_assert((AddressBytes >= 1) && (AddressBytes <= 8),
+			"register address must be 1 to 8 bytes");
+	static_assert((DataBytes >= 1) && (DataBytes <= 8),
+			"register data must be 1 to 8 bytes");
+	static_assert((AddressBytes == 8) || (Address >> (AddressBytes * 8)) == 0,
+			"register address does not fit its address width");
+public:
+	typedef typename I2C_Register_Value<DataBytes>::type value_type;
+	typedef array<uint8_t, AddressBytes> address_bytes;
+	typedef array<uint8_t, DataBytes> data_bytes;
+
+	static constexpr uint64_t ADDRESS = Address;
+	static constexpr size_t ADDRESS_BYTES = AddressBytes;
+	static constexpr size_t DATA_BYTES = DataBytes;
+	static constexpr size_t DATA_BITS = DataBytes * 8;
+	static constexpr I2C_BYTE_ORDER ORDER = Order;
+	static constexpr bool IS_VOLATILE = Volatile;
+
+	static address_bytes encodeAddress()
+	{
+		address_bytes bytes;
+		for (size_t index = 0; index < AddressBytes; index++)
+		{
+			bytes[index] = (Address >> ((AddressBytes - 1 - index) * 8)) & 0xFF;
+		}
+		return bytes;
+	}
+
+	static data_bytes encode(value_type value)
+	{
+		data_bytes bytes;
+		for (size_t index = 0; index < DataBytes; index++)
+		{
+			bytes[getByteIndex(index)] = (uint64_t) value >> (index * 8);
+		}
+		return bytes;
+	}
+
+	static value_type decode(const data_bytes &bytes)
+	{
+		uint64_t value = 0;
+		for (size_t index = 0; index < DataBytes; index++)
+		{
+			value |= (uint64_t) bytes[getByteIndex(index)] << (index * 8);
+		}
+		return value;
+	}
+
+	static bool decode(const vector<uint8_t> &bytes, value_type &value)
+	{
+		if (bytes.size() != DataBytes)
+		{
+			return false;
+		}
+		data_bytes data;
+		std::copy(bytes.begin(), bytes.end(), data.begin());
+		value = decode(data);
+		return true;
+	}
+
+	static I2C_Message read()
+	{
+		address_bytes address = encodeAddress();
+		I2C_Message message;
+		message.configureRead(vector<uint8_t>(address.begin(), address.end()),
+				DataBytes);
+		return message;
+	}
+
+	static I2C_Message write(value_type value)
+	{
+		address_bytes address = encodeAddress();
+		data_bytes data = encode(value);
+		I2C_Message message;
+		message.configureWrite(vector<uint8_t>(address.begin(), address.end()),
+				vector<uint8_t>(data.begin(), data.end()));
+		return message;
+	}
+
+	static bool decode(const I2C_Message &message, value_type &value)
+	{
+		return !I2CError(message.m_error).isError()
+				&& decode(message.m_data, value);
+	}
+private:
+	// Position of the byte holding bits [index * 8, index * 8 + 7]
+	static constexpr size_t getByteIndex(size_t index)
+	{
+		return (Order == I2C_BIG_ENDIAN) ? (DataBytes - 1 - index) : index;
+	}
+};
+
+template<uint64_t Address, size_t AddressBytes, size_t DataBytes,
+		I2C_BYTE_ORDER Order, bool Volatile>
+constexpr uint64_t I2C_Register<Address, AddressBytes, DataBytes, Order, Volatile>::ADDRESS;
+template<uint64_t Address, size_t AddressBytes, size_t DataBytes,
+		I2C_BYTE_ORDER Order, bool Volatile>
+constexpr size_t I2C_Register<Address, AddressBytes, DataBytes, Order, Volatile>::ADDRESS_BYTES;
+template<uint64_t Address, size_t AddressBytes, size_t DataBytes,
+		I2C_BYTE_ORDER Order, bool Volatile>
+constexpr size_t I2C_Register<Address, AddressBytes, DataBytes, Order, Volatile>::DATA_BYTES;
+template<uint64_t Address, size_t AddressBytes, size_t DataBytes,
+		I2C_BYTE_ORDER Order, bool Volatile>
+constexpr size_t I2C_Register<Address, AddressBytes, DataBytes, Order, Volatile>::DATA_BITS;
+template<uint64_t Address, size_t AddressBytes, size_t DataBytes,
+		I2C_BYTE_ORDER Order, bool Volatile>
+constexpr I2C_BYTE_ORDER I2C_Register<Address, AddressBytes, DataBytes, Order, Volatile>::ORDER;
+template<uint64_t Address, size_t AddressBytes, size_t DataBytes,
+		I2C_BYTE_ORDER Order, bool Volatile>
+constexpr bool I2C_Register<Address, AddressBytes, DataBytes, Order, Volatile>::IS_VOLATILE;
+
+/*
+ * Bit field of a register value. Offset and Width are checked against the
+ * register width at compile time.
+ */
+template<typename Register, uint8_t Offset, uint8_t Width>
+class I2C_Field
+{
+	static_assert(Width > 0, "field must be at least one bit wide");
+	static_assert((size_t) Offset + Width <= Register::DATA_BITS,
+			"field does not fit in its register");
+public:
+	typedef Register register_type;
+	typedef typename Register::value_type value_type;
+
+	static constexpr uint8_t OFFSET = Offset;
+	static constexpr uint8_t WIDTH = Width;
+	static constexpr value_type MASK = (value_type) (((Width == 64) ?
+			~0ULL : ((1ULL << Width) - 1)) << Offset);
+
+	static constexpr value_type get(value_type registerValue)
+	{
+		return (registerValue & MASK) >> Offset;
+	}
+
+	static constexpr value_type set(value_type registerValue,
+			value_type fieldValue)
+	{
+		return (registerValue & ~MASK) | (((uint64_t) fieldValue << Offset) & MASK);
+	}
+
+	static constexpr value_type make(value_type fieldValue)
+	{
+		return set(0, fieldValue);
+	}
+};
+
+template<typename Register, uint8_t Offset, uint8_t Width>
+constexpr uint8_t I2C_Field<Register, Offset, Width>::OFFSET;
+template<typename Register, uint8_t Offset, uint8_t Width>
+constexpr uint8_t I2C_Field<Register, Offset, Width>::WIDTH;
+template<typename Register, uint8_t Offset, uint8_t Width>
+constexpr typename I2C_Field<Register, Offset, Width>::value_type I2C_Field<
+		Register, Offset, Width>::MASK;
+
+/*
+ * Typed transactions for a chip on an I2C_Interface. Writes are queued as
+ * fire-and-forget requests; reads are registered as polling events whose
+ * callback decodes the message with Register::decode.
+ */
+template<uint16_t ChipAddress>
+class I2C_Register_Device
+{
+public:
+	template<typename Register>
+	static I2C_Transaction_Message* createWrite(
+			typename Register::value_type value)
+	{
+		I2C_Transaction_Message *message = new I2C_Transaction_Message(
+				ChipAddress, vector<I2C_Message>(1, Register::write(value)));
+		// The interface frees request-only messages once they have run
+		message->setType(REQUEST_ONLY);
+		return message;
+	}
+
+	template<typename Register>
+	static I2C_Transaction_Message createRead()
+	{
+		return I2C_Transaction_Message(ChipAddress,
+				vector<I2C_Message>(1, Register::read()));
+	}
+
+	template<typename Register>
+	static void write(I2C_Interface &interface,
+			typename Register::value_type value)
+	{
+		interface.enque(createWrite<Register>(value));
+	}
+
+	template<typename Register>
+	static uint64_t poll(I2C_Interface &interface, uint64_t periodUsec,
+			void *callback, void *context)
+	{
+		I2C_Transaction_Message message = createRead<Register>();
+		message.setPeriod(periodUsec);
+		message.registerConstEventHandle(callback, context);
+		return interface.registerEvent(message);
+	}
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CREGISTERMAP_H_ */
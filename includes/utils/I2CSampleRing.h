@@ -0,0 +1,97 @@
+/*
+ * I2CSampleRing.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CSAMPLERING_H_
+#define INCLUDES_APRA_UTILS_I2CSAMPLERING_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include "constants/I2CByteOrder.h"
+#include "models/I2CTransactionMessage.h"
+
+using namespace std;
+
+namespace apra
+{
+
+class I2C_Sample_Channel
+{
+public:
+	I2C_Sample_Channel();
+	I2C_Sample_Channel(size_t messageIndex, I2C_BYTE_ORDER byteOrder =
+			I2C_BIG_ENDIAN, bool isSigned = false);
+	virtual ~I2C_Sample_Channel();
+	size_t m_messageIndex;
+	I2C_BYTE_ORDER m_byteOrder;
+	bool m_isSigned;
+};
+
+/*
+ * Consumer side buffer of a batch read: one timestamp column and one value
+ * column per channel. Reading into the same batch again reuses its storage.
+ */
+class I2C_Sample_Batch
+{
+public:
+	I2C_Sample_Batch();
+	I2C_Sample_Batch(size_t capacity, size_t channelCount);
+	virtual ~I2C_Sample_Batch();
+	size_t size() const;
+	vector<int64_t> m_timestamps;
+	vector<vector<int64_t> > m_values;
+};
+
+/*
+ * Preallocated single-producer/single-consumer ring of timestamped samples,
+ * stored column by column. The I2C_Interface thread decodes each channel
+ * from the data of one read message of a streamed event straight into its
+ * slot; a consumer drains whole batches. A full ring drops the new sample
+ * and counts an overrun rather than blocking the bus thread.
+ */
+class I2C_Sample_Ring
+{
+public:
+	I2C_Sample_Ring(size_t capacity, const vector<I2C_Sample_Channel> &channels);
+	virtual ~I2C_Sample_Ring();
+	bool push(int64_t timestampUsec, const int64_t *values);
+	bool record(int64_t timestampUsec, I2C_Transaction_Message &message);
+	size_t read(I2C_Sample_Batch &batch, size_t maxSamples);
+	size_t read(int64_t *timestamps, int64_t *values, size_t maxSamples);
+	size_t size() const;
+	size_t capacity() const;
+	size_t getChannelCount() const;
+	const vector<I2C_Sample_Channel>& getChannels() const;
+	uint64_t getSampleCount() const;
+	uint64_t getOverrunCount() const;
+	uint64_t getErrorCount() const;
+	static int64_t decode(const vector<uint8_t> &data, I2C_BYTE_ORDER byteOrder,
+			bool isSigned);
+protected:
+	bool reserveSlot(size_t &slot);
+	void commitSlot();
+	void copyColumn(const int64_t *column, size_t head, size_t count,
+			int64_t *output);
+
+	vector<I2C_Sample_Channel> m_channels;
+	size_t m_capacity;
+	size_t m_mask;
+	vector<int64_t> m_timestamps;
+	vector<int64_t> m_values;
+	std::atomic<size_t> m_head;
+	std::atomic<size_t> m_tail;
+	std::atomic<uint64_t> m_overrunCount;
+	std::atomic<uint64_t> m_errorCount;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CSAMPLERING_H_ */
@@ -0,0 +1,117 @@
+/*
+ * I2CSimulatedTransport.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CSIMULATEDTRANSPORT_H_
+#define INCLUDES_APRA_UTILS_I2CSIMULATEDTRANSPORT_H_
+
+#include <map>
+#include <vector>
+#include "models/I2CBusStatistics.h"
+#include "utils/I2CTransport.h"
+#include "utils/Mutex.h"
+
+using namespace std;
+
+namespace apra
+{
+
+class I2C_Simulated_Device
+{
+public:
+	I2C_Simulated_Device();
+	I2C_Simulated_Device(uint8_t registerSize);
+	virtual ~I2C_Simulated_Device();
+	uint8_t m_registerSize;
+	uint64_t m_pointer;
+	map<uint64_t, uint8_t> m_registers;
+	uint32_t m_nackCount;
+	uint32_t m_errorPermille;
+	uint64_t m_extraLatencyUsec;
+	uint64_t m_transferCount;
+	uint64_t m_pageSize;
+	uint64_t m_writeCycleUsec;
+	int64_t m_busyUntilTs;
+	int32_t m_muxAddress;
+	uint8_t m_muxChannel;
+};
+
+/*
+ * In-process bus with register-map devices. Every transfer costs the bus
+ * time of its bytes at the configured clock plus a fixed overhead, and
+ * faults can be injected per device or for the whole bus. A device placed
+ * behind a mux only answers while the mux's control byte, the last byte
+ * written to it, enables its channel.
+ */
+class I2C_Simulated_Transport: public I2C_Transport
+{
+public:
+	I2C_Simulated_Transport(uint64_t busClockHz = I2C_DEFAULT_BUS_CLOCK_HZ);
+	virtual ~I2C_Simulated_Transport();
+	virtual I2CError openBus();
+	virtual void closeBus();
+	virtual bool isOpen();
+	virtual uint64_t getFunctionality();
+	virtual bool selectChip(uint8_t chipAddress);
+	virtual int32_t transfer(struct i2c_msg *messages, uint32_t count);
+	virtual int32_t smbusTransfer(struct i2c_smbus_ioctl_data &args);
+
+	void setFunctionality(uint64_t functionality);
+	void setBusClock(uint64_t busClockHz);
+	void setLatencyModel(bool enabled, uint64_t transferOverheadUsec);
+	void addDevice(uint8_t chipAddress, uint8_t registerSize);
+	void removeDevice(uint8_t chipAddress);
+	bool hasDevice(uint8_t chipAddress);
+	void setRegisters(uint8_t chipAddress, uint64_t registerAddress,
+			const vector<uint8_t> &data);
+	vector<uint8_t> getRegisters(uint8_t chipAddress,
+			uint64_t registerAddress, size_t size);
+	void injectNack(uint8_t chipAddress, uint32_t transferCount);
+	void setErrorRate(uint8_t chipAddress, uint32_t permille);
+	void setExtraLatency(uint8_t chipAddress, uint64_t latencyUsec);
+	void setEepromModel(uint8_t chipAddress, uint64_t pageSize,
+			uint64_t writeCycleUsec);
+	void setMuxChannel(uint8_t chipAddress, uint8_t muxAddress,
+			uint8_t channel);
+	void setBusStuck(bool stuck);
+	void setOpenFailure(bool fail);
+	uint64_t getTransferCount();
+	uint64_t getTransferCount(uint8_t chipAddress);
+	uint64_t getSMBusTransferCount();
+	uint64_t getSimulatedBusTimeUsec();
+protected:
+	I2C_Simulated_Device* acquireDevice(uint8_t chipAddress, int32_t &errorCode);
+	void writeBytes(I2C_Simulated_Device &device, const uint8_t *bytes,
+			size_t count);
+	void readBytes(I2C_Simulated_Device &device, uint8_t *bytes, size_t count);
+	void storeByte(I2C_Simulated_Device &device, uint8_t value);
+	void startWriteCycle(I2C_Simulated_Device &device);
+	int32_t fail(int32_t errorCode);
+	void waitBusTime(uint64_t busTimeUsec);
+
+	apra::Mutex m_lock;
+	map<uint8_t, I2C_Simulated_Device> m_devices;
+	bool m_isOpen;
+	bool m_openFailure;
+	bool m_busStuck;
+	bool m_latencyEnabled;
+	uint64_t m_functionality;
+	uint64_t m_busClockHz;
+	uint64_t m_transferOverheadUsec;
+	uint64_t m_transferCount;
+	uint64_t m_smbusTransferCount;
+	uint64_t m_simulatedBusTimeUsec;
+	uint32_t m_randomSeed;
+	int32_t m_selectedChip;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CSIMULATEDTRANSPORT_H_ */
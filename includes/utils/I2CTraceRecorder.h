@@ -0,0 +1,63 @@
+/*
+ * I2CTraceRecorder.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CTRACERECORDER_H_
+#define INCLUDES_APRA_UTILS_I2CTRACERECORDER_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "models/I2CTraceRecord.h"
+#include "utils/Mutex.h"
+
+#define I2C_TRACE_MAGIC "API2CTRC"
+#define I2C_TRACE_VERSION 2
+#define I2C_TRACE_FLUSH_SIZE 65536
+
+using namespace std;
+
+namespace apra
+{
+
+/*
+ * Appends I2C_Trace_Records to a binary trace file. Records are buffered and
+ * written in blocks of I2C_TRACE_FLUSH_SIZE; timestamps are stored relative
+ * to open().
+ */
+class I2C_Trace_Recorder
+{
+public:
+	I2C_Trace_Recorder();
+	virtual ~I2C_Trace_Recorder();
+	bool open(string path, uint64_t busClockHz);
+	void close();
+	bool isRecording();
+	void record(const I2C_Trace_Record &record);
+	void flush();
+	uint64_t getRecordCount();
+	static bool load(string path, vector<I2C_Trace_Record> &records,
+			uint64_t &busClockHz);
+protected:
+	void writeBuffer();
+	Mutex m_lock;
+	FILE *m_file;
+	std::atomic<bool> m_isRecording;
+	int64_t m_startTs;
+	int64_t m_lastTimestampUsec;
+	uint64_t m_recordCount;
+	vector<uint8_t> m_buffer;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CTRACERECORDER_H_ */
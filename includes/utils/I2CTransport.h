@@ -0,0 +1,43 @@
+/*
+ * I2CTransport.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_I2CTRANSPORT_H_
+#define INCLUDES_APRA_UTILS_I2CTRANSPORT_H_
+
+#include <stdint.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include "models/I2CError.h"
+
+namespace apra
+{
+
+/*
+ * Backend executing raw I2C_RDWR and I2C_SMBUS transfers for I2C_Bus.
+ * Transfers return a negative value on failure, like the ioctls they model.
+ */
+class I2C_Transport
+{
+public:
+	I2C_Transport();
+	virtual ~I2C_Transport();
+	virtual I2CError openBus() = 0;
+	virtual void closeBus() = 0;
+	virtual bool isOpen() = 0;
+	virtual uint64_t getFunctionality() = 0;
+	virtual bool selectChip(uint8_t chipAddress) = 0;
+	virtual int32_t transfer(struct i2c_msg *messages, uint32_t count) = 0;
+	virtual int32_t smbusTransfer(struct i2c_smbus_ioctl_data &args) = 0;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_I2CTRANSPORT_H_ */
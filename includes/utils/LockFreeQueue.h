@@ -0,0 +1,103 @@
+/*
+ * LockFreeQueue.h
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#ifndef INCLUDES_APRA_UTILS_LOCKFREEQUEUE_H_
+#define INCLUDES_APRA_UTILS_LOCKFREEQUEUE_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace apra
+{
+
+/*
+ * Bounded single-producer/single-consumer ring. push never blocks; it
+ * returns false when the ring is full.
+ */
+template<typename T>
+class LockFreeQueue
+{
+public:
+	LockFreeQueue(size_t capacity) :
+			m_slots(roundUpCapacity(capacity)), m_mask(m_slots.size() - 1), m_head(
+					0), m_tail(0)
+	{
+	}
+
+	bool push(T &&item)
+	{
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+		if ((tail - m_head.load(std::memory_order_acquire)) >= m_slots.size())
+		{
+			return false;
+		}
+		m_slots[tail & m_mask] = std::move(item);
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool push(const T &item)
+	{
+		T copy(item);
+		return push(std::move(copy));
+	}
+
+	bool pop(T &item)
+	{
+		size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		item = std::move(m_slots[head & m_mask]);
+		m_slots[head & m_mask] = T();
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	size_t size() const
+	{
+		return m_tail.load(std::memory_order_acquire)
+				- m_head.load(std::memory_order_acquire);
+	}
+
+	size_t capacity() const
+	{
+		return m_slots.size();
+	}
+
+	bool empty() const
+	{
+		return size() == 0;
+	}
+
+private:
+	static size_t roundUpCapacity(size_t capacity)
+	{
+		size_t rounded = 1;
+		while (rounded < capacity)
+		{
+			rounded <<= 1;
+		}
+		return rounded;
+	}
+
+	std::vector<T> m_slots;
+	size_t m_mask;
+	std::atomic<size_t> m_head;
+	std::atomic<size_t> m_tail;
+};
+
+} /* namespace apra */
+
+#endif /* INCLUDES_APRA_UTILS_LOCKFREEQUEUE_H_ */
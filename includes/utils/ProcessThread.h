@@ -50,6 +50,7 @@ protected:
 	int32_t mainLoop();
 	static void* beginProxy(void *arg);
 	void someFunction(bool &executedOnce);
+	virtual void waitForNextCycle(uint64_t timeoutUsec);
 	void enqueResponse(Message *message);
 	void trimQueue(std::queue<Message*> &queue);
 	string m_threadname;
@@ -0,0 +1,322 @@
+/*
+ * I2CBroker.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "controllers/I2CBroker.h"
+#include "utils/Macro.h"
+#include "utils/ScopeLock.h"
+
+namespace apra
+{
+
+I2C_Broker::I2C_Broker(string i2cPath, string socketPath, string name,
+		uint64_t fpsHz, bool shouldPrint) :
+		I2C_Interface(i2cPath, name, fpsHz, shouldPrint), m_socketPath(
+				socketPath), m_listenFd(-1), m_regionFd(-1), m_doorbellFd(-1), m_ring(), m_requests(
+		I2C_BROKER_SLOT_COUNT), m_submittedSlots(), m_clients(), m_nextClientId(
+				1), m_pollFds(), m_brokeredCount(0)
+{
+}
+
+I2C_Broker::I2C_Broker(I2C_Transport *transport, string socketPath,
+		string name, uint64_t fpsHz, bool shouldPrint) :
+		I2C_Interface(transport, name, fpsHz, shouldPrint), m_socketPath(
+				socketPath), m_listenFd(-1), m_regionFd(-1), m_doorbellFd(-1), m_ring(), m_requests(
+		I2C_BROKER_SLOT_COUNT), m_submittedSlots(), m_clients(), m_nextClientId(
+				1), m_pollFds(), m_brokeredCount(0)
+{
+}
+
+I2C_Broker::~I2C_Broker()
+{
+	if (shouldIquit())
+	{
+		end();
+	}
+	closeBroker();
+}
+
+I2CError I2C_Broker::openBroker()
+{
+	// The bus thread reads the descriptors and the ring without a lock
+	if (!closeBroker())
+	{
+		return I2CError("Stop the I2C broker before reopening it",
+				BROKER_ERROR);
+	}
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (m_socketPath.empty() || (m_socketPath.size() >= sizeof(address.sun_path)))
+	{
+		return I2CError("Invalid I2C broker socket path", BROKER_ERROR);
+	}
+	strncpy(address.sun_path, m_socketPath.c_str(),
+			sizeof(address.sun_path) - 1);
+	m_regionFd = memfd_create("apra_i2c_broker", MFD_CLOEXEC);
+	if (m_regionFd < 0)
+	{
+		return I2CError("Unable to create the I2C broker region",
+				BROKER_ERROR);
+	}
+	I2CError response = m_ring.create(m_regionFd);
+	if (response.isError())
+	{
+		closeBroker();
+		return response;
+	}
+	m_doorbellFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+			0);
+	unlink(m_socketPath.c_str());
+	if ((m_doorbellFd < 0) || (m_listenFd < 0)
+			|| (bind(m_listenFd, (struct sockaddr*) &address, sizeof(address))
+					< 0) || (listen(m_listenFd, I2C_BROKER_SLOT_COUNT) < 0))
+	{
+		closeBroker();
+		return I2CError("Unable to open the I2C broker socket",
+				m_socketPath, BROKER_ERROR);
+	}
+	return response;
+}
+
+bool I2C_Broker::closeBroker()
+{
+	if (shouldIquit())
+	{
+		return false;
+	}
+	if (m_ring.isAttached())
+	{
+		for (size_t slot = 0; slot < m_requests.size(); slot++)
+		{
+			if (m_busArbiter.removeRequest(&m_requests[slot]))
+			{
+				m_requests[slot].setError(
+						I2CError("I2C broker was closed", BROKER_ERROR));
+				m_ring.complete(slot, m_requests[slot]);
+			}
+		}
+	}
+	{
+		ScopeLock lock(m_clientLock);
+		for (map<int, uint32_t>::iterator clientItr = m_clients.begin();
+				clientItr != m_clients.end(); clientItr++)
+		{
+			close(clientItr->first);
+		}
+		m_clients.clear();
+	}
+	if (m_listenFd >= 0)
+	{
+		close(m_listenFd);
+		unlink(m_socketPath.c_str());
+	}
+	if (m_doorbellFd >= 0)
+	{
+		close(m_doorbellFd);
+	}
+	m_ring.detach();
+	if (m_regionFd >= 0)
+	{
+		close(m_regionFd);
+	}
+	m_listenFd = -1;
+	m_doorbellFd = -1;
+	m_regionFd = -1;
+	return true;
+}
+
+bool I2C_Broker::isBrokerOpen()
+{
+	return m_listenFd >= 0;
+}
+
+size_t I2C_Broker::getClientCount()
+{
+	ScopeLock lock(m_clientLock);
+	return m_clients.size();
+}
+
+uint64_t I2C_Broker::getBrokeredCount()
+{
+	return m_brokeredCount;
+}
+
+void I2C_Broker::process(Message *obj)
+{
+	if (m_listenFd >= 0)
+	{
+		serviceClients(0);
+	}
+	I2C_Interface::process(obj);
+}
+
+void I2C_Broker::waitForNextCycle(uint64_t timeoutUsec)
+{
+	if (m_listenFd < 0)
+	{
+		I2C_Interface::waitForNextCycle(timeoutUsec);
+		return;
+	}
+	MONOCURRTIME(timeNow);
+	syncRegisteredEvents(timeNow);
+	serviceClients(timeoutUsec);
+}
+
+void I2C_Broker::admitRequests(int64_t timeNow)
+{
+	I2C_Interface::admitRequests(timeNow);
+	uint64_t doorbellCount = 0;
+	if ((m_doorbellFd < 0)
+			|| (read(m_doorbellFd, &doorbellCount, sizeof(doorbellCount))
+					!= sizeof(doorbellCount)))
+	{
+		return;
+	}
+	m_ring.collectSubmitted(m_submittedSlots);
+	for (size_t index = 0; index < m_submittedSlots.size(); index++)
+	{
+		I2C_Transaction_Message &request = m_requests[m_submittedSlots[index]];
+		if (!m_ring.toMessage(m_submittedSlots[index], request))
+		{
+			// A malformed slot never reaches the bus
+			completeRequest(&request);
+			continue;
+		}
+		m_busArbiter.pushRequest(&request, false, timeNow);
+	}
+}
+
+void I2C_Broker::completeRequest(I2C_Transaction_Message *txMessage)
+{
+	if ((txMessage < &m_requests.front()) || (txMessage > &m_requests.back()))
+	{
+		I2C_Interface::completeRequest(txMessage);
+		return;
+	}
+	m_ring.complete(txMessage - &m_requests.front(), *txMessage);
+	m_brokeredCount++;
+}
+
+void I2C_Broker::serviceClients(uint64_t timeoutUsec)
+{
+	m_pollFds.clear();
+	struct pollfd pollFd;
+	pollFd.events = POLLIN;
+	pollFd.revents = 0;
+	pollFd.fd = m_listenFd;
+	m_pollFds.push_back(pollFd);
+	pollFd.fd = m_doorbellFd;
+	m_pollFds.push_back(pollFd);
+	{
+		ScopeLock lock(m_clientLock);
+		for (map<int, uint32_t>::iterator clientItr = m_clients.begin();
+				clientItr != m_clients.end(); clientItr++)
+		{
+			pollFd.fd = clientItr->first;
+			m_pollFds.push_back(pollFd);
+		}
+	}
+	size_t clientEnd = m_pollFds.size();
+	// Trigger edges only need to end the wait; process() consumes them
+	m_pollFds.insert(m_pollFds.end(), m_triggerFds.begin(), m_triggerFds.end());
+	struct timespec timeout;
+	timeout.tv_sec = timeoutUsec / 1000000;
+	timeout.tv_nsec = (timeoutUsec % 1000000) * 1000;
+	if (ppoll(m_pollFds.data(), m_pollFds.size(), &timeout, NULL) <= 0)
+	{
+		return;
+	}
+	if (m_pollFds[0].revents & POLLIN)
+	{
+		acceptClients();
+	}
+	for (size_t index = 2; index < clientEnd; index++)
+	{
+		if (!m_pollFds[index].revents)
+		{
+			continue;
+		}
+		// Clients never write to the control socket; data here means EOF
+		char discard[64];
+		if (recv(m_pollFds[index].fd, discard, sizeof(discard), 0) <= 0)
+		{
+			dropClient(m_pollFds[index].fd);
+		}
+	}
+}
+
+void I2C_Broker::acceptClients()
+{
+	int clientFd = accept4(m_listenFd, NULL, NULL,
+			SOCK_NONBLOCK | SOCK_CLOEXEC);
+	while (clientFd >= 0)
+	{
+		uint32_t clientId = m_nextClientId++;
+		if (sendHandles(clientFd, clientId))
+		{
+			ScopeLock lock(m_clientLock);
+			m_clients[clientFd] = clientId;
+		}
+		else
+		{
+			close(clientFd);
+		}
+		clientFd = accept4(m_listenFd, NULL, NULL,
+				SOCK_NONBLOCK | SOCK_CLOEXEC);
+	}
+}
+
+bool I2C_Broker::sendHandles(int clientFd, uint32_t clientId)
+{
+	int handles[2] =
+	{ m_regionFd, m_doorbellFd };
+	char control[CMSG_SPACE(sizeof(handles))];
+	memset(control, 0, sizeof(control));
+	struct iovec payload;
+	payload.iov_base = &clientId;
+	payload.iov_len = sizeof(clientId);
+	struct msghdr header;
+	memset(&header, 0, sizeof(header));
+	header.msg_iov = &payload;
+	header.msg_iovlen = 1;
+	header.msg_control = control;
+	header.msg_controllen = sizeof(control);
+	struct cmsghdr *controlHeader = CMSG_FIRSTHDR(&header);
+	controlHeader->cmsg_level = SOL_SOCKET;
+	controlHeader->cmsg_type = SCM_RIGHTS;
+	controlHeader->cmsg_len = CMSG_LEN(sizeof(handles));
+	memcpy(CMSG_DATA(controlHeader), handles, sizeof(handles));
+	return sendmsg(clientFd, &header, MSG_NOSIGNAL) == sizeof(clientId);
+}
+
+void I2C_Broker::dropClient(int clientFd)
+{
+	ScopeLock lock(m_clientLock);
+	map<int, uint32_t>::iterator clientItr = m_clients.find(clientFd);
+	if (clientItr == m_clients.end())
+	{
+		return;
+	}
+	// Slots of a client that went away are freed, or freed on completion
+	m_ring.releaseClient(clientItr->second);
+	close(clientFd);
+	m_clients.erase(clientItr);
+}
+
+} /* namespace apra */
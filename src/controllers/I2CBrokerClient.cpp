@@ -0,0 +1,226 @@
+/*
+ * I2CBrokerClient.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "controllers/I2CBrokerClient.h"
+
+namespace apra
+{
+
+I2C_Broker_Client::I2C_Broker_Client() :
+		m_socketFd(-1), m_doorbellFd(-1), m_clientId(0), m_ring()
+{
+}
+
+I2C_Broker_Client::~I2C_Broker_Client()
+{
+	disconnectBroker();
+}
+
+I2CError I2C_Broker_Client::connectBroker(string socketPath)
+{
+	disconnectBroker();
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socketPath.empty() || (socketPath.size() >= sizeof(address.sun_path)))
+	{
+		return I2CError("Invalid I2C broker socket path", BROKER_ERROR);
+	}
+	strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+	m_socketFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	struct timeval timeout;
+	timeout.tv_sec = I2C_BROKER_CONNECT_TIMEOUT_USEC / 1000000;
+	timeout.tv_usec = I2C_BROKER_CONNECT_TIMEOUT_USEC % 1000000;
+	if ((m_socketFd < 0)
+			|| (setsockopt(m_socketFd, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+					sizeof(timeout)) < 0)
+			|| (connect(m_socketFd, (struct sockaddr*) &address,
+					sizeof(address)) < 0))
+	{
+		disconnectBroker();
+		return I2CError("Unable to connect to the I2C broker", socketPath,
+				BROKER_ERROR);
+	}
+	int regionFd = -1;
+	if (!receiveHandles(regionFd))
+	{
+		disconnectBroker();
+		return I2CError("I2C broker did not send its handles", socketPath,
+				BROKER_ERROR);
+	}
+	// The mapping keeps the region alive; the descriptor is not needed
+	I2CError response = m_ring.attach(regionFd);
+	close(regionFd);
+	if (response.isError())
+	{
+		disconnectBroker();
+	}
+	return response;
+}
+
+void I2C_Broker_Client::disconnectBroker()
+{
+	m_ring.detach();
+	if (m_doorbellFd >= 0)
+	{
+		close(m_doorbellFd);
+	}
+	if (m_socketFd >= 0)
+	{
+		close(m_socketFd);
+	}
+	m_doorbellFd = -1;
+	m_socketFd = -1;
+	m_clientId = 0;
+}
+
+bool I2C_Broker_Client::isConnected()
+{
+	return m_ring.isAttached();
+}
+
+uint32_t I2C_Broker_Client::getClientId()
+{
+	return m_clientId;
+}
+
+I2CError I2C_Broker_Client::transact(I2C_Transaction_Message &message,
+		uint64_t timeoutUsec)
+{
+	if (!isConnected())
+	{
+		message.setError(
+				I2CError("I2C broker is not connected", BROKER_ERROR));
+		return message.getError();
+	}
+	int32_t slot = submit(message);
+	if (slot < 0)
+	{
+		message.setError(
+				I2CError("I2C transaction does not fit a free broker slot",
+						BROKER_ERROR));
+		return message.getError();
+	}
+	if (!wait(slot, timeoutUsec))
+	{
+		abandon(slot);
+		message.setError(
+				I2CError("I2C broker did not answer in time", BROKER_ERROR));
+		return message.getError();
+	}
+	m_ring.decode(slot, message);
+	release(slot);
+	return message.getError();
+}
+
+int32_t I2C_Broker_Client::submit(const I2C_Transaction_Message &message)
+{
+	int32_t slot = m_ring.claim(m_clientId);
+	if (slot < 0)
+	{
+		return slot;
+	}
+	if (!m_ring.encode(slot, message))
+	{
+		m_ring.release(slot);
+		return -1;
+	}
+	m_ring.submit(slot);
+	uint64_t doorbell = 1;
+	ssize_t written = write(m_doorbellFd, &doorbell, sizeof(doorbell));
+	(void) written;
+	return slot;
+}
+
+bool I2C_Broker_Client::wait(int32_t slot, uint64_t timeoutUsec)
+{
+	return m_ring.wait(slot, timeoutUsec);
+}
+
+const I2C_Broker_Slot& I2C_Broker_Client::getResult(int32_t slot)
+{
+	return m_ring.getSlot(slot);
+}
+
+void I2C_Broker_Client::release(int32_t slot)
+{
+	m_ring.release(slot);
+}
+
+void I2C_Broker_Client::abandon(int32_t slot)
+{
+	m_ring.abandon(slot);
+}
+
+bool I2C_Broker_Client::receiveHandles(int &regionFd)
+{
+	int handles[2] =
+	{ -1, -1 };
+	char control[CMSG_SPACE(sizeof(handles))];
+	memset(control, 0, sizeof(control));
+	struct iovec payload;
+	payload.iov_base = &m_clientId;
+	payload.iov_len = sizeof(m_clientId);
+	struct msghdr header;
+	memset(&header, 0, sizeof(header));
+	header.msg_iov = &payload;
+	header.msg_iovlen = 1;
+	header.msg_control = control;
+	header.msg_controllen = sizeof(control);
+	ssize_t received = recvmsg(m_socketFd, &header, MSG_CMSG_CLOEXEC);
+	if (received < 0)
+	{
+		return false;
+	}
+	struct cmsghdr *controlHeader = CMSG_FIRSTHDR(&header);
+	if ((received != sizeof(m_clientId)) || !controlHeader
+			|| (controlHeader->cmsg_level != SOL_SOCKET)
+			|| (controlHeader->cmsg_type != SCM_RIGHTS)
+			|| (controlHeader->cmsg_len != CMSG_LEN(sizeof(handles))))
+	{
+		// Descriptors that did arrive are already ours to close
+		closeHandles(header);
+		return false;
+	}
+	memcpy(handles, CMSG_DATA(controlHeader), sizeof(handles));
+	regionFd = handles[0];
+	m_doorbellFd = handles[1];
+	return true;
+}
+
+void I2C_Broker_Client::closeHandles(struct msghdr &header)
+{
+	for (struct cmsghdr *controlHeader = CMSG_FIRSTHDR(&header); controlHeader;
+			controlHeader = CMSG_NXTHDR(&header, controlHeader))
+	{
+		if ((controlHeader->cmsg_level != SOL_SOCKET)
+				|| (controlHeader->cmsg_type != SCM_RIGHTS))
+		{
+			continue;
+		}
+		size_t handleCount = (controlHeader->cmsg_len - CMSG_LEN(0))
+				/ sizeof(int);
+		for (size_t index = 0; index < handleCount; index++)
+		{
+			int handle = -1;
+			memcpy(&handle, CMSG_DATA(controlHeader) + (index * sizeof(int)),
+					sizeof(handle));
+			close(handle);
+		}
+	}
+}
+
+} /* namespace apra */
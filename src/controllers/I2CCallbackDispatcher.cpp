@@ -0,0 +1,90 @@
+/*
+ * I2CCallbackDispatcher.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <time.h>
+#include "controllers/I2CCallbackDispatcher.h"
+
+namespace apra
+{
+
+I2C_Callback_Dispatcher::I2C_Callback_Dispatcher(string name,
+		size_t queueDepth) :
+		ProcessThread(name), m_queue(queueDepth), m_pendingCount(0), m_dispatchedCount(
+				0), m_droppedCount(0)
+{
+	pthread_mutex_init(&m_pendingLock, NULL);
+	// Monotonic, so a wall clock step neither stalls nor spins the wait
+	pthread_condattr_t attributes;
+	pthread_condattr_init(&attributes);
+	pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+	pthread_cond_init(&m_pendingCondition, &attributes);
+	pthread_condattr_destroy(&attributes);
+}
+
+I2C_Callback_Dispatcher::~I2C_Callback_Dispatcher()
+{
+	pthread_cond_destroy(&m_pendingCondition);
+	pthread_mutex_destroy(&m_pendingLock);
+}
+
+bool I2C_Callback_Dispatcher::dispatch(
+		shared_ptr<const I2C_Transaction_Message> message)
+{
+	if (!m_queue.push(std::move(message)))
+	{
+		m_droppedCount++;
+		return false;
+	}
+	pthread_mutex_lock(&m_pendingLock);
+	m_pendingCount++;
+	pthread_cond_signal(&m_pendingCondition);
+	pthread_mutex_unlock(&m_pendingLock);
+	return true;
+}
+
+void I2C_Callback_Dispatcher::process(Message*)
+{
+	struct timespec timeout;
+	clock_gettime(CLOCK_MONOTONIC, &timeout);
+	timeout.tv_nsec += I2C_DISPATCH_WAIT_USEC * 1000;
+	timeout.tv_sec += timeout.tv_nsec / 1000000000;
+	timeout.tv_nsec %= 1000000000;
+	pthread_mutex_lock(&m_pendingLock);
+	while (!m_pendingCount)
+	{
+		if (pthread_cond_timedwait(&m_pendingCondition, &m_pendingLock,
+				&timeout))
+		{
+			break;
+		}
+	}
+	m_pendingCount = 0;
+	pthread_mutex_unlock(&m_pendingLock);
+	shared_ptr<const I2C_Transaction_Message> message;
+	while (m_queue.pop(message))
+	{
+		message->publishTransaction();
+		message.reset();
+		m_dispatchedCount++;
+	}
+}
+
+uint64_t I2C_Callback_Dispatcher::getDispatchedCount()
+{
+	return m_dispatchedCount;
+}
+
+uint64_t I2C_Callback_Dispatcher::getDroppedCount()
+{
+	return m_droppedCount;
+}
+
+} /* namespace apra */
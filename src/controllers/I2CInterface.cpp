@@ -9,6 +9,8 @@
  * See LICENSE file in the project root for full license information.
  */
 
+#include <time.h>
+#include <unistd.h>
 #include <algorithm>
 #include <stdexcept>
 #include "utils/Macro.h"
@@ -21,8 +23,42 @@ namespace apra
 I2C_Interface::I2C_Interface(string i2cPath, string name, uint64_t fpsHz,
 		bool shouldPrint) :
 		ProcessThread(name, fpsHz), m_i2cPath(i2cPath), m_i2cBus(i2cPath,
-				shouldPrint), m_lastProcessedEventTs(0), m_setupSuccess(false)
+				shouldPrint), m_eventRegistry(), m_eventSnapshot(
+				m_eventRegistry.getSnapshot()), m_eventSnapshotVersion(
+				m_eventRegistry.getVersion()), m_eventScheduler(), m_scheduleEpoch(
+				0), m_lastProcessedEventTs(0), m_setupSuccess(
+				false), m_callbackDispatcher(NULL), m_traceRecorder(), m_traceTransactionId(
+				0), m_busArbiter(), m_busHealth(), m_muxTopology(), m_dueEvents(), m_capacityPlanner(), m_phaseStagger(
+				(m_frequSec > 0) ? m_frequSec : 1), m_isStaggering(false), m_readCache(), m_isCoalescing(
+				false), m_deviceSnapshot(), m_snapshotPath(), m_triggerFds(
+				), m_triggerEvents(), m_missedTriggerCount(
+				0)
 {
+	m_capacityPlanner.setBusClock(m_i2cBus.getBusClock());
+	setupI2CBus();
+}
+
+I2C_Interface::I2C_Interface(I2C_Transport *transport, string name,
+		uint64_t fpsHz, bool shouldPrint) :
+		ProcessThread(name, fpsHz), m_i2cPath("custom transport"), m_i2cBus(
+				transport, shouldPrint), m_eventRegistry(), m_eventSnapshot(
+				m_eventRegistry.getSnapshot()), m_eventSnapshotVersion(
+				m_eventRegistry.getVersion()), m_eventScheduler(), m_scheduleEpoch(
+				0), m_lastProcessedEventTs(0), m_setupSuccess(
+				false), m_callbackDispatcher(NULL), m_traceRecorder(), m_traceTransactionId(
+				0), m_busArbiter(), m_busHealth(), m_muxTopology(), m_dueEvents(), m_capacityPlanner(), m_phaseStagger(
+				(m_frequSec > 0) ? m_frequSec : 1), m_isStaggering(false), m_readCache(), m_isCoalescing(
+				false), m_deviceSnapshot(), m_snapshotPath(), m_triggerFds(
+				), m_triggerEvents(), m_missedTriggerCount(
+				0)
+{
+	m_capacityPlanner.setBusClock(m_i2cBus.getBusClock());
+	setupI2CBus();
+}
+
+void I2C_Interface::setupI2CBus()
+{
+	MONOTIMEUS(m_scheduleEpoch);
 	I2CError i2cError = m_i2cBus.openBus();
 	if (i2cError.isError())
 	{
@@ -39,14 +75,383 @@ I2C_Interface::I2C_Interface(string i2cPath, string name, uint64_t fpsHz,
 
 I2C_Interface::~I2C_Interface()
 {
+	if (m_callbackDispatcher)
+	{
+		m_callbackDispatcher->end();
+		delete m_callbackDispatcher;
+		m_callbackDispatcher = NULL;
+	}
+	m_traceRecorder.close();
+	saveDeviceSnapshot();
 	m_i2cBus.closeBus();
 }
 
+bool I2C_Interface::enableAsyncCallbacks(size_t queueDepth)
+{
+	if (m_callbackDispatcher)
+	{
+		return true;
+	}
+	I2C_Callback_Dispatcher *dispatcher = new I2C_Callback_Dispatcher(
+			getName() + "_callbacks", queueDepth);
+	if (dispatcher->begin() != 0)
+	{
+		delete dispatcher;
+		return false;
+	}
+	m_callbackDispatcher = dispatcher;
+	return true;
+}
+
+I2C_Callback_Dispatcher* I2C_Interface::getCallbackDispatcher()
+{
+	return m_callbackDispatcher;
+}
+
+void I2C_Interface::setBusClock(uint64_t busClockHz)
+{
+	m_i2cBus.setBusClock(busClockHz);
+	m_capacityPlanner.setBusClock(busClockHz);
+}
+
+I2C_Bus_Statistics I2C_Interface::getStatistics()
+{
+	return m_i2cBus.getStatistics();
+}
+
+void I2C_Interface::resetStatistics()
+{
+	m_i2cBus.resetStatistics();
+}
+
+bool I2C_Interface::startTrace(string path)
+{
+	return m_traceRecorder.open(path, m_i2cBus.getBusClock());
+}
+
+void I2C_Interface::stopTrace()
+{
+	m_traceRecorder.close();
+}
+
+bool I2C_Interface::isTracing()
+{
+	return m_traceRecorder.isRecording();
+}
+
+uint64_t I2C_Interface::getExecutedCount(I2C_PRIORITY priority)
+{
+	return m_busArbiter.getExecutedCount(priority);
+}
+
+uint64_t I2C_Interface::getMaxWaitUsec(I2C_PRIORITY priority)
+{
+	return m_busArbiter.getMaxWaitUsec(priority);
+}
+
+void I2C_Interface::setHealthPolicy(const I2C_Health_Policy &policy)
+{
+	m_busHealth.setPolicy(policy);
+}
+
+I2C_Bus_Health& I2C_Interface::getBusHealth()
+{
+	return m_busHealth;
+}
+
+I2CError I2C_Interface::writeEeprom(const I2C_Eeprom_Config &config,
+		uint64_t address, const vector<uint8_t> &data,
+		I2C_Eeprom_Report &report)
+{
+	I2C_Eeprom_Writer writer(m_i2cBus, &m_processLock, &m_muxTopology);
+	I2CError error = writer.write(config, address, data, report);
+	// Block-addressed parts spread the range over several chip addresses
+	vector<uint8_t> chipAddresses = writer.getChipAddresses(config, address,
+			data.size());
+	for (size_t index = 0; index < chipAddresses.size(); index++)
+	{
+		m_readCache.invalidate(chipAddresses[index]);
+	}
+	return error;
+}
+
+I2CError I2C_Interface::readEeprom(const I2C_Eeprom_Config &config,
+		uint64_t address, size_t size, vector<uint8_t> &data)
+{
+	I2C_Eeprom_Writer writer(m_i2cBus, &m_processLock, &m_muxTopology);
+	return writer.read(config, address, size, data);
+}
+
+bool I2C_Interface::loadDeviceSnapshot(string path)
+{
+	m_snapshotPath = path;
+	return m_deviceSnapshot.load(path);
+}
+
+bool I2C_Interface::saveDeviceSnapshot()
+{
+	if (m_snapshotPath.empty())
+	{
+		return false;
+	}
+	return m_deviceSnapshot.save(m_snapshotPath);
+}
+
+I2CError I2C_Interface::initDevice(const I2C_Device_Init &device)
+{
+	I2C_Init_Report report;
+	return initDevice(device, report);
+}
+
+I2CError I2C_Interface::initDevice(const I2C_Device_Init &device,
+		I2C_Init_Report &report)
+{
+	report = I2C_Init_Report();
+	vector<I2C_Message> signature = device.m_signature;
+	if (m_deviceSnapshot.isCurrent(device)
+			&& !readSignature(device, signature, report).isError()
+			&& m_deviceSnapshot.verify(device, signature))
+	{
+		report.m_isWarm = true;
+		return I2CError();
+	}
+	// Not yet trusted until the full sequence has been applied again
+	m_deviceSnapshot.remove(device.m_chipAddress);
+	m_deviceSnapshot.countCold();
+	I2CError response;
+	size_t index = 0;
+	while (!response.isError() && (index < device.m_initMessages.size()))
+	{
+		size_t runEnd = device.getWriteRunEnd(index);
+		if (runEnd > index)
+		{
+			response = applyWriteRun(device, index, runEnd, report);
+			index = runEnd;
+			continue;
+		}
+		I2C_Message message = device.m_initMessages[index++];
+		response = applyInitMessage(device.m_chipAddress, message, report);
+	}
+	if (response.isError())
+	{
+		return response;
+	}
+	signature = device.m_signature;
+	response = readSignature(device, signature, report);
+	if (!response.isError())
+	{
+		m_deviceSnapshot.record(device, signature);
+	}
+	return response;
+}
+
+I2C_Device_Snapshot& I2C_Interface::getDeviceSnapshot()
+{
+	return m_deviceSnapshot;
+}
+
+I2CError I2C_Interface::readSignature(const I2C_Device_Init &device,
+		vector<I2C_Message> &signature, I2C_Init_Report &report)
+{
+	I2CError response;
+	for (size_t index = 0; index < signature.size(); index++)
+	{
+		report.m_readCount++;
+		response = performInitMessage(device.m_chipAddress, signature[index]);
+		if (response.isError())
+		{
+			break;
+		}
+	}
+	return response;
+}
+
+I2CError I2C_Interface::applyInitMessage(uint8_t chipNumber,
+		I2C_Message &message, I2C_Init_Report &report)
+{
+	if (message.m_type == I2C_WRITE)
+	{
+		report.m_writeCount++;
+	}
+	else
+	{
+		report.m_readCount++;
+	}
+	I2CError response = performInitMessage(chipNumber, message);
+	if (!response.isError() && message.m_delayInUsec)
+	{
+		usleep(message.m_delayInUsec);
+	}
+	return response;
+}
+
+I2CError I2C_Interface::performInitMessage(uint8_t chipNumber,
+		I2C_Message &message)
+{
+	// Runs on the caller's thread, which must not run the interface's work
+	message.m_allowOtherProcessOnIdle = false;
+	message.m_allowCoalescing = false;
+	MONOCURRTIME(startTs);
+	I2CError response;
+	if (!m_busHealth.isChipAvailable(chipNumber, startTs))
+	{
+		response = I2CError("I2C chip is quarantined after repeated failures",
+				CHIP_QUARANTINED);
+		message.m_error = response;
+		return response;
+	}
+	switch (message.m_type)
+	{
+	case I2C_WRITE:
+	{
+		response = performWrite(chipNumber, message);
+		break;
+	}
+	case I2C_READ:
+	{
+		response = performRead(chipNumber, message, startTs);
+		break;
+	}
+	case I2C_READ_COMPARE_EQUAL:
+	case I2C_READ_COMPARE_NOT_EQUAL:
+	{
+		response = performCompareRead(chipNumber, message,
+				message.m_type == I2C_READ_COMPARE_EQUAL);
+		break;
+	}
+	}
+	if (m_traceRecorder.isRecording())
+	{
+		traceMessage(++m_traceTransactionId, chipNumber, false, message,
+				startTs);
+	}
+	return response;
+}
+
+I2CError I2C_Interface::applyWriteRun(const I2C_Device_Init &device,
+		size_t begin, size_t end, I2C_Init_Report &report)
+{
+	vector<uint8_t> current;
+	I2CError response;
+	if (device.m_writeChangedOnly)
+	{
+		response = readWriteRun(device, begin, end, current, report);
+		if (response.isError())
+		{
+			return response;
+		}
+	}
+	size_t offset = 0;
+	size_t writeCount = 0;
+	for (size_t index = begin; index < end; index++)
+	{
+		I2C_Message message = device.m_initMessages[index];
+		size_t size = message.m_data.size();
+		if (device.m_writeChangedOnly
+				&& std::equal(message.m_data.begin(), message.m_data.end(),
+						current.begin() + offset))
+		{
+			report.m_skippedWriteCount++;
+		}
+		else
+		{
+			response = applyInitMessage(device.m_chipAddress, message, report);
+			if (response.isError())
+			{
+				return response;
+			}
+			writeCount++;
+		}
+		offset += size;
+	}
+	if (!device.m_verify || !writeCount)
+	{
+		return response;
+	}
+	response = readWriteRun(device, begin, end, current, report);
+	if (response.isError())
+	{
+		return response;
+	}
+	offset = 0;
+	for (size_t index = begin; index < end; index++)
+	{
+		const vector<uint8_t> &data = device.m_initMessages[index].m_data;
+		if (!std::equal(data.begin(), data.end(), current.begin() + offset))
+		{
+			report.m_mismatchCount++;
+		}
+		offset += data.size();
+	}
+	if (report.m_mismatchCount)
+	{
+		response = I2CError("Init registers differ from written data",
+				VERIFY_ERROR);
+	}
+	return response;
+}
+
+I2CError I2C_Interface::readWriteRun(const I2C_Device_Init &device,
+		size_t begin, size_t end, vector<uint8_t> &data,
+		I2C_Init_Report &report)
+{
+	uint64_t runSize = 0;
+	for (size_t index = begin; index < end; index++)
+	{
+		runSize += device.m_initMessages[index].m_data.size();
+	}
+	I2C_Message read;
+	read.configureRead(device.m_initMessages[begin].m_registerNumber, runSize);
+	report.m_readCount++;
+	I2CError response = performInitMessage(device.m_chipAddress, read);
+	if (!response.isError() && (read.m_data.size() != runSize))
+	{
+		response = I2CError("Short read of init registers", READ_ERROR);
+	}
+	data.swap(read.m_data);
+	return response;
+}
+
+bool I2C_Interface::addMuxDevice(uint8_t chipAddress, uint8_t muxAddress,
+		uint8_t channel)
+{
+	ScopeLock lock(m_processLock);
+	return m_muxTopology.addDevice(chipAddress, muxAddress, channel);
+}
+
+void I2C_Interface::removeMuxDevice(uint8_t chipAddress)
+{
+	ScopeLock lock(m_processLock);
+	m_muxTopology.removeDevice(chipAddress);
+}
+
+uint64_t I2C_Interface::getMuxSelectCount()
+{
+	return m_muxTopology.getSelectCount();
+}
+
+uint64_t I2C_Interface::getMuxSkippedCount()
+{
+	return m_muxTopology.getSkippedCount();
+}
+
+uint64_t I2C_Interface::getDeadlineMissCount(I2C_PRIORITY priority)
+{
+	return m_busArbiter.getDeadlineMissCount(priority);
+}
+
+uint64_t I2C_Interface::getDroppedCount(I2C_PRIORITY priority)
+{
+	return m_busArbiter.getDroppedCount(priority);
+}
+
 I2CError I2C_Interface::reSetupI2CBus()
 {
 	ScopeLock lock(m_processLock);
 	I2CError response;
 	m_i2cBus.closeBus();
+	m_muxTopology.invalidate();
+	m_readCache.invalidate();
 	m_setupSuccess = false;
 	response = m_i2cBus.openBus();
 	m_setupSuccess = !response.isError();
@@ -60,154 +465,635 @@ bool I2C_Interface::isSuccessfullSetup()
 
 uint64_t I2C_Interface::registerEvent(I2C_Transaction_Message message)
 {
-	ScopeLock scopeLock(m_eventMessageLock);
-	m_registeredEvents[message.getHandle()] = message;
-	return message.getHandle();
+	return admitEvent(make_shared<I2C_Registered_Event>(message));
+}
+
+uint64_t I2C_Interface::registerStream(I2C_Transaction_Message message,
+		shared_ptr<I2C_Sample_Ring> sampleRing)
+{
+	return admitEvent(make_shared<I2C_Registered_Event>(message, sampleRing));
+}
+
+uint64_t I2C_Interface::registerTriggeredEvent(
+		I2C_Transaction_Message message, int triggerFd, short pollEvents,
+		shared_ptr<I2C_Sample_Ring> sampleRing)
+{
+	if (triggerFd < 0)
+	{
+		return 0;
+	}
+	shared_ptr<I2C_Registered_Event> event = make_shared<I2C_Registered_Event>(
+			message, sampleRing);
+	event->m_triggerFd = triggerFd;
+	event->m_triggerEvents = pollEvents;
+	return admitEvent(event);
+}
+
+uint64_t I2C_Interface::registerEdgeEvent(I2C_Transaction_Message message,
+		GPIO &gpio, GPIO_EDGES edge, shared_ptr<I2C_Sample_Ring> sampleRing)
+{
+	if (!gpio.Init4EdgeInterrupt(true, edge) || (gpio.Open() < 0))
+	{
+		return 0;
+	}
+	// Consume the level present at open so only new edges trigger
+	gpio.Read();
+	return registerTriggeredEvent(message, gpio.GetGPIODescriptor(),
+			POLLPRI | POLLERR, sampleRing);
+}
+
+uint64_t I2C_Interface::getMissedTriggerCount()
+{
+	return m_missedTriggerCount.load(std::memory_order_relaxed);
+}
+
+uint64_t I2C_Interface::getEventPeriodUsec(uint64_t messageHandle)
+{
+	shared_ptr<const I2C_Event_Map> snapshot = m_eventRegistry.getSnapshot();
+	I2C_Event_Map::const_iterator eventItr = snapshot->find(messageHandle);
+	if (eventItr == snapshot->end())
+	{
+		return 0;
+	}
+	return getEventPeriod(*eventItr->second);
+}
+
+uint64_t I2C_Interface::getSuppressedCount(uint64_t messageHandle)
+{
+	shared_ptr<const I2C_Event_Map> snapshot = m_eventRegistry.getSnapshot();
+	I2C_Event_Map::const_iterator eventItr = snapshot->find(messageHandle);
+	if (eventItr == snapshot->end())
+	{
+		return 0;
+	}
+	return eventItr->second->m_suppressedCount.load(std::memory_order_relaxed);
 }
 
 void I2C_Interface::unregisterEvent(uint64_t messageHandle)
 {
-	ScopeLock scopeLock(m_eventMessageLock);
-	m_registeredEvents.erase(messageHandle);
+	m_eventRegistry.remove(messageHandle);
+	m_capacityPlanner.remove(messageHandle);
+}
+
+uint64_t I2C_Interface::admitEvent(shared_ptr<I2C_Registered_Event> event)
+{
+	I2C_Transaction_Message &message = event->m_message;
+	uint64_t periodUsec = getEventPeriod(message);
+	if (message.isAdaptive() && message.m_minPeriodUsec)
+	{
+		periodUsec = message.m_minPeriodUsec;
+	}
+	else if (event->m_triggerFd >= 0)
+	{
+		// Only a declared minimum interval makes a trigger plannable
+		periodUsec = message.m_periodUsec;
+	}
+	if (!m_capacityPlanner.admit(
+			I2C_Capacity_Planner::estimate(message.getHandle(), message,
+					periodUsec)))
+	{
+		return 0;
+	}
+	return m_eventRegistry.add(event);
+}
+
+void I2C_Interface::setCapacityPolicy(const I2C_Capacity_Policy &policy)
+{
+	m_capacityPlanner.setPolicy(policy);
+}
+
+I2C_Capacity_Planner& I2C_Interface::getCapacityPlanner()
+{
+	return m_capacityPlanner;
+}
+
+void I2C_Interface::setPhaseStaggering(bool enable)
+{
+	m_isStaggering = enable;
+}
+
+uint64_t I2C_Interface::getEventPhaseUsec(uint64_t messageHandle)
+{
+	uint64_t phaseUsec = 0;
+	if (m_phaseStagger.getPhase(messageHandle, phaseUsec))
+	{
+		return phaseUsec;
+	}
+	shared_ptr<const I2C_Event_Map> snapshot = m_eventRegistry.getSnapshot();
+	I2C_Event_Map::const_iterator eventItr = snapshot->find(messageHandle);
+	return (eventItr == snapshot->end()) ?
+			0 : eventItr->second->m_message.m_phaseUsec;
+}
+
+void I2C_Interface::setReadCoalescing(bool enable, uint64_t freshnessUsec)
+{
+	m_readCache.setFreshness(freshnessUsec);
+	m_readCache.invalidate();
+	m_isCoalescing = enable;
+}
+
+uint64_t I2C_Interface::getCoalescedReadCount()
+{
+	return m_readCache.getHitCount();
+}
+
+I2C_Capacity_Report I2C_Interface::getCapacityReport()
+{
+	I2C_Capacity_Report report = m_capacityPlanner.getReport();
+	shared_ptr<const I2C_Event_Map> snapshot = m_eventRegistry.getSnapshot();
+	for (size_t index = 0; index < report.m_entries.size(); index++)
+	{
+		I2C_Capacity_Entry &entry = report.m_entries[index];
+		I2C_Event_Map::const_iterator eventItr = snapshot->find(entry.m_handle);
+		if (eventItr == snapshot->end())
+		{
+			continue;
+		}
+		const I2C_Registered_Event &event = *eventItr->second;
+		entry.m_executionCount = event.m_executionCount.load(
+				std::memory_order_acquire);
+		if (entry.m_executionCount < 2)
+		{
+			continue;
+		}
+		entry.m_measuredPeriodUsec = (double) (event.m_lastStartTs.load(
+				std::memory_order_relaxed)
+				- event.m_firstExecutionTs.load(std::memory_order_relaxed))
+				/ (entry.m_executionCount - 1);
+		entry.m_measuredExecutionUsec = (double) event.m_executionUsec.load(
+				std::memory_order_relaxed) / entry.m_executionCount;
+		report.m_measuredUtilisation += entry.getMeasuredUtilisation();
+	}
+	report.m_measuredBusOccupancy = m_i2cBus.getStatistics().getBusOccupancy();
+	return report;
 }
 
 void I2C_Interface::process(Message *obj)
 {
+	MONOCURRTIME(timeNow);
+	recoverBusIfDue(timeNow);
 	if (!m_setupSuccess)
 	{
 		return;
 	}
-	processEvents();
-	if (!obj)
+	if (obj)
 	{
-		return;
+		m_busArbiter.pushRequest((I2C_Transaction_Message*) obj, false,
+				timeNow);
 	}
-	I2C_Transaction_Message *txMessage = (I2C_Transaction_Message*) obj;
-	processMessage(txMessage);
-	std::queue<I2C_Transaction_Message*> requests;
+	admitRequests(timeNow);
+	admitDueEvents(timeNow);
+	pollTriggers(0);
+	I2C_Arbiter_Entry entry;
+	while (m_busArbiter.pop(entry, timeNow))
 	{
-		ScopeLock lock(m_requestLock);
-		while (!m_requestQueue.empty())
-		{
-			Message *item = m_requestQueue.front();
-			m_requestQueue.pop();
-			if (item)
-			{
-				requests.push((I2C_Transaction_Message*) item);
-			}
-		}
+		executeEntry(entry);
+		MONOTIMEUS(timeNow);
+		recoverBusIfDue(timeNow);
+		admitRequests(timeNow);
+	}
+}
+
+void I2C_Interface::recoverBusIfDue(int64_t timeNow)
+{
+	if (!m_busHealth.isRecoveryDue(timeNow))
+	{
+		return;
 	}
-	while (!requests.empty())
+	I2CError response = reSetupI2CBus();
+	MONOTIMEUS(timeNow);
+	m_busHealth.recordRecovery(!response.isError(), timeNow);
+}
+
+void I2C_Interface::admitRequests(int64_t timeNow)
+{
+	ScopeLock lock(m_requestLock);
+	while (!m_requestQueue.empty())
 	{
-		I2C_Transaction_Message *item = requests.front();
-		requests.pop();
+		Message *item = m_requestQueue.front();
+		m_requestQueue.pop();
 		if (item)
 		{
-			processMessage(item);
+			m_busArbiter.pushRequest((I2C_Transaction_Message*) item,
+					item->getType() != REQUEST_RESPONSE, timeNow);
 		}
 	}
 }
 
-void I2C_Interface::processEvents()
+void I2C_Interface::admitDueEvents(int64_t timeNow)
+{
+	syncRegisteredEvents(timeNow);
+	int64_t releaseTs = 0;
+	shared_ptr<I2C_Registered_Event> event = popDueEvent(timeNow, releaseTs);
+	while (event)
+	{
+		uint64_t deadlineUsec =
+				event->m_message.m_deadlineUsec ?
+						event->m_message.m_deadlineUsec :
+						getEventPeriod(*event);
+		event->m_isExecuting = true;
+		Due_Event dueEvent;
+		dueEvent.m_group = -1;
+		dueEvent.m_deadlineTs = deadlineUsec ? (releaseTs + deadlineUsec) : 0;
+		dueEvent.m_event = event;
+		m_dueEvents.push_back(dueEvent);
+		event = popDueEvent(timeNow, releaseTs);
+	}
+	orderByMuxChannel();
+	for (size_t index = 0; index < m_dueEvents.size(); index++)
+	{
+		m_busArbiter.pushEvent(m_dueEvents[index].m_event, timeNow,
+				m_dueEvents[index].m_deadlineTs);
+	}
+	m_dueEvents.clear();
+}
+
+void I2C_Interface::orderByMuxChannel()
+{
+	if (m_dueEvents.size() < 2)
+	{
+		return;
+	}
+	// The arbiter runs equal deadlines in push order: chips reachable
+	// without a switch go first, then the rest one mux channel at a time
+	ScopeLock lock(m_processLock);
+	for (size_t index = 0; index < m_dueEvents.size(); index++)
+	{
+		uint8_t chipNumber = m_dueEvents[index].m_event->m_message.m_chipNumber;
+		m_dueEvents[index].m_group =
+				m_muxTopology.isSelected(chipNumber) ?
+						-1 : m_muxTopology.getGroup(chipNumber);
+	}
+	std::stable_sort(m_dueEvents.begin(), m_dueEvents.end());
+}
+
+bool I2C_Interface::Due_Event::operator<(const Due_Event &other) const
+{
+	return m_group < other.m_group;
+}
+
+void I2C_Interface::executeEntry(I2C_Arbiter_Entry &entry)
 {
 	MONOCURRTIME(timeNow);
-	if ((timeNow - m_lastProcessedEventTs) < m_frequSec)
+	if (entry.isStale(timeNow))
+	{
+		dropEntry(entry);
+		return;
+	}
+	if (entry.m_event)
+	{
+		executeEvent(entry.m_event, entry.m_admitTs);
+		MONOTIMEUS(m_lastProcessedEventTs);
+		m_busArbiter.recordCompletion(entry, m_lastProcessedEventTs);
+		return;
+	}
+	processMessage(entry.m_request, entry.m_admitTs);
+	MONOTIMEUS(timeNow);
+	m_busArbiter.recordCompletion(entry, timeNow);
+	if (entry.m_ownsRequest)
+	{
+		delete entry.m_request;
+	}
+	entry.m_request = NULL;
+}
+
+void I2C_Interface::dropEntry(I2C_Arbiter_Entry &entry)
+{
+	m_busArbiter.recordDrop(entry);
+	if (entry.m_event)
 	{
+		entry.m_event->m_isExecuting = false;
 		return;
 	}
-	map<uint64_t, I2C_Transaction_Message> eventMessages;
+	entry.m_request->setError(
+			I2CError("I2C transaction deadline expired", DEADLINE_EXPIRED));
+	completeRequest(entry.m_request);
+	if (entry.m_ownsRequest)
+	{
+		delete entry.m_request;
+	}
+	entry.m_request = NULL;
+}
+
+bool I2C_Interface::processIdleWork(int64_t timeNow)
+{
+	admitRequests(timeNow);
+	pollTriggers(0);
+	I2C_Arbiter_Entry entry;
+	if (m_busArbiter.pop(entry, timeNow, I2C_PRIORITY_URGENT))
+	{
+		executeEntry(entry);
+		return true;
+	}
+	if (isEventDue(timeNow))
+	{
+		processSingleEvent();
+		return true;
+	}
+	return false;
+}
+
+void I2C_Interface::processSingleEvent()
+{
+	MONOCURRTIME(timeNow);
+	syncRegisteredEvents(timeNow);
+	int64_t releaseTs = 0;
+	shared_ptr<I2C_Registered_Event> event = popDueEvent(timeNow, releaseTs);
+	if (event)
+	{
+		executeEvent(event, releaseTs);
+		MONOTIMEUS(m_lastProcessedEventTs);
+	}
+}
+
+void I2C_Interface::syncRegisteredEvents(int64_t timeNow)
+{
+	uint64_t version = m_eventRegistry.getVersion();
+	if (version == m_eventSnapshotVersion)
 	{
-		ScopeLock lock(m_eventMessageLock);
-		eventMessages = m_registeredEvents;
+		return;
 	}
-	bool isAnyEventProcessed = false;
-	for (map<uint64_t, I2C_Transaction_Message>::iterator eventItr =
-			eventMessages.begin(); eventItr != eventMessages.end(); eventItr++)
+	shared_ptr<const I2C_Event_Map> snapshot = m_eventRegistry.getSnapshot();
+	for (I2C_Event_Map::const_iterator eventItr = m_eventSnapshot->begin();
+			eventItr != m_eventSnapshot->end(); eventItr++)
 	{
-		if (std::find(m_processedEvents.begin(), m_processedEvents.end(),
-				eventItr->first) != m_processedEvents.end())
+		if (snapshot->find(eventItr->first) == snapshot->end())
 		{
-			continue;
+			m_eventScheduler.remove(eventItr->first);
+			m_phaseStagger.remove(eventItr->first);
+		}
+	}
+	for (I2C_Event_Map::const_iterator eventItr = snapshot->begin();
+			eventItr != snapshot->end(); eventItr++)
+	{
+		I2C_Registered_Event &event = *eventItr->second;
+		if (!event.m_isScheduled)
+		{
+			event.m_isScheduled = true;
+			prepareEvent(event);
+			if (event.m_triggerFd >= 0)
+			{
+				continue;
+			}
+			m_eventScheduler.schedule(eventItr->first,
+					I2C_Event_Scheduler::getFirstDeadline(m_scheduleEpoch,
+							timeNow, getEventPeriod(event),
+							getEventPhase(eventItr->first, event)));
 		}
-		isAnyEventProcessed = true;
-		I2C_Transaction_Message i2cTxMessage = eventItr->second;
-		processI2CTransaction(&i2cTxMessage);
-		i2cTxMessage.publishTransaction();
 	}
+	m_eventSnapshot = snapshot;
+	m_eventSnapshotVersion = version;
+	rebuildTriggers();
+}
 
-	m_processedEvents.clear();
-	if (isAnyEventProcessed)
+uint64_t I2C_Interface::getEventPhase(uint64_t handle,
+		const I2C_Registered_Event &event)
+{
+	const I2C_Transaction_Message &message = event.m_message;
+	if (!m_isStaggering)
 	{
-		MONOTIMEUS(m_lastProcessedEventTs);
+		return message.m_phaseUsec;
+	}
+	uint64_t costUsec = m_capacityPlanner.getCostUsec(handle);
+	if (message.m_isPhasePinned)
+	{
+		m_phaseStagger.reserve(handle, getEventPeriod(event),
+				message.m_phaseUsec, costUsec);
+		return message.m_phaseUsec;
 	}
+	return m_phaseStagger.assign(handle, getEventPeriod(event), costUsec);
 }
 
-void I2C_Interface::processSingleEvent()
+void I2C_Interface::rebuildTriggers()
+{
+	m_triggerFds.clear();
+	m_triggerEvents.clear();
+	for (I2C_Event_Map::const_iterator eventItr = m_eventSnapshot->begin();
+			eventItr != m_eventSnapshot->end(); eventItr++)
+	{
+		if (eventItr->second->m_triggerFd < 0)
+		{
+			continue;
+		}
+		struct pollfd triggerFd;
+		triggerFd.fd = eventItr->second->m_triggerFd;
+		triggerFd.events = eventItr->second->m_triggerEvents;
+		triggerFd.revents = 0;
+		m_triggerFds.push_back(triggerFd);
+		m_triggerEvents.push_back(eventItr->second);
+	}
+}
+
+void I2C_Interface::waitForNextCycle(uint64_t timeoutUsec)
 {
 	MONOCURRTIME(timeNow);
-	if ((timeNow - m_lastProcessedEventTs) < m_frequSec)
+	syncRegisteredEvents(timeNow);
+	if (m_triggerFds.empty())
 	{
+		ProcessThread::waitForNextCycle(timeoutUsec);
 		return;
 	}
-	map<uint64_t, I2C_Transaction_Message> eventMessages;
+	pollTriggers(timeoutUsec);
+}
+
+bool I2C_Interface::pollTriggers(uint64_t timeoutUsec)
+{
+	if (m_triggerFds.empty())
+	{
+		return false;
+	}
+	struct timespec timeout;
+	timeout.tv_sec = timeoutUsec / 1000000;
+	timeout.tv_nsec = (timeoutUsec % 1000000) * 1000;
+	if (ppoll(m_triggerFds.data(), m_triggerFds.size(), &timeout, NULL) <= 0)
 	{
-		ScopeLock lock(m_eventMessageLock);
-		eventMessages = m_registeredEvents;
+		return false;
 	}
-	for (map<uint64_t, I2C_Transaction_Message>::iterator eventItr =
-			eventMessages.begin(); eventItr != eventMessages.end(); eventItr++)
+	MONOCURRTIME(triggerTs);
+	bool isTriggered = false;
+	for (size_t index = 0; index < m_triggerFds.size(); index++)
 	{
-		if (std::find(m_processedEvents.begin(), m_processedEvents.end(),
-				eventItr->first) != m_processedEvents.end())
+		struct pollfd &triggerFd = m_triggerFds[index];
+		if (!(triggerFd.revents & triggerFd.events))
+		{
+			if (triggerFd.revents & (POLLHUP | POLLNVAL))
+			{
+				// A closed source would wake every poll; stop watching it
+				triggerFd.fd = -1;
+			}
+			continue;
+		}
+		// Consume the signal; sysfs GPIO values are re-read from the start
+		char value[16];
+		lseek(triggerFd.fd, 0, SEEK_SET);
+		ssize_t consumed = read(triggerFd.fd, value, sizeof(value));
+		(void) consumed;
+		shared_ptr<I2C_Registered_Event> &event = m_triggerEvents[index];
+		if (event->m_isExecuting)
 		{
+			m_missedTriggerCount.fetch_add(1, std::memory_order_relaxed);
 			continue;
 		}
-		I2C_Transaction_Message i2cTxMessage = eventItr->second;
-		processI2CTransaction(&i2cTxMessage);
-		i2cTxMessage.publishTransaction();
-		m_processedEvents.push_back(eventItr->first);
-		break;
+		event->m_message.m_triggerTs = triggerTs;
+		event->m_isExecuting = true;
+		m_busArbiter.pushEvent(event, triggerTs,
+				event->m_message.m_deadlineUsec ?
+						triggerTs + event->m_message.m_deadlineUsec : 0);
+		isTriggered = true;
 	}
-	if (m_processedEvents.size() >= m_registeredEvents.size())
+	return isTriggered;
+}
+
+shared_ptr<I2C_Registered_Event> I2C_Interface::popDueEvent(int64_t timeNow,
+		int64_t &releaseTs)
+{
+	uint64_t handle = 0;
+	int64_t deadline = 0;
+	while (m_eventScheduler.popDue(timeNow, handle, deadline))
 	{
-		m_processedEvents.clear();
-		MONOTIMEUS(m_lastProcessedEventTs);
+		I2C_Event_Map::const_iterator eventItr = m_eventSnapshot->find(handle);
+		if (eventItr == m_eventSnapshot->end())
+		{
+			continue;
+		}
+		m_eventScheduler.schedule(handle,
+				I2C_Event_Scheduler::getNextDeadline(deadline, timeNow,
+						getEventPeriod(*eventItr->second)));
+		if (!eventItr->second->m_isExecuting)
+		{
+			releaseTs = deadline;
+			return eventItr->second;
+		}
 	}
+	return shared_ptr<I2C_Registered_Event>();
 }
 
-void I2C_Interface::processMessage(I2C_Transaction_Message *txMessage)
+void I2C_Interface::executeEvent(shared_ptr<I2C_Registered_Event> event,
+		int64_t requestTs)
 {
-	processI2CTransaction(txMessage);
-	enqueResponse(txMessage);
-	if (txMessage->m_transactionDelayUsec > 0)
+	event->m_isExecuting = true;
+	// A program builds its messages as it runs; nothing to prepare
+	if (!event->m_message.m_program
+			&& (event->m_preparedTransfers.size()
+					!= event->m_message.m_messages.size()))
+	{
+		prepareEvent(*event);
+	}
+	MONOCURRTIME(startTs);
+	processI2CTransaction(&event->m_message, requestTs, true,
+			event->m_preparedTransfers.data());
+	if (event->m_sampleRing)
 	{
-		MONOCURRTIME(timeNow);
-		uint64_t timeDelay = txMessage->m_transactionDelayUsec;
-		if ((timeNow - m_lastProcessedEventTs) > m_frequSec)
+		event->m_sampleRing->record(
+				(event->m_triggerFd >= 0) ?
+						event->m_message.m_triggerTs : startTs,
+				event->m_message);
+	}
+	else if (event->shouldPublish())
+	{
+		// Suppressed results are neither copied nor dispatched
+		if (m_callbackDispatcher && event->m_message.hasEventHandle())
 		{
-			processEvents();
-			timeDelay = getNormalizedDelay(m_lastProcessedEventTs, timeNow,
-					txMessage->m_transactionDelayUsec);
+			m_callbackDispatcher->dispatch(
+					make_shared<const I2C_Transaction_Message>(
+							event->m_message));
 		}
-		if (timeDelay)
+		else
 		{
-			usleep(timeDelay);
+			event->m_message.publishTransaction();
 		}
 	}
-	else
+	MONOTIMEUS(event->m_lastExecutionTs);
+	if (event->adaptPeriod() && (event->m_triggerFd < 0))
+	{
+		// The next deadline was taken at the old period when it was popped
+		m_eventScheduler.schedule(event->m_message.getHandle(),
+				I2C_Event_Scheduler::getNextDeadline(startTs,
+						event->m_lastExecutionTs, getEventPeriod(*event)));
+	}
+	if (!event->m_executionCount.load(std::memory_order_relaxed))
+	{
+		event->m_firstExecutionTs.store(startTs, std::memory_order_relaxed);
+	}
+	event->m_lastStartTs.store(startTs, std::memory_order_relaxed);
+	event->m_executionUsec.fetch_add(event->m_lastExecutionTs - startTs,
+			std::memory_order_relaxed);
+	event->m_executionCount.fetch_add(1, std::memory_order_release);
+	event->m_isExecuting = false;
+}
+
+bool I2C_Interface::isEventDue(int64_t timeNow)
+{
+	syncRegisteredEvents(timeNow);
+	return m_eventScheduler.isDue(timeNow);
+}
+
+uint64_t I2C_Interface::getEventPeriod(const I2C_Transaction_Message &message)
+{
+	if (message.m_periodUsec)
+	{
+		return message.m_periodUsec;
+	}
+	return (m_frequSec > 0) ? m_frequSec : 0;
+}
+
+uint64_t I2C_Interface::getEventPeriod(const I2C_Registered_Event &event)
+{
+	if (event.m_message.isAdaptive())
+	{
+		return event.m_currentPeriodUsec.load(std::memory_order_relaxed);
+	}
+	return getEventPeriod(event.m_message);
+}
+
+void I2C_Interface::processMessage(I2C_Transaction_Message *txMessage,
+		int64_t requestTs)
+{
+	processI2CTransaction(txMessage, requestTs);
+	uint64_t transactionDelayUsec = txMessage->m_transactionDelayUsec;
+	completeRequest(txMessage);
+	performTransactionDelay(transactionDelayUsec);
+}
+
+void I2C_Interface::completeRequest(I2C_Transaction_Message *txMessage)
+{
+	// A private completion queue keeps the response away from dequeue()
+	if (txMessage->m_completionQueue)
+	{
+		if (!txMessage->m_completionQueue->push(txMessage)
+				&& (txMessage->getType() == REQUEST_RESPONSE))
+		{
+			// Its owner closed the queue and stopped waiting for it
+			delete txMessage;
+		}
+		return;
+	}
+	if (txMessage->getType() == REQUEST_RESPONSE)
 	{
-		processEvents();
+		enqueResponse(txMessage);
 	}
 }
 
-I2CError I2C_Interface::performRead(uint8_t chipNumber, I2C_Message &message)
+I2CError I2C_Interface::performRead(uint8_t chipNumber, I2C_Message &message,
+		int64_t requestTs, I2C_Prepared_Transfer *prepared)
 {
 	I2CError response;
+	bool isCoalescing = m_isCoalescing && message.m_allowCoalescing;
+	MONOCURRTIME(readTs);
+	if (isCoalescing
+			&& m_readCache.lookup(chipNumber, message.m_registerNumber,
+					message.getDataSize(), requestTs, readTs,
+					message.m_data))
+	{
+		message.m_error = response;
+		return response;
+	}
 	uint64_t retryCount = message.m_retryCount;
 	do
 	{
 		if (retryCount != message.m_retryCount)
 		{
+			m_i2cBus.recordRetry(chipNumber, message.m_registerNumber);
 			if (message.m_allowOtherProcessOnIdle)
 			{
 				performTransactionDelay(message.m_retryDelayInUsec);
@@ -217,24 +1103,26 @@ I2CError I2C_Interface::performRead(uint8_t chipNumber, I2C_Message &message)
 				usleep(message.m_retryDelayInUsec);
 			}
 		}
-		{
-			ScopeLock lock(m_processLock);
-			m_i2cBus.setSize(message.m_registerNumber.size(),
-					message.getDataSize());
-			response = m_i2cBus.genericRead(chipNumber,
-					message.m_registerNumber, message.m_data);
-		}
+		MONOTIMEUS(readTs);
+		response = transferMessage(chipNumber, message, true, prepared);
 		if (!response.isError())
 		{
 			break;
 		}
 	} while (retryCount-- > 0);
+	recordBusResult(chipNumber, response);
+	if (isCoalescing && !response.isError())
+	{
+		m_readCache.store(chipNumber, message.m_registerNumber, message.m_data,
+				readTs);
+	}
 	message.m_error = response;
 	return response;
 }
 
 I2CError I2C_Interface::performCompareRead(uint8_t chipNumber,
-		I2C_Message &message, bool compareEquals)
+		I2C_Message &message, bool compareEquals,
+		I2C_Prepared_Transfer *prepared)
 {
 	I2CError response;
 	uint64_t retryCount = message.m_retryCount;
@@ -242,6 +1130,7 @@ I2CError I2C_Interface::performCompareRead(uint8_t chipNumber,
 	{
 		if (retryCount != message.m_retryCount)
 		{
+			m_i2cBus.recordRetry(chipNumber, message.m_registerNumber);
 			if (message.m_allowOtherProcessOnIdle)
 			{
 				performTransactionDelay(message.m_retryDelayInUsec);
@@ -251,13 +1140,7 @@ I2CError I2C_Interface::performCompareRead(uint8_t chipNumber,
 				usleep(message.m_retryDelayInUsec);
 			}
 		}
-		{
-			ScopeLock lock(m_processLock);
-			m_i2cBus.setSize(message.m_registerNumber.size(),
-					message.getDataSize());
-			response = m_i2cBus.genericRead(chipNumber,
-					message.m_registerNumber, message.m_data);
-		}
+		response = transferMessage(chipNumber, message, true, prepared);
 		if (!response.isError())
 		{
 			if (compareEquals
@@ -274,11 +1157,13 @@ I2CError I2C_Interface::performCompareRead(uint8_t chipNumber,
 			}
 		}
 	} while (retryCount-- > 0);
+	recordBusResult(chipNumber, response);
 	message.m_error = response;
 	return response;
 }
 
-I2CError I2C_Interface::performWrite(uint8_t chipNumber, I2C_Message &message)
+I2CError I2C_Interface::performWrite(uint8_t chipNumber, I2C_Message &message,
+		I2C_Prepared_Transfer *prepared)
 {
 	I2CError response;
 	uint64_t retryCount = message.m_retryCount;
@@ -286,6 +1171,7 @@ I2CError I2C_Interface::performWrite(uint8_t chipNumber, I2C_Message &message)
 	{
 		if (retryCount != message.m_retryCount)
 		{
+			m_i2cBus.recordRetry(chipNumber, message.m_registerNumber);
 			if (message.m_allowOtherProcessOnIdle)
 			{
 				performTransactionDelay(message.m_retryDelayInUsec);
@@ -295,35 +1181,117 @@ I2CError I2C_Interface::performWrite(uint8_t chipNumber, I2C_Message &message)
 				usleep(message.m_retryDelayInUsec);
 			}
 		}
-		{
-			ScopeLock lock(m_processLock);
-			m_i2cBus.setSize(message.m_registerNumber.size(),
-								message.m_data.size());
-			response = m_i2cBus.genericWrite(chipNumber,
-					message.m_registerNumber, message.m_data);
-		}
+		response = transferMessage(chipNumber, message, false, prepared);
 		if (!response.isError())
 		{
 			break;
 		}
 	} while (retryCount-- > 0);
+	// One result per message once its retries are spent
+	recordBusResult(chipNumber, response);
+	if (m_isCoalescing)
+	{
+		// Even a failed write may have reached the chip
+		m_readCache.invalidate(chipNumber);
+	}
 	message.m_error = response;
 	return response;
 }
 
-void I2C_Interface::processI2CTransaction(I2C_Transaction_Message *txMessage)
+I2CError I2C_Interface::transferMessage(uint8_t chipNumber,
+		I2C_Message &message, bool isRead, I2C_Prepared_Transfer *prepared)
 {
-	I2CError transactionError;
-	for (size_t messageIndex = 0; messageIndex < txMessage->m_messages.size();
+	ScopeLock lock(m_processLock);
+	I2CError response = m_muxTopology.select(chipNumber, m_i2cBus);
+	if (response.isError())
+	{
+		return response;
+	}
+	if (prepared)
+	{
+		response = m_i2cBus.execute(*prepared, message.m_data);
+	}
+	else
+	{
+		m_i2cBus.setSize(message.m_registerNumber.size(),
+				isRead ? message.getDataSize() : message.m_data.size());
+		response =
+				isRead ?
+						m_i2cBus.genericRead(chipNumber,
+								message.m_registerNumber, message.m_data) :
+						m_i2cBus.genericWrite(chipNumber,
+								message.m_registerNumber, message.m_data);
+	}
+	if (response.isError())
+	{
+		// The mux may have been reset; select it again next time
+		m_muxTopology.invalidate(chipNumber);
+	}
+	return response;
+}
+
+void I2C_Interface::prepareEvent(I2C_Registered_Event &event)
+{
+	I2C_Transaction_Message &message = event.m_message;
+	event.m_preparedTransfers.resize(message.m_messages.size());
+	ScopeLock lock(m_processLock);
+	for (size_t messageIndex = 0; messageIndex < message.m_messages.size();
 			messageIndex++)
+	{
+		I2C_Message &i2cMessage = message.m_messages[messageIndex];
+		bool isRead = (i2cMessage.m_type != I2C_WRITE);
+		m_i2cBus.prepare(event.m_preparedTransfers[messageIndex],
+				message.m_chipNumber, i2cMessage.m_registerNumber,
+				isRead ? i2cMessage.getDataSize() : i2cMessage.m_data.size(),
+				isRead);
+	}
+}
+
+void I2C_Interface::recordBusResult(uint8_t chipNumber, I2CError &response)
+{
+	MONOCURRTIME(timeNow);
+	m_busHealth.recordResult(chipNumber, !response.isError(), timeNow);
+}
+
+void I2C_Interface::processI2CTransaction(I2C_Transaction_Message *txMessage,
+		int64_t requestTs, bool isEvent,
+		I2C_Prepared_Transfer *preparedTransfers)
+{
+	I2CError transactionError;
+	MONOCURRTIME(timeNow);
+	if (!m_busHealth.isChipAvailable(txMessage->m_chipNumber, timeNow))
+	{
+		transactionError = I2CError(
+				"I2C chip is quarantined after repeated failures",
+				CHIP_QUARANTINED);
+		for (size_t messageIndex = 0;
+				messageIndex < txMessage->m_messages.size(); messageIndex++)
+		{
+			txMessage->m_messages[messageIndex].m_error = transactionError;
+		}
+		txMessage->setError(transactionError);
+		return;
+	}
+	if (txMessage->m_program)
+	{
+		runProgram(txMessage, isEvent, requestTs);
+		return;
+	}
+	bool isTracing = m_traceRecorder.isRecording();
+	uint64_t transactionId = isTracing ? ++m_traceTransactionId : 0;
+	size_t messageIndex = 0;
+	for (; messageIndex < txMessage->m_messages.size(); messageIndex++)
 	{
 		I2CError i2cError;
+		I2C_Prepared_Transfer *prepared =
+				preparedTransfers ? &preparedTransfers[messageIndex] : NULL;
+		MONOCURRTIME(startTs);
 		switch (txMessage->m_messages[messageIndex].m_type)
 		{
 		case I2C_READ:
 		{
 			i2cError = performRead(txMessage->m_chipNumber,
-					txMessage->m_messages[messageIndex]);
+					txMessage->m_messages[messageIndex], requestTs, prepared);
 			break;
 		}
 		case I2C_READ_COMPARE_EQUAL:
@@ -332,21 +1300,27 @@ void I2C_Interface::processI2CTransaction(I2C_Transaction_Message *txMessage)
 			i2cError = performCompareRead(txMessage->m_chipNumber,
 					txMessage->m_messages[messageIndex],
 					txMessage->m_messages[messageIndex].m_type
-							== I2C_READ_COMPARE_EQUAL);
+							== I2C_READ_COMPARE_EQUAL, prepared);
 			break;
 		}
 		case I2C_WRITE:
 		{
 			i2cError = performWrite(txMessage->m_chipNumber,
-					txMessage->m_messages[messageIndex]);
+					txMessage->m_messages[messageIndex], prepared);
 			break;
 		}
 		}
+		if (isTracing)
+		{
+			traceMessage(transactionId, txMessage->m_chipNumber, isEvent,
+					txMessage->m_messages[messageIndex], startTs);
+		}
 		if (i2cError.isError())
 		{
 			transactionError = i2cError;
 			if (txMessage->m_stopOnAnyTransactionFailure)
 			{
+				messageIndex++;
 				break;
 			}
 		}
@@ -363,9 +1337,179 @@ void I2C_Interface::processI2CTransaction(I2C_Transaction_Message *txMessage)
 			}
 		}
 	}
+	// Registered events are reused, so skipped messages must not keep the
+	// previous run's data and success
+	for (; messageIndex < txMessage->m_messages.size(); messageIndex++)
+	{
+		I2C_Message &skipped = txMessage->m_messages[messageIndex];
+		skipped.m_error = transactionError;
+		if (skipped.m_type != I2C_WRITE)
+		{
+			skipped.m_data.clear();
+		}
+	}
+	txMessage->setError(transactionError);
+}
+
+void I2C_Interface::runProgram(I2C_Transaction_Message *txMessage,
+		bool isEvent, int64_t requestTs)
+{
+	const I2C_Transaction_Program &program = *txMessage->m_program;
+	txMessage->m_messages.clear();
+	if (!program.isValid())
+	{
+		txMessage->setError(
+				I2CError("I2C transaction program is malformed",
+						PROGRAM_ERROR));
+		return;
+	}
+	I2CError transactionError;
+	bool isTracing = m_traceRecorder.isRecording();
+	uint64_t transactionId = isTracing ? ++m_traceTransactionId : 0;
+	uint64_t variables[I2C_PROGRAM_VARIABLE_COUNT] =
+	{ 0 };
+	size_t counter = 0;
+	uint64_t stepCount = 0;
+	while (counter < program.m_instructions.size())
+	{
+		if (++stepCount > I2C_PROGRAM_MAX_STEPS)
+		{
+			transactionError = I2CError(
+					"I2C transaction program exceeded its step limit",
+					PROGRAM_ERROR);
+			break;
+		}
+		const I2C_Program_Instruction &instruction =
+				program.m_instructions[counter++];
+		switch (instruction.m_opcode)
+		{
+		case I2C_OP_READ:
+		case I2C_OP_READ_VARIABLE:
+		case I2C_OP_WRITE:
+		{
+			bool isWrite = (instruction.m_opcode == I2C_OP_WRITE);
+			uint64_t size = instruction.m_value;
+			if (instruction.m_opcode == I2C_OP_READ_VARIABLE)
+			{
+				size = std::min(variables[instruction.m_variable], size);
+			}
+			if (!isWrite && !size)
+			{
+				break;
+			}
+			txMessage->m_messages.push_back(I2C_Message());
+			I2C_Message &message = txMessage->m_messages.back();
+			if (isWrite)
+			{
+				message.configureWrite(instruction.m_registerNumber,
+						instruction.m_data);
+			}
+			else
+			{
+				message.configureRead(instruction.m_registerNumber, size);
+			}
+			message.setRetries(program.m_retryCount);
+			MONOCURRTIME(startTs);
+			I2CError i2cError =
+					isWrite ?
+							performWrite(txMessage->m_chipNumber, message) :
+							performRead(txMessage->m_chipNumber, message,
+									requestTs);
+			if (isTracing)
+			{
+				traceMessage(transactionId, txMessage->m_chipNumber, isEvent,
+						message, startTs);
+			}
+			if (i2cError.isError())
+			{
+				// Later instructions may depend on this result; stop here
+				transactionError = i2cError;
+				counter = program.m_instructions.size();
+			}
+			else if ((instruction.m_opcode == I2C_OP_READ)
+					&& (instruction.m_variable < I2C_PROGRAM_VARIABLE_COUNT))
+			{
+				variables[instruction.m_variable] = message.getCombinedData();
+			}
+			break;
+		}
+		case I2C_OP_LOAD:
+		{
+			variables[instruction.m_variable] = instruction.m_value;
+			break;
+		}
+		case I2C_OP_AND:
+		{
+			variables[instruction.m_variable] &= instruction.m_value;
+			break;
+		}
+		case I2C_OP_SHIFT_RIGHT:
+		{
+			variables[instruction.m_variable] =
+					(instruction.m_value < 64) ?
+							(variables[instruction.m_variable]
+									>> instruction.m_value) :
+							0;
+			break;
+		}
+		case I2C_OP_MULTIPLY:
+		{
+			variables[instruction.m_variable] *= instruction.m_value;
+			break;
+		}
+		case I2C_OP_ADD:
+		{
+			variables[instruction.m_variable] += instruction.m_value;
+			break;
+		}
+		case I2C_OP_JUMP:
+		{
+			counter = instruction.m_value;
+			break;
+		}
+		case I2C_OP_JUMP_IF_ZERO:
+		case I2C_OP_JUMP_IF_NOT_ZERO:
+		{
+			bool isZero = !variables[instruction.m_variable];
+			if (isZero == (instruction.m_opcode == I2C_OP_JUMP_IF_ZERO))
+			{
+				counter = instruction.m_value;
+			}
+			break;
+		}
+		case I2C_OP_DELAY:
+		{
+			usleep(instruction.m_value);
+			break;
+		}
+		case I2C_OP_END:
+		{
+			counter = program.m_instructions.size();
+			break;
+		}
+		}
+	}
 	txMessage->setError(transactionError);
 }
 
+void I2C_Interface::traceMessage(uint64_t transactionId, uint16_t chipNumber,
+		bool isEvent, const I2C_Message &message, int64_t startTs)
+{
+	MONOCURRTIME(timeNow);
+	I2C_Trace_Record record;
+	record.m_timestampUsec = startTs;
+	record.m_transactionId = transactionId;
+	record.m_chipNumber = chipNumber;
+	record.m_type = message.m_type;
+	record.m_isEvent = isEvent;
+	record.m_errorCode = I2CError(message.m_error).getCode();
+	record.m_latencyUsec = timeNow - startTs;
+	record.m_registerNumber = message.m_registerNumber;
+	record.m_data = message.m_data;
+	record.m_compareData = message.m_compareData;
+	m_traceRecorder.record(record);
+}
+
 void I2C_Interface::performTransactionDelay(const uint64_t timeDelay)
 {
 	if (!timeDelay)
@@ -374,13 +1518,10 @@ void I2C_Interface::performTransactionDelay(const uint64_t timeDelay)
 	}
 	MONOCURRTIME(startTime);
 	int64_t timeNow = startTime;
-	uint64_t pendingEvents = m_registeredEvents.size()
-			- m_processedEvents.size();
 
 	uint64_t delayInUsec = getNormalizedDelay(timeNow, startTime, timeDelay);
-	while ((delayInUsec > 0) && (pendingEvents-- > 0))
+	while ((delayInUsec > 0) && processIdleWork(timeNow))
 	{
-		processSingleEvent();
 		MONOTIMEUS(timeNow);
 		delayInUsec = getNormalizedDelay(timeNow, startTime, timeDelay);
 	}
@@ -0,0 +1,356 @@
+/*
+ * I2CTraceReplayer.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <unistd.h>
+#include "utils/Macro.h"
+#include "utils/I2CTraceRecorder.h"
+#include "controllers/I2CTraceReplayer.h"
+
+namespace apra
+{
+
+I2C_Replay_Report::I2C_Replay_Report() :
+		m_transactionCount(0), m_completedCount(0), m_errorCount(0), m_mismatchCount(
+				0), m_recordedDurationUsec(0), m_replayDurationUsec(0), m_totalLatencyUsec(
+				0), m_maxLatencyUsec(0)
+{
+}
+
+I2C_Replay_Report::~I2C_Replay_Report()
+{
+}
+
+double I2C_Replay_Report::getAverageLatencyUsec() const
+{
+	return m_completedCount ?
+			(double) m_totalLatencyUsec / m_completedCount : 0;
+}
+
+I2C_Trace_Replayer::I2C_Trace_Replayer() :
+		m_transactions(), m_busClockHz(I2C_DEFAULT_BUS_CLOCK_HZ), m_completions(
+				make_shared<I2C_Completion_Queue>()), m_pendingReads()
+{
+}
+
+I2C_Trace_Replayer::I2C_Trace_Replayer(const vector<I2C_Trace_Record> &records) :
+		m_transactions(), m_busClockHz(I2C_DEFAULT_BUS_CLOCK_HZ), m_completions(
+				make_shared<I2C_Completion_Queue>()), m_pendingReads()
+{
+	setRecords(records);
+}
+
+I2C_Trace_Replayer::~I2C_Trace_Replayer()
+{
+	// Transactions completing after this are freed by the interface
+	m_completions->close();
+	I2C_Transaction_Message *response = NULL;
+	while (m_completions->pop(response))
+	{
+		delete response;
+	}
+}
+
+bool I2C_Trace_Replayer::load(string path)
+{
+	vector<I2C_Trace_Record> records;
+	uint64_t busClockHz = 0;
+	if (!I2C_Trace_Recorder::load(path, records, busClockHz))
+	{
+		return false;
+	}
+	setRecords(records);
+	m_busClockHz = busClockHz;
+	return true;
+}
+
+void I2C_Trace_Replayer::setRecords(const vector<I2C_Trace_Record> &records)
+{
+	m_transactions.clear();
+	map<uint64_t, size_t> transactionIndex;
+	for (size_t recordIndex = 0; recordIndex < records.size(); recordIndex++)
+	{
+		const I2C_Trace_Record &record = records[recordIndex];
+		map<uint64_t, size_t>::iterator indexItr = transactionIndex.find(
+				record.m_transactionId);
+		if (indexItr == transactionIndex.end())
+		{
+			transactionIndex[record.m_transactionId] = m_transactions.size();
+			m_transactions.push_back(vector<I2C_Trace_Record>(1, record));
+		}
+		else
+		{
+			m_transactions[indexItr->second].push_back(record);
+		}
+	}
+}
+
+size_t I2C_Trace_Replayer::getTransactionCount()
+{
+	return m_transactions.size();
+}
+
+uint64_t I2C_Trace_Replayer::getBusClock()
+{
+	return m_busClockHz;
+}
+
+void I2C_Trace_Replayer::primeTransport(I2C_Simulated_Transport &transport)
+{
+	transport.setBusClock(m_busClockHz);
+	for (size_t index = 0; index < m_transactions.size(); index++)
+	{
+		const I2C_Trace_Record &record = m_transactions[index][0];
+		if (!transport.hasDevice(record.m_chipNumber))
+		{
+			transport.addDevice(record.m_chipNumber,
+					record.m_registerNumber.size());
+		}
+	}
+}
+
+I2C_Replay_Report I2C_Trace_Replayer::replay(I2C_Interface &interface,
+		double speedFactor, I2C_Simulated_Transport *transport,
+		uint64_t drainTimeoutUsec)
+{
+	I2C_Replay_Report report;
+	if (m_transactions.empty())
+	{
+		return report;
+	}
+	map<Message*, pair<size_t, int64_t> > pending;
+	m_pendingReads.clear();
+	int64_t firstTs = m_transactions.front()[0].m_timestampUsec;
+	report.m_recordedDurationUsec = m_transactions.back()[0].m_timestampUsec
+			- firstTs;
+	MONOCURRTIME(startTs);
+	for (size_t index = 0; index < m_transactions.size(); index++)
+	{
+		const vector<I2C_Trace_Record> &records = m_transactions[index];
+		if (speedFactor > 0)
+		{
+			int64_t targetTs = startTs
+					+ (int64_t) ((records[0].m_timestampUsec - firstTs)
+							/ speedFactor);
+			MONOCURRTIME(timeNow);
+			while (timeNow < targetTs)
+			{
+				collectResponses(pending, report);
+				int64_t waitUsec = targetTs - timeNow;
+				usleep(
+						(waitUsec < I2C_REPLAY_POLL_USEC) ?
+								waitUsec : I2C_REPLAY_POLL_USEC);
+				MONOTIMEUS(timeNow);
+			}
+		}
+		// Bounded so the request queue never trims a pending transaction
+		while (pending.size() >= I2C_REPLAY_MAX_PENDING)
+		{
+			usleep(I2C_REPLAY_POLL_USEC);
+			collectResponses(pending, report);
+		}
+		if (transport)
+		{
+			// Loading now would overwrite data an earlier read has yet to see
+			while (isReadPending(records))
+			{
+				usleep(I2C_REPLAY_POLL_USEC);
+				collectResponses(pending, report);
+			}
+			loadReadData(records, *transport);
+			trackReads(records, true);
+		}
+		I2C_Transaction_Message *txMessage = buildTransaction(records);
+		MONOCURRTIME(submitTs);
+		pending[txMessage] = make_pair(index, submitTs);
+		interface.enque(txMessage);
+		report.m_transactionCount++;
+	}
+	MONOCURRTIME(drainStartTs);
+	int64_t timeNow = drainStartTs;
+	collectResponses(pending, report);
+	while (!pending.empty()
+			&& ((uint64_t) (timeNow - drainStartTs) < drainTimeoutUsec))
+	{
+		usleep(I2C_REPLAY_POLL_USEC);
+		collectResponses(pending, report);
+		MONOTIMEUS(timeNow);
+	}
+	MONOTIMEUS(timeNow);
+	report.m_replayDurationUsec = timeNow - startTs;
+	return report;
+}
+
+I2C_Transaction_Message* I2C_Trace_Replayer::buildTransaction(
+		const vector<I2C_Trace_Record> &records)
+{
+	vector<I2C_Message> messages;
+	for (size_t index = 0; index < records.size(); index++)
+	{
+		I2C_Message message;
+		if (records[index].m_type == I2C_WRITE)
+		{
+			message.configureWrite(records[index].m_registerNumber,
+					records[index].m_data);
+		}
+		else if (records[index].isCompare())
+		{
+			message.configureReadWithComparison(
+					records[index].m_registerNumber,
+					records[index].m_data.size(),
+					records[index].m_compareData,
+					records[index].m_type == I2C_READ_COMPARE_EQUAL);
+		}
+		else
+		{
+			message.configureRead(records[index].m_registerNumber,
+					records[index].m_data.size());
+		}
+		messages.push_back(message);
+	}
+	I2C_Transaction_Message *txMessage = new I2C_Transaction_Message(
+			records[0].m_chipNumber, messages);
+	txMessage->setType(REQUEST_RESPONSE);
+	txMessage->setCompletionQueue(m_completions);
+	return txMessage;
+}
+
+void I2C_Trace_Replayer::loadReadData(const vector<I2C_Trace_Record> &records,
+		I2C_Simulated_Transport &transport)
+{
+	for (size_t index = 0; index < records.size(); index++)
+	{
+		if ((records[index].m_type != I2C_WRITE)
+				&& (records[index].m_errorCode == NO_ERROR))
+		{
+			transport.setRegisters(records[index].m_chipNumber,
+					getRegisterAddress(records[index].m_registerNumber),
+					records[index].m_data);
+		}
+	}
+}
+
+void I2C_Trace_Replayer::collectResponses(
+		map<Message*, pair<size_t, int64_t> > &pending,
+		I2C_Replay_Report &report)
+{
+	I2C_Transaction_Message *response = NULL;
+	while (m_completions->pop(response))
+	{
+		map<Message*, pair<size_t, int64_t> >::iterator pendingItr =
+				pending.find(response);
+		if (pendingItr == pending.end())
+		{
+			// Completed after an earlier replay stopped waiting for it
+			delete response;
+		}
+		else
+		{
+			MONOCURRTIME(timeNow);
+			uint64_t latencyUsec = timeNow - pendingItr->second.second;
+			report.m_completedCount++;
+			report.m_totalLatencyUsec += latencyUsec;
+			if (latencyUsec > report.m_maxLatencyUsec)
+			{
+				report.m_maxLatencyUsec = latencyUsec;
+			}
+			const vector<I2C_Trace_Record> &records =
+					m_transactions[pendingItr->second.first];
+			bool isError = false;
+			bool isMismatch = false;
+			vector<I2C_Message> &messages = response->getAllMessages();
+			for (size_t index = 0; index < messages.size(); index++)
+			{
+				bool isMessageError = messages[index].m_error.isError();
+				isError = isError || isMessageError;
+				if (isMessageError != (records[index].m_errorCode != NO_ERROR))
+				{
+					isMismatch = true;
+				}
+				else if (!isMessageError && (records[index].m_type != I2C_WRITE)
+						&& (messages[index].m_data != records[index].m_data))
+				{
+					isMismatch = true;
+				}
+			}
+			report.m_errorCount += isError ? 1 : 0;
+			report.m_mismatchCount += isMismatch ? 1 : 0;
+			trackReads(records, false);
+			pending.erase(pendingItr);
+			delete response;
+		}
+	}
+}
+
+bool I2C_Trace_Replayer::isReadPending(
+		const vector<I2C_Trace_Record> &records)
+{
+	for (size_t index = 0; index < records.size(); index++)
+	{
+		const I2C_Trace_Record &record = records[index];
+		if ((record.m_type == I2C_WRITE) || (record.m_errorCode != NO_ERROR))
+		{
+			continue;
+		}
+		uint64_t registerAddress = getRegisterAddress(record.m_registerNumber);
+		for (size_t offset = 0; offset < record.m_data.size(); offset++)
+		{
+			if (m_pendingReads.count(
+					make_pair(record.m_chipNumber, registerAddress + offset)))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void I2C_Trace_Replayer::trackReads(const vector<I2C_Trace_Record> &records,
+		bool isPending)
+{
+	for (size_t index = 0; index < records.size(); index++)
+	{
+		const I2C_Trace_Record &record = records[index];
+		if ((record.m_type == I2C_WRITE) || (record.m_errorCode != NO_ERROR))
+		{
+			continue;
+		}
+		uint64_t registerAddress = getRegisterAddress(record.m_registerNumber);
+		for (size_t offset = 0; offset < record.m_data.size(); offset++)
+		{
+			pair<uint16_t, uint64_t> key = make_pair(record.m_chipNumber,
+					registerAddress + offset);
+			if (isPending)
+			{
+				m_pendingReads[key]++;
+				continue;
+			}
+			map<pair<uint16_t, uint64_t>, size_t>::iterator readItr =
+					m_pendingReads.find(key);
+			if ((readItr != m_pendingReads.end()) && !--readItr->second)
+			{
+				m_pendingReads.erase(readItr);
+			}
+		}
+	}
+}
+
+uint64_t I2C_Trace_Replayer::getRegisterAddress(
+		const vector<uint8_t> &registerNumber)
+{
+	uint64_t registerAddress = 0;
+	for (size_t index = 0; index < registerNumber.size(); index++)
+	{
+		registerAddress = (registerAddress << 8) | registerNumber[index];
+	}
+	return registerAddress;
+}
+
+} /* namespace apra */
@@ -0,0 +1,204 @@
+/*
+ * I2CBusStatistics.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <string.h>
+#include "models/I2CBusStatistics.h"
+
+// (repeated) start + address/rw + ack
+#define I2C_SEGMENT_OVERHEAD_BITS 10
+#define I2C_STOP_BITS 1
+#define I2C_BITS_PER_BYTE 9
+
+namespace apra
+{
+
+I2C_Register_Statistics::I2C_Register_Statistics() :
+		m_readCount(0), m_writeCount(0), m_bytesRead(0), m_bytesWritten(0), m_retryCount(
+				0), m_errorCount(0), m_totalLatencyUsec(0), m_maxLatencyUsec(0), m_busTimeUsec(
+				0), m_errorCodes()
+{
+	memset(m_latencyHistogram, 0, sizeof(m_latencyHistogram));
+}
+
+I2C_Register_Statistics::~I2C_Register_Statistics()
+{
+}
+
+void I2C_Register_Statistics::recordTransfer(bool isRead, uint64_t byteCount,
+		uint64_t latencyUsec, uint64_t busTimeUsec, I2C_ERROR_CODE code)
+{
+	if (isRead)
+	{
+		m_readCount++;
+	}
+	else
+	{
+		m_writeCount++;
+	}
+	if (code != NO_ERROR)
+	{
+		m_errorCount++;
+		m_errorCodes[code]++;
+	}
+	else if (isRead)
+	{
+		m_bytesRead += byteCount;
+	}
+	else
+	{
+		m_bytesWritten += byteCount;
+	}
+	m_totalLatencyUsec += latencyUsec;
+	if (latencyUsec > m_maxLatencyUsec)
+	{
+		m_maxLatencyUsec = latencyUsec;
+	}
+	m_busTimeUsec += busTimeUsec;
+	m_latencyHistogram[getLatencyBucket(latencyUsec)]++;
+}
+
+void I2C_Register_Statistics::recordRetry()
+{
+	m_retryCount++;
+}
+
+void I2C_Register_Statistics::merge(const I2C_Register_Statistics &other)
+{
+	m_readCount += other.m_readCount;
+	m_writeCount += other.m_writeCount;
+	m_bytesRead += other.m_bytesRead;
+	m_bytesWritten += other.m_bytesWritten;
+	m_retryCount += other.m_retryCount;
+	m_errorCount += other.m_errorCount;
+	m_totalLatencyUsec += other.m_totalLatencyUsec;
+	if (other.m_maxLatencyUsec > m_maxLatencyUsec)
+	{
+		m_maxLatencyUsec = other.m_maxLatencyUsec;
+	}
+	m_busTimeUsec += other.m_busTimeUsec;
+	for (size_t bucket = 0; bucket < I2C_LATENCY_BUCKET_COUNT; bucket++)
+	{
+		m_latencyHistogram[bucket] += other.m_latencyHistogram[bucket];
+	}
+	for (map<I2C_ERROR_CODE, uint64_t>::const_iterator codeItr =
+			other.m_errorCodes.begin(); codeItr != other.m_errorCodes.end();
+			codeItr++)
+	{
+		m_errorCodes[codeItr->first] += codeItr->second;
+	}
+}
+
+uint64_t I2C_Register_Statistics::getOperationCount() const
+{
+	return m_readCount + m_writeCount;
+}
+
+uint64_t I2C_Register_Statistics::getAverageLatencyUsec() const
+{
+	uint64_t operations = getOperationCount();
+	return operations ? (m_totalLatencyUsec / operations) : 0;
+}
+
+size_t I2C_Register_Statistics::getLatencyBucket(uint64_t latencyUsec)
+{
+	size_t bucket = 0;
+	while ((latencyUsec > 0) && (bucket < (I2C_LATENCY_BUCKET_COUNT - 1)))
+	{
+		latencyUsec >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+uint64_t I2C_Register_Statistics::getLatencyBucketLimitUsec(size_t bucket)
+{
+	if (bucket >= (I2C_LATENCY_BUCKET_COUNT - 1))
+	{
+		return UINT64_MAX;
+	}
+	return (1ULL << bucket) - 1;
+}
+
+I2C_Chip_Statistics::I2C_Chip_Statistics() :
+		m_total(), m_registers()
+{
+}
+
+I2C_Chip_Statistics::~I2C_Chip_Statistics()
+{
+}
+
+I2C_Bus_Statistics::I2C_Bus_Statistics() :
+		m_busClockHz(I2C_DEFAULT_BUS_CLOCK_HZ), m_collectionStartTs(0), m_snapshotTs(
+				0), m_total(), m_chips()
+{
+}
+
+I2C_Bus_Statistics::~I2C_Bus_Statistics()
+{
+}
+
+void I2C_Bus_Statistics::recordTransfer(uint8_t chipAddress,
+		uint64_t registerAddress, bool isRead, uint64_t byteCount,
+		uint64_t latencyUsec, uint64_t busTimeUsec, I2C_ERROR_CODE code)
+{
+	I2C_Chip_Statistics &chip = m_chips[chipAddress];
+	chip.m_registers[registerAddress].recordTransfer(isRead, byteCount,
+			latencyUsec, busTimeUsec, code);
+	chip.m_total.recordTransfer(isRead, byteCount, latencyUsec, busTimeUsec,
+			code);
+	m_total.recordTransfer(isRead, byteCount, latencyUsec, busTimeUsec, code);
+}
+
+void I2C_Bus_Statistics::recordRetry(uint8_t chipAddress,
+		uint64_t registerAddress)
+{
+	I2C_Chip_Statistics &chip = m_chips[chipAddress];
+	chip.m_registers[registerAddress].recordRetry();
+	chip.m_total.recordRetry();
+	m_total.recordRetry();
+}
+
+void I2C_Bus_Statistics::reset(int64_t timeNow)
+{
+	m_collectionStartTs = timeNow;
+	m_snapshotTs = timeNow;
+	m_total = I2C_Register_Statistics();
+	m_chips.clear();
+}
+
+double I2C_Bus_Statistics::getBusOccupancy() const
+{
+	int64_t elapsed = m_snapshotTs - m_collectionStartTs;
+	if (elapsed <= 0)
+	{
+		return 0;
+	}
+	return (double) m_total.m_busTimeUsec / elapsed;
+}
+
+uint64_t I2C_Bus_Statistics::estimateTransferUsec(uint64_t busClockHz,
+		uint64_t writeBytes, uint64_t readBytes)
+{
+	if (!busClockHz)
+	{
+		return 0;
+	}
+	uint64_t bits = I2C_SEGMENT_OVERHEAD_BITS + (writeBytes * I2C_BITS_PER_BYTE)
+			+ I2C_STOP_BITS;
+	if (readBytes)
+	{
+		bits += I2C_SEGMENT_OVERHEAD_BITS + (readBytes * I2C_BITS_PER_BYTE);
+	}
+	return ((bits * 1000000) + busClockHz - 1) / busClockHz;
+}
+
+} /* namespace apra */
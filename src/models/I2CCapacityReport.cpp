@@ -0,0 +1,61 @@
+/*
+ * I2CCapacityReport.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include "models/I2CCapacityReport.h"
+
+namespace apra
+{
+
+I2C_Capacity_Entry::I2C_Capacity_Entry() :
+		m_handle(0), m_chipNumber(0), m_periodUsec(0), m_transfers(), m_delayUsec(
+				0), m_busTimeUsec(0), m_executionCount(0), m_measuredPeriodUsec(
+				0), m_measuredExecutionUsec(0)
+{
+}
+
+I2C_Capacity_Entry::~I2C_Capacity_Entry()
+{
+}
+
+double I2C_Capacity_Entry::getProjectedUtilisation() const
+{
+	if (!m_periodUsec)
+	{
+		return 0;
+	}
+	return (double) (m_busTimeUsec + m_delayUsec) / m_periodUsec;
+}
+
+double I2C_Capacity_Entry::getMeasuredUtilisation() const
+{
+	if (m_measuredPeriodUsec <= 0)
+	{
+		return 0;
+	}
+	return m_measuredExecutionUsec / m_measuredPeriodUsec;
+}
+
+I2C_Capacity_Report::I2C_Capacity_Report() :
+		m_busClockHz(0), m_budget(0), m_projectedUtilisation(0), m_measuredUtilisation(
+				0), m_measuredBusOccupancy(0), m_entries()
+{
+}
+
+I2C_Capacity_Report::~I2C_Capacity_Report()
+{
+}
+
+bool I2C_Capacity_Report::isOversubscribed() const
+{
+	return m_projectedUtilisation > m_budget;
+}
+
+} /* namespace apra */
@@ -18,7 +18,7 @@ namespace apra
 I2C_Message::I2C_Message() :
 		m_error(), m_type(I2C_READ), m_registerNumber(), m_data(), m_compareData(), m_retryCount(
 				0), m_delayInUsec(0), m_retryDelayInUsec(
-		I2C_RETRY_FAILURE_DELAY), m_allowOtherProcessOnIdle(false), m_registerSize(
+		I2C_RETRY_FAILURE_DELAY), m_allowOtherProcessOnIdle(false), m_allowCoalescing(true), m_registerSize(
 				0), m_dataSize(0)
 {
 }
@@ -110,7 +110,7 @@ uint64_t I2C_Message::getCombinedRegister()
 	return Utils::combineBytes(m_registerNumber);
 }
 
-uint64_t I2C_Message::getDataSize()
+uint64_t I2C_Message::getDataSize() const
 {
 	return m_dataSize;
 }
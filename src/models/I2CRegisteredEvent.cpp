@@ -0,0 +1,175 @@
+/*
+ * I2CRegisteredEvent.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <algorithm>
+#include "models/I2CRegisteredEvent.h"
+#include "utils/I2CEventScheduler.h"
+#include "utils/I2CSampleRing.h"
+#include "utils/Utils.h"
+
+namespace apra
+{
+
+I2C_Registered_Event::I2C_Registered_Event(
+		const I2C_Transaction_Message &message) :
+		m_message(message), m_isScheduled(false), m_isExecuting(false), m_lastExecutionTs(
+				0), m_executionCount(0), m_firstExecutionTs(
+				0), m_lastStartTs(0), m_executionUsec(0), m_sampleRing(), m_preparedTransfers(), m_triggerFd(
+				-1), m_triggerEvents(0), m_currentPeriodUsec(
+				0), m_lastValues(), m_publishedData(), m_filteredCount(0), m_suppressedCount(
+				0)
+{
+	initPeriod();
+}
+
+I2C_Registered_Event::I2C_Registered_Event(
+		const I2C_Transaction_Message &message,
+		std::shared_ptr<I2C_Sample_Ring> sampleRing) :
+		m_message(message), m_isScheduled(false), m_isExecuting(false), m_lastExecutionTs(
+				0), m_executionCount(0), m_firstExecutionTs(
+				0), m_lastStartTs(0), m_executionUsec(0), m_sampleRing(sampleRing), m_preparedTransfers(), m_triggerFd(
+				-1), m_triggerEvents(0), m_currentPeriodUsec(
+				0), m_lastValues(), m_publishedData(), m_filteredCount(0), m_suppressedCount(
+				0)
+{
+	initPeriod();
+}
+
+I2C_Registered_Event::~I2C_Registered_Event()
+{
+}
+
+void I2C_Registered_Event::initPeriod()
+{
+	if (!m_message.isAdaptive())
+	{
+		return;
+	}
+	m_currentPeriodUsec = std::min(
+			std::max(m_message.m_periodUsec, m_message.m_minPeriodUsec),
+			m_message.m_maxPeriodUsec);
+}
+
+bool I2C_Registered_Event::adaptPeriod()
+{
+	if (!m_message.isAdaptive() || m_message.getError().isError())
+	{
+		return false;
+	}
+	vector<uint64_t> values;
+	for (size_t index = 0; index < m_message.m_messages.size(); index++)
+	{
+		I2C_Message &message = m_message.m_messages[index];
+		if (message.m_type != I2C_WRITE)
+		{
+			values.push_back(message.getCombinedData());
+		}
+	}
+	if (values.size() != m_lastValues.size())
+	{
+		// Nothing to compare the first result against yet
+		m_lastValues = values;
+		return false;
+	}
+	bool isChanging = false;
+	for (size_t index = 0; index < values.size(); index++)
+	{
+		uint64_t change =
+				(values[index] > m_lastValues[index]) ?
+						values[index] - m_lastValues[index] :
+						m_lastValues[index] - values[index];
+		isChanging |= (change > m_message.m_changeThreshold);
+	}
+	m_lastValues = values;
+	uint64_t periodUsec = m_currentPeriodUsec.load(std::memory_order_relaxed);
+	uint64_t adaptedUsec = I2C_Event_Scheduler::getAdaptivePeriod(periodUsec,
+			isChanging, m_message.m_minPeriodUsec, m_message.m_maxPeriodUsec);
+	m_currentPeriodUsec.store(adaptedUsec, std::memory_order_relaxed);
+	return adaptedUsec != periodUsec;
+}
+
+bool I2C_Registered_Event::shouldPublish()
+{
+	bool isDue = true;
+	switch (m_message.m_publishFilter)
+	{
+	case I2C_PUBLISH_ON_CHANGE:
+	case I2C_PUBLISH_DEADBAND:
+		isDue = hasDataChanged();
+		break;
+	case I2C_PUBLISH_EVERY_NTH:
+		isDue = !m_message.m_publishParameter
+				|| !(m_filteredCount % m_message.m_publishParameter);
+		break;
+	default:
+		break;
+	}
+	m_filteredCount++;
+	if (!isDue)
+	{
+		m_suppressedCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	return isDue;
+}
+
+bool I2C_Registered_Event::hasDataChanged()
+{
+	if (m_message.getError().isError())
+	{
+		// Failures always go out; the next good read is published again
+		m_publishedData.clear();
+		return true;
+	}
+	size_t readCount = 0;
+	bool isChanged = false;
+	for (size_t index = 0; index < m_message.m_messages.size(); index++)
+	{
+		I2C_Message &message = m_message.m_messages[index];
+		if (message.m_type == I2C_WRITE)
+		{
+			continue;
+		}
+		if (readCount >= m_publishedData.size())
+		{
+			isChanged = true;
+			break;
+		}
+		const vector<uint8_t> &published = m_publishedData[readCount++];
+		if (m_message.m_publishFilter == I2C_PUBLISH_DEADBAND)
+		{
+			// Measured from the last published value, not the last read
+			uint64_t value = message.getCombinedData();
+			uint64_t reference = Utils::combineBytes(published);
+			uint64_t change =
+					(value > reference) ? value - reference : reference - value;
+			isChanged |= (change > m_message.m_publishParameter);
+		}
+		else
+		{
+			isChanged |= (message.m_data != published);
+		}
+	}
+	if (!isChanged)
+	{
+		return false;
+	}
+	m_publishedData.clear();
+	for (size_t index = 0; index < m_message.m_messages.size(); index++)
+	{
+		if (m_message.m_messages[index].m_type != I2C_WRITE)
+		{
+			m_publishedData.push_back(m_message.m_messages[index].m_data);
+		}
+	}
+	return true;
+}
+
+} /* namespace apra */
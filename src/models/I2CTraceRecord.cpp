@@ -0,0 +1,144 @@
+/*
+ * I2CTraceRecord.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include "models/I2CTraceRecord.h"
+
+#define I2C_TRACE_TYPE_MASK 0x03
+#define I2C_TRACE_EVENT_FLAG 0x04
+
+namespace apra
+{
+
+I2C_Trace_Record::I2C_Trace_Record() :
+		m_timestampUsec(0), m_transactionId(0), m_chipNumber(0), m_type(
+				I2C_WRITE), m_isEvent(false), m_errorCode(NO_ERROR), m_latencyUsec(
+				0), m_registerNumber(), m_data(), m_compareData()
+{
+}
+
+I2C_Trace_Record::~I2C_Trace_Record()
+{
+}
+
+void I2C_Trace_Record::encode(vector<uint8_t> &buffer,
+		int64_t previousTimestampUsec) const
+{
+	int64_t delta = m_timestampUsec - previousTimestampUsec;
+	putVarint(buffer, ((uint64_t) delta << 1) ^ (uint64_t) (delta >> 63));
+	putVarint(buffer, m_transactionId);
+	putVarint(buffer, m_chipNumber);
+	buffer.push_back(
+			(m_type & I2C_TRACE_TYPE_MASK)
+					| (m_isEvent ? I2C_TRACE_EVENT_FLAG : 0));
+	putVarint(buffer, m_errorCode);
+	putVarint(buffer, m_latencyUsec);
+	putVarint(buffer, m_registerNumber.size());
+	buffer.insert(buffer.end(), m_registerNumber.begin(),
+			m_registerNumber.end());
+	putVarint(buffer, m_data.size());
+	buffer.insert(buffer.end(), m_data.begin(), m_data.end());
+	if (isCompare())
+	{
+		putVarint(buffer, m_compareData.size());
+		buffer.insert(buffer.end(), m_compareData.begin(),
+				m_compareData.end());
+	}
+}
+
+bool I2C_Trace_Record::decode(const vector<uint8_t> &buffer, size_t &offset,
+		int64_t previousTimestampUsec)
+{
+	uint64_t delta = 0;
+	uint64_t chipNumber = 0;
+	uint64_t errorCode = 0;
+	uint64_t registerSize = 0;
+	uint64_t dataSize = 0;
+	if (!getVarint(buffer, offset, delta)
+			|| !getVarint(buffer, offset, m_transactionId)
+			|| !getVarint(buffer, offset, chipNumber)
+			|| (offset >= buffer.size()))
+	{
+		return false;
+	}
+	uint8_t flags = buffer[offset++];
+	if (!getVarint(buffer, offset, errorCode)
+			|| !getVarint(buffer, offset, m_latencyUsec)
+			|| !getVarint(buffer, offset, registerSize)
+			|| (registerSize > buffer.size() - offset))
+	{
+		return false;
+	}
+	m_registerNumber.assign(buffer.begin() + offset,
+			buffer.begin() + offset + registerSize);
+	offset += registerSize;
+	if (!getVarint(buffer, offset, dataSize)
+			|| (dataSize > buffer.size() - offset))
+	{
+		return false;
+	}
+	m_data.assign(buffer.begin() + offset, buffer.begin() + offset + dataSize);
+	offset += dataSize;
+	m_type = (I2C_MESSAGE_TYPE) (flags & I2C_TRACE_TYPE_MASK);
+	m_compareData.clear();
+	if (isCompare())
+	{
+		uint64_t compareSize = 0;
+		if (!getVarint(buffer, offset, compareSize)
+				|| (compareSize > buffer.size() - offset))
+		{
+			return false;
+		}
+		m_compareData.assign(buffer.begin() + offset,
+				buffer.begin() + offset + compareSize);
+		offset += compareSize;
+	}
+	m_timestampUsec = previousTimestampUsec
+			+ (int64_t) ((delta >> 1) ^ (~(delta & 1) + 1));
+	m_chipNumber = chipNumber;
+	m_isEvent = (flags & I2C_TRACE_EVENT_FLAG) != 0;
+	m_errorCode = (I2C_ERROR_CODE) errorCode;
+	return true;
+}
+
+bool I2C_Trace_Record::isCompare() const
+{
+	return (m_type == I2C_READ_COMPARE_EQUAL)
+			|| (m_type == I2C_READ_COMPARE_NOT_EQUAL);
+}
+
+void I2C_Trace_Record::putVarint(vector<uint8_t> &buffer, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		buffer.push_back((value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+	buffer.push_back(value);
+}
+
+bool I2C_Trace_Record::getVarint(const vector<uint8_t> &buffer, size_t &offset,
+		uint64_t &value)
+{
+	value = 0;
+	for (uint32_t shift = 0; (shift < 64) && (offset < buffer.size()); shift +=
+			7)
+	{
+		uint8_t byte = buffer[offset++];
+		value |= (uint64_t) (byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+} /* namespace apra */
@@ -11,6 +11,7 @@
 
 #include <models/I2CTransactionMessage.h>
 #include "utils/Macro.h"
+#include <algorithm>
 #include <iostream>
 #include <inttypes.h>
 #include <stdio.h>
@@ -20,8 +21,12 @@ namespace apra
 
 I2C_Transaction_Message::I2C_Transaction_Message() :
 		Message(), m_error(), m_chipNumber(0), m_stopOnAnyTransactionFailure(
-				true), m_transactionDelayUsec(0), m_messages(), m_callbackContext(
-		NULL), m_callback(NULL)
+				true), m_transactionDelayUsec(0), m_messages(), m_periodUsec(0), m_phaseUsec(
+				0), m_isPhasePinned(false), m_priority(I2C_PRIORITY_NORMAL), m_deadlineUsec(0), m_deadlineTs(
+				0), m_dropIfStale(false), m_triggerTs(0), m_minPeriodUsec(0), m_maxPeriodUsec(
+				0), m_changeThreshold(0), m_publishFilter(
+				I2C_PUBLISH_ALWAYS), m_publishParameter(0), m_program(), m_completionQueue(), m_callbackContext(NULL), m_callback(
+		NULL), m_constCallback(NULL)
 {
 	setType(REQUEST_RESPONSE);
 }
@@ -29,7 +34,12 @@ I2C_Transaction_Message::I2C_Transaction_Message(uint16_t chipNumber,
 		vector<I2C_Message> messageQueue, uint64_t transactionDelayUsec) :
 		Message(), m_error(), m_chipNumber(chipNumber), m_stopOnAnyTransactionFailure(
 				true), m_transactionDelayUsec(transactionDelayUsec), m_messages(
-				messageQueue), m_callbackContext(NULL), m_callback(NULL)
+				messageQueue), m_periodUsec(0), m_phaseUsec(0), m_isPhasePinned(false), m_priority(
+				I2C_PRIORITY_NORMAL), m_deadlineUsec(0), m_deadlineTs(0), m_dropIfStale(
+				false), m_triggerTs(0), m_minPeriodUsec(0), m_maxPeriodUsec(
+				0), m_changeThreshold(0), m_publishFilter(
+				I2C_PUBLISH_ALWAYS), m_publishParameter(0), m_program(), m_completionQueue(), m_callbackContext(
+				NULL), m_callback(NULL), m_constCallback(NULL)
 {
 	setType(REQUEST_RESPONSE);
 }
@@ -46,8 +56,24 @@ I2C_Transaction_Message& I2C_Transaction_Message::operator=(
 	m_stopOnAnyTransactionFailure = other.m_stopOnAnyTransactionFailure;
 	m_transactionDelayUsec = other.m_transactionDelayUsec;
 	m_messages = other.m_messages;
+	m_periodUsec = other.m_periodUsec;
+	m_phaseUsec = other.m_phaseUsec;
+	m_isPhasePinned = other.m_isPhasePinned;
+	m_priority = other.m_priority;
+	m_deadlineUsec = other.m_deadlineUsec;
+	m_deadlineTs = other.m_deadlineTs;
+	m_dropIfStale = other.m_dropIfStale;
+	m_triggerTs = other.m_triggerTs;
+	m_minPeriodUsec = other.m_minPeriodUsec;
+	m_maxPeriodUsec = other.m_maxPeriodUsec;
+	m_changeThreshold = other.m_changeThreshold;
+	m_publishFilter = other.m_publishFilter;
+	m_publishParameter = other.m_publishParameter;
+	m_program = other.m_program;
+	m_completionQueue = other.m_completionQueue;
 	m_callbackContext = other.m_callbackContext;
 	m_callback = other.m_callback;
+	m_constCallback = other.m_constCallback;
 	m_handle = other.m_handle;
 	m_type = other.m_type;
 	return *this;
@@ -74,8 +100,89 @@ void I2C_Transaction_Message::registerEventHandle(void *callback, void *context)
 	m_callbackContext = context;
 }
 
-void I2C_Transaction_Message::publishTransaction()
+void I2C_Transaction_Message::setPeriod(uint64_t periodUsec,
+		uint64_t phaseUsec)
 {
+	m_periodUsec = periodUsec;
+	m_phaseUsec = phaseUsec;
+	m_isPhasePinned = (phaseUsec != 0);
+}
+
+void I2C_Transaction_Message::pinPhase(uint64_t phaseUsec)
+{
+	m_phaseUsec = phaseUsec;
+	m_isPhasePinned = true;
+}
+
+void I2C_Transaction_Message::setPriority(I2C_PRIORITY priority)
+{
+	m_priority = priority;
+}
+
+void I2C_Transaction_Message::setDeadline(uint64_t deadlineUsec,
+		bool dropIfStale)
+{
+	m_deadlineUsec = deadlineUsec;
+	m_dropIfStale = dropIfStale;
+	m_deadlineTs = 0;
+	if (deadlineUsec)
+	{
+		MONOTIMEUS(m_deadlineTs);
+		m_deadlineTs += deadlineUsec;
+	}
+}
+
+void I2C_Transaction_Message::setAdaptivePeriod(uint64_t minPeriodUsec,
+		uint64_t maxPeriodUsec, uint64_t changeThreshold)
+{
+	m_minPeriodUsec = std::min(minPeriodUsec, maxPeriodUsec);
+	m_maxPeriodUsec = maxPeriodUsec;
+	m_changeThreshold = changeThreshold;
+}
+
+bool I2C_Transaction_Message::isAdaptive() const
+{
+	return m_maxPeriodUsec != 0;
+}
+
+void I2C_Transaction_Message::setPublishFilter(I2C_PUBLISH_FILTER filter,
+		uint64_t parameter)
+{
+	m_publishFilter = filter;
+	m_publishParameter = parameter;
+}
+
+void I2C_Transaction_Message::setProgram(
+		shared_ptr<const I2C_Transaction_Program> program)
+{
+	m_program = program;
+	m_messages.clear();
+}
+
+void I2C_Transaction_Message::setCompletionQueue(
+		shared_ptr<I2C_Completion_Queue> completionQueue)
+{
+	m_completionQueue = completionQueue;
+}
+
+void I2C_Transaction_Message::registerConstEventHandle(void *callback,
+		void *context)
+{
+	m_constCallback = (I2CEventConstCallback *) (callback);
+	m_callbackContext = context;
+}
+
+bool I2C_Transaction_Message::hasEventHandle() const
+{
+	return m_callback || m_constCallback;
+}
+
+void I2C_Transaction_Message::publishTransaction() const
+{
+	if (m_constCallback)
+	{
+		(*m_constCallback)(m_callbackContext, *this);
+	}
 	if (m_callback)
 	{
 		(*m_callback)(m_callbackContext, *this);
@@ -0,0 +1,214 @@
+/*
+ * I2CTransactionProgram.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include "models/I2CTransactionProgram.h"
+
+namespace apra
+{
+
+I2C_Program_Instruction::I2C_Program_Instruction() :
+		m_opcode(I2C_OP_END), m_variable(I2C_PROGRAM_NO_VARIABLE), m_value(0), m_registerNumber(), m_data()
+{
+}
+
+I2C_Program_Instruction::I2C_Program_Instruction(I2C_PROGRAM_OPCODE opcode,
+		uint8_t variable, uint64_t value) :
+		m_opcode(opcode), m_variable(variable), m_value(value), m_registerNumber(), m_data()
+{
+}
+
+I2C_Program_Instruction::~I2C_Program_Instruction()
+{
+}
+
+I2C_Transaction_Program::I2C_Transaction_Program() :
+		m_instructions(), m_retryCount(0)
+{
+}
+
+I2C_Transaction_Program::~I2C_Transaction_Program()
+{
+}
+
+size_t I2C_Transaction_Program::read(vector<uint8_t> registerNumber,
+		uint64_t size, uint8_t variable)
+{
+	I2C_Program_Instruction instruction(I2C_OP_READ, variable, size);
+	instruction.m_registerNumber = registerNumber;
+	return append(instruction);
+}
+
+size_t I2C_Transaction_Program::readVariable(vector<uint8_t> registerNumber,
+		uint8_t sizeVariable, uint64_t maxSize)
+{
+	I2C_Program_Instruction instruction(I2C_OP_READ_VARIABLE, sizeVariable,
+			maxSize);
+	instruction.m_registerNumber = registerNumber;
+	return append(instruction);
+}
+
+size_t I2C_Transaction_Program::write(vector<uint8_t> registerNumber,
+		vector<uint8_t> data)
+{
+	I2C_Program_Instruction instruction(I2C_OP_WRITE, I2C_PROGRAM_NO_VARIABLE,
+			0);
+	instruction.m_registerNumber = registerNumber;
+	instruction.m_data = data;
+	return append(instruction);
+}
+
+size_t I2C_Transaction_Program::load(uint8_t variable, uint64_t value)
+{
+	return append(I2C_Program_Instruction(I2C_OP_LOAD, variable, value));
+}
+
+size_t I2C_Transaction_Program::andValue(uint8_t variable, uint64_t mask)
+{
+	return append(I2C_Program_Instruction(I2C_OP_AND, variable, mask));
+}
+
+size_t I2C_Transaction_Program::shiftRight(uint8_t variable, uint64_t bits)
+{
+	return append(I2C_Program_Instruction(I2C_OP_SHIFT_RIGHT, variable, bits));
+}
+
+size_t I2C_Transaction_Program::multiply(uint8_t variable, uint64_t factor)
+{
+	return append(I2C_Program_Instruction(I2C_OP_MULTIPLY, variable, factor));
+}
+
+size_t I2C_Transaction_Program::add(uint8_t variable, int64_t value)
+{
+	return append(
+			I2C_Program_Instruction(I2C_OP_ADD, variable, (uint64_t) value));
+}
+
+size_t I2C_Transaction_Program::jump(size_t target)
+{
+	return append(
+			I2C_Program_Instruction(I2C_OP_JUMP, I2C_PROGRAM_NO_VARIABLE,
+					target));
+}
+
+size_t I2C_Transaction_Program::jumpIfZero(uint8_t variable, size_t target)
+{
+	return append(I2C_Program_Instruction(I2C_OP_JUMP_IF_ZERO, variable, target));
+}
+
+size_t I2C_Transaction_Program::jumpIfNotZero(uint8_t variable, size_t target)
+{
+	return append(
+			I2C_Program_Instruction(I2C_OP_JUMP_IF_NOT_ZERO, variable, target));
+}
+
+size_t I2C_Transaction_Program::delay(uint64_t delayUsec)
+{
+	return append(
+			I2C_Program_Instruction(I2C_OP_DELAY, I2C_PROGRAM_NO_VARIABLE,
+					delayUsec));
+}
+
+size_t I2C_Transaction_Program::end()
+{
+	return append(
+			I2C_Program_Instruction(I2C_OP_END, I2C_PROGRAM_NO_VARIABLE, 0));
+}
+
+size_t I2C_Transaction_Program::label() const
+{
+	return m_instructions.size();
+}
+
+void I2C_Transaction_Program::setTarget(size_t instruction, size_t target)
+{
+	if (instruction < m_instructions.size())
+	{
+		m_instructions[instruction].m_value = target;
+	}
+}
+
+void I2C_Transaction_Program::setRetries(uint64_t retryCount)
+{
+	m_retryCount = retryCount;
+}
+
+bool I2C_Transaction_Program::isValid() const
+{
+	for (size_t index = 0; index < m_instructions.size(); index++)
+	{
+		const I2C_Program_Instruction &instruction = m_instructions[index];
+		bool usesVariable = true;
+		switch (instruction.m_opcode)
+		{
+		case I2C_OP_READ:
+		{
+			usesVariable = (instruction.m_variable != I2C_PROGRAM_NO_VARIABLE);
+			if (!instruction.m_value
+					|| (instruction.m_value > I2C_PROGRAM_MAX_READ_SIZE))
+			{
+				return false;
+			}
+			// A variable holds the whole value, so it must fit in one
+			if (usesVariable && (instruction.m_value > sizeof(uint64_t)))
+			{
+				return false;
+			}
+			break;
+		}
+		case I2C_OP_READ_VARIABLE:
+		{
+			if (instruction.m_value > I2C_PROGRAM_MAX_READ_SIZE)
+			{
+				return false;
+			}
+			break;
+		}
+		case I2C_OP_JUMP:
+		case I2C_OP_JUMP_IF_ZERO:
+		case I2C_OP_JUMP_IF_NOT_ZERO:
+		{
+			usesVariable = (instruction.m_opcode != I2C_OP_JUMP);
+			// Jumping to the end is how a program finishes early
+			if (instruction.m_value > m_instructions.size())
+			{
+				return false;
+			}
+			break;
+		}
+		case I2C_OP_WRITE:
+		case I2C_OP_DELAY:
+		case I2C_OP_END:
+		{
+			usesVariable = false;
+			break;
+		}
+		default:
+		{
+			break;
+		}
+		}
+		if (usesVariable
+				&& (instruction.m_variable >= I2C_PROGRAM_VARIABLE_COUNT))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t I2C_Transaction_Program::append(
+		const I2C_Program_Instruction &instruction)
+{
+	m_instructions.push_back(instruction);
+	return m_instructions.size() - 1;
+}
+
+} /* namespace apra */
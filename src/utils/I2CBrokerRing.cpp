@@ -0,0 +1,462 @@
+/*
+ * I2CBrokerRing.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <new>
+#include "utils/I2CBrokerRing.h"
+#include "utils/Macro.h"
+
+namespace apra
+{
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+		"slot state must be usable as a futex word");
+
+namespace
+{
+// Slots start on a cache line of their own
+const size_t I2C_BROKER_HEADER_SIZE = ((sizeof(I2C_Broker_Header) + 63) / 64)
+		* 64;
+
+bool isEarlierSequence(I2C_Broker_Slot *slots, uint32_t first, uint32_t second)
+{
+	return slots[first].m_sequence < slots[second].m_sequence;
+}
+}
+
+I2C_Broker_Ring::I2C_Broker_Ring() :
+		m_region(NULL), m_header(NULL), m_slots(NULL)
+{
+}
+
+I2C_Broker_Ring::~I2C_Broker_Ring()
+{
+	detach();
+}
+
+I2CError I2C_Broker_Ring::create(int regionFd)
+{
+	if (ftruncate(regionFd, getRegionSize()) < 0)
+	{
+		return I2CError("Unable to size the I2C broker region", BROKER_ERROR);
+	}
+	I2CError response = mapRegion(regionFd);
+	if (response.isError())
+	{
+		return response;
+	}
+	m_header = new (m_region) I2C_Broker_Header();
+	m_header->m_magic = I2C_BROKER_MAGIC;
+	m_header->m_version = I2C_BROKER_VERSION;
+	m_header->m_slotCount = I2C_BROKER_SLOT_COUNT;
+	m_header->m_slotSize = sizeof(I2C_Broker_Slot);
+	m_header->m_sequence = 0;
+	for (uint32_t slot = 0; slot < I2C_BROKER_SLOT_COUNT; slot++)
+	{
+		new (&m_slots[slot]) I2C_Broker_Slot();
+		m_slots[slot].m_state = I2C_SLOT_FREE;
+	}
+	return response;
+}
+
+I2CError I2C_Broker_Ring::attach(int regionFd)
+{
+	I2CError response = mapRegion(regionFd);
+	if (response.isError())
+	{
+		return response;
+	}
+	if ((m_header->m_magic != I2C_BROKER_MAGIC)
+			|| (m_header->m_version != I2C_BROKER_VERSION)
+			|| (m_header->m_slotCount != I2C_BROKER_SLOT_COUNT)
+			|| (m_header->m_slotSize != sizeof(I2C_Broker_Slot)))
+	{
+		detach();
+		return I2CError("I2C broker region layout does not match",
+				BROKER_ERROR);
+	}
+	return response;
+}
+
+void I2C_Broker_Ring::detach()
+{
+	if (m_region)
+	{
+		munmap(m_region, getRegionSize());
+	}
+	m_region = NULL;
+	m_header = NULL;
+	m_slots = NULL;
+}
+
+bool I2C_Broker_Ring::isAttached()
+{
+	return m_region != NULL;
+}
+
+I2C_Broker_Slot& I2C_Broker_Ring::getSlot(uint32_t slot)
+{
+	return m_slots[slot];
+}
+
+int32_t I2C_Broker_Ring::claim(uint32_t clientId)
+{
+	for (uint32_t slot = 0; slot < I2C_BROKER_SLOT_COUNT; slot++)
+	{
+		uint32_t expected = I2C_SLOT_FREE;
+		if (m_slots[slot].m_state.compare_exchange_strong(expected,
+				I2C_SLOT_CLAIMED, std::memory_order_acquire))
+		{
+			m_slots[slot].m_clientId = clientId;
+			return slot;
+		}
+	}
+	return -1;
+}
+
+bool I2C_Broker_Ring::encode(uint32_t slot,
+		const I2C_Transaction_Message &message)
+{
+	// Programs are not flattened into slots
+	if ((message.m_messages.size() > I2C_BROKER_MAX_MESSAGES)
+			|| message.m_program)
+	{
+		return false;
+	}
+	I2C_Broker_Slot &brokerSlot = m_slots[slot];
+	for (size_t index = 0; index < message.m_messages.size(); index++)
+	{
+		if (!encodeMessage(message.m_messages[index],
+				brokerSlot.m_messages[index]))
+		{
+			return false;
+		}
+	}
+	brokerSlot.m_chipNumber = message.m_chipNumber;
+	brokerSlot.m_priority = message.m_priority;
+	brokerSlot.m_stopOnAnyFailure = message.m_stopOnAnyTransactionFailure;
+	brokerSlot.m_dropIfStale = message.m_dropIfStale;
+	brokerSlot.m_messageCount = message.m_messages.size();
+	brokerSlot.m_errorCode = NO_ERROR;
+	brokerSlot.m_transactionDelayUsec = message.m_transactionDelayUsec;
+	brokerSlot.m_deadlineTs = message.m_deadlineTs;
+	return true;
+}
+
+void I2C_Broker_Ring::submit(uint32_t slot)
+{
+	m_slots[slot].m_sequence = m_header->m_sequence.fetch_add(1);
+	m_slots[slot].m_state.store(I2C_SLOT_SUBMITTED, std::memory_order_release);
+}
+
+bool I2C_Broker_Ring::wait(uint32_t slot, uint64_t timeoutUsec)
+{
+	std::atomic<uint32_t> &state = m_slots[slot].m_state;
+	MONOCURRTIME(startTs);
+	uint32_t current = state.load(std::memory_order_acquire);
+	while (current != I2C_SLOT_COMPLETE)
+	{
+		MONOCURRTIME(timeNow);
+		int64_t remainingUsec = (int64_t) timeoutUsec - (timeNow - startTs);
+		if (remainingUsec <= 0)
+		{
+			return false;
+		}
+		struct timespec timeout;
+		timeout.tv_sec = remainingUsec / 1000000;
+		timeout.tv_nsec = (remainingUsec % 1000000) * 1000;
+		// Not FUTEX_PRIVATE: the word is shared with the broker process
+		syscall(SYS_futex, (uint32_t*) &state, FUTEX_WAIT, current, &timeout,
+				NULL, 0);
+		current = state.load(std::memory_order_acquire);
+	}
+	return true;
+}
+
+void I2C_Broker_Ring::decode(uint32_t slot, I2C_Transaction_Message &message)
+{
+	const I2C_Broker_Slot &brokerSlot = m_slots[slot];
+	size_t messageCount = std::min<size_t>(message.m_messages.size(),
+			brokerSlot.m_messageCount);
+	for (size_t index = 0; index < messageCount; index++)
+	{
+		I2C_Message &i2cMessage = message.m_messages[index];
+		const I2C_Broker_Message &slotMessage = brokerSlot.m_messages[index];
+		if (i2cMessage.m_type != I2C_WRITE)
+		{
+			i2cMessage.m_data.assign(slotMessage.m_data,
+					slotMessage.m_data
+							+ std::min<size_t>(slotMessage.m_dataSize,
+									I2C_BROKER_MAX_DATA_SIZE));
+		}
+		i2cMessage.m_error =
+				slotMessage.m_errorCode ?
+						I2CError("I2C message failed in the broker",
+								(I2C_ERROR_CODE) slotMessage.m_errorCode) :
+						I2CError();
+	}
+	message.setError(
+			brokerSlot.m_errorCode ?
+					I2CError("I2C transaction failed in the broker",
+							(I2C_ERROR_CODE) brokerSlot.m_errorCode) :
+					I2CError());
+}
+
+void I2C_Broker_Ring::release(uint32_t slot)
+{
+	m_slots[slot].m_state.store(I2C_SLOT_FREE, std::memory_order_release);
+}
+
+void I2C_Broker_Ring::abandon(uint32_t slot)
+{
+	std::atomic<uint32_t> &state = m_slots[slot].m_state;
+	uint32_t current = state.load(std::memory_order_acquire);
+	while (current != I2C_SLOT_ABANDONED)
+	{
+		// Queued work still belongs to the broker; it frees the slot when done
+		uint32_t next = (current == I2C_SLOT_QUEUED) ?
+				I2C_SLOT_ABANDONED : I2C_SLOT_FREE;
+		if (state.compare_exchange_weak(current, next,
+				std::memory_order_acq_rel))
+		{
+			break;
+		}
+	}
+}
+
+size_t I2C_Broker_Ring::collectSubmitted(vector<uint32_t> &slots)
+{
+	slots.clear();
+	for (uint32_t slot = 0; slot < I2C_BROKER_SLOT_COUNT; slot++)
+	{
+		uint32_t expected = I2C_SLOT_SUBMITTED;
+		if (m_slots[slot].m_state.compare_exchange_strong(expected,
+				I2C_SLOT_QUEUED, std::memory_order_acquire))
+		{
+			slots.push_back(slot);
+		}
+	}
+	// Clients are served in the order they submitted
+	for (size_t index = 1; index < slots.size(); index++)
+	{
+		uint32_t slot = slots[index];
+		size_t position = index;
+		while ((position > 0)
+				&& isEarlierSequence(m_slots, slot, slots[position - 1]))
+		{
+			slots[position] = slots[position - 1];
+			position--;
+		}
+		slots[position] = slot;
+	}
+	return slots.size();
+}
+
+bool I2C_Broker_Ring::toMessage(uint32_t slot, I2C_Transaction_Message &message)
+{
+	const I2C_Broker_Slot &brokerSlot = m_slots[slot];
+	message.m_chipNumber = brokerSlot.m_chipNumber;
+	message.m_priority = (I2C_PRIORITY) brokerSlot.m_priority;
+	message.m_stopOnAnyTransactionFailure = brokerSlot.m_stopOnAnyFailure;
+	message.m_dropIfStale = brokerSlot.m_dropIfStale;
+	message.m_transactionDelayUsec = brokerSlot.m_transactionDelayUsec;
+	message.m_deadlineTs = brokerSlot.m_deadlineTs;
+	message.m_messages.clear();
+	// The client may still be writing the slot; validate a private copy
+	size_t messageCount = brokerSlot.m_messageCount;
+	bool isValid = (messageCount <= I2C_BROKER_MAX_MESSAGES);
+	message.m_messages.resize(isValid ? messageCount : 0);
+	for (size_t index = 0; isValid && (index < messageCount); index++)
+	{
+		I2C_Broker_Message slotMessage = brokerSlot.m_messages[index];
+		if (!isValidMessage(slotMessage))
+		{
+			isValid = false;
+			continue;
+		}
+		I2C_Message &i2cMessage = message.m_messages[index];
+		vector<uint8_t> registerNumber(slotMessage.m_registerNumber,
+				slotMessage.m_registerNumber + slotMessage.m_registerSize);
+		switch (slotMessage.m_type)
+		{
+		case I2C_WRITE:
+		{
+			i2cMessage.configureWrite(registerNumber,
+					vector<uint8_t>(slotMessage.m_data,
+							slotMessage.m_data + slotMessage.m_dataSize));
+			break;
+		}
+		case I2C_READ_COMPARE_EQUAL:
+		case I2C_READ_COMPARE_NOT_EQUAL:
+		{
+			i2cMessage.configureReadWithComparison(registerNumber,
+					slotMessage.m_dataSize,
+					vector<uint8_t>(slotMessage.m_compareData,
+							slotMessage.m_compareData
+									+ slotMessage.m_compareSize),
+					slotMessage.m_type == I2C_READ_COMPARE_EQUAL);
+			break;
+		}
+		default:
+		{
+			i2cMessage.configureRead(registerNumber, slotMessage.m_dataSize);
+			i2cMessage.m_data.clear();
+			break;
+		}
+		}
+		i2cMessage.m_error = I2CError();
+		i2cMessage.m_retryCount = slotMessage.m_retryCount;
+		i2cMessage.m_delayInUsec = slotMessage.m_delayUsec;
+		i2cMessage.m_retryDelayInUsec = slotMessage.m_retryDelayUsec;
+		i2cMessage.m_allowOtherProcessOnIdle =
+				slotMessage.m_allowOtherProcessOnIdle;
+		i2cMessage.m_allowCoalescing = slotMessage.m_allowCoalescing;
+	}
+	if (!isValid)
+	{
+		message.m_messages.clear();
+		message.setError(
+				I2CError("Malformed I2C broker slot", BROKER_ERROR));
+		return false;
+	}
+	message.setError(I2CError());
+	return true;
+}
+
+void I2C_Broker_Ring::complete(uint32_t slot, I2C_Transaction_Message &message)
+{
+	I2C_Broker_Slot &brokerSlot = m_slots[slot];
+	size_t messageCount = std::min<size_t>(message.m_messages.size(),
+			brokerSlot.m_messageCount);
+	for (size_t index = 0; index < messageCount; index++)
+	{
+		I2C_Message &i2cMessage = message.m_messages[index];
+		I2C_Broker_Message &slotMessage = brokerSlot.m_messages[index];
+		if (i2cMessage.m_type != I2C_WRITE)
+		{
+			slotMessage.m_dataSize = std::min<size_t>(i2cMessage.m_data.size(),
+					I2C_BROKER_MAX_DATA_SIZE);
+			std::copy(i2cMessage.m_data.begin(),
+					i2cMessage.m_data.begin() + slotMessage.m_dataSize,
+					slotMessage.m_data);
+		}
+		slotMessage.m_errorCode = I2CError(i2cMessage.m_error).getCode();
+	}
+	// Only the messages that ran carry results back
+	brokerSlot.m_messageCount = messageCount;
+	brokerSlot.m_errorCode = message.getError().getCode();
+	uint32_t expected = I2C_SLOT_QUEUED;
+	if (!brokerSlot.m_state.compare_exchange_strong(expected,
+			I2C_SLOT_COMPLETE, std::memory_order_release))
+	{
+		// Nobody is waiting for an abandoned slot
+		brokerSlot.m_state.store(I2C_SLOT_FREE, std::memory_order_release);
+		return;
+	}
+	wake(brokerSlot.m_state);
+}
+
+void I2C_Broker_Ring::releaseClient(uint32_t clientId)
+{
+	for (uint32_t slot = 0; slot < I2C_BROKER_SLOT_COUNT; slot++)
+	{
+		if ((m_slots[slot].m_clientId == clientId)
+				&& (m_slots[slot].m_state != I2C_SLOT_FREE))
+		{
+			abandon(slot);
+		}
+	}
+}
+
+size_t I2C_Broker_Ring::getFreeCount()
+{
+	size_t freeCount = 0;
+	for (uint32_t slot = 0; slot < I2C_BROKER_SLOT_COUNT; slot++)
+	{
+		freeCount += (m_slots[slot].m_state == I2C_SLOT_FREE);
+	}
+	return freeCount;
+}
+
+size_t I2C_Broker_Ring::getRegionSize()
+{
+	return I2C_BROKER_HEADER_SIZE
+			+ (I2C_BROKER_SLOT_COUNT * sizeof(I2C_Broker_Slot));
+}
+
+I2CError I2C_Broker_Ring::mapRegion(int regionFd)
+{
+	detach();
+	void *region = mmap(NULL, getRegionSize(), PROT_READ | PROT_WRITE,
+			MAP_SHARED, regionFd, 0);
+	if (region == MAP_FAILED)
+	{
+		return I2CError("Unable to map the I2C broker region", BROKER_ERROR);
+	}
+	m_region = region;
+	m_header = (I2C_Broker_Header*) region;
+	m_slots = (I2C_Broker_Slot*) ((uint8_t*) region + I2C_BROKER_HEADER_SIZE);
+	return I2CError();
+}
+
+bool I2C_Broker_Ring::encodeMessage(const I2C_Message &message,
+		I2C_Broker_Message &slotMessage)
+{
+	bool isWrite = (message.m_type == I2C_WRITE);
+	size_t dataSize = isWrite ? message.m_data.size() : message.getDataSize();
+	if ((message.m_registerNumber.size() > I2C_BROKER_MAX_REGISTER_SIZE)
+			|| (dataSize > I2C_BROKER_MAX_DATA_SIZE)
+			|| (message.m_compareData.size() > I2C_BROKER_MAX_DATA_SIZE))
+	{
+		return false;
+	}
+	slotMessage.m_type = message.m_type;
+	slotMessage.m_registerSize = message.m_registerNumber.size();
+	slotMessage.m_allowOtherProcessOnIdle = message.m_allowOtherProcessOnIdle;
+	slotMessage.m_allowCoalescing = message.m_allowCoalescing;
+	slotMessage.m_dataSize = dataSize;
+	slotMessage.m_compareSize = message.m_compareData.size();
+	slotMessage.m_errorCode = NO_ERROR;
+	slotMessage.m_retryCount = message.m_retryCount;
+	slotMessage.m_delayUsec = message.m_delayInUsec;
+	slotMessage.m_retryDelayUsec = message.m_retryDelayInUsec;
+	std::copy(message.m_registerNumber.begin(), message.m_registerNumber.end(),
+			slotMessage.m_registerNumber);
+	if (isWrite)
+	{
+		std::copy(message.m_data.begin(), message.m_data.end(),
+				slotMessage.m_data);
+	}
+	std::copy(message.m_compareData.begin(), message.m_compareData.end(),
+			slotMessage.m_compareData);
+	return true;
+}
+
+bool I2C_Broker_Ring::isValidMessage(const I2C_Broker_Message &slotMessage)
+{
+	return (slotMessage.m_type <= I2C_READ_COMPARE_NOT_EQUAL)
+			&& (slotMessage.m_registerSize <= I2C_BROKER_MAX_REGISTER_SIZE)
+			&& (slotMessage.m_dataSize <= I2C_BROKER_MAX_DATA_SIZE)
+			&& (slotMessage.m_compareSize <= I2C_BROKER_MAX_DATA_SIZE);
+}
+
+void I2C_Broker_Ring::wake(std::atomic<uint32_t> &state)
+{
+	syscall(SYS_futex, (uint32_t*) &state, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+} /* namespace apra */
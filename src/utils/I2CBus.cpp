@@ -9,29 +9,48 @@
  * See LICENSE file in the project root for full license information.
  */
 
-#include <linux/i2c-dev.h>
-#include <linux/i2c.h>
-#include <sys/ioctl.h>
-#include <fcntl.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <inttypes.h>
+#include <algorithm>
 #include "models/I2CError.h"
 #include "utils/Utils.h"
 #include "utils/Macro.h"
+#include "utils/ScopeLock.h"
+#include "utils/I2CDevTransport.h"
 
 #include "utils/I2CBus.h"
 using namespace apra;
 
 I2C_Bus::I2C_Bus(string i2cPath, bool shouldPrint) :
-		m_i2cPath(i2cPath), m_shouldPrint(shouldPrint), m_i2cFileDescriptor(-1), m_registerSize(
-				1), m_dataSize(1), m_lastI2COperationTs(0)
+		m_i2cPath(i2cPath), m_shouldPrint(shouldPrint), m_transport(
+				new I2C_Dev_Transport(i2cPath, shouldPrint)), m_ownsTransport(
+				true), m_registerSize(1), m_dataSize(1), m_lastI2COperationTs(0), m_smbusEnabled(
+				true), m_prepareGeneration(1), m_statisticsEnabled(true), m_statistics()
 {
+	resetStatistics();
+}
 
+I2C_Bus::I2C_Bus(I2C_Transport *transport, bool shouldPrint) :
+		m_i2cPath(), m_shouldPrint(shouldPrint), m_transport(transport), m_ownsTransport(
+				false), m_registerSize(1), m_dataSize(1), m_lastI2COperationTs(0), m_smbusEnabled(
+				true), m_prepareGeneration(1), m_statisticsEnabled(true), m_statistics()
+{
+	resetStatistics();
 }
 
 I2C_Bus::~I2C_Bus()
 {
+	if (m_ownsTransport)
+	{
+		delete m_transport;
+		m_transport = NULL;
+	}
+}
+
+I2C_Transport* I2C_Bus::getTransport()
+{
+	return m_transport;
 }
 
 bool I2C_Bus::isI2CExecRecommended()
@@ -46,54 +65,210 @@ void I2C_Bus::setSize(uint8_t registerSize, uint8_t dataSize)
 	m_dataSize = dataSize;
 }
 
-I2CError I2C_Bus::openBus()
+void I2C_Bus::setSMBusEnabled(bool enable)
 {
-	I2CError error;
-#if defined(__arm__) || defined(__aarch64__)
-	m_i2cFileDescriptor = open(m_i2cPath.c_str(), O_RDWR);
-	if (m_i2cFileDescriptor < 0)
+	m_smbusEnabled = enable;
+	m_prepareGeneration++;
+}
+
+uint64_t I2C_Bus::getFunctionality()
+{
+	return m_transport->getFunctionality();
+}
+
+void I2C_Bus::setBusClock(uint64_t busClockHz)
+{
+	ScopeLock lock(m_statisticsLock);
+	m_statistics.m_busClockHz = busClockHz;
+}
+
+uint64_t I2C_Bus::getBusClock()
+{
+	ScopeLock lock(m_statisticsLock);
+	return m_statistics.m_busClockHz;
+}
+
+void I2C_Bus::setStatisticsEnabled(bool enable)
+{
+	m_statisticsEnabled = enable;
+}
+
+I2C_Bus_Statistics I2C_Bus::getStatistics()
+{
+	ScopeLock lock(m_statisticsLock);
+	MONOTIMEUS(m_statistics.m_snapshotTs);
+	return m_statistics;
+}
+
+void I2C_Bus::resetStatistics()
+{
+	MONOCURRTIME(timeNow);
+	ScopeLock lock(m_statisticsLock);
+	m_statistics.reset(timeNow);
+}
+
+void I2C_Bus::recordRetry(uint8_t chipAddress,
+		const vector<uint8_t> &registerAddress)
+{
+	if (!m_statisticsEnabled)
 	{
-		m_i2cFileDescriptor = -1;
-		if (m_shouldPrint)
+		return;
+	}
+	ScopeLock lock(m_statisticsLock);
+	m_statistics.recordRetry(chipAddress, getRegisterKey(registerAddress));
+}
+
+uint64_t I2C_Bus::getRegisterKey(const vector<uint8_t> &registerAddress)
+{
+	uint64_t key = 0;
+	for (size_t index = 0; index < registerAddress.size(); index++)
+	{
+		key = (key << 8) | registerAddress[index];
+	}
+	return key;
+}
+
+void I2C_Bus::recordTransfer(uint8_t chipAddress,
+		const vector<uint8_t> &registerAddress, bool isRead, size_t dataSize,
+		int64_t startTs, I2CError &error)
+{
+	if (!m_statisticsEnabled)
+	{
+		return;
+	}
+	MONOCURRTIME(timeNow);
+	uint64_t latency = (timeNow > startTs) ? (timeNow - startTs) : 0;
+	I2C_ERROR_CODE code = error.isError() ? error.getCode() : NO_ERROR;
+	if (error.isError() && (code == NO_ERROR))
+	{
+		code = isRead ? READ_ERROR : WRITE_ERROR;
+	}
+	ScopeLock lock(m_statisticsLock);
+	uint64_t busTime = I2C_Bus_Statistics::estimateTransferUsec(
+			m_statistics.m_busClockHz,
+			registerAddress.size() + (isRead ? 0 : dataSize),
+			isRead ? dataSize : 0);
+	m_statistics.recordTransfer(chipAddress, getRegisterKey(registerAddress),
+			isRead, dataSize, latency, busTime, code);
+}
+
+int32_t I2C_Bus::getSMBusTransaction(bool isRead, size_t registerSize,
+		size_t dataSize)
+{
+	if (!m_smbusEnabled || registerSize != 1
+			|| dataSize > I2C_SMBUS_MAX_BLOCK_SIZE)
+	{
+		return -1;
+	}
+	uint64_t functionality = m_transport->getFunctionality();
+	if (isRead)
+	{
+		if ((dataSize == 1)
+				&& (functionality & I2C_FUNC_SMBUS_READ_BYTE_DATA))
 		{
-			char err[200];
-			sprintf(err, "open('%s') in i2c_init", m_i2cPath.c_str());
-			error = I2CError(err, OPEN_BUS_ERROR);
-			perror(err);
+			return I2C_SMBUS_BYTE_DATA;
 		}
+		if ((dataSize == 2)
+				&& (functionality & I2C_FUNC_SMBUS_READ_WORD_DATA))
+		{
+			return I2C_SMBUS_WORD_DATA;
+		}
+		if (dataSize && (functionality & I2C_FUNC_SMBUS_READ_I2C_BLOCK))
+		{
+			return I2C_SMBUS_I2C_BLOCK_DATA;
+		}
+		return -1;
 	}
-#endif
-	return error;
+	if ((dataSize == 0) && (functionality & I2C_FUNC_SMBUS_WRITE_BYTE))
+	{
+		return I2C_SMBUS_BYTE;
+	}
+	if ((dataSize == 1) && (functionality & I2C_FUNC_SMBUS_WRITE_BYTE_DATA))
+	{
+		return I2C_SMBUS_BYTE_DATA;
+	}
+	if ((dataSize == 2) && (functionality & I2C_FUNC_SMBUS_WRITE_WORD_DATA))
+	{
+		return I2C_SMBUS_WORD_DATA;
+	}
+	if (dataSize && (functionality & I2C_FUNC_SMBUS_WRITE_I2C_BLOCK))
+	{
+		return I2C_SMBUS_I2C_BLOCK_DATA;
+	}
+	return -1;
 }
 
-void I2C_Bus::closeBus()
+int32_t I2C_Bus::smbusAccess(bool isRead, int32_t transaction, uint8_t command,
+		vector<uint8_t> &data, size_t dataSize)
 {
-#if defined(__arm__) || defined(__aarch64__)
-	if (m_i2cFileDescriptor > -1)
+	union i2c_smbus_data smbusData;
+	struct i2c_smbus_ioctl_data args;
+	args.read_write = isRead ? I2C_SMBUS_READ : I2C_SMBUS_WRITE;
+	args.command = command;
+	args.size = transaction;
+	args.data = &smbusData;
+	if (transaction == I2C_SMBUS_I2C_BLOCK_DATA)
+	{
+		smbusData.block[0] = dataSize;
+		if (!isRead)
+		{
+			std::copy(data.begin(), data.begin() + dataSize,
+					smbusData.block + 1);
+		}
+	}
+	else if (!isRead && (transaction == I2C_SMBUS_BYTE_DATA))
+	{
+		smbusData.byte = data[0];
+	}
+	else if (!isRead && (transaction == I2C_SMBUS_WORD_DATA))
 	{
-		close(m_i2cFileDescriptor);
-		m_i2cFileDescriptor = -1;
+		smbusData.word = data[0] | (data[1] << 8);
 	}
-#endif
+	int32_t result = m_transport->smbusTransfer(args);
+	if ((result < 0) || !isRead)
+	{
+		return result;
+	}
+	data.resize(dataSize);
+	switch (transaction)
+	{
+	case I2C_SMBUS_BYTE_DATA:
+		data[0] = smbusData.byte;
+		break;
+	case I2C_SMBUS_WORD_DATA:
+		data[0] = smbusData.word & 0xFF;
+		data[1] = (smbusData.word >> 8) & 0xFF;
+		break;
+	default:
+		std::copy(smbusData.block + 1, smbusData.block + 1 + dataSize,
+				data.begin());
+		break;
+	}
+	return result;
+}
+
+I2CError I2C_Bus::openBus()
+{
+	m_prepareGeneration++;
+	return m_transport->openBus();
+}
+
+void I2C_Bus::closeBus()
+{
+	m_transport->closeBus();
+}
+
+bool I2C_Bus::isOpen()
+{
+	return m_transport->isOpen();
 }
 
 I2CError I2C_Bus::genericWrite(uint8_t chipAddress,
 		vector<uint8_t> registerAddress, vector<uint8_t> data)
 {
 	I2CError error;
-#if defined(__arm__) || defined(__aarch64__)
-	if (m_i2cFileDescriptor > -1)
-	{
-		vector<uint8_t> i2cBytes = registerAddress;
-		i2cBytes.insert(i2cBytes.end(), data.begin(), data.end());
-		struct i2c_msg msgs[1];
-		struct i2c_rdwr_ioctl_data msgset[1];
-		msgs[0].addr = chipAddress;
-		msgs[0].flags = 0;
-		msgs[0].len = i2cBytes.size();
-		msgs[0].buf = i2cBytes.data();
-		msgset[0].msgs = msgs;
-		msgset[0].nmsgs = 1;
+	if (m_transport->isOpen())
+	{
 		string debugString(__func__);
 		debugString += " , 0x";
 		for (uint32_t count = 0; count < registerAddress.size(); count++)
@@ -116,9 +291,34 @@ I2CError I2C_Bus::genericWrite(uint8_t chipAddress,
 		{
 			printf("%s", debugString.c_str());
 		}
-		if (ioctl(m_i2cFileDescriptor, I2C_RDWR, &msgset) < 0)
+		int32_t result = -1;
+		MONOCURRTIME(startTs);
+		int32_t transaction = getSMBusTransaction(false,
+				registerAddress.size(), data.size());
+		bool isSMBus = (transaction > -1)
+				&& m_transport->selectChip(chipAddress);
+		if (isSMBus)
+		{
+			result = smbusAccess(false, transaction, registerAddress[0], data,
+					data.size());
+		}
+		else
+		{
+			vector<uint8_t> i2cBytes = registerAddress;
+			i2cBytes.insert(i2cBytes.end(), data.begin(), data.end());
+			struct i2c_msg msgs[1];
+			msgs[0].addr = chipAddress;
+			msgs[0].flags = 0;
+			msgs[0].len = i2cBytes.size();
+			msgs[0].buf = i2cBytes.data();
+			result = m_transport->transfer(msgs, 1);
+		}
+		if (result < 0)
 		{
-			error = I2CError("ioctl(I2C_RDWR) in i2c_write", debugString,
+			error = I2CError(
+					isSMBus ?
+							"ioctl(I2C_SMBUS) in i2c_write" :
+							"ioctl(I2C_RDWR) in i2c_write", debugString,
 					WRITE_ERROR);
 			if(m_shouldPrint)
 			{
@@ -128,12 +328,13 @@ I2CError I2C_Bus::genericWrite(uint8_t chipAddress,
 		{
 			MONOTIMEUS(m_lastI2COperationTs);
 		}
+		recordTransfer(chipAddress, registerAddress, false, data.size(),
+				startTs, error);
 	}
 	else
 	{
-		error = I2CError("I2C bus is not opened yet");
+		error = I2CError("I2C bus is not opened yet", BUS_UNOPENED);
 	}
-#endif
 	return error;
 
 }
@@ -142,43 +343,28 @@ I2CError I2C_Bus::genericRead(uint8_t chipAddress,
 {
 	I2CError error;
 	string debugString(__func__);
-#if defined(__arm__) || defined(__aarch64__)
-	uint8_t *readBytes = (uint8_t*) calloc((m_dataSize + 1), 1);
-	if (readBytes == NULL)
+	if (!m_transport->isOpen())
 	{
-		error = I2CError("Unable to allocate memory for i2c read");
-		if (m_shouldPrint)
-		{
-			printf("%s\n", error.getMessage().c_str());
-		}
+		return I2CError("I2C bus is not opened yet", BUS_UNOPENED);
 	}
-	else
+	debugString += " , 0x";
+	for (uint32_t count = 0; count < registerAddress.size(); count++)
 	{
-		vector<uint8_t> i2cBytes = registerAddress;
-		struct i2c_msg msgs[2];
-		struct i2c_rdwr_ioctl_data msgset[1];
-		msgs[0].addr = chipAddress;
-		msgs[0].flags = 0;
-		msgs[0].len = i2cBytes.size();
-		msgs[0].buf = i2cBytes.data();
-		msgs[1].addr = chipAddress;
-		msgs[1].flags = I2C_M_RD;
-		msgs[1].len = m_dataSize;
-		msgs[1].buf = readBytes;
-		msgset[0].msgs = msgs;
-		msgset[0].nmsgs = 2;
-		debugString += " , 0x";
-		for (uint32_t count = 0; count < registerAddress.size(); count++)
-		{
-			char regCh[5] =
-			{	0};
-			sprintf(regCh, "%02x", registerAddress[count]);
-			debugString += string(regCh);
-		}
-		if (ioctl(m_i2cFileDescriptor, I2C_RDWR, &msgset) < 0 )
+		char regCh[5] =
+		{	0};
+		sprintf(regCh, "%02x", registerAddress[count]);
+		debugString += string(regCh);
+	}
+	MONOCURRTIME(startTs);
+	int32_t transaction = getSMBusTransaction(true, registerAddress.size(),
+			m_dataSize);
+	if ((transaction > -1) && m_transport->selectChip(chipAddress))
+	{
+		if (smbusAccess(true, transaction, registerAddress[0], readData,
+				m_dataSize) < 0)
 		{
 			debugString += "\n";
-			error = I2CError("ioctl(I2C_RDWR) in i2c_read", debugString,
+			error = I2CError("ioctl(I2C_SMBUS) in i2c_read", debugString,
 					READ_ERROR);
 			if(m_shouldPrint)
 			{
@@ -187,18 +373,58 @@ I2CError I2C_Bus::genericRead(uint8_t chipAddress,
 		else
 		{
 			MONOTIMEUS(m_lastI2COperationTs);
-			readData.clear();
-			for (uint16_t count = 0; count < m_dataSize; ++count)
-			{
-				readData.push_back(readBytes[count]);
-			}
 		}
 	}
-	if (readBytes != NULL)
+	else
 	{
-		free(readBytes);
-		readBytes = NULL;
+		uint8_t *readBytes = (uint8_t*) calloc((m_dataSize + 1), 1);
+		if (readBytes == NULL)
+		{
+			error = I2CError("Unable to allocate memory for i2c read");
+			if (m_shouldPrint)
+			{
+				printf("%s\n", error.getMessage().c_str());
+			}
+		}
+		else
+		{
+			vector<uint8_t> i2cBytes = registerAddress;
+			struct i2c_msg msgs[2];
+			msgs[0].addr = chipAddress;
+			msgs[0].flags = 0;
+			msgs[0].len = i2cBytes.size();
+			msgs[0].buf = i2cBytes.data();
+			msgs[1].addr = chipAddress;
+			msgs[1].flags = I2C_M_RD;
+			msgs[1].len = m_dataSize;
+			msgs[1].buf = readBytes;
+			if (m_transport->transfer(msgs, 2) < 0)
+			{
+				debugString += "\n";
+				error = I2CError("ioctl(I2C_RDWR) in i2c_read", debugString,
+						READ_ERROR);
+				if(m_shouldPrint)
+				{
+					perror(error.getMessage().c_str());}
+			}
+			else
+			{
+				MONOTIMEUS(m_lastI2COperationTs);
+				readData.clear();
+				for (uint16_t count = 0; count < m_dataSize; ++count)
+				{
+					readData.push_back(readBytes[count]);
+				}
+			}
+		}
+		if (readBytes != NULL)
+		{
+			free(readBytes);
+			readBytes = NULL;
+		}
 	}
+	recordTransfer(chipAddress, registerAddress, true, m_dataSize, startTs,
+			error);
 
 	if (m_shouldPrint)
 	{
@@ -209,10 +435,119 @@ I2CError I2C_Bus::genericRead(uint8_t chipAddress,
 		}
 		printf("\n");
 	}
-#endif
 	return error;
 }
 
+void I2C_Bus::prepare(I2C_Prepared_Transfer &prepared, uint8_t chipAddress,
+		const vector<uint8_t> &registerAddress, size_t dataSize, bool isRead)
+{
+	prepared.m_chipAddress = chipAddress;
+	prepared.m_isRead = isRead;
+	prepared.m_dataSize = dataSize;
+	prepared.m_registerAddress = registerAddress;
+	prepared.m_smbusTransaction = getSMBusTransaction(isRead,
+			registerAddress.size(), dataSize);
+	prepared.m_buffer = registerAddress;
+	prepared.m_buffer.resize(registerAddress.size() + dataSize, 0);
+	prepared.m_messages[0].addr = chipAddress;
+	prepared.m_messages[0].flags = 0;
+	prepared.m_messages[1].addr = chipAddress;
+	prepared.m_messages[1].flags = I2C_M_RD;
+	prepared.m_messages[1].len = dataSize;
+	if (isRead)
+	{
+		prepared.m_messages[0].len = registerAddress.size();
+		prepared.m_messageCount = 2;
+	}
+	else
+	{
+		prepared.m_messages[0].len = prepared.m_buffer.size();
+		prepared.m_messageCount = 1;
+	}
+	prepared.bindMessages();
+	prepared.m_generation = m_prepareGeneration;
+}
+
+I2CError I2C_Bus::execute(I2C_Prepared_Transfer &prepared,
+		vector<uint8_t> &data)
+{
+	if (!m_transport->isOpen())
+	{
+		return I2CError("I2C bus is not opened yet", BUS_UNOPENED);
+	}
+	if ((prepared.m_generation != m_prepareGeneration)
+			|| (!prepared.m_isRead && (data.size() != prepared.m_dataSize)))
+	{
+		prepare(prepared, prepared.m_chipAddress, prepared.m_registerAddress,
+				prepared.m_isRead ? prepared.m_dataSize : data.size(),
+				prepared.m_isRead);
+	}
+	I2CError error;
+	int32_t result = -1;
+	MONOCURRTIME(startTs);
+	bool isSMBus = (prepared.m_smbusTransaction > -1)
+			&& m_transport->selectChip(prepared.m_chipAddress);
+	if (isSMBus)
+	{
+		result = smbusAccess(prepared.m_isRead, prepared.m_smbusTransaction,
+				prepared.m_registerAddress[0], data, prepared.m_dataSize);
+	}
+	else
+	{
+		if (!prepared.m_isRead)
+		{
+			std::copy(data.begin(), data.end(),
+					prepared.m_buffer.begin()
+							+ prepared.m_registerAddress.size());
+		}
+		result = m_transport->transfer(prepared.m_messages,
+				prepared.m_messageCount);
+		if ((result > -1) && prepared.m_isRead)
+		{
+			data.assign(
+					prepared.m_buffer.begin()
+							+ prepared.m_registerAddress.size(),
+					prepared.m_buffer.end());
+		}
+	}
+	if (result < 0)
+	{
+		string function(prepared.m_isRead ? "i2c_read" : "i2c_write");
+		error = I2CError(
+				(isSMBus ? "ioctl(I2C_SMBUS) in " : "ioctl(I2C_RDWR) in ")
+						+ function,
+				getDebugString(__func__, prepared.m_registerAddress),
+				prepared.m_isRead ? READ_ERROR : WRITE_ERROR);
+		if (m_shouldPrint)
+		{
+			perror(error.getMessage().c_str());
+		}
+	}
+	else
+	{
+		MONOTIMEUS(m_lastI2COperationTs);
+	}
+	recordTransfer(prepared.m_chipAddress, prepared.m_registerAddress,
+			prepared.m_isRead, prepared.m_dataSize, startTs, error);
+	return error;
+}
+
+string I2C_Bus::getDebugString(const char *function,
+		const vector<uint8_t> &registerAddress)
+{
+	string debugString(function);
+	debugString += " , 0x";
+	for (uint32_t count = 0; count < registerAddress.size(); count++)
+	{
+		char regCh[5] =
+		{ 0 };
+		sprintf(regCh, "%02x", registerAddress[count]);
+		debugString += string(regCh);
+	}
+	debugString += "\n";
+	return debugString;
+}
+
 I2CError I2C_Bus::writeOnce(uint8_t chipAddress, uint64_t registerAddress,
 		uint64_t data)
 {
@@ -244,8 +579,7 @@ I2CError I2C_Bus::writeOnI2C(uint8_t chipAddress, uint64_t registerAddress,
 	vector<uint8_t> registerArray = Utils::extractBytes(registerAddress,
 			m_registerSize);
 	vector<uint8_t> dataArray = Utils::extractBytes(data, m_dataSize);
-#if defined(__arm__) || defined(__aarch64__)
-	if (m_i2cFileDescriptor > -1)
+	if (m_transport->isOpen())
 	{
 		error = genericWrite(chipAddress, registerArray, dataArray);
 	}
@@ -253,7 +587,6 @@ I2CError I2C_Bus::writeOnI2C(uint8_t chipAddress, uint64_t registerAddress,
 	{
 		error = I2CError("I2C bus is not opened yet", BUS_UNOPENED);
 	}
-#endif
 	return error;
 }
 
@@ -264,8 +597,7 @@ I2CError I2C_Bus::readOnI2C(uint8_t chipAddress, uint64_t registerAddress,
 	vector<uint8_t> registerArray = Utils::extractBytes(registerAddress,
 			m_registerSize);
 	vector<uint8_t> dataArray;
-#if defined(__arm__) || defined(__aarch64__)
-	if (m_i2cFileDescriptor > -1)
+	if (m_transport->isOpen())
 	{
 		error = genericRead(chipAddress, registerArray, dataArray);
 		if (!error.isError())
@@ -277,6 +609,5 @@ I2CError I2C_Bus::readOnI2C(uint8_t chipAddress, uint64_t registerAddress,
 	{
 		error = I2CError("I2C bus is not opened yet", BUS_UNOPENED);
 	}
-#endif
 	return error;
 }
@@ -0,0 +1,214 @@
+/*
+ * I2CBusArbiter.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <algorithm>
+#include "utils/I2CBusArbiter.h"
+
+namespace apra
+{
+
+I2C_Arbiter_Entry::I2C_Arbiter_Entry() :
+		m_priority(I2C_PRIORITY_NORMAL), m_admitTs(0), m_deadlineTs(0), m_dropIfStale(
+				false), m_sequence(0), m_request(NULL), m_ownsRequest(false), m_event()
+{
+}
+
+I2C_Arbiter_Entry::~I2C_Arbiter_Entry()
+{
+}
+
+bool I2C_Arbiter_Entry::isStale(int64_t timeNow) const
+{
+	return m_dropIfStale && m_deadlineTs && (timeNow > m_deadlineTs);
+}
+
+I2C_Bus_Arbiter::I2C_Bus_Arbiter() :
+		m_sequence(0)
+{
+	resetStatistics();
+}
+
+I2C_Bus_Arbiter::~I2C_Bus_Arbiter()
+{
+}
+
+void I2C_Bus_Arbiter::pushRequest(I2C_Transaction_Message *request,
+		bool ownsRequest, int64_t timeNow)
+{
+	I2C_Arbiter_Entry entry;
+	entry.m_priority = getPriority(*request);
+	entry.m_admitTs = timeNow;
+	entry.m_deadlineTs = request->m_deadlineTs;
+	entry.m_dropIfStale = request->m_dropIfStale;
+	entry.m_request = request;
+	entry.m_ownsRequest = ownsRequest;
+	push(entry);
+}
+
+void I2C_Bus_Arbiter::pushEvent(shared_ptr<I2C_Registered_Event> event,
+		int64_t timeNow, int64_t deadlineTs)
+{
+	I2C_Arbiter_Entry entry;
+	entry.m_priority = getPriority(event->m_message);
+	entry.m_admitTs = timeNow;
+	entry.m_deadlineTs = deadlineTs;
+	entry.m_dropIfStale = event->m_message.m_dropIfStale;
+	entry.m_event = event;
+	push(entry);
+}
+
+bool I2C_Bus_Arbiter::pop(I2C_Arbiter_Entry &entry, int64_t timeNow,
+		I2C_PRIORITY lowestPriority)
+{
+	for (int32_t priority = I2C_PRIORITY_URGENT; priority <= lowestPriority;
+			priority++)
+	{
+		if (m_queues[priority].empty())
+		{
+			continue;
+		}
+		std::pop_heap(m_queues[priority].begin(), m_queues[priority].end(),
+				EntryCompare());
+		entry = m_queues[priority].back();
+		m_queues[priority].pop_back();
+		uint64_t waitUsec =
+				(timeNow > entry.m_admitTs) ? (timeNow - entry.m_admitTs) : 0;
+		if (waitUsec > m_maxWaitUsec[priority])
+		{
+			m_maxWaitUsec[priority] = waitUsec;
+		}
+		return true;
+	}
+	return false;
+}
+
+bool I2C_Bus_Arbiter::removeRequest(const I2C_Transaction_Message *request)
+{
+	for (int32_t priority = 0; priority < I2C_PRIORITY_COUNT; priority++)
+	{
+		vector<I2C_Arbiter_Entry> &queue = m_queues[priority];
+		for (size_t index = 0; index < queue.size(); index++)
+		{
+			if (queue[index].m_request == request)
+			{
+				queue.erase(queue.begin() + index);
+				std::make_heap(queue.begin(), queue.end(), EntryCompare());
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool I2C_Bus_Arbiter::hasPending(I2C_PRIORITY lowestPriority)
+{
+	for (int32_t priority = I2C_PRIORITY_URGENT; priority <= lowestPriority;
+			priority++)
+	{
+		if (!m_queues[priority].empty())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t I2C_Bus_Arbiter::size()
+{
+	size_t pending = 0;
+	for (int32_t priority = 0; priority < I2C_PRIORITY_COUNT; priority++)
+	{
+		pending += m_queues[priority].size();
+	}
+	return pending;
+}
+
+uint64_t I2C_Bus_Arbiter::getExecutedCount(I2C_PRIORITY priority)
+{
+	return m_executedCount[priority];
+}
+
+uint64_t I2C_Bus_Arbiter::getMaxWaitUsec(I2C_PRIORITY priority)
+{
+	return m_maxWaitUsec[priority];
+}
+
+uint64_t I2C_Bus_Arbiter::getDeadlineMissCount(I2C_PRIORITY priority)
+{
+	return m_deadlineMissCount[priority];
+}
+
+uint64_t I2C_Bus_Arbiter::getDroppedCount(I2C_PRIORITY priority)
+{
+	return m_droppedCount[priority];
+}
+
+void I2C_Bus_Arbiter::recordCompletion(const I2C_Arbiter_Entry &entry,
+		int64_t timeNow)
+{
+	m_executedCount[entry.m_priority]++;
+	if (entry.m_deadlineTs && (timeNow > entry.m_deadlineTs))
+	{
+		m_deadlineMissCount[entry.m_priority]++;
+	}
+}
+
+void I2C_Bus_Arbiter::recordDrop(const I2C_Arbiter_Entry &entry)
+{
+	m_deadlineMissCount[entry.m_priority]++;
+	m_droppedCount[entry.m_priority]++;
+}
+
+void I2C_Bus_Arbiter::resetStatistics()
+{
+	for (int32_t priority = 0; priority < I2C_PRIORITY_COUNT; priority++)
+	{
+		m_executedCount[priority] = 0;
+		m_maxWaitUsec[priority] = 0;
+		m_deadlineMissCount[priority] = 0;
+		m_droppedCount[priority] = 0;
+	}
+}
+
+I2C_PRIORITY I2C_Bus_Arbiter::getPriority(
+		const I2C_Transaction_Message &message)
+{
+	if ((message.m_priority < I2C_PRIORITY_URGENT)
+			|| (message.m_priority > I2C_PRIORITY_BACKGROUND))
+	{
+		return I2C_PRIORITY_NORMAL;
+	}
+	return message.m_priority;
+}
+
+void I2C_Bus_Arbiter::push(I2C_Arbiter_Entry &entry)
+{
+	entry.m_sequence = m_sequence++;
+	m_queues[entry.m_priority].push_back(entry);
+	std::push_heap(m_queues[entry.m_priority].begin(),
+			m_queues[entry.m_priority].end(), EntryCompare());
+}
+
+// Heap order: true when first should run after second
+bool I2C_Bus_Arbiter::EntryCompare::operator()(const I2C_Arbiter_Entry &first,
+		const I2C_Arbiter_Entry &second) const
+{
+	int64_t firstDeadline = first.m_deadlineTs ? first.m_deadlineTs : INT64_MAX;
+	int64_t secondDeadline =
+			second.m_deadlineTs ? second.m_deadlineTs : INT64_MAX;
+	if (firstDeadline != secondDeadline)
+	{
+		return firstDeadline > secondDeadline;
+	}
+	return first.m_sequence > second.m_sequence;
+}
+
+} /* namespace apra */
@@ -0,0 +1,198 @@
+/*
+ * I2CBusHealth.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include "utils/ScopeLock.h"
+#include "utils/I2CBusHealth.h"
+
+namespace apra
+{
+
+I2C_Health_Policy::I2C_Health_Policy() :
+		m_enabled(false), m_quarantineThreshold(3), m_quarantineBaseUsec(100000), m_quarantineMaxUsec(
+				10000000), m_stuckChipThreshold(2), m_stuckErrorThreshold(4), m_stuckTimeoutUsec(
+				1000000), m_recoveryBaseUsec(10000), m_recoveryMaxUsec(5000000)
+{
+}
+
+I2C_Health_Policy::~I2C_Health_Policy()
+{
+}
+
+I2C_Chip_Health::I2C_Chip_Health() :
+		m_consecutiveFailures(0), m_quarantineLevel(0), m_quarantineUntilTs(0), m_quarantineCount(
+				0)
+{
+}
+
+I2C_Chip_Health::~I2C_Chip_Health()
+{
+}
+
+I2C_Bus_Health::I2C_Bus_Health() :
+		m_lock(), m_policy(), m_chips(), m_failingChips(), m_consecutiveBusFailures(
+				0), m_firstFailureTs(0), m_isBusStuck(false), m_recoveryLevel(0), m_nextRecoveryTs(
+				0), m_recoveryCount(0)
+{
+}
+
+I2C_Bus_Health::~I2C_Bus_Health()
+{
+}
+
+void I2C_Bus_Health::setPolicy(const I2C_Health_Policy &policy)
+{
+	ScopeLock lock(m_lock);
+	m_policy = policy;
+}
+
+I2C_Health_Policy I2C_Bus_Health::getPolicy()
+{
+	ScopeLock lock(m_lock);
+	return m_policy;
+}
+
+bool I2C_Bus_Health::isChipAvailable(uint8_t chipAddress, int64_t timeNow)
+{
+	ScopeLock lock(m_lock);
+	if (!m_policy.m_enabled)
+	{
+		return true;
+	}
+	map<uint8_t, I2C_Chip_Health>::iterator chipItr = m_chips.find(
+			chipAddress);
+	return (chipItr == m_chips.end())
+			|| (timeNow >= chipItr->second.m_quarantineUntilTs);
+}
+
+void I2C_Bus_Health::recordResult(uint8_t chipAddress, bool success,
+		int64_t timeNow)
+{
+	ScopeLock lock(m_lock);
+	if (!m_policy.m_enabled)
+	{
+		return;
+	}
+	I2C_Chip_Health &chip = m_chips[chipAddress];
+	if (success)
+	{
+		chip.m_consecutiveFailures = 0;
+		chip.m_quarantineLevel = 0;
+		m_failingChips.clear();
+		m_consecutiveBusFailures = 0;
+		m_firstFailureTs = 0;
+		m_isBusStuck = false;
+		m_recoveryLevel = 0;
+		m_nextRecoveryTs = 0;
+		return;
+	}
+	if (!m_consecutiveBusFailures)
+	{
+		m_firstFailureTs = timeNow;
+	}
+	m_consecutiveBusFailures++;
+	m_failingChips.insert(chipAddress);
+	if (!m_isBusStuck
+			&& (((m_failingChips.size() >= m_policy.m_stuckChipThreshold)
+					&& (m_consecutiveBusFailures
+							>= m_policy.m_stuckErrorThreshold))
+					|| ((uint64_t) (timeNow - m_firstFailureTs)
+							>= m_policy.m_stuckTimeoutUsec)))
+	{
+		m_isBusStuck = true;
+		m_nextRecoveryTs = timeNow;
+	}
+	if (++chip.m_consecutiveFailures >= m_policy.m_quarantineThreshold)
+	{
+		chip.m_quarantineUntilTs = timeNow
+				+ getBackoffUsec(m_policy.m_quarantineBaseUsec,
+						m_policy.m_quarantineMaxUsec, chip.m_quarantineLevel);
+		chip.m_quarantineLevel++;
+		chip.m_quarantineCount++;
+		// A single failure after the quarantine sends the chip straight back
+		chip.m_consecutiveFailures = m_policy.m_quarantineThreshold - 1;
+	}
+}
+
+bool I2C_Bus_Health::isBusStuck()
+{
+	ScopeLock lock(m_lock);
+	return m_isBusStuck;
+}
+
+bool I2C_Bus_Health::isRecoveryDue(int64_t timeNow)
+{
+	ScopeLock lock(m_lock);
+	return m_policy.m_enabled && m_isBusStuck && (timeNow >= m_nextRecoveryTs);
+}
+
+void I2C_Bus_Health::recordRecovery(bool success, int64_t timeNow)
+{
+	ScopeLock lock(m_lock);
+	m_recoveryCount++;
+	m_nextRecoveryTs = timeNow
+			+ getBackoffUsec(m_policy.m_recoveryBaseUsec,
+					m_policy.m_recoveryMaxUsec, m_recoveryLevel);
+	m_recoveryLevel++;
+	if (success)
+	{
+		// Give the reopened adapter a fresh window before judging it again
+		m_failingChips.clear();
+		m_consecutiveBusFailures = 0;
+		m_firstFailureTs = 0;
+		m_isBusStuck = false;
+		for (map<uint8_t, I2C_Chip_Health>::iterator chipItr = m_chips.begin();
+				chipItr != m_chips.end(); chipItr++)
+		{
+			chipItr->second.m_quarantineUntilTs = 0;
+		}
+	}
+}
+
+uint64_t I2C_Bus_Health::getRecoveryCount()
+{
+	ScopeLock lock(m_lock);
+	return m_recoveryCount;
+}
+
+uint64_t I2C_Bus_Health::getQuarantineCount(uint8_t chipAddress)
+{
+	ScopeLock lock(m_lock);
+	map<uint8_t, I2C_Chip_Health>::iterator chipItr = m_chips.find(
+			chipAddress);
+	return (chipItr == m_chips.end()) ? 0 : chipItr->second.m_quarantineCount;
+}
+
+void I2C_Bus_Health::reset()
+{
+	ScopeLock lock(m_lock);
+	m_chips.clear();
+	m_failingChips.clear();
+	m_consecutiveBusFailures = 0;
+	m_firstFailureTs = 0;
+	m_isBusStuck = false;
+	m_recoveryLevel = 0;
+	m_nextRecoveryTs = 0;
+	m_recoveryCount = 0;
+}
+
+uint64_t I2C_Bus_Health::getBackoffUsec(uint64_t baseUsec, uint64_t maxUsec,
+		uint32_t level)
+{
+	uint64_t backoffUsec = baseUsec;
+	for (uint32_t index = 0; (index < level) && (backoffUsec < maxUsec);
+			index++)
+	{
+		backoffUsec <<= 1;
+	}
+	return (backoffUsec < maxUsec) ? backoffUsec : maxUsec;
+}
+
+} /* namespace apra */
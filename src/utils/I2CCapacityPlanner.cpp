@@ -0,0 +1,194 @@
+/*
+ * I2CCapacityPlanner.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <stdio.h>
+#include "models/I2CBusStatistics.h"
+#include "utils/I2CCapacityPlanner.h"
+#include "utils/ScopeLock.h"
+
+namespace apra
+{
+
+I2C_Capacity_Policy::I2C_Capacity_Policy() :
+		m_mode(I2C_ADMIT_WARN), m_budget(1.0), m_transferOverheadUsec(0)
+{
+}
+
+I2C_Capacity_Policy::~I2C_Capacity_Policy()
+{
+}
+
+I2C_Capacity_Planner::I2C_Capacity_Planner() :
+		m_policy(), m_busClockHz(I2C_DEFAULT_BUS_CLOCK_HZ), m_entries(), m_rejectedCount(
+				0), m_warningCount(0)
+{
+}
+
+I2C_Capacity_Planner::~I2C_Capacity_Planner()
+{
+}
+
+void I2C_Capacity_Planner::setPolicy(const I2C_Capacity_Policy &policy)
+{
+	ScopeLock lock(m_lock);
+	m_policy = policy;
+	for (map<uint64_t, I2C_Capacity_Entry>::iterator entryItr =
+			m_entries.begin(); entryItr != m_entries.end(); entryItr++)
+	{
+		updateBusTime(entryItr->second);
+	}
+}
+
+I2C_Capacity_Policy I2C_Capacity_Planner::getPolicy()
+{
+	ScopeLock lock(m_lock);
+	return m_policy;
+}
+
+void I2C_Capacity_Planner::setBusClock(uint64_t busClockHz)
+{
+	ScopeLock lock(m_lock);
+	m_busClockHz = busClockHz;
+	for (map<uint64_t, I2C_Capacity_Entry>::iterator entryItr =
+			m_entries.begin(); entryItr != m_entries.end(); entryItr++)
+	{
+		updateBusTime(entryItr->second);
+	}
+}
+
+bool I2C_Capacity_Planner::admit(I2C_Capacity_Entry entry)
+{
+	ScopeLock lock(m_lock);
+	updateBusTime(entry);
+	m_entries.erase(entry.m_handle);
+	double utilisation = getTotalUtilisation()
+			+ entry.getProjectedUtilisation();
+	if ((utilisation > m_policy.m_budget) && (m_policy.m_mode != I2C_ADMIT_ALL))
+	{
+		if (m_policy.m_mode == I2C_ADMIT_REJECT)
+		{
+			m_rejectedCount++;
+			return false;
+		}
+		m_warningCount++;
+		printf("I2C bus oversubscribed: chip 0x%02x brings utilisation to "
+				"%.1f%% of a %.1f%% budget\n", entry.m_chipNumber,
+				utilisation * 100, m_policy.m_budget * 100);
+	}
+	m_entries[entry.m_handle] = entry;
+	return true;
+}
+
+void I2C_Capacity_Planner::remove(uint64_t handle)
+{
+	ScopeLock lock(m_lock);
+	m_entries.erase(handle);
+}
+
+double I2C_Capacity_Planner::getUtilisation()
+{
+	ScopeLock lock(m_lock);
+	return getTotalUtilisation();
+}
+
+uint64_t I2C_Capacity_Planner::getCostUsec(uint64_t handle)
+{
+	ScopeLock lock(m_lock);
+	map<uint64_t, I2C_Capacity_Entry>::const_iterator entryItr = m_entries.find(
+			handle);
+	if (entryItr == m_entries.end())
+	{
+		return 0;
+	}
+	return entryItr->second.m_busTimeUsec + entryItr->second.m_delayUsec;
+}
+
+uint64_t I2C_Capacity_Planner::getRejectedCount()
+{
+	ScopeLock lock(m_lock);
+	return m_rejectedCount;
+}
+
+uint64_t I2C_Capacity_Planner::getWarningCount()
+{
+	ScopeLock lock(m_lock);
+	return m_warningCount;
+}
+
+I2C_Capacity_Report I2C_Capacity_Planner::getReport()
+{
+	ScopeLock lock(m_lock);
+	I2C_Capacity_Report report;
+	report.m_busClockHz = m_busClockHz;
+	report.m_budget = m_policy.m_budget;
+	report.m_projectedUtilisation = getTotalUtilisation();
+	for (map<uint64_t, I2C_Capacity_Entry>::const_iterator entryItr =
+			m_entries.begin(); entryItr != m_entries.end(); entryItr++)
+	{
+		report.m_entries.push_back(entryItr->second);
+	}
+	return report;
+}
+
+I2C_Capacity_Entry I2C_Capacity_Planner::estimate(uint64_t handle,
+		const I2C_Transaction_Message &message, uint64_t periodUsec)
+{
+	I2C_Capacity_Entry entry;
+	entry.m_handle = handle;
+	entry.m_chipNumber = message.m_chipNumber;
+	entry.m_periodUsec = periodUsec;
+	for (size_t index = 0; index < message.m_messages.size(); index++)
+	{
+		const I2C_Message &i2cMessage = message.m_messages[index];
+		uint64_t registerBytes = i2cMessage.m_registerNumber.size();
+		if (i2cMessage.m_type == I2C_WRITE)
+		{
+			entry.m_transfers.push_back(
+					make_pair(registerBytes + i2cMessage.m_data.size(), 0));
+		}
+		else
+		{
+			entry.m_transfers.push_back(
+					make_pair(registerBytes, i2cMessage.getDataSize()));
+		}
+		if (!i2cMessage.m_allowOtherProcessOnIdle)
+		{
+			// Other work may run during a delay that allows it
+			entry.m_delayUsec += i2cMessage.m_delayInUsec;
+		}
+	}
+	return entry;
+}
+
+void I2C_Capacity_Planner::updateBusTime(I2C_Capacity_Entry &entry)
+{
+	entry.m_busTimeUsec = 0;
+	for (size_t index = 0; index < entry.m_transfers.size(); index++)
+	{
+		entry.m_busTimeUsec += I2C_Bus_Statistics::estimateTransferUsec(
+				m_busClockHz, entry.m_transfers[index].first,
+				entry.m_transfers[index].second)
+				+ m_policy.m_transferOverheadUsec;
+	}
+}
+
+double I2C_Capacity_Planner::getTotalUtilisation()
+{
+	double utilisation = 0;
+	for (map<uint64_t, I2C_Capacity_Entry>::const_iterator entryItr =
+			m_entries.begin(); entryItr != m_entries.end(); entryItr++)
+	{
+		utilisation += entryItr->second.getProjectedUtilisation();
+	}
+	return utilisation;
+}
+
+} /* namespace apra */
@@ -0,0 +1,62 @@
+/*
+ * I2CCompletionQueue.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include "utils/I2CCompletionQueue.h"
+#include "utils/ScopeLock.h"
+
+namespace apra
+{
+
+I2C_Completion_Queue::I2C_Completion_Queue() :
+		m_isOpen(true), m_messages()
+{
+}
+
+I2C_Completion_Queue::~I2C_Completion_Queue()
+{
+}
+
+bool I2C_Completion_Queue::push(I2C_Transaction_Message *message)
+{
+	ScopeLock lock(m_lock);
+	if (!m_isOpen)
+	{
+		return false;
+	}
+	m_messages.push(message);
+	return true;
+}
+
+bool I2C_Completion_Queue::pop(I2C_Transaction_Message *&message)
+{
+	ScopeLock lock(m_lock);
+	if (m_messages.empty())
+	{
+		return false;
+	}
+	message = m_messages.front();
+	m_messages.pop();
+	return true;
+}
+
+void I2C_Completion_Queue::close()
+{
+	ScopeLock lock(m_lock);
+	m_isOpen = false;
+}
+
+bool I2C_Completion_Queue::isOpen()
+{
+	ScopeLock lock(m_lock);
+	return m_isOpen;
+}
+
+} /* namespace apra */
@@ -0,0 +1,108 @@
+/*
+ * I2CDevTransport.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "utils/I2CDevTransport.h"
+
+namespace apra
+{
+
+I2C_Dev_Transport::I2C_Dev_Transport(string i2cPath, bool shouldPrint) :
+		m_i2cPath(i2cPath), m_shouldPrint(shouldPrint), m_i2cFileDescriptor(-1), m_functionality(
+				0), m_slaveAddress(-1)
+{
+}
+
+I2C_Dev_Transport::~I2C_Dev_Transport()
+{
+	closeBus();
+}
+
+I2CError I2C_Dev_Transport::openBus()
+{
+	I2CError error;
+	m_i2cFileDescriptor = open(m_i2cPath.c_str(), O_RDWR);
+	if (m_i2cFileDescriptor < 0)
+	{
+		m_i2cFileDescriptor = -1;
+		char err[200];
+		snprintf(err, sizeof(err), "open('%s') in i2c_init",
+				m_i2cPath.c_str());
+		error = I2CError(err, OPEN_BUS_ERROR);
+		if (m_shouldPrint)
+		{
+			perror(err);
+		}
+	}
+	else
+	{
+		unsigned long functionality = 0;
+		m_functionality =
+				(ioctl(m_i2cFileDescriptor, I2C_FUNCS, &functionality) < 0) ?
+						I2C_FUNC_I2C : functionality;
+		m_slaveAddress = -1;
+	}
+	return error;
+}
+
+void I2C_Dev_Transport::closeBus()
+{
+	if (m_i2cFileDescriptor > -1)
+	{
+		close(m_i2cFileDescriptor);
+		m_i2cFileDescriptor = -1;
+		m_functionality = 0;
+		m_slaveAddress = -1;
+	}
+}
+
+bool I2C_Dev_Transport::isOpen()
+{
+	return m_i2cFileDescriptor > -1;
+}
+
+uint64_t I2C_Dev_Transport::getFunctionality()
+{
+	return m_functionality;
+}
+
+bool I2C_Dev_Transport::selectChip(uint8_t chipAddress)
+{
+	if (m_slaveAddress == chipAddress)
+	{
+		return true;
+	}
+	m_slaveAddress = -1;
+	if (ioctl(m_i2cFileDescriptor, I2C_SLAVE, chipAddress) < 0)
+	{
+		return false;
+	}
+	m_slaveAddress = chipAddress;
+	return true;
+}
+
+int32_t I2C_Dev_Transport::transfer(struct i2c_msg *messages, uint32_t count)
+{
+	struct i2c_rdwr_ioctl_data msgset;
+	msgset.msgs = messages;
+	msgset.nmsgs = count;
+	return ioctl(m_i2cFileDescriptor, I2C_RDWR, &msgset);
+}
+
+int32_t I2C_Dev_Transport::smbusTransfer(struct i2c_smbus_ioctl_data &args)
+{
+	return ioctl(m_i2cFileDescriptor, I2C_SMBUS, &args);
+}
+
+} /* namespace apra */
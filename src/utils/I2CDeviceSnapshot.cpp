@@ -0,0 +1,388 @@
+/*
+ * I2CDeviceSnapshot.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "models/I2CTraceRecord.h"
+#include "utils/I2CDeviceSnapshot.h"
+#include "utils/ScopeLock.h"
+
+#define I2C_SNAPSHOT_HASH_OFFSET 0xCBF29CE484222325ULL
+#define I2C_SNAPSHOT_HASH_PRIME 0x100000001B3ULL
+
+namespace apra
+{
+
+I2C_Device_Init::I2C_Device_Init() :
+		m_chipAddress(0), m_initMessages(), m_signature(), m_writeChangedOnly(
+				false), m_verify(false)
+{
+}
+
+I2C_Device_Init::I2C_Device_Init(uint8_t chipAddress,
+		vector<I2C_Message> initMessages) :
+		m_chipAddress(chipAddress), m_initMessages(initMessages), m_signature(), m_writeChangedOnly(
+				false), m_verify(false)
+{
+}
+
+I2C_Device_Init::~I2C_Device_Init()
+{
+}
+
+void I2C_Device_Init::addSignature(vector<uint8_t> registerNumber,
+		uint64_t dataSize)
+{
+	I2C_Message message;
+	message.configureRead(registerNumber, dataSize);
+	// Verification has to see the chip, never a coalesced read
+	message.m_allowCoalescing = false;
+	m_signature.push_back(message);
+}
+
+uint64_t I2C_Device_Init::getInitHash() const
+{
+	uint64_t hash = I2C_SNAPSHOT_HASH_OFFSET;
+	hashValue(hash, m_chipAddress);
+	for (size_t index = 0; index < m_initMessages.size(); index++)
+	{
+		const I2C_Message &message = m_initMessages[index];
+		hashValue(hash, message.m_type);
+		hashBytes(hash, message.m_registerNumber);
+		hashBytes(hash, message.m_data);
+		hashValue(hash, message.getDataSize());
+		hashValue(hash, message.m_delayInUsec);
+	}
+	// A different signature set cannot be checked against the stored one
+	for (size_t index = 0; index < m_signature.size(); index++)
+	{
+		hashBytes(hash, m_signature[index].m_registerNumber);
+		hashValue(hash, m_signature[index].getDataSize());
+	}
+	return hash;
+}
+
+void I2C_Device_Init::hashValue(uint64_t &hash, uint64_t value)
+{
+	for (size_t index = 0; index < sizeof(value); index++)
+	{
+		hash ^= (value >> (index * 8)) & 0xFF;
+		hash *= I2C_SNAPSHOT_HASH_PRIME;
+	}
+}
+
+void I2C_Device_Init::hashBytes(uint64_t &hash, const vector<uint8_t> &bytes)
+{
+	hashValue(hash, bytes.size());
+	for (size_t index = 0; index < bytes.size(); index++)
+	{
+		hash ^= bytes[index];
+		hash *= I2C_SNAPSHOT_HASH_PRIME;
+	}
+}
+
+bool I2C_Device_Init::isWriteRunMember(size_t index) const
+{
+	if ((!m_writeChangedOnly && !m_verify) || (index >= m_initMessages.size()))
+	{
+		return false;
+	}
+	const I2C_Message &message = m_initMessages[index];
+	return (message.m_type == I2C_WRITE) && message.m_allowCoalescing
+			&& !message.m_registerNumber.empty() && !message.m_data.empty()
+			&& (message.m_registerNumber.size() <= sizeof(uint64_t))
+			&& (message.m_data.size() <= I2C_INIT_MAX_BURST_SIZE);
+}
+
+size_t I2C_Device_Init::getWriteRunEnd(size_t begin) const
+{
+	if (!isWriteRunMember(begin))
+	{
+		return begin;
+	}
+	size_t end = begin + 1;
+	uint64_t runSize = m_initMessages[begin].m_data.size();
+	while (isWriteRunMember(end))
+	{
+		const I2C_Message &previous = m_initMessages[end - 1];
+		const I2C_Message &message = m_initMessages[end];
+		// A settling delay has to pass before the next register is touched
+		if (previous.m_delayInUsec
+				|| (message.m_registerNumber.size()
+						!= previous.m_registerNumber.size())
+				|| (getRegisterValue(message.m_registerNumber)
+						!= getRegisterValue(previous.m_registerNumber)
+								+ previous.m_data.size())
+				|| (runSize + message.m_data.size() > I2C_INIT_MAX_BURST_SIZE))
+		{
+			break;
+		}
+		runSize += message.m_data.size();
+		end++;
+	}
+	return end;
+}
+
+uint64_t I2C_Device_Init::getRegisterValue(
+		const vector<uint8_t> &registerNumber)
+{
+	uint64_t value = 0;
+	for (size_t index = 0; index < registerNumber.size(); index++)
+	{
+		value = (value << 8) | registerNumber[index];
+	}
+	return value;
+}
+
+I2C_Init_Report::I2C_Init_Report() :
+		m_isWarm(false), m_readCount(0), m_writeCount(0), m_skippedWriteCount(
+				0), m_mismatchCount(0)
+{
+}
+
+I2C_Init_Report::~I2C_Init_Report()
+{
+}
+
+I2C_Device_Snapshot::I2C_Device_Snapshot() :
+		m_lock(), m_entries(), m_warmCount(0), m_coldCount(0)
+{
+}
+
+I2C_Device_Snapshot::~I2C_Device_Snapshot()
+{
+}
+
+bool I2C_Device_Snapshot::load(string path)
+{
+	FILE *file = fopen(path.c_str(), "rb");
+	if (!file)
+	{
+		return false;
+	}
+	vector<uint8_t> buffer;
+	uint8_t block[4096];
+	size_t readSize = 0;
+	while ((readSize = fread(block, 1, sizeof(block), file)) > 0)
+	{
+		buffer.insert(buffer.end(), block, block + readSize);
+	}
+	fclose(file);
+
+	map<uint8_t, Entry> entries;
+	if (!decode(buffer, entries))
+	{
+		return false;
+	}
+	ScopeLock lock(m_lock);
+	m_entries.swap(entries);
+	return true;
+}
+
+bool I2C_Device_Snapshot::save(string path)
+{
+	vector<uint8_t> buffer(I2C_SNAPSHOT_MAGIC,
+			I2C_SNAPSHOT_MAGIC + strlen(I2C_SNAPSHOT_MAGIC));
+	buffer.push_back(I2C_SNAPSHOT_VERSION);
+	{
+		ScopeLock lock(m_lock);
+		uint64_t confirmedCount = 0;
+		for (map<uint8_t, Entry>::iterator entryItr = m_entries.begin();
+				entryItr != m_entries.end(); entryItr++)
+		{
+			confirmedCount += entryItr->second.m_isConfirmed ? 1 : 0;
+		}
+		I2C_Trace_Record::putVarint(buffer, confirmedCount);
+		for (map<uint8_t, Entry>::iterator entryItr = m_entries.begin();
+				entryItr != m_entries.end(); entryItr++)
+		{
+			if (!entryItr->second.m_isConfirmed)
+			{
+				continue;
+			}
+			I2C_Trace_Record::putVarint(buffer, entryItr->first);
+			I2C_Trace_Record::putVarint(buffer, entryItr->second.m_initHash);
+			I2C_Trace_Record::putVarint(buffer,
+					entryItr->second.m_signatureData.size());
+			for (size_t index = 0;
+					index < entryItr->second.m_signatureData.size(); index++)
+			{
+				putBytes(buffer, entryItr->second.m_signatureData[index]);
+			}
+		}
+	}
+	// Written aside and renamed so a crash mid-save leaves no torn snapshot
+	string tempPath = path + ".tmp";
+	FILE *file = fopen(tempPath.c_str(), "wb");
+	if (!file)
+	{
+		return false;
+	}
+	bool isWritten = fwrite(buffer.data(), 1, buffer.size(), file)
+			== buffer.size();
+	isWritten = (fclose(file) == 0) && isWritten;
+	if (!isWritten || (rename(tempPath.c_str(), path.c_str()) != 0))
+	{
+		::remove(tempPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool I2C_Device_Snapshot::isCurrent(const I2C_Device_Init &device)
+{
+	ScopeLock lock(m_lock);
+	map<uint8_t, Entry>::const_iterator entryItr = m_entries.find(
+			device.m_chipAddress);
+	return (entryItr != m_entries.end()) && !device.m_signature.empty()
+			&& (entryItr->second.m_initHash == device.getInitHash());
+}
+
+bool I2C_Device_Snapshot::verify(const I2C_Device_Init &device,
+		const vector<I2C_Message> &signature)
+{
+	ScopeLock lock(m_lock);
+	map<uint8_t, Entry>::iterator entryItr = m_entries.find(
+			device.m_chipAddress);
+	if ((entryItr == m_entries.end()) || signature.empty()
+			|| (entryItr->second.m_initHash != device.getInitHash())
+			|| (entryItr->second.m_signatureData.size() != signature.size()))
+	{
+		return false;
+	}
+	for (size_t index = 0; index < signature.size(); index++)
+	{
+		if (I2CError(signature[index].m_error).isError()
+				|| (signature[index].m_data
+						!= entryItr->second.m_signatureData[index]))
+		{
+			return false;
+		}
+	}
+	entryItr->second.m_isConfirmed = true;
+	m_warmCount++;
+	return true;
+}
+
+void I2C_Device_Snapshot::record(const I2C_Device_Init &device,
+		const vector<I2C_Message> &signature)
+{
+	Entry entry;
+	entry.m_initHash = device.getInitHash();
+	entry.m_isConfirmed = true;
+	for (size_t index = 0; index < signature.size(); index++)
+	{
+		entry.m_signatureData.push_back(signature[index].m_data);
+	}
+	ScopeLock lock(m_lock);
+	m_entries[device.m_chipAddress] = entry;
+}
+
+void I2C_Device_Snapshot::remove(uint8_t chipAddress)
+{
+	ScopeLock lock(m_lock);
+	m_entries.erase(chipAddress);
+}
+
+void I2C_Device_Snapshot::clear()
+{
+	ScopeLock lock(m_lock);
+	m_entries.clear();
+}
+
+size_t I2C_Device_Snapshot::size()
+{
+	ScopeLock lock(m_lock);
+	return m_entries.size();
+}
+
+uint64_t I2C_Device_Snapshot::getWarmCount()
+{
+	return m_warmCount;
+}
+
+uint64_t I2C_Device_Snapshot::getColdCount()
+{
+	return m_coldCount;
+}
+
+void I2C_Device_Snapshot::countCold()
+{
+	m_coldCount++;
+}
+
+bool I2C_Device_Snapshot::decode(const vector<uint8_t> &buffer,
+		map<uint8_t, Entry> &entries)
+{
+	size_t magicSize = strlen(I2C_SNAPSHOT_MAGIC);
+	if ((buffer.size() <= magicSize)
+			|| memcmp(buffer.data(), I2C_SNAPSHOT_MAGIC, magicSize)
+			|| (buffer[magicSize] != I2C_SNAPSHOT_VERSION))
+	{
+		return false;
+	}
+	size_t offset = magicSize + 1;
+	uint64_t deviceCount = 0;
+	if (!I2C_Trace_Record::getVarint(buffer, offset, deviceCount))
+	{
+		return false;
+	}
+	for (uint64_t device = 0; device < deviceCount; device++)
+	{
+		uint64_t chipAddress = 0;
+		uint64_t signatureCount = 0;
+		Entry entry;
+		entry.m_isConfirmed = false;
+		if (!I2C_Trace_Record::getVarint(buffer, offset, chipAddress)
+				|| (chipAddress > 0xFF)
+				|| !I2C_Trace_Record::getVarint(buffer, offset,
+						entry.m_initHash)
+				|| !I2C_Trace_Record::getVarint(buffer, offset,
+						signatureCount)
+				|| (signatureCount > buffer.size() - offset))
+		{
+			return false;
+		}
+		entry.m_signatureData.resize(signatureCount);
+		for (uint64_t index = 0; index < signatureCount; index++)
+		{
+			if (!getBytes(buffer, offset, entry.m_signatureData[index]))
+			{
+				return false;
+			}
+		}
+		entries[chipAddress] = entry;
+	}
+	return offset == buffer.size();
+}
+
+void I2C_Device_Snapshot::putBytes(vector<uint8_t> &buffer,
+		const vector<uint8_t> &bytes)
+{
+	I2C_Trace_Record::putVarint(buffer, bytes.size());
+	buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+}
+
+bool I2C_Device_Snapshot::getBytes(const vector<uint8_t> &buffer,
+		size_t &offset, vector<uint8_t> &bytes)
+{
+	uint64_t size = 0;
+	if (!I2C_Trace_Record::getVarint(buffer, offset, size)
+			|| (size > buffer.size() - offset))
+	{
+		return false;
+	}
+	bytes.assign(buffer.begin() + offset, buffer.begin() + offset + size);
+	offset += size;
+	return true;
+}
+
+} /* namespace apra */
@@ -0,0 +1,322 @@
+/*
+ * I2CEepromWriter.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <unistd.h>
+#include <algorithm>
+#include "utils/Macro.h"
+#include "utils/ScopeLock.h"
+#include "utils/Utils.h"
+#include "utils/I2CEepromWriter.h"
+
+namespace apra
+{
+
+I2C_Eeprom_Config::I2C_Eeprom_Config() :
+		m_chipAddress(0x50), m_addressBytes(2), m_pageSize(32), m_capacity(0), m_writeCycleTimeoutUsec(
+				10000), m_pollIntervalUsec(50), m_readChunkSize(
+				I2C_SMBUS_MAX_BLOCK_SIZE), m_verify(true)
+{
+}
+
+I2C_Eeprom_Config::I2C_Eeprom_Config(uint8_t chipAddress,
+		uint8_t addressBytes, uint64_t pageSize, uint64_t capacity) :
+		m_chipAddress(chipAddress), m_addressBytes(addressBytes), m_pageSize(
+				pageSize), m_capacity(capacity), m_writeCycleTimeoutUsec(10000), m_pollIntervalUsec(
+				50), m_readChunkSize(I2C_SMBUS_MAX_BLOCK_SIZE), m_verify(true)
+{
+}
+
+I2C_Eeprom_Config::~I2C_Eeprom_Config()
+{
+}
+
+I2C_Eeprom_Report::I2C_Eeprom_Report() :
+		m_bytesWritten(0), m_pageCount(0), m_pollCount(0), m_maxWriteCycleUsec(
+				0), m_writeTimeUsec(0), m_verifyTimeUsec(0), m_mismatchCount(0), m_firstMismatchAddress(
+				0)
+{
+}
+
+I2C_Eeprom_Report::~I2C_Eeprom_Report()
+{
+}
+
+double I2C_Eeprom_Report::getThroughputBytesPerSec() const
+{
+	int64_t totalUsec = m_writeTimeUsec + m_verifyTimeUsec;
+	if (totalUsec <= 0)
+	{
+		return 0;
+	}
+	return (m_bytesWritten * 1000000.0) / totalUsec;
+}
+
+I2C_Eeprom_Writer::I2C_Eeprom_Writer(I2C_Bus &bus, Mutex *busLock,
+		I2C_Mux_Topology *muxTopology) :
+		m_bus(bus), m_ownLock(), m_busLock(busLock ? busLock : &m_ownLock), m_muxTopology(
+				muxTopology), m_lastWriteTs(0)
+{
+}
+
+I2C_Eeprom_Writer::~I2C_Eeprom_Writer()
+{
+}
+
+I2CError I2C_Eeprom_Writer::write(const I2C_Eeprom_Config &config,
+		uint64_t address, const vector<uint8_t> &data,
+		I2C_Eeprom_Report &report)
+{
+	report = I2C_Eeprom_Report();
+	I2CError error = checkRange(config, address, data.size());
+	if (error.isError() || data.empty())
+	{
+		return error;
+	}
+	MONOCURRTIME(startTs);
+	m_lastWriteTs = 0;
+	vector<pair<uint64_t, size_t> > spans = getPageSpans(address,
+			data.size(), config.m_pageSize);
+	size_t offset = 0;
+	for (size_t index = 0; index < spans.size(); index++)
+	{
+		vector<uint8_t> page(data.begin() + offset,
+				data.begin() + offset + spans[index].second);
+		error = writePage(config, spans[index].first, page, report);
+		if (error.isError())
+		{
+			break;
+		}
+		offset += spans[index].second;
+		report.m_bytesWritten += spans[index].second;
+		report.m_pageCount++;
+	}
+	if (!error.isError())
+	{
+		error = waitWriteCycle(config, spans.back().first, report);
+	}
+	MONOCURRTIME(endTs);
+	report.m_writeTimeUsec = endTs - startTs;
+	if (!error.isError() && config.m_verify)
+	{
+		error = verify(config, address, data, report);
+	}
+	return error;
+}
+
+I2CError I2C_Eeprom_Writer::read(const I2C_Eeprom_Config &config,
+		uint64_t address, size_t size, vector<uint8_t> &data)
+{
+	data.clear();
+	I2CError error = checkRange(config, address, size);
+	if (error.isError())
+	{
+		return error;
+	}
+	uint64_t chunkSize =
+			config.m_readChunkSize ?
+					config.m_readChunkSize : I2C_SMBUS_MAX_BLOCK_SIZE;
+	uint64_t blockSize = getBlockSize(config);
+	data.reserve(size);
+	while (data.size() < size)
+	{
+		uint64_t chunkAddress = address + data.size();
+		uint64_t blockEnd = (chunkAddress / blockSize + 1) * blockSize;
+		uint64_t length = std::min<uint64_t>(chunkSize, size - data.size());
+		length = std::min<uint64_t>(length, blockEnd - chunkAddress);
+		vector<uint8_t> chunk;
+		{
+			ScopeLock lock(*m_busLock);
+			uint8_t chipAddress = getChipAddress(config, chunkAddress);
+			error = selectRoute(chipAddress);
+			if (!error.isError())
+			{
+				m_bus.setSize(config.m_addressBytes, length);
+				error = m_bus.genericRead(chipAddress,
+						getRegisterAddress(config, chunkAddress), chunk);
+			}
+		}
+		if (error.isError())
+		{
+			break;
+		}
+		chunk.resize(length, 0);
+		data.insert(data.end(), chunk.begin(), chunk.end());
+	}
+	return error;
+}
+
+I2CError I2C_Eeprom_Writer::verify(const I2C_Eeprom_Config &config,
+		uint64_t address, const vector<uint8_t> &data,
+		I2C_Eeprom_Report &report)
+{
+	MONOCURRTIME(startTs);
+	report.m_mismatchCount = 0;
+	vector<uint8_t> readBack;
+	I2CError error = read(config, address, data.size(), readBack);
+	if (!error.isError())
+	{
+		for (size_t index = 0; index < data.size(); index++)
+		{
+			if (readBack[index] != data[index])
+			{
+				if (!report.m_mismatchCount)
+				{
+					report.m_firstMismatchAddress = address + index;
+				}
+				report.m_mismatchCount++;
+			}
+		}
+		if (report.m_mismatchCount)
+		{
+			error = I2CError("EEPROM read-back differs from written data",
+					VERIFY_ERROR);
+		}
+	}
+	MONOCURRTIME(endTs);
+	report.m_verifyTimeUsec = endTs - startTs;
+	return error;
+}
+
+vector<pair<uint64_t, size_t> > I2C_Eeprom_Writer::getPageSpans(
+		uint64_t address, size_t size, uint64_t pageSize)
+{
+	vector<pair<uint64_t, size_t> > spans;
+	if (!pageSize)
+	{
+		return spans;
+	}
+	while (size)
+	{
+		uint64_t pageRemaining = pageSize - (address % pageSize);
+		size_t length = (size < pageRemaining) ? size : pageRemaining;
+		spans.push_back(make_pair(address, length));
+		address += length;
+		size -= length;
+	}
+	return spans;
+}
+
+I2CError I2C_Eeprom_Writer::checkRange(const I2C_Eeprom_Config &config,
+		uint64_t address, size_t size)
+{
+	if (!config.m_pageSize || !config.m_addressBytes
+			|| (config.m_addressBytes > 4))
+	{
+		return I2CError("Invalid EEPROM page size or address width",
+				WRITE_ERROR);
+	}
+	if (config.m_capacity && (address + size > config.m_capacity))
+	{
+		return I2CError("EEPROM access beyond device capacity", WRITE_ERROR);
+	}
+	return I2CError();
+}
+
+I2CError I2C_Eeprom_Writer::writePage(const I2C_Eeprom_Config &config,
+		uint64_t address, const vector<uint8_t> &data,
+		I2C_Eeprom_Report &report)
+{
+	MONOCURRTIME(startTs);
+	while (true)
+	{
+		I2CError error = transfer(config, address, data);
+		MONOCURRTIME(timeNow);
+		if (!error.isError())
+		{
+			if (m_lastWriteTs
+					&& (uint64_t) (timeNow - m_lastWriteTs)
+							> report.m_maxWriteCycleUsec)
+			{
+				report.m_maxWriteCycleUsec = timeNow - m_lastWriteTs;
+			}
+			m_lastWriteTs = timeNow;
+			return error;
+		}
+		if ((uint64_t) (timeNow - startTs) >= config.m_writeCycleTimeoutUsec)
+		{
+			return error;
+		}
+		report.m_pollCount++;
+		if (config.m_pollIntervalUsec)
+		{
+			usleep(config.m_pollIntervalUsec);
+		}
+	}
+}
+
+I2CError I2C_Eeprom_Writer::waitWriteCycle(const I2C_Eeprom_Config &config,
+		uint64_t address, I2C_Eeprom_Report &report)
+{
+	// An address-only write is acknowledged once the write cycle is over
+	return writePage(config, address, vector<uint8_t>(), report);
+}
+
+I2CError I2C_Eeprom_Writer::transfer(const I2C_Eeprom_Config &config,
+		uint64_t address, const vector<uint8_t> &data)
+{
+	ScopeLock lock(*m_busLock);
+	uint8_t chipAddress = getChipAddress(config, address);
+	I2CError error = selectRoute(chipAddress);
+	if (error.isError())
+	{
+		return error;
+	}
+	m_bus.setSize(config.m_addressBytes, data.size());
+	return m_bus.genericWrite(chipAddress, getRegisterAddress(config, address),
+			data);
+}
+
+I2CError I2C_Eeprom_Writer::selectRoute(uint8_t chipAddress)
+{
+	// A busy chip NACKs every poll, so a failed transfer keeps the channel
+	if (!m_muxTopology)
+	{
+		return I2CError();
+	}
+	return m_muxTopology->select(chipAddress, m_bus);
+}
+
+vector<uint8_t> I2C_Eeprom_Writer::getChipAddresses(
+		const I2C_Eeprom_Config &config, uint64_t address, size_t size)
+{
+	vector<uint8_t> chipAddresses;
+	if (!size)
+	{
+		return chipAddresses;
+	}
+	uint64_t blockSize = getBlockSize(config);
+	for (uint64_t block = address / blockSize;
+			block <= (address + size - 1) / blockSize; block++)
+	{
+		chipAddresses.push_back(getChipAddress(config, block * blockSize));
+	}
+	return chipAddresses;
+}
+
+uint8_t I2C_Eeprom_Writer::getChipAddress(const I2C_Eeprom_Config &config,
+		uint64_t address)
+{
+	return config.m_chipAddress | (address / getBlockSize(config));
+}
+
+vector<uint8_t> I2C_Eeprom_Writer::getRegisterAddress(
+		const I2C_Eeprom_Config &config, uint64_t address)
+{
+	return Utils::extractBytes(address % getBlockSize(config),
+			config.m_addressBytes);
+}
+
+uint64_t I2C_Eeprom_Writer::getBlockSize(const I2C_Eeprom_Config &config)
+{
+	return 1ULL << (8 * config.m_addressBytes);
+}
+
+} /* namespace apra */
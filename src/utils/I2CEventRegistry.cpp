@@ -0,0 +1,80 @@
+/*
+ * I2CEventRegistry.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include "utils/ScopeLock.h"
+#include "utils/I2CEventRegistry.h"
+
+namespace apra
+{
+
+I2C_Event_Registry::I2C_Event_Registry() :
+		m_writeLock(), m_snapshot(make_shared<const I2C_Event_Map>()), m_version(
+				0)
+{
+}
+
+I2C_Event_Registry::~I2C_Event_Registry()
+{
+}
+
+uint64_t I2C_Event_Registry::add(const I2C_Transaction_Message &message,
+		shared_ptr<I2C_Sample_Ring> sampleRing)
+{
+	return add(make_shared<I2C_Registered_Event>(message, sampleRing));
+}
+
+uint64_t I2C_Event_Registry::add(shared_ptr<I2C_Registered_Event> event)
+{
+	uint64_t handle = event->m_message.getHandle();
+	ScopeLock lock(m_writeLock);
+	shared_ptr<I2C_Event_Map> snapshot = make_shared<I2C_Event_Map>(
+			*std::atomic_load(&m_snapshot));
+	(*snapshot)[handle] = event;
+	publish(snapshot);
+	return handle;
+}
+
+bool I2C_Event_Registry::remove(uint64_t handle)
+{
+	ScopeLock lock(m_writeLock);
+	shared_ptr<const I2C_Event_Map> current = std::atomic_load(&m_snapshot);
+	if (current->find(handle) == current->end())
+	{
+		return false;
+	}
+	shared_ptr<I2C_Event_Map> snapshot = make_shared<I2C_Event_Map>(*current);
+	snapshot->erase(handle);
+	publish(snapshot);
+	return true;
+}
+
+shared_ptr<const I2C_Event_Map> I2C_Event_Registry::getSnapshot()
+{
+	return std::atomic_load(&m_snapshot);
+}
+
+uint64_t I2C_Event_Registry::getVersion()
+{
+	return m_version.load(std::memory_order_acquire);
+}
+
+size_t I2C_Event_Registry::size()
+{
+	return std::atomic_load(&m_snapshot)->size();
+}
+
+void I2C_Event_Registry::publish(shared_ptr<const I2C_Event_Map> snapshot)
+{
+	std::atomic_store(&m_snapshot, snapshot);
+	m_version.fetch_add(1, std::memory_order_release);
+}
+
+} /* namespace apra */
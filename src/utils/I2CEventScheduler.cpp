@@ -0,0 +1,164 @@
+/*
+ * I2CEventScheduler.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <algorithm>
+#include "utils/I2CEventScheduler.h"
+
+namespace apra
+{
+
+bool I2C_Event_Scheduler::EntryCompare::operator()(const Entry &first,
+		const Entry &second) const
+{
+	if (first.m_deadline != second.m_deadline)
+	{
+		return first.m_deadline > second.m_deadline;
+	}
+	return first.m_handle > second.m_handle;
+}
+
+I2C_Event_Scheduler::I2C_Event_Scheduler() :
+		m_heap(), m_generations(), m_generationCounter(0)
+{
+}
+
+I2C_Event_Scheduler::~I2C_Event_Scheduler()
+{
+}
+
+void I2C_Event_Scheduler::schedule(uint64_t handle, int64_t deadline)
+{
+	Entry entry;
+	entry.m_deadline = deadline;
+	entry.m_handle = handle;
+	entry.m_generation = ++m_generationCounter;
+	m_generations[handle] = entry.m_generation;
+	m_heap.push_back(entry);
+	std::push_heap(m_heap.begin(), m_heap.end(), EntryCompare());
+}
+
+void I2C_Event_Scheduler::remove(uint64_t handle)
+{
+	m_generations.erase(handle);
+	if (m_generations.empty())
+	{
+		m_heap.clear();
+	}
+}
+
+bool I2C_Event_Scheduler::popDue(int64_t timeNow, uint64_t &handle,
+		int64_t &deadline)
+{
+	discardStale();
+	if (m_heap.empty() || (m_heap.front().m_deadline > timeNow))
+	{
+		return false;
+	}
+	handle = m_heap.front().m_handle;
+	deadline = m_heap.front().m_deadline;
+	std::pop_heap(m_heap.begin(), m_heap.end(), EntryCompare());
+	m_heap.pop_back();
+	m_generations.erase(handle);
+	return true;
+}
+
+bool I2C_Event_Scheduler::isDue(int64_t timeNow)
+{
+	discardStale();
+	return !m_heap.empty() && (m_heap.front().m_deadline <= timeNow);
+}
+
+bool I2C_Event_Scheduler::getNextDeadline(int64_t &deadline)
+{
+	discardStale();
+	if (m_heap.empty())
+	{
+		return false;
+	}
+	deadline = m_heap.front().m_deadline;
+	return true;
+}
+
+size_t I2C_Event_Scheduler::size()
+{
+	return m_generations.size();
+}
+
+void I2C_Event_Scheduler::clear()
+{
+	m_heap.clear();
+	m_generations.clear();
+}
+
+int64_t I2C_Event_Scheduler::getFirstDeadline(int64_t epoch, int64_t timeNow,
+		uint64_t periodUsec, uint64_t phaseUsec)
+{
+	if (!periodUsec)
+	{
+		return timeNow + phaseUsec;
+	}
+	int64_t period = periodUsec;
+	int64_t deadline = epoch + (phaseUsec % periodUsec);
+	if (deadline < timeNow)
+	{
+		deadline += ((timeNow - deadline + period - 1) / period) * period;
+	}
+	return deadline;
+}
+
+int64_t I2C_Event_Scheduler::getNextDeadline(int64_t lastDeadline,
+		int64_t timeNow, uint64_t periodUsec)
+{
+	if (!periodUsec)
+	{
+		return timeNow + 1;
+	}
+	int64_t period = periodUsec;
+	int64_t deadline = lastDeadline + period;
+	if (deadline <= timeNow)
+	{
+		deadline += ((timeNow - deadline) / period + 1) * period;
+	}
+	return deadline;
+}
+
+uint64_t I2C_Event_Scheduler::getAdaptivePeriod(uint64_t periodUsec,
+		bool isChanging, uint64_t minPeriodUsec, uint64_t maxPeriodUsec)
+{
+	if (isChanging)
+	{
+		periodUsec /= I2C_ADAPTIVE_SPEEDUP_DIVISOR;
+	}
+	else
+	{
+		periodUsec += std::max<uint64_t>(
+				periodUsec / I2C_ADAPTIVE_BACKOFF_DIVISOR, 1);
+	}
+	return std::min(std::max(periodUsec, minPeriodUsec), maxPeriodUsec);
+}
+
+void I2C_Event_Scheduler::discardStale()
+{
+	while (!m_heap.empty())
+	{
+		map<uint64_t, uint64_t>::iterator generationItr = m_generations.find(
+				m_heap.front().m_handle);
+		if ((generationItr != m_generations.end())
+				&& (generationItr->second == m_heap.front().m_generation))
+		{
+			break;
+		}
+		std::pop_heap(m_heap.begin(), m_heap.end(), EntryCompare());
+		m_heap.pop_back();
+	}
+}
+
+} /* namespace apra */
@@ -0,0 +1,178 @@
+/*
+ * I2CMuxTopology.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include "utils/I2CMuxTopology.h"
+
+namespace apra
+{
+
+I2C_Mux_Route::I2C_Mux_Route() :
+		m_muxAddress(0), m_channel(0)
+{
+}
+
+I2C_Mux_Route::I2C_Mux_Route(uint8_t muxAddress, uint8_t channel) :
+		m_muxAddress(muxAddress), m_channel(channel)
+{
+}
+
+I2C_Mux_Route::~I2C_Mux_Route()
+{
+}
+
+I2C_Mux_Topology::I2C_Mux_Topology() :
+		m_routes(), m_selectedChannels(), m_selectCount(0), m_skippedCount(0)
+{
+}
+
+I2C_Mux_Topology::~I2C_Mux_Topology()
+{
+}
+
+bool I2C_Mux_Topology::addDevice(uint8_t chipAddress, uint8_t muxAddress,
+		uint8_t channel)
+{
+	if (channel >= I2C_MUX_CHANNEL_COUNT)
+	{
+		return false;
+	}
+	// Refuse routes that would make a mux sit behind itself
+	for (uint8_t upstream = muxAddress;;)
+	{
+		if (upstream == chipAddress)
+		{
+			return false;
+		}
+		map<uint8_t, I2C_Mux_Route>::const_iterator routeItr = m_routes.find(
+				upstream);
+		if (routeItr == m_routes.end())
+		{
+			break;
+		}
+		upstream = routeItr->second.m_muxAddress;
+	}
+	m_routes[chipAddress] = I2C_Mux_Route(muxAddress, channel);
+	if (m_selectedChannels.find(muxAddress) == m_selectedChannels.end())
+	{
+		m_selectedChannels[muxAddress] = I2C_MUX_UNKNOWN_CHANNEL;
+	}
+	return true;
+}
+
+void I2C_Mux_Topology::removeDevice(uint8_t chipAddress)
+{
+	m_routes.erase(chipAddress);
+}
+
+bool I2C_Mux_Topology::isRouted(uint8_t chipAddress) const
+{
+	return m_routes.find(chipAddress) != m_routes.end();
+}
+
+bool I2C_Mux_Topology::isSelected(uint8_t chipAddress) const
+{
+	map<uint8_t, I2C_Mux_Route>::const_iterator routeItr = m_routes.find(
+			chipAddress);
+	if (routeItr == m_routes.end())
+	{
+		return true;
+	}
+	map<uint8_t, int32_t>::const_iterator selectedItr =
+			m_selectedChannels.find(routeItr->second.m_muxAddress);
+	return (selectedItr != m_selectedChannels.end())
+			&& (selectedItr->second == routeItr->second.m_channel)
+			&& isSelected(routeItr->second.m_muxAddress);
+}
+
+int32_t I2C_Mux_Topology::getGroup(uint8_t chipAddress) const
+{
+	map<uint8_t, I2C_Mux_Route>::const_iterator routeItr = m_routes.find(
+			chipAddress);
+	if (routeItr == m_routes.end())
+	{
+		return -1;
+	}
+	return (routeItr->second.m_muxAddress << 8) | routeItr->second.m_channel;
+}
+
+I2CError I2C_Mux_Topology::select(uint8_t chipAddress, I2C_Bus &bus)
+{
+	map<uint8_t, I2C_Mux_Route>::const_iterator routeItr = m_routes.find(
+			chipAddress);
+	if (routeItr == m_routes.end())
+	{
+		return I2CError();
+	}
+	const I2C_Mux_Route &route = routeItr->second;
+	I2CError error = select(route.m_muxAddress, bus);
+	if (error.isError())
+	{
+		return error;
+	}
+	int32_t &selectedChannel = m_selectedChannels[route.m_muxAddress];
+	if (selectedChannel == route.m_channel)
+	{
+		m_skippedCount.fetch_add(1, std::memory_order_relaxed);
+		return error;
+	}
+	m_selectCount.fetch_add(1, std::memory_order_relaxed);
+	bus.setSize(1, 0);
+	error = bus.genericWrite(route.m_muxAddress,
+			vector<uint8_t>(1, getControlByte(route.m_channel)),
+			vector<uint8_t>());
+	if (error.isError())
+	{
+		selectedChannel = I2C_MUX_UNKNOWN_CHANNEL;
+		return I2CError("Unable to select I2C mux channel",
+				error.getDebugMessage(), MUX_SELECT_ERROR);
+	}
+	selectedChannel = route.m_channel;
+	return error;
+}
+
+void I2C_Mux_Topology::invalidate()
+{
+	for (map<uint8_t, int32_t>::iterator selectedItr =
+			m_selectedChannels.begin(); selectedItr != m_selectedChannels.end();
+			selectedItr++)
+	{
+		selectedItr->second = I2C_MUX_UNKNOWN_CHANNEL;
+	}
+}
+
+void I2C_Mux_Topology::invalidate(uint8_t chipAddress)
+{
+	map<uint8_t, I2C_Mux_Route>::const_iterator routeItr = m_routes.find(
+			chipAddress);
+	if (routeItr != m_routes.end())
+	{
+		m_selectedChannels[routeItr->second.m_muxAddress] =
+				I2C_MUX_UNKNOWN_CHANNEL;
+	}
+}
+
+uint64_t I2C_Mux_Topology::getSelectCount()
+{
+	return m_selectCount.load(std::memory_order_relaxed);
+}
+
+uint64_t I2C_Mux_Topology::getSkippedCount()
+{
+	return m_skippedCount.load(std::memory_order_relaxed);
+}
+
+uint8_t I2C_Mux_Topology::getControlByte(uint8_t channel)
+{
+	// PCA9543/9546/9548: one enable bit per channel
+	return 1 << channel;
+}
+
+} /* namespace apra */
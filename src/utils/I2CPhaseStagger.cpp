@@ -0,0 +1,169 @@
+/*
+ * I2CPhaseStagger.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <algorithm>
+#include "utils/I2CPhaseStagger.h"
+#include "utils/ScopeLock.h"
+
+namespace apra
+{
+
+I2C_Phase_Stagger::I2C_Phase_Stagger(uint64_t slotUsec) :
+		m_slotUsec(slotUsec ? slotUsec : 1), m_loads(), m_timeline()
+{
+}
+
+I2C_Phase_Stagger::~I2C_Phase_Stagger()
+{
+}
+
+uint64_t I2C_Phase_Stagger::assign(uint64_t handle, uint64_t periodUsec,
+		uint64_t costUsec)
+{
+	ScopeLock lock(m_lock);
+	m_loads.erase(handle);
+	uint64_t periodSlots = getPeriodSlots(periodUsec);
+	uint64_t slotCount = getHyperperiodSlots(periodSlots);
+	fillTimeline(slotCount);
+	// Lowest peak first, then lowest total, then the earliest phase
+	uint64_t bestSlot = 0;
+	uint64_t bestPeak = UINT64_MAX;
+	uint64_t bestTotal = UINT64_MAX;
+	uint64_t phaseCount = std::min(periodSlots, slotCount);
+	for (uint64_t phaseSlot = 0; phaseSlot < phaseCount; phaseSlot++)
+	{
+		uint64_t peak = 0;
+		uint64_t total = 0;
+		for (uint64_t slot = phaseSlot; slot < slotCount; slot += periodSlots)
+		{
+			peak = std::max(peak, m_timeline[slot]);
+			total += m_timeline[slot];
+		}
+		if ((peak < bestPeak) || ((peak == bestPeak) && (total < bestTotal)))
+		{
+			bestSlot = phaseSlot;
+			bestPeak = peak;
+			bestTotal = total;
+		}
+	}
+	Load load;
+	load.m_periodSlots = periodSlots;
+	load.m_phaseSlot = bestSlot;
+	load.m_costUsec = std::max<uint64_t>(costUsec, 1);
+	m_loads[handle] = load;
+	return bestSlot * m_slotUsec;
+}
+
+void I2C_Phase_Stagger::reserve(uint64_t handle, uint64_t periodUsec,
+		uint64_t phaseUsec, uint64_t costUsec)
+{
+	ScopeLock lock(m_lock);
+	Load load;
+	load.m_periodSlots = getPeriodSlots(periodUsec);
+	load.m_phaseSlot = (phaseUsec / m_slotUsec) % load.m_periodSlots;
+	load.m_costUsec = std::max<uint64_t>(costUsec, 1);
+	m_loads[handle] = load;
+}
+
+void I2C_Phase_Stagger::remove(uint64_t handle)
+{
+	ScopeLock lock(m_lock);
+	m_loads.erase(handle);
+}
+
+bool I2C_Phase_Stagger::getPhase(uint64_t handle, uint64_t &phaseUsec)
+{
+	ScopeLock lock(m_lock);
+	map<uint64_t, Load>::const_iterator loadItr = m_loads.find(handle);
+	if (loadItr == m_loads.end())
+	{
+		return false;
+	}
+	phaseUsec = loadItr->second.m_phaseSlot * m_slotUsec;
+	return true;
+}
+
+uint64_t I2C_Phase_Stagger::getPeakLoadUsec()
+{
+	ScopeLock lock(m_lock);
+	fillTimeline(getHyperperiodSlots(1));
+	uint64_t peak = 0;
+	for (size_t slot = 0; slot < m_timeline.size(); slot++)
+	{
+		peak = std::max(peak, m_timeline[slot]);
+	}
+	return peak;
+}
+
+void I2C_Phase_Stagger::clear()
+{
+	ScopeLock lock(m_lock);
+	m_loads.clear();
+}
+
+uint64_t I2C_Phase_Stagger::getPeriodSlots(uint64_t periodUsec)
+{
+	return std::max<uint64_t>(periodUsec / m_slotUsec, 1);
+}
+
+uint64_t I2C_Phase_Stagger::getHyperperiodSlots(uint64_t periodSlots)
+{
+	if (periodSlots > I2C_STAGGER_MAX_SLOTS)
+	{
+		// A long period is placed within the other events' hyperperiod
+		return getHyperperiodSlots(1);
+	}
+	uint64_t slotCount = periodSlots;
+	for (map<uint64_t, Load>::const_iterator loadItr = m_loads.begin();
+			loadItr != m_loads.end(); loadItr++)
+	{
+		uint64_t first = slotCount;
+		uint64_t second = loadItr->second.m_periodSlots;
+		while (second)
+		{
+			uint64_t remainder = first % second;
+			first = second;
+			second = remainder;
+		}
+		if (loadItr->second.m_periodSlots > I2C_STAGGER_MAX_SLOTS)
+		{
+			slotCount = UINT64_MAX;
+		}
+		else
+		{
+			slotCount = (slotCount / first) * loadItr->second.m_periodSlots;
+		}
+		if (slotCount > I2C_STAGGER_MAX_SLOTS)
+		{
+			// Past the cap the timeline is only an approximation
+			return (I2C_STAGGER_MAX_SLOTS / periodSlots) * periodSlots;
+		}
+	}
+	return slotCount;
+}
+
+void I2C_Phase_Stagger::fillTimeline(uint64_t slotCount)
+{
+	m_timeline.assign(slotCount, 0);
+	for (map<uint64_t, Load>::const_iterator loadItr = m_loads.begin();
+			loadItr != m_loads.end(); loadItr++)
+	{
+		const Load &load = loadItr->second;
+		// Releases past the end of the timeline wrap around onto it
+		for (uint64_t slot = load.m_phaseSlot % slotCount; slot < slotCount;
+				slot += load.m_periodSlots)
+		{
+			m_timeline[slot] += load.m_costUsec;
+		}
+	}
+}
+
+} /* namespace apra */
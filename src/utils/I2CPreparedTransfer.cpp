@@ -0,0 +1,72 @@
+/*
+ * I2CPreparedTransfer.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <string.h>
+#include "utils/I2CPreparedTransfer.h"
+
+namespace apra
+{
+
+I2C_Prepared_Transfer::I2C_Prepared_Transfer() :
+		m_generation(0), m_chipAddress(0), m_isRead(false), m_smbusTransaction(
+				-1), m_dataSize(0), m_registerAddress(), m_buffer(), m_messageCount(
+				0)
+{
+	memset(m_messages, 0, sizeof(m_messages));
+}
+
+I2C_Prepared_Transfer::I2C_Prepared_Transfer(
+		const I2C_Prepared_Transfer &other) :
+		m_generation(other.m_generation), m_chipAddress(other.m_chipAddress), m_isRead(
+				other.m_isRead), m_smbusTransaction(other.m_smbusTransaction), m_dataSize(
+				other.m_dataSize), m_registerAddress(other.m_registerAddress), m_buffer(
+				other.m_buffer), m_messageCount(other.m_messageCount)
+{
+	memcpy(m_messages, other.m_messages, sizeof(m_messages));
+	bindMessages();
+}
+
+I2C_Prepared_Transfer::~I2C_Prepared_Transfer()
+{
+}
+
+I2C_Prepared_Transfer& I2C_Prepared_Transfer::operator=(
+		const I2C_Prepared_Transfer &other)
+{
+	if (this != &other)
+	{
+		m_generation = other.m_generation;
+		m_chipAddress = other.m_chipAddress;
+		m_isRead = other.m_isRead;
+		m_smbusTransaction = other.m_smbusTransaction;
+		m_dataSize = other.m_dataSize;
+		m_registerAddress = other.m_registerAddress;
+		m_buffer = other.m_buffer;
+		m_messageCount = other.m_messageCount;
+		memcpy(m_messages, other.m_messages, sizeof(m_messages));
+		bindMessages();
+	}
+	return *this;
+}
+
+bool I2C_Prepared_Transfer::isPrepared() const
+{
+	return m_generation != 0;
+}
+
+void I2C_Prepared_Transfer::bindMessages()
+{
+	// The messages point into m_buffer: register bytes first, then data
+	m_messages[0].buf = m_buffer.data();
+	m_messages[1].buf = m_buffer.data() + m_registerAddress.size();
+}
+
+} /* namespace apra */
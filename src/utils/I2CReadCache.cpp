@@ -0,0 +1,149 @@
+/*
+ * I2CReadCache.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include "utils/I2CReadCache.h"
+#include "utils/ScopeLock.h"
+
+namespace apra
+{
+
+I2C_Read_Cache::I2C_Read_Cache() :
+		m_freshnessUsec(0), m_entries(), m_hitCount(0), m_missCount(0)
+{
+}
+
+I2C_Read_Cache::~I2C_Read_Cache()
+{
+}
+
+void I2C_Read_Cache::setFreshness(uint64_t freshnessUsec)
+{
+	ScopeLock lock(m_lock);
+	m_freshnessUsec = freshnessUsec;
+}
+
+uint64_t I2C_Read_Cache::getFreshness()
+{
+	ScopeLock lock(m_lock);
+	return m_freshnessUsec;
+}
+
+bool I2C_Read_Cache::lookup(uint8_t chipNumber,
+		const vector<uint8_t> &registerNumber, uint64_t dataSize,
+		int64_t requestTs, int64_t timeNow, vector<uint8_t> &data)
+{
+	ScopeLock lock(m_lock);
+	Key key;
+	key.m_chipNumber = chipNumber;
+	key.m_registerNumber = registerNumber;
+	key.m_dataSize = dataSize;
+	map<Key, Entry>::const_iterator entryItr = m_entries.find(key);
+	if ((entryItr == m_entries.end())
+			|| ((entryItr->second.m_readTs < requestTs)
+					&& (timeNow - entryItr->second.m_readTs
+							> (int64_t) m_freshnessUsec)))
+	{
+		m_missCount++;
+		return false;
+	}
+	data = entryItr->second.m_data;
+	m_hitCount++;
+	return true;
+}
+
+void I2C_Read_Cache::store(uint8_t chipNumber,
+		const vector<uint8_t> &registerNumber, const vector<uint8_t> &data,
+		int64_t readTs)
+{
+	ScopeLock lock(m_lock);
+	if (m_entries.size() >= I2C_READ_CACHE_MAX_ENTRIES)
+	{
+		evictExpired(readTs);
+	}
+	Key key;
+	key.m_chipNumber = chipNumber;
+	key.m_registerNumber = registerNumber;
+	key.m_dataSize = data.size();
+	Entry &entry = m_entries[key];
+	entry.m_readTs = readTs;
+	entry.m_data = data;
+}
+
+void I2C_Read_Cache::invalidate()
+{
+	ScopeLock lock(m_lock);
+	m_entries.clear();
+}
+
+void I2C_Read_Cache::invalidate(uint8_t chipNumber)
+{
+	ScopeLock lock(m_lock);
+	Key key;
+	key.m_chipNumber = chipNumber;
+	key.m_dataSize = 0;
+	map<Key, Entry>::iterator entryItr = m_entries.lower_bound(key);
+	while ((entryItr != m_entries.end())
+			&& (entryItr->first.m_chipNumber == chipNumber))
+	{
+		m_entries.erase(entryItr++);
+	}
+}
+
+size_t I2C_Read_Cache::size()
+{
+	ScopeLock lock(m_lock);
+	return m_entries.size();
+}
+
+uint64_t I2C_Read_Cache::getHitCount()
+{
+	return m_hitCount;
+}
+
+uint64_t I2C_Read_Cache::getMissCount()
+{
+	return m_missCount;
+}
+
+void I2C_Read_Cache::evictExpired(int64_t timeNow)
+{
+	map<Key, Entry>::iterator entryItr = m_entries.begin();
+	while (entryItr != m_entries.end())
+	{
+		if (timeNow - entryItr->second.m_readTs > (int64_t) m_freshnessUsec)
+		{
+			m_entries.erase(entryItr++);
+		}
+		else
+		{
+			entryItr++;
+		}
+	}
+	if (m_entries.size() >= I2C_READ_CACHE_MAX_ENTRIES)
+	{
+		m_entries.clear();
+	}
+}
+
+bool I2C_Read_Cache::Key::operator<(const Key &other) const
+{
+	if (m_chipNumber != other.m_chipNumber)
+	{
+		return m_chipNumber < other.m_chipNumber;
+	}
+	if (m_registerNumber != other.m_registerNumber)
+	{
+		return m_registerNumber < other.m_registerNumber;
+	}
+	return m_dataSize < other.m_dataSize;
+}
+
+} /* namespace apra */
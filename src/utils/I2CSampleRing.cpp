@@ -0,0 +1,238 @@
+/*
+ * I2CSampleRing.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <algorithm>
+#include "utils/I2CSampleRing.h"
+
+namespace apra
+{
+
+I2C_Sample_Channel::I2C_Sample_Channel() :
+		m_messageIndex(0), m_byteOrder(I2C_BIG_ENDIAN), m_isSigned(false)
+{
+}
+
+I2C_Sample_Channel::I2C_Sample_Channel(size_t messageIndex,
+		I2C_BYTE_ORDER byteOrder, bool isSigned) :
+		m_messageIndex(messageIndex), m_byteOrder(byteOrder), m_isSigned(
+				isSigned)
+{
+}
+
+I2C_Sample_Channel::~I2C_Sample_Channel()
+{
+}
+
+I2C_Sample_Batch::I2C_Sample_Batch() :
+		m_timestamps(), m_values()
+{
+}
+
+I2C_Sample_Batch::I2C_Sample_Batch(size_t capacity, size_t channelCount) :
+		m_timestamps(), m_values(channelCount)
+{
+	m_timestamps.reserve(capacity);
+	for (size_t channel = 0; channel < channelCount; channel++)
+	{
+		m_values[channel].reserve(capacity);
+	}
+}
+
+I2C_Sample_Batch::~I2C_Sample_Batch()
+{
+}
+
+size_t I2C_Sample_Batch::size() const
+{
+	return m_timestamps.size();
+}
+
+I2C_Sample_Ring::I2C_Sample_Ring(size_t capacity,
+		const vector<I2C_Sample_Channel> &channels) :
+		m_channels(channels), m_capacity(1), m_mask(0), m_timestamps(), m_values(), m_head(
+				0), m_tail(0), m_overrunCount(0), m_errorCount(0)
+{
+	while (m_capacity < capacity)
+	{
+		m_capacity <<= 1;
+	}
+	m_mask = m_capacity - 1;
+	m_timestamps.resize(m_capacity, 0);
+	m_values.resize(m_capacity * m_channels.size(), 0);
+}
+
+I2C_Sample_Ring::~I2C_Sample_Ring()
+{
+}
+
+bool I2C_Sample_Ring::push(int64_t timestampUsec, const int64_t *values)
+{
+	size_t slot = 0;
+	if (!reserveSlot(slot))
+	{
+		return false;
+	}
+	m_timestamps[slot] = timestampUsec;
+	for (size_t channel = 0; channel < m_channels.size(); channel++)
+	{
+		m_values[channel * m_capacity + slot] = values[channel];
+	}
+	commitSlot();
+	return true;
+}
+
+bool I2C_Sample_Ring::record(int64_t timestampUsec,
+		I2C_Transaction_Message &message)
+{
+	if (message.getError().isError())
+	{
+		m_errorCount.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	size_t slot = 0;
+	if (!reserveSlot(slot))
+	{
+		return false;
+	}
+	m_timestamps[slot] = timestampUsec;
+	for (size_t channel = 0; channel < m_channels.size(); channel++)
+	{
+		const I2C_Sample_Channel &sampleChannel = m_channels[channel];
+		m_values[channel * m_capacity + slot] =
+				(sampleChannel.m_messageIndex < message.m_messages.size()) ?
+						decode(
+								message.m_messages[sampleChannel.m_messageIndex].m_data,
+								sampleChannel.m_byteOrder,
+								sampleChannel.m_isSigned) :
+						0;
+	}
+	commitSlot();
+	return true;
+}
+
+size_t I2C_Sample_Ring::read(I2C_Sample_Batch &batch, size_t maxSamples)
+{
+	size_t head = m_head.load(std::memory_order_relaxed);
+	size_t count = std::min(maxSamples,
+			m_tail.load(std::memory_order_acquire) - head);
+	batch.m_timestamps.resize(count);
+	batch.m_values.resize(m_channels.size());
+	copyColumn(m_timestamps.data(), head, count, batch.m_timestamps.data());
+	for (size_t channel = 0; channel < m_channels.size(); channel++)
+	{
+		batch.m_values[channel].resize(count);
+		copyColumn(m_values.data() + channel * m_capacity, head, count,
+				batch.m_values[channel].data());
+	}
+	m_head.store(head + count, std::memory_order_release);
+	return count;
+}
+
+size_t I2C_Sample_Ring::read(int64_t *timestamps, int64_t *values,
+		size_t maxSamples)
+{
+	// values is laid out column by column, maxSamples entries per channel
+	size_t head = m_head.load(std::memory_order_relaxed);
+	size_t count = std::min(maxSamples,
+			m_tail.load(std::memory_order_acquire) - head);
+	copyColumn(m_timestamps.data(), head, count, timestamps);
+	for (size_t channel = 0; channel < m_channels.size(); channel++)
+	{
+		copyColumn(m_values.data() + channel * m_capacity, head, count,
+				values + channel * maxSamples);
+	}
+	m_head.store(head + count, std::memory_order_release);
+	return count;
+}
+
+size_t I2C_Sample_Ring::size() const
+{
+	return m_tail.load(std::memory_order_acquire)
+			- m_head.load(std::memory_order_acquire);
+}
+
+size_t I2C_Sample_Ring::capacity() const
+{
+	return m_capacity;
+}
+
+size_t I2C_Sample_Ring::getChannelCount() const
+{
+	return m_channels.size();
+}
+
+const vector<I2C_Sample_Channel>& I2C_Sample_Ring::getChannels() const
+{
+	return m_channels;
+}
+
+uint64_t I2C_Sample_Ring::getSampleCount() const
+{
+	return m_tail.load(std::memory_order_acquire);
+}
+
+uint64_t I2C_Sample_Ring::getOverrunCount() const
+{
+	return m_overrunCount.load(std::memory_order_relaxed);
+}
+
+uint64_t I2C_Sample_Ring::getErrorCount() const
+{
+	return m_errorCount.load(std::memory_order_relaxed);
+}
+
+int64_t I2C_Sample_Ring::decode(const vector<uint8_t> &data,
+		I2C_BYTE_ORDER byteOrder, bool isSigned)
+{
+	size_t size = std::min<size_t>(data.size(), 8);
+	uint64_t value = 0;
+	for (size_t index = 0; index < size; index++)
+	{
+		uint8_t byte =
+				(byteOrder == I2C_BIG_ENDIAN) ?
+						data[index] : data[size - 1 - index];
+		value = (value << 8) | byte;
+	}
+	if (isSigned && size && (size < 8) && (value >> (size * 8 - 1)))
+	{
+		value |= ~0ULL << (size * 8);
+	}
+	return (int64_t) value;
+}
+
+bool I2C_Sample_Ring::reserveSlot(size_t &slot)
+{
+	size_t tail = m_tail.load(std::memory_order_relaxed);
+	if ((tail - m_head.load(std::memory_order_acquire)) >= m_capacity)
+	{
+		m_overrunCount.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	slot = tail & m_mask;
+	return true;
+}
+
+void I2C_Sample_Ring::commitSlot()
+{
+	m_tail.store(m_tail.load(std::memory_order_relaxed) + 1,
+			std::memory_order_release);
+}
+
+void I2C_Sample_Ring::copyColumn(const int64_t *column, size_t head,
+		size_t count, int64_t *output)
+{
+	size_t first = head & m_mask;
+	size_t firstCount = std::min(count, m_capacity - first);
+	std::copy(column + first, column + first + firstCount, output);
+	std::copy(column, column + (count - firstCount), output + firstCount);
+}
+
+} /* namespace apra */
@@ -0,0 +1,585 @@
+/*
+ * I2CSimulatedTransport.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "utils/Macro.h"
+#include "utils/ScopeLock.h"
+#include "utils/I2CSimulatedTransport.h"
+
+#define I2C_SIMULATED_SPIN_LIMIT_USEC 100
+
+namespace apra
+{
+
+I2C_Simulated_Device::I2C_Simulated_Device() :
+		m_registerSize(1), m_pointer(0), m_registers(), m_nackCount(0), m_errorPermille(
+				0), m_extraLatencyUsec(0), m_transferCount(0), m_pageSize(0), m_writeCycleUsec(
+				0), m_busyUntilTs(0), m_muxAddress(-1), m_muxChannel(0)
+{
+}
+
+I2C_Simulated_Device::I2C_Simulated_Device(uint8_t registerSize) :
+		m_registerSize(registerSize), m_pointer(0), m_registers(), m_nackCount(
+				0), m_errorPermille(0), m_extraLatencyUsec(0), m_transferCount(0), m_pageSize(
+				0), m_writeCycleUsec(0), m_busyUntilTs(0), m_muxAddress(-1), m_muxChannel(
+				0)
+{
+}
+
+I2C_Simulated_Device::~I2C_Simulated_Device()
+{
+}
+
+I2C_Simulated_Transport::I2C_Simulated_Transport(uint64_t busClockHz) :
+		m_lock(), m_devices(), m_isOpen(false), m_openFailure(false), m_busStuck(
+				false), m_latencyEnabled(true), m_functionality(
+				I2C_FUNC_I2C | I2C_FUNC_SMBUS_EMUL), m_busClockHz(busClockHz), m_transferOverheadUsec(
+				0), m_transferCount(0), m_smbusTransferCount(0), m_simulatedBusTimeUsec(
+				0), m_randomSeed(1), m_selectedChip(-1)
+{
+}
+
+I2C_Simulated_Transport::~I2C_Simulated_Transport()
+{
+}
+
+I2CError I2C_Simulated_Transport::openBus()
+{
+	ScopeLock lock(m_lock);
+	if (m_openFailure)
+	{
+		return I2CError("open('simulated') in i2c_init", OPEN_BUS_ERROR);
+	}
+	m_isOpen = true;
+	m_selectedChip = -1;
+	return I2CError();
+}
+
+void I2C_Simulated_Transport::closeBus()
+{
+	ScopeLock lock(m_lock);
+	m_isOpen = false;
+	m_selectedChip = -1;
+}
+
+bool I2C_Simulated_Transport::isOpen()
+{
+	ScopeLock lock(m_lock);
+	return m_isOpen;
+}
+
+uint64_t I2C_Simulated_Transport::getFunctionality()
+{
+	ScopeLock lock(m_lock);
+	return m_isOpen ? m_functionality : 0;
+}
+
+bool I2C_Simulated_Transport::selectChip(uint8_t chipAddress)
+{
+	ScopeLock lock(m_lock);
+	m_selectedChip = chipAddress;
+	return true;
+}
+
+int32_t I2C_Simulated_Transport::transfer(struct i2c_msg *messages,
+		uint32_t count)
+{
+	int32_t result = count;
+	uint64_t busTime = 0;
+	{
+		ScopeLock lock(m_lock);
+		if (!m_isOpen)
+		{
+			return fail(EBADF);
+		}
+		if (!(m_functionality & I2C_FUNC_I2C))
+		{
+			return fail(EOPNOTSUPP);
+		}
+		uint64_t writeBytes = 0;
+		uint64_t readBytes = 0;
+		uint64_t extraLatency = 0;
+		for (uint32_t index = 0; index < count; index++)
+		{
+			int32_t errorCode = 0;
+			I2C_Simulated_Device *device = m_busStuck ?
+			NULL : acquireDevice(messages[index].addr, errorCode);
+			if (!device)
+			{
+				result = fail(m_busStuck ? ETIMEDOUT : errorCode);
+				break;
+			}
+			if (device->m_extraLatencyUsec > extraLatency)
+			{
+				extraLatency = device->m_extraLatencyUsec;
+			}
+			if (messages[index].flags & I2C_M_RD)
+			{
+				this->readBytes(*device, messages[index].buf,
+						messages[index].len);
+				readBytes += messages[index].len;
+			}
+			else
+			{
+				this->writeBytes(*device, messages[index].buf,
+						messages[index].len);
+				writeBytes += messages[index].len;
+			}
+		}
+		busTime = I2C_Bus_Statistics::estimateTransferUsec(m_busClockHz,
+				writeBytes, readBytes) + m_transferOverheadUsec + extraLatency;
+		m_simulatedBusTimeUsec += busTime;
+		m_transferCount++;
+		if (!m_latencyEnabled)
+		{
+			busTime = 0;
+		}
+	}
+	int32_t errorCode = errno;
+	waitBusTime(busTime);
+	errno = errorCode;
+	return result;
+}
+
+int32_t I2C_Simulated_Transport::smbusTransfer(
+		struct i2c_smbus_ioctl_data &args)
+{
+	int32_t result = 0;
+	uint64_t busTime = 0;
+	{
+		ScopeLock lock(m_lock);
+		if (!m_isOpen || (m_selectedChip < 0))
+		{
+			return fail(EBADF);
+		}
+		bool isRead = (args.read_write == I2C_SMBUS_READ);
+		uint64_t requiredFunctionality = 0;
+		switch (args.size)
+		{
+		case I2C_SMBUS_QUICK:
+			requiredFunctionality = I2C_FUNC_SMBUS_QUICK;
+			break;
+		case I2C_SMBUS_BYTE:
+			requiredFunctionality =
+					isRead ? I2C_FUNC_SMBUS_READ_BYTE : I2C_FUNC_SMBUS_WRITE_BYTE;
+			break;
+		case I2C_SMBUS_BYTE_DATA:
+			requiredFunctionality =
+					isRead ?
+							I2C_FUNC_SMBUS_READ_BYTE_DATA :
+							I2C_FUNC_SMBUS_WRITE_BYTE_DATA;
+			break;
+		case I2C_SMBUS_WORD_DATA:
+			requiredFunctionality =
+					isRead ?
+							I2C_FUNC_SMBUS_READ_WORD_DATA :
+							I2C_FUNC_SMBUS_WRITE_WORD_DATA;
+			break;
+		case I2C_SMBUS_I2C_BLOCK_DATA:
+			requiredFunctionality =
+					isRead ?
+							I2C_FUNC_SMBUS_READ_I2C_BLOCK :
+							I2C_FUNC_SMBUS_WRITE_I2C_BLOCK;
+			break;
+		default:
+			return fail(EOPNOTSUPP);
+		}
+		if (!(m_functionality & requiredFunctionality))
+		{
+			return fail(EOPNOTSUPP);
+		}
+		int32_t errorCode = 0;
+		I2C_Simulated_Device *device = m_busStuck ?
+		NULL : acquireDevice(m_selectedChip, errorCode);
+		uint64_t writeBytes = 1;
+		uint64_t readBytes = 0;
+		if (!device)
+		{
+			result = fail(m_busStuck ? ETIMEDOUT : errorCode);
+		}
+		else
+		{
+			uint8_t bytes[I2C_SMBUS_BLOCK_MAX];
+			size_t length = 0;
+			switch (args.size)
+			{
+			case I2C_SMBUS_QUICK:
+				writeBytes = 0;
+				break;
+			case I2C_SMBUS_BYTE:
+				if (isRead)
+				{
+					writeBytes = 0;
+					length = 1;
+				}
+				else
+				{
+					device->m_pointer = args.command;
+				}
+				break;
+			case I2C_SMBUS_BYTE_DATA:
+				length = 1;
+				bytes[0] = args.data->byte;
+				break;
+			case I2C_SMBUS_WORD_DATA:
+				length = 2;
+				bytes[0] = args.data->word & 0xFF;
+				bytes[1] = (args.data->word >> 8) & 0xFF;
+				break;
+			case I2C_SMBUS_I2C_BLOCK_DATA:
+				length = args.data->block[0];
+				if (length > I2C_SMBUS_BLOCK_MAX)
+				{
+					length = I2C_SMBUS_BLOCK_MAX;
+				}
+				std::copy(args.data->block + 1, args.data->block + 1 + length,
+						bytes);
+				break;
+			}
+			if (args.size != I2C_SMBUS_BYTE && args.size != I2C_SMBUS_QUICK)
+			{
+				device->m_pointer = args.command;
+			}
+			if (isRead && length)
+			{
+				readBytes = length;
+				this->readBytes(*device, bytes, length);
+				switch (args.size)
+				{
+				case I2C_SMBUS_BYTE:
+				case I2C_SMBUS_BYTE_DATA:
+					args.data->byte = bytes[0];
+					break;
+				case I2C_SMBUS_WORD_DATA:
+					args.data->word = bytes[0] | (bytes[1] << 8);
+					break;
+				default:
+					args.data->block[0] = length;
+					std::copy(bytes, bytes + length, args.data->block + 1);
+					break;
+				}
+			}
+			else if (!isRead && length)
+			{
+				for (size_t index = 0; index < length; index++)
+				{
+					storeByte(*device, bytes[index]);
+				}
+				startWriteCycle(*device);
+				writeBytes += length;
+			}
+			busTime = device->m_extraLatencyUsec;
+		}
+		busTime += I2C_Bus_Statistics::estimateTransferUsec(m_busClockHz,
+				writeBytes, readBytes) + m_transferOverheadUsec;
+		m_simulatedBusTimeUsec += busTime;
+		m_transferCount++;
+		m_smbusTransferCount++;
+		if (!m_latencyEnabled)
+		{
+			busTime = 0;
+		}
+	}
+	int32_t errorCode = errno;
+	waitBusTime(busTime);
+	errno = errorCode;
+	return result;
+}
+
+void I2C_Simulated_Transport::setFunctionality(uint64_t functionality)
+{
+	ScopeLock lock(m_lock);
+	m_functionality = functionality;
+}
+
+void I2C_Simulated_Transport::setBusClock(uint64_t busClockHz)
+{
+	ScopeLock lock(m_lock);
+	m_busClockHz = busClockHz;
+}
+
+void I2C_Simulated_Transport::setLatencyModel(bool enabled,
+		uint64_t transferOverheadUsec)
+{
+	ScopeLock lock(m_lock);
+	m_latencyEnabled = enabled;
+	m_transferOverheadUsec = transferOverheadUsec;
+}
+
+void I2C_Simulated_Transport::addDevice(uint8_t chipAddress,
+		uint8_t registerSize)
+{
+	ScopeLock lock(m_lock);
+	m_devices[chipAddress] = I2C_Simulated_Device(registerSize);
+}
+
+void I2C_Simulated_Transport::removeDevice(uint8_t chipAddress)
+{
+	ScopeLock lock(m_lock);
+	m_devices.erase(chipAddress);
+}
+
+bool I2C_Simulated_Transport::hasDevice(uint8_t chipAddress)
+{
+	ScopeLock lock(m_lock);
+	return m_devices.find(chipAddress) != m_devices.end();
+}
+
+void I2C_Simulated_Transport::setRegisters(uint8_t chipAddress,
+		uint64_t registerAddress, const vector<uint8_t> &data)
+{
+	ScopeLock lock(m_lock);
+	I2C_Simulated_Device &device = m_devices[chipAddress];
+	for (size_t index = 0; index < data.size(); index++)
+	{
+		device.m_registers[registerAddress + index] = data[index];
+	}
+}
+
+vector<uint8_t> I2C_Simulated_Transport::getRegisters(uint8_t chipAddress,
+		uint64_t registerAddress, size_t size)
+{
+	ScopeLock lock(m_lock);
+	vector<uint8_t> data(size, 0);
+	map<uint8_t, I2C_Simulated_Device>::iterator deviceItr = m_devices.find(
+			chipAddress);
+	if (deviceItr == m_devices.end())
+	{
+		return data;
+	}
+	for (size_t index = 0; index < size; index++)
+	{
+		map<uint64_t, uint8_t>::iterator registerItr =
+				deviceItr->second.m_registers.find(registerAddress + index);
+		if (registerItr != deviceItr->second.m_registers.end())
+		{
+			data[index] = registerItr->second;
+		}
+	}
+	return data;
+}
+
+void I2C_Simulated_Transport::injectNack(uint8_t chipAddress,
+		uint32_t transferCount)
+{
+	ScopeLock lock(m_lock);
+	m_devices[chipAddress].m_nackCount = transferCount;
+}
+
+void I2C_Simulated_Transport::setErrorRate(uint8_t chipAddress,
+		uint32_t permille)
+{
+	ScopeLock lock(m_lock);
+	m_devices[chipAddress].m_errorPermille = permille;
+}
+
+void I2C_Simulated_Transport::setExtraLatency(uint8_t chipAddress,
+		uint64_t latencyUsec)
+{
+	ScopeLock lock(m_lock);
+	m_devices[chipAddress].m_extraLatencyUsec = latencyUsec;
+}
+
+void I2C_Simulated_Transport::setEepromModel(uint8_t chipAddress,
+		uint64_t pageSize, uint64_t writeCycleUsec)
+{
+	ScopeLock lock(m_lock);
+	I2C_Simulated_Device &device = m_devices[chipAddress];
+	device.m_pageSize = pageSize;
+	device.m_writeCycleUsec = writeCycleUsec;
+	device.m_busyUntilTs = 0;
+}
+
+void I2C_Simulated_Transport::setMuxChannel(uint8_t chipAddress,
+		uint8_t muxAddress, uint8_t channel)
+{
+	ScopeLock lock(m_lock);
+	I2C_Simulated_Device &device = m_devices[chipAddress];
+	device.m_muxAddress = muxAddress;
+	device.m_muxChannel = channel;
+}
+
+void I2C_Simulated_Transport::setBusStuck(bool stuck)
+{
+	ScopeLock lock(m_lock);
+	m_busStuck = stuck;
+}
+
+void I2C_Simulated_Transport::setOpenFailure(bool fail)
+{
+	ScopeLock lock(m_lock);
+	m_openFailure = fail;
+}
+
+uint64_t I2C_Simulated_Transport::getTransferCount()
+{
+	ScopeLock lock(m_lock);
+	return m_transferCount;
+}
+
+uint64_t I2C_Simulated_Transport::getTransferCount(uint8_t chipAddress)
+{
+	ScopeLock lock(m_lock);
+	map<uint8_t, I2C_Simulated_Device>::iterator deviceItr = m_devices.find(
+			chipAddress);
+	return (deviceItr == m_devices.end()) ? 0 : deviceItr->second.m_transferCount;
+}
+
+uint64_t I2C_Simulated_Transport::getSMBusTransferCount()
+{
+	ScopeLock lock(m_lock);
+	return m_smbusTransferCount;
+}
+
+uint64_t I2C_Simulated_Transport::getSimulatedBusTimeUsec()
+{
+	ScopeLock lock(m_lock);
+	return m_simulatedBusTimeUsec;
+}
+
+I2C_Simulated_Device* I2C_Simulated_Transport::acquireDevice(
+		uint8_t chipAddress, int32_t &errorCode)
+{
+	map<uint8_t, I2C_Simulated_Device>::iterator deviceItr = m_devices.find(
+			chipAddress);
+	if (deviceItr == m_devices.end())
+	{
+		errorCode = ENXIO;
+		return NULL;
+	}
+	I2C_Simulated_Device &device = deviceItr->second;
+	if (device.m_muxAddress >= 0)
+	{
+		map<uint8_t, I2C_Simulated_Device>::iterator muxItr = m_devices.find(
+				device.m_muxAddress);
+		if ((muxItr == m_devices.end())
+				|| !(muxItr->second.m_pointer & (1 << device.m_muxChannel)))
+		{
+			errorCode = ENXIO;
+			return NULL;
+		}
+	}
+	device.m_transferCount++;
+	if (device.m_busyUntilTs)
+	{
+		MONOCURRTIME(timeNow);
+		if (timeNow < device.m_busyUntilTs)
+		{
+			errorCode = EREMOTEIO;
+			return NULL;
+		}
+		device.m_busyUntilTs = 0;
+	}
+	if (device.m_nackCount)
+	{
+		device.m_nackCount--;
+		errorCode = EREMOTEIO;
+		return NULL;
+	}
+	if (device.m_errorPermille
+			&& ((uint32_t) (rand_r(&m_randomSeed) % 1000)
+					< device.m_errorPermille))
+	{
+		errorCode = EREMOTEIO;
+		return NULL;
+	}
+	return &device;
+}
+
+void I2C_Simulated_Transport::writeBytes(I2C_Simulated_Device &device,
+		const uint8_t *bytes, size_t count)
+{
+	if (count < device.m_registerSize)
+	{
+		return;
+	}
+	uint64_t pointer = 0;
+	for (size_t index = 0; index < device.m_registerSize; index++)
+	{
+		pointer = (pointer << 8) | bytes[index];
+	}
+	device.m_pointer = pointer;
+	for (size_t index = device.m_registerSize; index < count; index++)
+	{
+		storeByte(device, bytes[index]);
+	}
+	if (count > device.m_registerSize)
+	{
+		startWriteCycle(device);
+	}
+}
+
+void I2C_Simulated_Transport::readBytes(I2C_Simulated_Device &device,
+		uint8_t *bytes, size_t count)
+{
+	for (size_t index = 0; index < count; index++)
+	{
+		map<uint64_t, uint8_t>::iterator registerItr = device.m_registers.find(
+				device.m_pointer++);
+		bytes[index] =
+				(registerItr != device.m_registers.end()) ?
+						registerItr->second : 0;
+	}
+}
+
+void I2C_Simulated_Transport::storeByte(I2C_Simulated_Device &device,
+		uint8_t value)
+{
+	device.m_registers[device.m_pointer] = value;
+	if (!device.m_pageSize)
+	{
+		device.m_pointer++;
+		return;
+	}
+	// Page-organised memories roll over to the start of the current page
+	uint64_t pageStart = device.m_pointer - (device.m_pointer % device.m_pageSize);
+	device.m_pointer = pageStart
+			+ ((device.m_pointer + 1 - pageStart) % device.m_pageSize);
+}
+
+void I2C_Simulated_Transport::startWriteCycle(I2C_Simulated_Device &device)
+{
+	if (!device.m_writeCycleUsec)
+	{
+		return;
+	}
+	MONOCURRTIME(timeNow);
+	device.m_busyUntilTs = timeNow + device.m_writeCycleUsec;
+}
+
+int32_t I2C_Simulated_Transport::fail(int32_t errorCode)
+{
+	errno = errorCode;
+	return -1;
+}
+
+void I2C_Simulated_Transport::waitBusTime(uint64_t busTimeUsec)
+{
+	if (!busTimeUsec)
+	{
+		return;
+	}
+	MONOCURRTIME(startTs);
+	int64_t deadline = startTs + busTimeUsec;
+	if (busTimeUsec > I2C_SIMULATED_SPIN_LIMIT_USEC)
+	{
+		usleep(busTimeUsec - I2C_SIMULATED_SPIN_LIMIT_USEC);
+	}
+	int64_t timeNow = startTs;
+	while (timeNow < deadline)
+	{
+		MONOTIMEUS(timeNow);
+	}
+}
+
+} /* namespace apra */
@@ -0,0 +1,157 @@
+/*
+ * I2CTraceRecorder.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <string.h>
+#include "utils/Macro.h"
+#include "utils/ScopeLock.h"
+#include "utils/I2CTraceRecorder.h"
+
+namespace apra
+{
+
+I2C_Trace_Recorder::I2C_Trace_Recorder() :
+		m_lock(), m_file(NULL), m_isRecording(false), m_startTs(0), m_lastTimestampUsec(
+				0), m_recordCount(0), m_buffer()
+{
+}
+
+I2C_Trace_Recorder::~I2C_Trace_Recorder()
+{
+	close();
+}
+
+bool I2C_Trace_Recorder::open(string path, uint64_t busClockHz)
+{
+	close();
+	ScopeLock lock(m_lock);
+	m_file = fopen(path.c_str(), "wb");
+	if (!m_file)
+	{
+		return false;
+	}
+	m_buffer.clear();
+	m_buffer.insert(m_buffer.end(), I2C_TRACE_MAGIC,
+			I2C_TRACE_MAGIC + strlen(I2C_TRACE_MAGIC));
+	m_buffer.push_back(I2C_TRACE_VERSION);
+	I2C_Trace_Record::putVarint(m_buffer, busClockHz);
+	MONOTIMEUS(m_startTs);
+	m_lastTimestampUsec = 0;
+	m_recordCount = 0;
+	m_isRecording = true;
+	return true;
+}
+
+void I2C_Trace_Recorder::close()
+{
+	ScopeLock lock(m_lock);
+	m_isRecording = false;
+	if (m_file)
+	{
+		writeBuffer();
+		fclose(m_file);
+		m_file = NULL;
+	}
+}
+
+bool I2C_Trace_Recorder::isRecording()
+{
+	return m_isRecording;
+}
+
+void I2C_Trace_Recorder::record(const I2C_Trace_Record &record)
+{
+	ScopeLock lock(m_lock);
+	if (!m_file)
+	{
+		return;
+	}
+	int64_t timestampUsec = record.m_timestampUsec - m_startTs;
+	I2C_Trace_Record relative = record;
+	relative.m_timestampUsec = timestampUsec;
+	relative.encode(m_buffer, m_lastTimestampUsec);
+	m_lastTimestampUsec = timestampUsec;
+	m_recordCount++;
+	if (m_buffer.size() >= I2C_TRACE_FLUSH_SIZE)
+	{
+		writeBuffer();
+	}
+}
+
+void I2C_Trace_Recorder::flush()
+{
+	ScopeLock lock(m_lock);
+	if (m_file)
+	{
+		writeBuffer();
+		fflush(m_file);
+	}
+}
+
+uint64_t I2C_Trace_Recorder::getRecordCount()
+{
+	ScopeLock lock(m_lock);
+	return m_recordCount;
+}
+
+bool I2C_Trace_Recorder::load(string path, vector<I2C_Trace_Record> &records,
+		uint64_t &busClockHz)
+{
+	FILE *file = fopen(path.c_str(), "rb");
+	if (!file)
+	{
+		return false;
+	}
+	vector<uint8_t> buffer;
+	uint8_t block[4096];
+	size_t readSize = 0;
+	while ((readSize = fread(block, 1, sizeof(block), file)) > 0)
+	{
+		buffer.insert(buffer.end(), block, block + readSize);
+	}
+	fclose(file);
+
+	size_t magicSize = strlen(I2C_TRACE_MAGIC);
+	if ((buffer.size() <= magicSize)
+			|| memcmp(buffer.data(), I2C_TRACE_MAGIC, magicSize)
+			|| (buffer[magicSize] != I2C_TRACE_VERSION))
+	{
+		return false;
+	}
+	size_t offset = magicSize + 1;
+	if (!I2C_Trace_Record::getVarint(buffer, offset, busClockHz))
+	{
+		return false;
+	}
+	records.clear();
+	int64_t previousTimestampUsec = 0;
+	while (offset < buffer.size())
+	{
+		I2C_Trace_Record record;
+		if (!record.decode(buffer, offset, previousTimestampUsec))
+		{
+			return false;
+		}
+		previousTimestampUsec = record.m_timestampUsec;
+		records.push_back(record);
+	}
+	return true;
+}
+
+void I2C_Trace_Recorder::writeBuffer()
+{
+	if (!m_buffer.empty())
+	{
+		fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+		m_buffer.clear();
+	}
+}
+
+} /* namespace apra */
@@ -0,0 +1,25 @@
+/*
+ * I2CTransport.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include "utils/I2CTransport.h"
+
+namespace apra
+{
+
+I2C_Transport::I2C_Transport()
+{
+}
+
+I2C_Transport::~I2C_Transport()
+{
+}
+
+} /* namespace apra */
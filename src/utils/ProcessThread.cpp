@@ -133,7 +133,7 @@ int32_t ProcessThread::mainLoop()
 				int64_t td = m_frequSec - pt;
 				if (td > 0)
 				{
-					usleep(m_frequSec - pt);
+					waitForNextCycle(td);
 				}
 			}
 		}
@@ -154,6 +154,11 @@ int32_t ProcessThread::mainLoop()
 	return 0;
 }
 
+void ProcessThread::waitForNextCycle(uint64_t timeoutUsec)
+{
+	usleep(timeoutUsec);
+}
+
 void ProcessThread::enqueResponse(Message *message)
 {
 	ScopeLock lock(m_responseLock);
@@ -183,8 +188,9 @@ void ProcessThread::someFunction(bool &executedOnce)
 		}
 		if (item)
 		{
+			MESSAGE_TYPE itemType = item->getType();
 			process(item);
-			if (item->getType() != REQUEST_RESPONSE)
+			if (itemType != REQUEST_RESPONSE)
 			{
 				delete item;
 			}
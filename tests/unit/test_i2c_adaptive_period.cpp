@@ -0,0 +1,99 @@
+/*
+ * test_i2c_adaptive_period.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "models/I2CRegisteredEvent.h"
+#include "utils/I2CEventScheduler.h"
+#include "utils/I2CSimulatedTransport.h"
+
+using namespace apra;
+
+class I2CAdaptivePeriodTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        transport.setLatencyModel(false, 0);
+        transport.addDevice(0x20, 1);
+        transport.setRegisters(0x20, 0x00, vector<uint8_t>({ 0x10 }));
+    }
+
+    void TearDown() override {
+        // Cleanup code for each test
+    }
+
+    I2C_Transaction_Message makeAdaptiveRead() {
+        I2C_Message read;
+        read.configureRead(vector<uint8_t>({ 0x00 }), 1);
+        I2C_Transaction_Message message(0x20, vector<I2C_Message>({ read }));
+        message.setAdaptivePeriod(1000, 8000, 2);
+        return message;
+    }
+
+    I2C_Simulated_Transport transport;
+};
+
+// Test the period halves on change, grows by a quarter and stays in range
+TEST_F(I2CAdaptivePeriodTest, PeriodSteps) {
+    EXPECT_EQ(2000, I2C_Event_Scheduler::getAdaptivePeriod(4000, true, 1000,
+            8000));
+    EXPECT_EQ(1000, I2C_Event_Scheduler::getAdaptivePeriod(1500, true, 1000,
+            8000));
+    EXPECT_EQ(5000, I2C_Event_Scheduler::getAdaptivePeriod(4000, false, 1000,
+            8000));
+    EXPECT_EQ(8000, I2C_Event_Scheduler::getAdaptivePeriod(7000, false, 1000,
+            8000));
+    EXPECT_EQ(1, I2C_Event_Scheduler::getAdaptivePeriod(0, false, 0, 10));
+}
+
+// Test changes beyond the threshold speed the event up and stable values slow it
+TEST_F(I2CAdaptivePeriodTest, EventAdaptsToValues) {
+    I2C_Transaction_Message message = makeAdaptiveRead();
+    message.setPeriod(4000);
+    I2C_Registered_Event event(message);
+    EXPECT_EQ(4000, event.m_currentPeriodUsec);
+
+    event.m_message.m_messages[0].m_data = vector<uint8_t>({ 0x10 });
+    EXPECT_FALSE(event.adaptPeriod());
+    event.m_message.m_messages[0].m_data = vector<uint8_t>({ 0x20 });
+    EXPECT_TRUE(event.adaptPeriod());
+    EXPECT_EQ(2000, event.m_currentPeriodUsec);
+    event.m_message.m_messages[0].m_data = vector<uint8_t>({ 0x1E });
+    EXPECT_TRUE(event.adaptPeriod());
+    EXPECT_EQ(2500, event.m_currentPeriodUsec);
+
+    event.m_message.setError(I2CError("read failed", READ_ERROR));
+    EXPECT_FALSE(event.adaptPeriod());
+    EXPECT_EQ(2500, event.m_currentPeriodUsec);
+}
+
+// Test a stable register backs off to the maximum and a changing one speeds up
+TEST_F(I2CAdaptivePeriodTest, InterfaceFollowsActivity) {
+    I2C_Interface interface(&transport, "adaptive_test", 2000, false);
+    uint64_t handle = interface.registerEvent(makeAdaptiveRead());
+    EXPECT_EQ(1000, interface.getEventPeriodUsec(handle));
+    EXPECT_EQ(0, interface.getEventPeriodUsec(handle + 1000));
+    interface.begin();
+    usleep(100000);
+    EXPECT_EQ(8000, interface.getEventPeriodUsec(handle));
+
+    uint64_t stableCount = transport.getTransferCount();
+    for (int step = 0; step < 60; step++) {
+        transport.setRegisters(0x20, 0x00,
+                vector<uint8_t>({ (uint8_t) (0x10 + step * 3) }));
+        usleep(1000);
+    }
+    uint64_t periodUsec = interface.getEventPeriodUsec(handle);
+    interface.end();
+
+    EXPECT_GT(4000, periodUsec);
+    EXPECT_LT(stableCount + 10, transport.getTransferCount());
+}
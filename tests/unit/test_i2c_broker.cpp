@@ -0,0 +1,273 @@
+/*
+ * test_i2c_broker.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <string>
+#include "controllers/I2CBroker.h"
+#include "controllers/I2CBrokerClient.h"
+#include "utils/I2CBrokerRing.h"
+#include "utils/I2CSimulatedTransport.h"
+#include "utils/Macro.h"
+
+using namespace apra;
+
+namespace
+{
+// Exposes admission so a test can queue brokered work without running it
+class AdmittingBroker: public I2C_Broker {
+public:
+    AdmittingBroker(I2C_Transport *transport, std::string socketPath) :
+            I2C_Broker(transport, socketPath, "broker_close", 1000, false) {
+    }
+
+    void admit() {
+        MONOCURRTIME(timeNow);
+        admitRequests(timeNow);
+    }
+};
+}
+
+class I2CBrokerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        socketPath = "/tmp/apra_i2c_broker_" + std::to_string(getpid())
+                + ".sock";
+        regionFd = memfd_create("broker_test", MFD_CLOEXEC);
+        ASSERT_LE(0, regionFd);
+        transport.setLatencyModel(false, 0);
+        transport.addDevice(0x20, 1);
+        transport.setRegisters(0x20, 0x00, vector<uint8_t>({ 0x12, 0x34 }));
+    }
+
+    void TearDown() override {
+        close(regionFd);
+    }
+
+    I2C_Transaction_Message makeRead(uint8_t chip) {
+        I2C_Message read;
+        read.configureRead(vector<uint8_t>({ 0x00 }), 2);
+        return I2C_Transaction_Message(chip, vector<I2C_Message>({ read }));
+    }
+
+    I2C_Transaction_Message makeWrite(uint8_t registerNumber, uint8_t value) {
+        I2C_Message write;
+        write.configureWrite(vector<uint8_t>({ registerNumber }),
+                vector<uint8_t>({ value }));
+        return I2C_Transaction_Message(0x20, vector<I2C_Message>({ write }));
+    }
+
+    std::string socketPath;
+    int regionFd;
+    I2C_Simulated_Transport transport;
+};
+
+// Test a transaction crosses two mappings of the region and back
+TEST_F(I2CBrokerTest, RingRoundTrip) {
+    I2C_Broker_Ring broker;
+    ASSERT_FALSE(broker.create(regionFd).isError());
+    I2C_Broker_Ring client;
+    ASSERT_FALSE(client.attach(regionFd).isError());
+
+    I2C_Transaction_Message request = makeRead(0x20);
+    request.setPriority(I2C_PRIORITY_URGENT);
+    int32_t first = client.claim(1);
+    int32_t second = client.claim(1);
+    ASSERT_LE(0, first);
+    ASSERT_LE(0, second);
+    ASSERT_TRUE(client.encode(second, makeWrite(0x01, 0x55)));
+    ASSERT_TRUE(client.encode(first, request));
+    client.submit(second);
+    client.submit(first);
+
+    vector<uint32_t> slots;
+    ASSERT_EQ(2, broker.collectSubmitted(slots));
+    EXPECT_EQ((uint32_t) second, slots[0]);
+    EXPECT_EQ((uint32_t) first, slots[1]);
+    I2C_Transaction_Message received;
+    broker.toMessage(first, received);
+    EXPECT_EQ(0x20, received.m_chipNumber);
+    EXPECT_EQ(I2C_PRIORITY_URGENT, received.m_priority);
+    ASSERT_EQ(1, received.m_messages.size());
+    EXPECT_EQ(2, received.m_messages[0].getDataSize());
+    received.m_messages[0].m_data = vector<uint8_t>({ 0xAB, 0xCD });
+    broker.complete(first, received);
+
+    EXPECT_TRUE(client.wait(first, 1000));
+    EXPECT_FALSE(client.wait(second, 1000));
+    client.decode(first, request);
+    EXPECT_FALSE(request.getError().isError());
+    EXPECT_EQ(vector<uint8_t>({ 0xAB, 0xCD }), request.m_messages[0].m_data);
+    client.release(first);
+    EXPECT_EQ(I2C_BROKER_SLOT_COUNT - 1, broker.getFreeCount());
+}
+
+// Test oversized transactions are refused and abandoned slots come back
+TEST_F(I2CBrokerTest, RingLimitsAndAbandon) {
+    I2C_Broker_Ring broker;
+    ASSERT_FALSE(broker.create(regionFd).isError());
+    I2C_Transaction_Message large = makeRead(0x20);
+    large.m_messages[0].configureRead(vector<uint8_t>({ 0x00 }),
+            I2C_BROKER_MAX_DATA_SIZE + 1);
+    int32_t slot = broker.claim(1);
+    EXPECT_FALSE(broker.encode(slot, large));
+
+    ASSERT_TRUE(broker.encode(slot, makeRead(0x20)));
+    broker.submit(slot);
+    vector<uint32_t> slots;
+    ASSERT_EQ(1, broker.collectSubmitted(slots));
+    broker.abandon(slot);
+    EXPECT_EQ(I2C_SLOT_ABANDONED, broker.getSlot(slot).m_state);
+    I2C_Transaction_Message received;
+    broker.toMessage(slot, received);
+    broker.complete(slot, received);
+    EXPECT_EQ(I2C_SLOT_FREE, broker.getSlot(slot).m_state);
+
+    broker.claim(7);
+    broker.claim(7);
+    EXPECT_EQ(I2C_BROKER_SLOT_COUNT - 2, broker.getFreeCount());
+    broker.releaseClient(7);
+    EXPECT_EQ(I2C_BROKER_SLOT_COUNT, broker.getFreeCount());
+
+    I2C_Broker_Ring mismatched;
+    int otherFd = memfd_create("broker_empty", MFD_CLOEXEC);
+    ASSERT_EQ(0, ftruncate(otherFd, I2C_Broker_Ring::getRegionSize()));
+    EXPECT_EQ(BROKER_ERROR, mismatched.attach(otherFd).getCode());
+    EXPECT_FALSE(mismatched.isAttached());
+    close(otherFd);
+}
+
+// Test slots whose counts or sizes overrun their arrays are failed unread
+TEST_F(I2CBrokerTest, RingRejectsCorruptSlots) {
+    I2C_Broker_Ring broker;
+    ASSERT_FALSE(broker.create(regionFd).isError());
+    I2C_Broker_Ring client;
+    ASSERT_FALSE(client.attach(regionFd).isError());
+
+    int32_t slots[4];
+    for (int index = 0; index < 4; index++) {
+        slots[index] = client.claim(1);
+        ASSERT_LE(0, slots[index]);
+        ASSERT_TRUE(client.encode(slots[index], makeRead(0x20)));
+    }
+    client.getSlot(slots[0]).m_messageCount = 255;
+    client.getSlot(slots[1]).m_messages[0].m_dataSize = 0xFFFF;
+    client.getSlot(slots[2]).m_messages[0].m_registerSize = 200;
+    client.getSlot(slots[3]).m_messages[0].m_type = 9;
+    for (int index = 0; index < 4; index++) {
+        client.submit(slots[index]);
+    }
+
+    vector<uint32_t> submitted;
+    ASSERT_EQ(4, broker.collectSubmitted(submitted));
+    for (size_t index = 0; index < submitted.size(); index++) {
+        I2C_Transaction_Message received;
+        EXPECT_FALSE(broker.toMessage(submitted[index], received));
+        EXPECT_EQ(BROKER_ERROR, received.getError().getCode());
+        EXPECT_TRUE(received.m_messages.empty());
+        broker.complete(submitted[index], received);
+    }
+
+    for (int index = 0; index < 4; index++) {
+        I2C_Transaction_Message request = makeRead(0x20);
+        EXPECT_TRUE(client.wait(slots[index], 1000));
+        client.decode(slots[index], request);
+        EXPECT_EQ(BROKER_ERROR, request.getError().getCode());
+        EXPECT_EQ(0, client.getSlot(slots[index]).m_messageCount);
+        client.release(slots[index]);
+    }
+    EXPECT_EQ(I2C_BROKER_SLOT_COUNT, broker.getFreeCount());
+}
+
+// Test clients share the broker's bus thread and see each other's writes
+TEST_F(I2CBrokerTest, ClientsTransactThroughBroker) {
+    I2C_Broker broker(&transport, socketPath, "broker_test", 1000, false);
+    ASSERT_FALSE(broker.openBroker().isError());
+    broker.begin();
+    I2C_Broker_Client first;
+    I2C_Broker_Client second;
+    ASSERT_FALSE(first.connectBroker(socketPath).isError());
+    ASSERT_FALSE(second.connectBroker(socketPath).isError());
+    EXPECT_NE(first.getClientId(), second.getClientId());
+
+    I2C_Transaction_Message read = makeRead(0x20);
+    EXPECT_FALSE(first.transact(read, 1000000).isError());
+    EXPECT_EQ(vector<uint8_t>({ 0x12, 0x34 }), read.m_messages[0].m_data);
+    I2C_Transaction_Message write = makeWrite(0x00, 0x56);
+    EXPECT_FALSE(second.transact(write, 1000000).isError());
+    EXPECT_FALSE(first.transact(read, 1000000).isError());
+    EXPECT_EQ(vector<uint8_t>({ 0x56, 0x34 }), read.m_messages[0].m_data);
+
+    I2C_Transaction_Message missing = makeRead(0x40);
+    EXPECT_TRUE(second.transact(missing, 1000000).isError());
+    EXPECT_TRUE(I2CError(missing.m_messages[0].m_error).isError());
+    EXPECT_EQ(2, broker.getClientCount());
+
+    second.disconnectBroker();
+    for (int wait = 0; (wait < 100) && (broker.getClientCount() > 1); wait++) {
+        usleep(1000);
+    }
+    EXPECT_EQ(1, broker.getClientCount());
+    broker.end();
+    broker.closeBroker();
+
+    EXPECT_EQ(4, broker.getBrokeredCount());
+    EXPECT_NE(0, access(socketPath.c_str(), F_OK));
+    EXPECT_EQ(BROKER_ERROR, first.transact(read, 1000).getCode());
+}
+
+// Test a client wakes on completion well inside one broker period
+TEST_F(I2CBrokerTest, DoorbellWakesBroker) {
+    I2C_Broker broker(&transport, socketPath, "broker_latency", 20, false);
+    ASSERT_FALSE(broker.openBroker().isError());
+    broker.begin();
+    I2C_Broker_Client client;
+    ASSERT_FALSE(client.connectBroker(socketPath).isError());
+    usleep(100000);
+    for (int request = 0; request < 5; request++) {
+        I2C_Transaction_Message read = makeRead(0x20);
+        MONOCURRTIME(startTs);
+        EXPECT_FALSE(client.transact(read, 1000000).isError());
+        MONOCURRTIME(endTs);
+        EXPECT_GT(20000, endTs - startTs);
+    }
+    broker.end();
+}
+
+// Test open and close are refused while running and closing fails queued work
+TEST_F(I2CBrokerTest, CloseFailsQueuedRequests) {
+    AdmittingBroker broker(&transport, socketPath);
+    ASSERT_FALSE(broker.openBroker().isError());
+    broker.begin();
+    I2C_Broker_Client client;
+    ASSERT_FALSE(client.connectBroker(socketPath).isError());
+    EXPECT_FALSE(broker.closeBroker());
+    EXPECT_EQ(BROKER_ERROR, broker.openBroker().getCode());
+    EXPECT_TRUE(broker.isBrokerOpen());
+    broker.end();
+
+    int32_t slot = client.submit(makeRead(0x20));
+    ASSERT_LE(0, slot);
+    broker.admit();
+    EXPECT_TRUE(broker.closeBroker());
+    EXPECT_FALSE(broker.isBrokerOpen());
+    ASSERT_TRUE(client.wait(slot, 1000));
+    EXPECT_EQ(BROKER_ERROR, client.getResult(slot).m_errorCode);
+    client.release(slot);
+
+    uint64_t transferCount = transport.getTransferCount();
+    broker.begin();
+    usleep(10000);
+    broker.end();
+    EXPECT_EQ(transferCount, transport.getTransferCount());
+    EXPECT_EQ(0, broker.getBrokeredCount());
+}
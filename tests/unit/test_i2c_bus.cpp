@@ -0,0 +1,114 @@
+/*
+ * test_i2c_bus.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include "utils/I2CBus.h"
+#include "utils/I2CSimulatedTransport.h"
+
+using namespace apra;
+
+class I2CBusTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        transport.setLatencyModel(false, 0);
+        transport.addDevice(0x20, 1);
+        transport.addDevice(0x50, 2);
+        bus = new I2C_Bus(&transport, false);
+        ASSERT_FALSE(bus->openBus().isError());
+    }
+
+    void TearDown() override {
+        bus->closeBus();
+        delete bus;
+    }
+
+    I2C_Simulated_Transport transport;
+    I2C_Bus *bus;
+};
+
+// Test bus reports transport state
+TEST_F(I2CBusTest, OpenState) {
+    EXPECT_TRUE(bus->isOpen());
+    EXPECT_EQ(&transport, bus->getTransport());
+    bus->closeBus();
+    EXPECT_FALSE(bus->isOpen());
+    vector<uint8_t> data;
+    EXPECT_EQ(BUS_UNOPENED,
+            bus->genericRead(0x20, vector<uint8_t>({ 0x00 }), data).getCode());
+}
+
+// Test single-byte register access takes the SMBus fast path
+TEST_F(I2CBusTest, SMBusFastPath) {
+    bus->setSize(1, 2);
+    EXPECT_FALSE(
+            bus->genericWrite(0x20, vector<uint8_t>({ 0x10 }),
+                    vector<uint8_t>({ 0xAB, 0xCD })).isError());
+    vector<uint8_t> readData(2, 0);
+    EXPECT_FALSE(
+            bus->genericRead(0x20, vector<uint8_t>({ 0x10 }), readData).isError());
+    EXPECT_EQ(vector<uint8_t>({ 0xAB, 0xCD }), readData);
+    EXPECT_EQ(2, transport.getSMBusTransferCount());
+}
+
+// Test multi-byte register access falls back to combined transfers
+TEST_F(I2CBusTest, CombinedTransfers) {
+    bus->setSize(2, 3);
+    EXPECT_FALSE(
+            bus->genericWrite(0x50, vector<uint8_t>({ 0x01, 0x00 }),
+                    vector<uint8_t>({ 0x11, 0x22, 0x33 })).isError());
+    vector<uint8_t> readData(3, 0);
+    EXPECT_FALSE(
+            bus->genericRead(0x50, vector<uint8_t>({ 0x01, 0x00 }), readData).isError());
+    EXPECT_EQ(vector<uint8_t>({ 0x11, 0x22, 0x33 }), readData);
+    EXPECT_EQ(0, transport.getSMBusTransferCount());
+    EXPECT_EQ(2, transport.getTransferCount());
+}
+
+// Test SMBus can be disabled in favour of combined transfers
+TEST_F(I2CBusTest, SMBusDisabled) {
+    bus->setSMBusEnabled(false);
+    bus->setSize(1, 1);
+    EXPECT_FALSE(bus->writeOnI2C(0x20, 0x05, 0x7F).isError());
+    uint64_t data = 0;
+    EXPECT_FALSE(bus->readOnI2C(0x20, 0x05, data).isError());
+    EXPECT_EQ(0x7F, data);
+    EXPECT_EQ(0, transport.getSMBusTransferCount());
+}
+
+// Test SMBus-only adapters are served without combined transfers
+TEST_F(I2CBusTest, SMBusOnlyAdapter) {
+    transport.setFunctionality(I2C_FUNC_SMBUS_BYTE_DATA);
+    bus->closeBus();
+    ASSERT_FALSE(bus->openBus().isError());
+    bus->setSize(1, 1);
+    EXPECT_FALSE(bus->writeOnI2C(0x20, 0x01, 0x42).isError());
+    uint64_t data = 0;
+    EXPECT_FALSE(bus->readOnI2C(0x20, 0x01, data).isError());
+    EXPECT_EQ(0x42, data);
+
+    vector<uint8_t> readData(2, 0);
+    EXPECT_TRUE(
+            bus->genericRead(0x50, vector<uint8_t>({ 0x00, 0x00 }), readData).isError());
+}
+
+// Test failed transfers surface errors and statistics
+TEST_F(I2CBusTest, ErrorsAreRecorded) {
+    transport.injectNack(0x50, 1);
+    vector<uint8_t> readData(1, 0);
+    EXPECT_TRUE(
+            bus->genericRead(0x50, vector<uint8_t>({ 0x00, 0x00 }), readData).isError());
+    EXPECT_FALSE(
+            bus->genericRead(0x50, vector<uint8_t>({ 0x00, 0x00 }), readData).isError());
+
+    I2C_Bus_Statistics statistics = bus->getStatistics();
+    EXPECT_EQ(2, statistics.m_total.getOperationCount());
+    EXPECT_EQ(1, statistics.m_total.m_errorCount);
+}
@@ -0,0 +1,227 @@
+/*
+ * test_i2c_bus_arbiter.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "utils/I2CBusArbiter.h"
+#include "utils/I2CSimulatedTransport.h"
+#include "utils/Macro.h"
+
+using namespace apra;
+
+class I2CBusArbiterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Setup code for each test
+    }
+
+    void TearDown() override {
+        // Cleanup code for each test
+    }
+
+    I2C_Transaction_Message createWrite(uint8_t registerNumber,
+            I2C_PRIORITY priority) {
+        I2C_Message message;
+        message.configureWrite(vector<uint8_t>({ registerNumber }),
+                vector<uint8_t>({ 0x01 }));
+        I2C_Transaction_Message transaction(0x20,
+                vector<I2C_Message>({ message }));
+        transaction.setPriority(priority);
+        return transaction;
+    }
+};
+
+// Test entries pop by priority class and FIFO within a class
+TEST_F(I2CBusArbiterTest, PriorityOrder) {
+    I2C_Bus_Arbiter arbiter;
+    I2C_Transaction_Message background = createWrite(0x01, I2C_PRIORITY_BACKGROUND);
+    I2C_Transaction_Message normalFirst = createWrite(0x02, I2C_PRIORITY_NORMAL);
+    I2C_Transaction_Message normalSecond = createWrite(0x03, I2C_PRIORITY_NORMAL);
+    I2C_Transaction_Message urgent = createWrite(0x04, I2C_PRIORITY_URGENT);
+    arbiter.pushRequest(&background, false, 0);
+    arbiter.pushRequest(&normalFirst, false, 0);
+    arbiter.pushRequest(&normalSecond, false, 0);
+    arbiter.pushRequest(&urgent, false, 0);
+    EXPECT_EQ(4, arbiter.size());
+
+    I2C_Arbiter_Entry entry;
+    ASSERT_TRUE(arbiter.pop(entry, 10));
+    EXPECT_EQ(&urgent, entry.m_request);
+    arbiter.recordCompletion(entry, 10);
+    ASSERT_TRUE(arbiter.pop(entry, 20));
+    EXPECT_EQ(&normalFirst, entry.m_request);
+    arbiter.recordCompletion(entry, 20);
+    ASSERT_TRUE(arbiter.pop(entry, 30));
+    EXPECT_EQ(&normalSecond, entry.m_request);
+    arbiter.recordCompletion(entry, 30);
+    ASSERT_TRUE(arbiter.pop(entry, 40));
+    EXPECT_EQ(&background, entry.m_request);
+    arbiter.recordCompletion(entry, 40);
+    EXPECT_FALSE(arbiter.pop(entry, 50));
+
+    EXPECT_EQ(1, arbiter.getExecutedCount(I2C_PRIORITY_URGENT));
+    EXPECT_EQ(2, arbiter.getExecutedCount(I2C_PRIORITY_NORMAL));
+    EXPECT_EQ(30, arbiter.getMaxWaitUsec(I2C_PRIORITY_NORMAL));
+    EXPECT_EQ(40, arbiter.getMaxWaitUsec(I2C_PRIORITY_BACKGROUND));
+}
+
+// Test popping can be limited to the most urgent classes
+TEST_F(I2CBusArbiterTest, LowestPriorityLimit) {
+    I2C_Bus_Arbiter arbiter;
+    I2C_Transaction_Message normal = createWrite(0x01, I2C_PRIORITY_NORMAL);
+    shared_ptr<I2C_Registered_Event> event = make_shared<I2C_Registered_Event>(
+            createWrite(0x02, I2C_PRIORITY_URGENT));
+    arbiter.pushRequest(&normal, false, 0);
+    EXPECT_TRUE(arbiter.hasPending());
+    EXPECT_FALSE(arbiter.hasPending(I2C_PRIORITY_URGENT));
+
+    I2C_Arbiter_Entry entry;
+    EXPECT_FALSE(arbiter.pop(entry, 0, I2C_PRIORITY_URGENT));
+    arbiter.pushEvent(event, 0, 0);
+    ASSERT_TRUE(arbiter.pop(entry, 0, I2C_PRIORITY_URGENT));
+    EXPECT_EQ(event, entry.m_event);
+    EXPECT_TRUE(entry.m_request == NULL);
+}
+
+// Test entries with deadlines run earliest deadline first within a class
+TEST_F(I2CBusArbiterTest, EarliestDeadlineFirst) {
+    I2C_Bus_Arbiter arbiter;
+    I2C_Transaction_Message noDeadline = createWrite(0x01, I2C_PRIORITY_NORMAL);
+    I2C_Transaction_Message late = createWrite(0x02, I2C_PRIORITY_NORMAL);
+    I2C_Transaction_Message early = createWrite(0x03, I2C_PRIORITY_NORMAL);
+    I2C_Transaction_Message background = createWrite(0x04, I2C_PRIORITY_BACKGROUND);
+    late.m_deadlineTs = 5000;
+    early.m_deadlineTs = 1000;
+    background.m_deadlineTs = 10;
+    arbiter.pushRequest(&noDeadline, false, 0);
+    arbiter.pushRequest(&background, false, 0);
+    arbiter.pushRequest(&late, false, 0);
+    arbiter.pushRequest(&early, false, 0);
+
+    I2C_Arbiter_Entry entry;
+    ASSERT_TRUE(arbiter.pop(entry, 0));
+    EXPECT_EQ(&early, entry.m_request);
+    ASSERT_TRUE(arbiter.pop(entry, 0));
+    EXPECT_EQ(&late, entry.m_request);
+    ASSERT_TRUE(arbiter.pop(entry, 0));
+    EXPECT_EQ(&noDeadline, entry.m_request);
+    ASSERT_TRUE(arbiter.pop(entry, 0));
+    EXPECT_EQ(&background, entry.m_request);
+}
+
+// Test deadline misses and stale drops are counted
+TEST_F(I2CBusArbiterTest, DeadlineAccounting) {
+    I2C_Bus_Arbiter arbiter;
+    I2C_Transaction_Message message = createWrite(0x01, I2C_PRIORITY_NORMAL);
+    message.m_deadlineTs = 100;
+    arbiter.pushRequest(&message, false, 0);
+
+    I2C_Arbiter_Entry entry;
+    ASSERT_TRUE(arbiter.pop(entry, 50));
+    EXPECT_FALSE(entry.isStale(200));
+    arbiter.recordCompletion(entry, 200);
+    EXPECT_EQ(1, arbiter.getDeadlineMissCount(I2C_PRIORITY_NORMAL));
+
+    message.m_dropIfStale = true;
+    arbiter.pushRequest(&message, false, 0);
+    ASSERT_TRUE(arbiter.pop(entry, 150));
+    EXPECT_FALSE(entry.isStale(100));
+    EXPECT_TRUE(entry.isStale(150));
+    arbiter.recordDrop(entry);
+    EXPECT_EQ(2, arbiter.getDeadlineMissCount(I2C_PRIORITY_NORMAL));
+    EXPECT_EQ(1, arbiter.getDroppedCount(I2C_PRIORITY_NORMAL));
+    EXPECT_EQ(1, arbiter.getExecutedCount(I2C_PRIORITY_NORMAL));
+}
+
+// Test setDeadline stamps an absolute deadline from now
+TEST_F(I2CBusArbiterTest, MessageDeadline) {
+    I2C_Transaction_Message message = createWrite(0x01, I2C_PRIORITY_NORMAL);
+    EXPECT_EQ(0, message.m_deadlineTs);
+    MONOCURRTIME(before);
+    message.setDeadline(5000, true);
+    EXPECT_LE(before + 5000, message.m_deadlineTs);
+    EXPECT_TRUE(message.m_dropIfStale);
+    message.setDeadline(0);
+    EXPECT_EQ(0, message.m_deadlineTs);
+}
+
+// Test invalid priorities fall back to normal
+TEST_F(I2CBusArbiterTest, InvalidPriority) {
+    I2C_Transaction_Message message = createWrite(0x01, (I2C_PRIORITY) 7);
+    EXPECT_EQ(I2C_PRIORITY_NORMAL, I2C_Bus_Arbiter::getPriority(message));
+}
+
+// Test an urgent request overtakes background polling at a transaction boundary
+TEST_F(I2CBusArbiterTest, UrgentRequestLatency) {
+    I2C_Simulated_Transport transport;
+    transport.setLatencyModel(true, 0);
+    transport.addDevice(0x20, 1);
+    transport.addDevice(0x21, 1);
+    transport.setExtraLatency(0x21, 5000);
+
+    I2C_Interface interface(&transport, "arbiter_test", 1000, false);
+    interface.setType(MESSAGE_AND_FREERUNNING);
+    for (uint8_t index = 0; index < 10; index++) {
+        I2C_Message read;
+        read.configureRead(vector<uint8_t>({ index }), 1);
+        I2C_Transaction_Message event(0x21, vector<I2C_Message>({ read }));
+        event.setPeriod(1000);
+        event.setPriority(I2C_PRIORITY_BACKGROUND);
+        interface.registerEvent(event);
+    }
+    interface.begin();
+    usleep(30000);
+
+    I2C_Transaction_Message urgent = createWrite(0x10, I2C_PRIORITY_URGENT);
+    MONOCURRTIME(submitTs);
+    interface.enque(&urgent);
+    Message *response = NULL;
+    int64_t timeNow = submitTs;
+    while (!response && (timeNow - submitTs) < 1000000) {
+        response = interface.dequeue();
+        usleep(100);
+        MONOTIMEUS(timeNow);
+    }
+    interface.end();
+
+    EXPECT_EQ(&urgent, response);
+    EXPECT_GT(20000, timeNow - submitTs);
+    EXPECT_EQ(1, interface.getExecutedCount(I2C_PRIORITY_URGENT));
+    EXPECT_LT(0, interface.getExecutedCount(I2C_PRIORITY_BACKGROUND));
+}
+
+// Test stale transactions are answered with DEADLINE_EXPIRED instead of running
+TEST_F(I2CBusArbiterTest, StaleRequestDropped) {
+    I2C_Simulated_Transport transport;
+    transport.setLatencyModel(false, 0);
+    transport.addDevice(0x20, 1);
+    I2C_Interface interface(&transport, "deadline_test", 1000, false);
+    interface.setType(MESSAGE_AND_FREERUNNING);
+
+    I2C_Transaction_Message stale = createWrite(0x10, I2C_PRIORITY_NORMAL);
+    stale.setDeadline(1, true);
+    I2C_Transaction_Message fresh = createWrite(0x11, I2C_PRIORITY_NORMAL);
+    fresh.setDeadline(1000000, true);
+    usleep(1000);
+    interface.enque(&stale);
+    interface.enque(&fresh);
+    interface.begin();
+    usleep(20000);
+    interface.end();
+
+    EXPECT_EQ(DEADLINE_EXPIRED, stale.getError().getCode());
+    EXPECT_FALSE(fresh.getError().isError());
+    EXPECT_EQ(vector<uint8_t>({ 0x00 }), transport.getRegisters(0x20, 0x10, 1));
+    EXPECT_EQ(vector<uint8_t>({ 0x01 }), transport.getRegisters(0x20, 0x11, 1));
+    EXPECT_EQ(1, interface.getDroppedCount(I2C_PRIORITY_NORMAL));
+    EXPECT_EQ(1, interface.getExecutedCount(I2C_PRIORITY_NORMAL));
+}
@@ -0,0 +1,198 @@
+/*
+ * test_i2c_bus_health.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "utils/I2CBusHealth.h"
+#include "utils/I2CSimulatedTransport.h"
+
+using namespace apra;
+
+class I2CBusHealthTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        policy.m_enabled = true;
+        policy.m_quarantineThreshold = 2;
+        policy.m_quarantineBaseUsec = 1000;
+        policy.m_quarantineMaxUsec = 4000;
+        policy.m_stuckChipThreshold = 2;
+        policy.m_stuckErrorThreshold = 3;
+        policy.m_stuckTimeoutUsec = 100000;
+        policy.m_recoveryBaseUsec = 500;
+        policy.m_recoveryMaxUsec = 2000;
+        health.setPolicy(policy);
+    }
+
+    void TearDown() override {
+        // Cleanup code for each test
+    }
+
+    I2C_Health_Policy policy;
+    I2C_Bus_Health health;
+};
+
+// Test backoff doubles per level and saturates at the maximum
+TEST_F(I2CBusHealthTest, Backoff) {
+    EXPECT_EQ(100, I2C_Bus_Health::getBackoffUsec(100, 1000, 0));
+    EXPECT_EQ(200, I2C_Bus_Health::getBackoffUsec(100, 1000, 1));
+    EXPECT_EQ(800, I2C_Bus_Health::getBackoffUsec(100, 1000, 3));
+    EXPECT_EQ(1000, I2C_Bus_Health::getBackoffUsec(100, 1000, 4));
+    EXPECT_EQ(1000, I2C_Bus_Health::getBackoffUsec(100, 1000, 200));
+}
+
+// Test a failing chip is quarantined with growing periods
+TEST_F(I2CBusHealthTest, ChipQuarantine) {
+    health.recordResult(0x20, false, 0);
+    EXPECT_TRUE(health.isChipAvailable(0x20, 0));
+    health.recordResult(0x20, false, 0);
+    EXPECT_FALSE(health.isChipAvailable(0x20, 999));
+    EXPECT_TRUE(health.isChipAvailable(0x20, 1000));
+    EXPECT_TRUE(health.isChipAvailable(0x21, 0));
+
+    health.recordResult(0x20, false, 1000);
+    EXPECT_FALSE(health.isChipAvailable(0x20, 2999));
+    EXPECT_TRUE(health.isChipAvailable(0x20, 3000));
+    EXPECT_EQ(2, health.getQuarantineCount(0x20));
+
+    health.recordResult(0x20, true, 3000);
+    health.recordResult(0x20, false, 3000);
+    EXPECT_TRUE(health.isChipAvailable(0x20, 3000));
+}
+
+// Test a single failing chip among healthy ones does not mark the bus stuck
+TEST_F(I2CBusHealthTest, SingleChipIsNotStuck) {
+    for (int64_t timeNow = 0; timeNow < 10; timeNow++) {
+        health.recordResult(0x20, false, timeNow);
+        health.recordResult(0x21, true, timeNow);
+    }
+    EXPECT_FALSE(health.isBusStuck());
+}
+
+// Test failures across chips mark the bus stuck and recovery backs off
+TEST_F(I2CBusHealthTest, StuckBusRecovery) {
+    health.recordResult(0x20, false, 0);
+    health.recordResult(0x21, false, 0);
+    EXPECT_FALSE(health.isBusStuck());
+    health.recordResult(0x22, false, 0);
+    EXPECT_TRUE(health.isBusStuck());
+    EXPECT_TRUE(health.isRecoveryDue(0));
+
+    health.recordRecovery(false, 0);
+    EXPECT_TRUE(health.isBusStuck());
+    EXPECT_FALSE(health.isRecoveryDue(499));
+    EXPECT_TRUE(health.isRecoveryDue(500));
+    health.recordRecovery(true, 500);
+    EXPECT_FALSE(health.isBusStuck());
+    EXPECT_TRUE(health.isChipAvailable(0x20, 500));
+    EXPECT_EQ(2, health.getRecoveryCount());
+
+    health.recordResult(0x20, true, 600);
+    EXPECT_FALSE(health.isRecoveryDue(600));
+}
+
+// Test a long run of failures without success marks the bus stuck
+TEST_F(I2CBusHealthTest, StuckTimeout) {
+    health.recordResult(0x20, false, 0);
+    EXPECT_FALSE(health.isBusStuck());
+    health.recordResult(0x20, false, 100000);
+    EXPECT_TRUE(health.isBusStuck());
+}
+
+// Test a dead chip does not slow down polling of a healthy chip
+TEST_F(I2CBusHealthTest, DeadChipQuarantinedOnInterface) {
+    I2C_Simulated_Transport transport;
+    transport.setLatencyModel(true, 0);
+    transport.addDevice(0x20, 1);
+    transport.addDevice(0x21, 1);
+    transport.injectNack(0x21, 1000000);
+
+    I2C_Interface interface(&transport, "health_test", 1000, false);
+    I2C_Health_Policy interfacePolicy;
+    interfacePolicy.m_enabled = true;
+    interfacePolicy.m_quarantineBaseUsec = 50000;
+    interface.setHealthPolicy(interfacePolicy);
+    for (uint8_t chip = 0x20; chip <= 0x21; chip++) {
+        I2C_Message read;
+        read.configureRead(vector<uint8_t>({ 0x00 }), 1);
+        read.setRetries(3);
+        read.m_retryDelayInUsec = 5000;
+        // Retries run to completion, so their delays must yield the bus
+        read.m_allowOtherProcessOnIdle = true;
+        I2C_Transaction_Message event(chip, vector<I2C_Message>({ read }));
+        event.setPeriod(2000);
+        interface.registerEvent(event);
+    }
+    interface.begin();
+    usleep(200000);
+    interface.end();
+
+    EXPECT_LT(60, transport.getTransferCount(0x20));
+    EXPECT_GT(20, transport.getTransferCount(0x21));
+    EXPECT_LE(1, interface.getBusHealth().getQuarantineCount(0x21));
+    EXPECT_FALSE(interface.getBusHealth().isBusStuck());
+}
+
+// Test a stuck bus is reopened and traffic resumes once it clears
+TEST_F(I2CBusHealthTest, StuckBusReopened) {
+    I2C_Simulated_Transport transport;
+    transport.setLatencyModel(false, 0);
+    transport.addDevice(0x20, 1);
+    transport.addDevice(0x21, 1);
+
+    I2C_Interface interface(&transport, "stuck_test", 1000, false);
+    interface.setHealthPolicy(policy);
+    for (uint8_t chip = 0x20; chip <= 0x21; chip++) {
+        I2C_Message read;
+        read.configureRead(vector<uint8_t>({ 0x00 }), 1);
+        I2C_Transaction_Message event(chip, vector<I2C_Message>({ read }));
+        event.setPeriod(1000);
+        interface.registerEvent(event);
+    }
+    transport.setBusStuck(true);
+    interface.begin();
+    usleep(50000);
+    EXPECT_LE(1, interface.getBusHealth().getRecoveryCount());
+    transport.setBusStuck(false);
+    usleep(50000);
+    interface.end();
+
+    EXPECT_FALSE(interface.getBusHealth().isBusStuck());
+    EXPECT_TRUE(interface.isSuccessfullSetup());
+}
+
+// Test quarantine never cuts a message's own retries short
+TEST_F(I2CBusHealthTest, RetriesRunToCompletion) {
+    EXPECT_FALSE(I2C_Health_Policy().m_enabled);
+    I2C_Simulated_Transport transport;
+    transport.setLatencyModel(false, 0);
+    transport.addDevice(0x20, 1);
+    transport.injectNack(0x20, 5);
+
+    I2C_Interface interface(&transport, "retry_test", 1000, false);
+    interface.setType(MESSAGE_AND_FREERUNNING);
+    interface.setHealthPolicy(policy);
+    I2C_Message read;
+    read.configureRead(vector<uint8_t>({ 0x00 }), 1);
+    read.setRetries(8);
+    I2C_Transaction_Message *request = new I2C_Transaction_Message(0x20,
+            vector<I2C_Message>({ read }));
+    interface.enque(request);
+    interface.begin();
+    usleep(30000);
+    interface.end();
+
+    EXPECT_EQ(request, interface.dequeue());
+    EXPECT_FALSE(request->getError().isError());
+    EXPECT_EQ(6, transport.getTransferCount(0x20));
+    EXPECT_EQ(0, interface.getBusHealth().getQuarantineCount(0x20));
+    delete request;
+}
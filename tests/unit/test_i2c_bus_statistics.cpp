@@ -0,0 +1,115 @@
+/*
+ * test_i2c_bus_statistics.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include "models/I2CBusStatistics.h"
+
+using namespace apra;
+
+class I2CBusStatisticsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Setup code for each test
+    }
+
+    void TearDown() override {
+        // Cleanup code for each test
+    }
+};
+
+// Test default statistics are empty
+TEST_F(I2CBusStatisticsTest, DefaultCreation) {
+    I2C_Bus_Statistics statistics;
+
+    EXPECT_EQ(I2C_DEFAULT_BUS_CLOCK_HZ, statistics.m_busClockHz);
+    EXPECT_EQ(0, statistics.m_total.getOperationCount());
+    EXPECT_EQ(0, statistics.m_chips.size());
+    EXPECT_DOUBLE_EQ(0, statistics.getBusOccupancy());
+}
+
+// Test latency histogram bucket boundaries
+TEST_F(I2CBusStatisticsTest, LatencyBuckets) {
+    EXPECT_EQ(0, I2C_Register_Statistics::getLatencyBucket(0));
+    EXPECT_EQ(1, I2C_Register_Statistics::getLatencyBucket(1));
+    EXPECT_EQ(2, I2C_Register_Statistics::getLatencyBucket(2));
+    EXPECT_EQ(2, I2C_Register_Statistics::getLatencyBucket(3));
+    EXPECT_EQ(3, I2C_Register_Statistics::getLatencyBucket(4));
+    EXPECT_EQ(I2C_LATENCY_BUCKET_COUNT - 1,
+            I2C_Register_Statistics::getLatencyBucket(UINT64_MAX));
+    EXPECT_EQ(3, I2C_Register_Statistics::getLatencyBucketLimitUsec(2));
+}
+
+// Test transfers are aggregated per register, chip and bus
+TEST_F(I2CBusStatisticsTest, RecordTransferAggregates) {
+    I2C_Bus_Statistics statistics;
+    statistics.recordTransfer(0x48, 0x00, true, 2, 100, 50, NO_ERROR);
+    statistics.recordTransfer(0x48, 0x01, false, 2, 300, 60, NO_ERROR);
+    statistics.recordTransfer(0x49, 0x00, true, 1, 50, 40, READ_ERROR);
+
+    EXPECT_EQ(3, statistics.m_total.getOperationCount());
+    EXPECT_EQ(2, statistics.m_total.m_readCount);
+    EXPECT_EQ(1, statistics.m_total.m_writeCount);
+    EXPECT_EQ(2, statistics.m_total.m_bytesRead);
+    EXPECT_EQ(2, statistics.m_total.m_bytesWritten);
+    EXPECT_EQ(150, statistics.m_total.m_busTimeUsec);
+    EXPECT_EQ(300, statistics.m_total.m_maxLatencyUsec);
+    EXPECT_EQ(150, statistics.m_total.getAverageLatencyUsec());
+
+    ASSERT_EQ(2, statistics.m_chips.size());
+    EXPECT_EQ(2, statistics.m_chips[0x48].m_total.getOperationCount());
+    EXPECT_EQ(2, statistics.m_chips[0x48].m_registers.size());
+    EXPECT_EQ(1, statistics.m_chips[0x49].m_total.m_errorCount);
+    EXPECT_EQ(1, statistics.m_chips[0x49].m_total.m_errorCodes[READ_ERROR]);
+}
+
+// Test retries are counted on every level
+TEST_F(I2CBusStatisticsTest, RecordRetry) {
+    I2C_Bus_Statistics statistics;
+    statistics.recordRetry(0x48, 0x10);
+    statistics.recordRetry(0x48, 0x10);
+
+    EXPECT_EQ(2, statistics.m_total.m_retryCount);
+    EXPECT_EQ(2, statistics.m_chips[0x48].m_total.m_retryCount);
+    EXPECT_EQ(2, statistics.m_chips[0x48].m_registers[0x10].m_retryCount);
+}
+
+// Test merging register statistics
+TEST_F(I2CBusStatisticsTest, MergeRegisterStatistics) {
+    I2C_Register_Statistics first;
+    I2C_Register_Statistics second;
+    first.recordTransfer(true, 2, 10, 5, NO_ERROR);
+    second.recordTransfer(false, 1, 20, 5, WRITE_ERROR);
+
+    first.merge(second);
+
+    EXPECT_EQ(2, first.getOperationCount());
+    EXPECT_EQ(20, first.m_maxLatencyUsec);
+    EXPECT_EQ(1, first.m_errorCodes[WRITE_ERROR]);
+}
+
+// Test bus time estimation from the clock model
+TEST_F(I2CBusStatisticsTest, EstimateTransferTime) {
+    // 1 register byte + 1 data byte write: 10 + 18 + 1 = 29 bits
+    EXPECT_EQ(290, I2C_Bus_Statistics::estimateTransferUsec(100000, 2, 0));
+    // 1 register byte write, 2 data bytes read: 10 + 9 + 1 + 10 + 18 = 48 bits
+    EXPECT_EQ(120, I2C_Bus_Statistics::estimateTransferUsec(400000, 1, 2));
+    EXPECT_EQ(0, I2C_Bus_Statistics::estimateTransferUsec(0, 1, 2));
+}
+
+// Test bus occupancy over the collection window
+TEST_F(I2CBusStatisticsTest, BusOccupancy) {
+    I2C_Bus_Statistics statistics;
+    statistics.reset(1000);
+    statistics.recordTransfer(0x48, 0x00, true, 2, 100, 250, NO_ERROR);
+    statistics.m_snapshotTs = 2000;
+
+    EXPECT_DOUBLE_EQ(0.25, statistics.getBusOccupancy());
+}
@@ -0,0 +1,85 @@
+/*
+ * test_i2c_callback_dispatcher.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <unistd.h>
+#include "controllers/I2CCallbackDispatcher.h"
+
+using namespace apra;
+
+namespace
+{
+std::atomic<int> g_callbackCount(0);
+std::atomic<uint16_t> g_lastChip(0);
+
+void* countingCallback(void*, const I2C_Transaction_Message &message) {
+    g_lastChip = message.m_chipNumber;
+    g_callbackCount++;
+    return NULL;
+}
+}
+
+class I2CCallbackDispatcherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        g_callbackCount = 0;
+        g_lastChip = 0;
+    }
+
+    std::shared_ptr<const I2C_Transaction_Message> createMessage(uint16_t chip) {
+        std::shared_ptr<I2C_Transaction_Message> message =
+                std::make_shared<I2C_Transaction_Message>();
+        message->m_chipNumber = chip;
+        message->registerConstEventHandle((void*) countingCallback, NULL);
+        return message;
+    }
+};
+
+// Test that a const callback is reported as an event handle
+TEST_F(I2CCallbackDispatcherTest, ConstCallbackRegistration) {
+    I2C_Transaction_Message message;
+    EXPECT_FALSE(message.hasEventHandle());
+    message.registerConstEventHandle((void*) countingCallback, NULL);
+    EXPECT_TRUE(message.hasEventHandle());
+
+    message.publishTransaction();
+    EXPECT_EQ(1, g_callbackCount);
+}
+
+// Test that dispatched messages are published on the dispatcher thread
+TEST_F(I2CCallbackDispatcherTest, DispatchPublishesOnThread) {
+    I2C_Callback_Dispatcher dispatcher("DispatcherTest", 8);
+    ASSERT_EQ(0, dispatcher.begin());
+
+    EXPECT_TRUE(dispatcher.dispatch(createMessage(0x48)));
+    EXPECT_TRUE(dispatcher.dispatch(createMessage(0x49)));
+    for (int i = 0; (i < 100) && (g_callbackCount < 2); i++) {
+        usleep(1000);
+    }
+    dispatcher.end();
+
+    EXPECT_EQ(2, g_callbackCount);
+    EXPECT_EQ(0x49, g_lastChip);
+    EXPECT_EQ(2, dispatcher.getDispatchedCount());
+    EXPECT_EQ(0, dispatcher.getDroppedCount());
+}
+
+// Test that dispatch drops instead of blocking when the queue is full
+TEST_F(I2CCallbackDispatcherTest, DispatchDropsWhenFull) {
+    I2C_Callback_Dispatcher dispatcher("DispatcherTest", 2);
+
+    EXPECT_TRUE(dispatcher.dispatch(createMessage(0x48)));
+    EXPECT_TRUE(dispatcher.dispatch(createMessage(0x48)));
+    EXPECT_FALSE(dispatcher.dispatch(createMessage(0x48)));
+    EXPECT_EQ(1, dispatcher.getDroppedCount());
+    EXPECT_EQ(0, g_callbackCount);
+}
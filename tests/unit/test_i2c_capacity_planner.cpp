@@ -0,0 +1,137 @@
+/*
+ * test_i2c_capacity_planner.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "utils/I2CCapacityPlanner.h"
+#include "utils/I2CSimulatedTransport.h"
+
+using namespace apra;
+
+class I2CCapacityPlannerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        policy.m_mode = I2C_ADMIT_REJECT;
+        policy.m_budget = 0.5;
+    }
+
+    void TearDown() override {
+        // Cleanup code for each test
+    }
+
+    // One 480 usec read at 100 kHz
+    I2C_Transaction_Message makeRead(uint64_t periodUsec) {
+        I2C_Message read;
+        read.configureRead(vector<uint8_t>({ 0x00 }), 2);
+        I2C_Transaction_Message message(0x20, vector<I2C_Message>({ read }));
+        message.setPeriod(periodUsec);
+        return message;
+    }
+
+    I2C_Capacity_Entry estimate(I2C_Transaction_Message message) {
+        return I2C_Capacity_Planner::estimate(message.getHandle(), message,
+                message.m_periodUsec);
+    }
+
+    I2C_Capacity_Policy policy;
+};
+
+// Test bus time is costed from bytes, clock, overhead and blocking delays
+TEST_F(I2CCapacityPlannerTest, Estimate) {
+    I2C_Message read;
+    read.configureRead(vector<uint8_t>({ 0x00 }), 2);
+    read.addDelay(100);
+    I2C_Message write;
+    write.configureWrite(vector<uint8_t>({ 0x10 }), vector<uint8_t>({ 0x01 }));
+    write.addDelay(50);
+    write.m_allowOtherProcessOnIdle = true;
+    I2C_Transaction_Message message(0x20,
+            vector<I2C_Message>({ read, write }));
+    message.setPeriod(10000);
+
+    I2C_Capacity_Planner planner;
+    EXPECT_TRUE(planner.admit(estimate(message)));
+    I2C_Capacity_Report report = planner.getReport();
+    ASSERT_EQ(1, report.m_entries.size());
+    EXPECT_EQ(770, report.m_entries[0].m_busTimeUsec);
+    EXPECT_EQ(100, report.m_entries[0].m_delayUsec);
+    EXPECT_DOUBLE_EQ(0.087, planner.getUtilisation());
+
+    planner.setBusClock(400000);
+    EXPECT_EQ(193, planner.getReport().m_entries[0].m_busTimeUsec);
+    policy.m_transferOverheadUsec = 10;
+    planner.setPolicy(policy);
+    EXPECT_EQ(213, planner.getReport().m_entries[0].m_busTimeUsec);
+}
+
+// Test registrations past the budget are refused until load is removed
+TEST_F(I2CCapacityPlannerTest, RejectOverBudget) {
+    I2C_Capacity_Planner planner;
+    planner.setPolicy(policy);
+    I2C_Transaction_Message first = makeRead(1500);
+    EXPECT_TRUE(planner.admit(estimate(first)));
+    EXPECT_FALSE(planner.admit(estimate(makeRead(1500))));
+    EXPECT_TRUE(planner.admit(estimate(makeRead(100000))));
+    EXPECT_EQ(1, planner.getRejectedCount());
+    EXPECT_FALSE(planner.getReport().isOversubscribed());
+
+    planner.remove(first.getHandle());
+    EXPECT_TRUE(planner.admit(estimate(makeRead(1500))));
+    EXPECT_EQ(2, planner.getReport().m_entries.size());
+}
+
+// Test warn mode admits and counts, admit-all only accounts
+TEST_F(I2CCapacityPlannerTest, WarnAndAdmitAll) {
+    I2C_Capacity_Planner planner;
+    policy.m_mode = I2C_ADMIT_WARN;
+    planner.setPolicy(policy);
+    for (int count = 0; count < 3; count++) {
+        EXPECT_TRUE(planner.admit(estimate(makeRead(1000))));
+    }
+    EXPECT_EQ(2, planner.getWarningCount());
+    EXPECT_TRUE(planner.getReport().isOversubscribed());
+
+    policy.m_mode = I2C_ADMIT_ALL;
+    planner.setPolicy(policy);
+    EXPECT_TRUE(planner.admit(estimate(makeRead(1000))));
+    EXPECT_EQ(2, planner.getWarningCount());
+    EXPECT_DOUBLE_EQ(1.92, planner.getUtilisation());
+}
+
+// Test the interface refuses overload and reports projected against measured
+TEST_F(I2CCapacityPlannerTest, InterfaceReport) {
+    I2C_Simulated_Transport transport;
+    transport.setLatencyModel(true, 0);
+    transport.addDevice(0x20, 1);
+    I2C_Interface interface(&transport, "capacity_test", 1000, false);
+    interface.setCapacityPolicy(policy);
+    uint64_t handle = interface.registerEvent(makeRead(4000));
+    EXPECT_NE(0, handle);
+    EXPECT_EQ(0, interface.registerEvent(makeRead(1000)));
+    interface.begin();
+    usleep(60000);
+    interface.end();
+
+    I2C_Capacity_Report report = interface.getCapacityReport();
+    ASSERT_EQ(1, report.m_entries.size());
+    const I2C_Capacity_Entry &entry = report.m_entries[0];
+    EXPECT_EQ(handle, entry.m_handle);
+    EXPECT_DOUBLE_EQ(0.12, report.m_projectedUtilisation);
+    EXPECT_LT(5, entry.m_executionCount);
+    EXPECT_NEAR(4000, entry.m_measuredPeriodUsec, 2000);
+    EXPECT_LE(480, entry.m_measuredExecutionUsec);
+    EXPECT_LT(0.1, report.m_measuredUtilisation);
+    EXPECT_LT(0, report.m_measuredBusOccupancy);
+
+    interface.unregisterEvent(handle);
+    EXPECT_EQ(0, interface.getCapacityPlanner().getUtilisation());
+}
@@ -0,0 +1,228 @@
+/*
+ * test_i2c_device_snapshot.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "utils/I2CDeviceSnapshot.h"
+#include "utils/I2CSimulatedTransport.h"
+
+using namespace apra;
+
+class I2CDeviceSnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        snapshotPath = "/tmp/aprautils_test_i2c_snapshot.bin";
+        unlink(snapshotPath.c_str());
+        transport.setLatencyModel(false, 0);
+        transport.addDevice(0x68, 1);
+    }
+
+    void TearDown() override {
+        unlink(snapshotPath.c_str());
+    }
+
+    // Two configuration writes, both checked back as signature registers
+    I2C_Device_Init makeInit(uint8_t rate = 0x03) {
+        I2C_Message power;
+        power.configureWrite(vector<uint8_t>({ 0x6B }),
+                vector<uint8_t>({ 0x01 }));
+        I2C_Message config;
+        config.configureWrite(vector<uint8_t>({ 0x1A }),
+                vector<uint8_t>({ rate }));
+        I2C_Device_Init device(0x68, vector<I2C_Message>({ power, config }));
+        device.addSignature(vector<uint8_t>({ 0x6B }), 1);
+        device.addSignature(vector<uint8_t>({ 0x1A }), 1);
+        return device;
+    }
+
+    // Runs one process lifetime and returns the transfers it cost
+    uint64_t restart(const I2C_Device_Init &device, I2CError &response,
+            bool &isWarm) {
+        uint64_t transferCount = transport.getTransferCount();
+        I2C_Interface interface(&transport, "snapshot_test", 1000, false);
+        interface.loadDeviceSnapshot(snapshotPath);
+        response = interface.initDevice(device);
+        isWarm = interface.getDeviceSnapshot().getWarmCount() == 1;
+        return transport.getTransferCount() - transferCount;
+    }
+
+    string snapshotPath;
+    I2C_Simulated_Transport transport;
+};
+
+// Test the first start runs the full init and a restart only verifies
+TEST_F(I2CDeviceSnapshotTest, WarmRestart) {
+    I2CError response;
+    bool isWarm = true;
+    EXPECT_EQ(4, restart(makeInit(), response, isWarm));
+    EXPECT_FALSE(response.isError());
+    EXPECT_FALSE(isWarm);
+    EXPECT_EQ(vector<uint8_t>({ 0x03 }), transport.getRegisters(0x68, 0x1A, 1));
+
+    EXPECT_EQ(2, restart(makeInit(), response, isWarm));
+    EXPECT_FALSE(response.isError());
+    EXPECT_TRUE(isWarm);
+    EXPECT_EQ(2, restart(makeInit(), response, isWarm));
+    EXPECT_TRUE(isWarm);
+}
+
+// Test a reset device or a changed init sequence falls back to a full init
+TEST_F(I2CDeviceSnapshotTest, FallbackToFullInit) {
+    I2CError response;
+    bool isWarm = false;
+    restart(makeInit(), response, isWarm);
+
+    transport.setRegisters(0x68, 0x6B, vector<uint8_t>({ 0x40 }));
+    EXPECT_EQ(6, restart(makeInit(), response, isWarm));
+    EXPECT_FALSE(isWarm);
+    EXPECT_EQ(vector<uint8_t>({ 0x01 }), transport.getRegisters(0x68, 0x6B, 1));
+
+    EXPECT_EQ(4, restart(makeInit(0x05), response, isWarm));
+    EXPECT_FALSE(isWarm);
+    EXPECT_EQ(vector<uint8_t>({ 0x05 }), transport.getRegisters(0x68, 0x1A, 1));
+    EXPECT_EQ(2, restart(makeInit(0x05), response, isWarm));
+    EXPECT_TRUE(isWarm);
+}
+
+// Test only devices confirmed in this run are saved and bad files are refused
+TEST_F(I2CDeviceSnapshotTest, SaveAndLoad) {
+    I2C_Device_Init device = makeInit();
+    vector<I2C_Message> signature = device.m_signature;
+    signature[0].m_data = vector<uint8_t>({ 0x01 });
+    signature[1].m_data = vector<uint8_t>({ 0x03 });
+    I2C_Device_Snapshot snapshot;
+    snapshot.record(device, signature);
+    EXPECT_TRUE(snapshot.save(snapshotPath));
+
+    I2C_Device_Snapshot loaded;
+    EXPECT_TRUE(loaded.load(snapshotPath));
+    EXPECT_EQ(1, loaded.size());
+    EXPECT_TRUE(loaded.isCurrent(device));
+    EXPECT_FALSE(loaded.isCurrent(makeInit(0x05)));
+    signature[1].m_data = vector<uint8_t>({ 0x04 });
+    EXPECT_FALSE(loaded.verify(device, signature));
+    EXPECT_TRUE(loaded.save(snapshotPath));
+    EXPECT_TRUE(loaded.load(snapshotPath));
+    EXPECT_EQ(0, loaded.size());
+
+    FILE *file = fopen(snapshotPath.c_str(), "wb");
+    fputs("API2CSNP", file);
+    fclose(file);
+    EXPECT_FALSE(loaded.load(snapshotPath));
+    EXPECT_FALSE(loaded.load("/tmp/aprautils_missing_snapshot.bin"));
+}
+
+// Test a failed init leaves nothing to trust on the next start
+TEST_F(I2CDeviceSnapshotTest, FailedInit) {
+    I2C_Device_Init device = makeInit();
+    device.m_chipAddress = 0x40;
+    I2C_Interface interface(&transport, "snapshot_test", 1000, false);
+    interface.loadDeviceSnapshot(snapshotPath);
+    EXPECT_TRUE(interface.initDevice(device).isError());
+    EXPECT_EQ(0, interface.getDeviceSnapshot().size());
+    EXPECT_EQ(1, interface.getDeviceSnapshot().getColdCount());
+    EXPECT_TRUE(interface.saveDeviceSnapshot());
+
+    I2C_Device_Snapshot snapshot;
+    EXPECT_TRUE(snapshot.load(snapshotPath));
+    EXPECT_EQ(0, snapshot.size());
+}
+
+// Test only registers that differ are written and re-applying costs reads
+TEST_F(I2CDeviceSnapshotTest, WriteChangedOnly) {
+    vector<I2C_Message> messages;
+    for (uint8_t offset = 0; offset < 4; offset++) {
+        I2C_Message write;
+        write.configureWrite(vector<uint8_t>({ (uint8_t) (0x10 + offset) }),
+                vector<uint8_t>({ (uint8_t) (offset + 1) }));
+        messages.push_back(write);
+    }
+    I2C_Message command;
+    command.configureWrite(vector<uint8_t>({ 0x20 }),
+            vector<uint8_t>({ 0x55 }));
+    command.m_allowCoalescing = false;
+    messages.push_back(command);
+    I2C_Device_Init device(0x68, messages);
+    device.m_writeChangedOnly = true;
+    device.m_verify = true;
+    transport.setRegisters(0x68, 0x10,
+            vector<uint8_t>({ 0x01, 0x02, 0x09, 0x04 }));
+    transport.setRegisters(0x68, 0x20, vector<uint8_t>({ 0x55 }));
+
+    I2C_Interface interface(&transport, "snapshot_test", 1000, false);
+    I2C_Init_Report report;
+    uint64_t transferCount = transport.getTransferCount();
+    EXPECT_FALSE(interface.initDevice(device, report).isError());
+    EXPECT_EQ(2, report.m_readCount);
+    EXPECT_EQ(2, report.m_writeCount);
+    EXPECT_EQ(3, report.m_skippedWriteCount);
+    EXPECT_EQ(4, transport.getTransferCount() - transferCount);
+    EXPECT_EQ(vector<uint8_t>({ 0x01, 0x02, 0x03, 0x04 }),
+            transport.getRegisters(0x68, 0x10, 4));
+
+    EXPECT_FALSE(interface.initDevice(device, report).isError());
+    EXPECT_EQ(1, report.m_readCount);
+    EXPECT_EQ(1, report.m_writeCount);
+    EXPECT_EQ(4, report.m_skippedWriteCount);
+}
+
+// Test verification reports registers that did not take the written value
+TEST_F(I2CDeviceSnapshotTest, VerifyAfterWrite) {
+    I2C_Message write;
+    write.configureWrite(vector<uint8_t>({ 0x11 }),
+            vector<uint8_t>({ 0x0A, 0x0B }));
+    I2C_Device_Init device(0x68, vector<I2C_Message>({ write }));
+    device.m_verify = true;
+    I2C_Interface interface(&transport, "snapshot_test", 1000, false);
+    I2C_Init_Report report;
+    EXPECT_FALSE(interface.initDevice(device, report).isError());
+    EXPECT_EQ(1, report.m_writeCount);
+    EXPECT_EQ(1, report.m_readCount);
+
+    // Page rollover sends the second byte back to 0x10
+    transport.setEepromModel(0x68, 2, 0);
+    transport.setRegisters(0x68, 0x10, vector<uint8_t>({ 0x00, 0x00, 0x00 }));
+    EXPECT_EQ(VERIFY_ERROR, interface.initDevice(device, report).getCode());
+    EXPECT_EQ(1, report.m_mismatchCount);
+    EXPECT_EQ(0, interface.getDeviceSnapshot().size());
+}
+
+// Test init retries stay on the caller and a quarantined chip is not touched
+TEST_F(I2CDeviceSnapshotTest, InitOnCallerThread) {
+    transport.addDevice(0x20, 1);
+    transport.injectNack(0x68, 1000000);
+    I2C_Interface interface(&transport, "snapshot_test", 1000, false);
+    interface.setType(MESSAGE_AND_FREERUNNING);
+    I2C_Health_Policy policy;
+    policy.m_enabled = true;
+    policy.m_quarantineThreshold = 2;
+    policy.m_quarantineBaseUsec = 10000000;
+    interface.setHealthPolicy(policy);
+    I2C_Message read;
+    read.configureRead(vector<uint8_t>({ 0x00 }), 1);
+    I2C_Transaction_Message queued(0x20, vector<I2C_Message>({ read }));
+    queued.setPriority(I2C_PRIORITY_URGENT);
+    interface.enque(&queued);
+
+    I2C_Device_Init device = makeInit();
+    device.m_initMessages[0].setRetries(2);
+    device.m_initMessages[0].m_retryDelayInUsec = 1000;
+    device.m_initMessages[0].m_allowOtherProcessOnIdle = true;
+    EXPECT_TRUE(interface.initDevice(device).isError());
+    EXPECT_EQ(3, transport.getTransferCount(0x68));
+    EXPECT_EQ(0, transport.getTransferCount(0x20));
+
+    EXPECT_TRUE(interface.initDevice(device).isError());
+    EXPECT_EQ(CHIP_QUARANTINED, interface.initDevice(device).getCode());
+    EXPECT_EQ(6, transport.getTransferCount(0x68));
+}
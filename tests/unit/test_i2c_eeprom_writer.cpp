@@ -0,0 +1,243 @@
+/*
+ * test_i2c_eeprom_writer.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "utils/I2CBus.h"
+#include "utils/I2CEepromWriter.h"
+#include "utils/I2CSimulatedTransport.h"
+
+using namespace apra;
+
+class I2CEepromWriterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        transport.setLatencyModel(false, 0);
+        transport.addDevice(0x50, 2);
+        transport.setEepromModel(0x50, 32, 2000);
+        bus = new I2C_Bus(&transport, false);
+        bus->openBus();
+        for (size_t index = 0; index < 200; index++) {
+            data.push_back((index * 7 + 3) & 0xFF);
+        }
+    }
+
+    void TearDown() override {
+        delete bus;
+    }
+
+    I2C_Simulated_Transport transport;
+    I2C_Bus *bus;
+    vector<uint8_t> data;
+};
+
+// Test buffers are split at page boundaries
+TEST_F(I2CEepromWriterTest, PageSpans) {
+    vector<pair<uint64_t, size_t> > spans = I2C_Eeprom_Writer::getPageSpans(
+            30, 70, 32);
+    ASSERT_EQ(4, spans.size());
+    EXPECT_EQ(make_pair((uint64_t) 30, (size_t) 2), spans[0]);
+    EXPECT_EQ(make_pair((uint64_t) 32, (size_t) 32), spans[1]);
+    EXPECT_EQ(make_pair((uint64_t) 64, (size_t) 32), spans[2]);
+    EXPECT_EQ(make_pair((uint64_t) 96, (size_t) 4), spans[3]);
+    EXPECT_EQ(1, I2C_Eeprom_Writer::getPageSpans(64, 32, 32).size());
+    EXPECT_TRUE(I2C_Eeprom_Writer::getPageSpans(0, 10, 0).empty());
+}
+
+// Test an unaligned buffer is written page by page and verified
+TEST_F(I2CEepromWriterTest, WriteAndVerify) {
+    I2C_Eeprom_Writer writer(*bus);
+    I2C_Eeprom_Config config(0x50, 2, 32, 4096);
+    I2C_Eeprom_Report report;
+
+    I2CError error = writer.write(config, 10, data, report);
+    EXPECT_FALSE(error.isError());
+    EXPECT_EQ(200, report.m_bytesWritten);
+    EXPECT_EQ(7, report.m_pageCount);
+    EXPECT_LT(0, report.m_pollCount);
+    EXPECT_EQ(0, report.m_mismatchCount);
+    EXPECT_LE(2000, report.m_maxWriteCycleUsec);
+    EXPECT_LT(0, report.getThroughputBytesPerSec());
+    EXPECT_EQ(data, transport.getRegisters(0x50, 10, 200));
+
+    vector<uint8_t> readBack;
+    EXPECT_FALSE(writer.read(config, 10, 200, readBack).isError());
+    EXPECT_EQ(data, readBack);
+}
+
+// Test acknowledge polling beats waiting a worst-case write cycle per page
+TEST_F(I2CEepromWriterTest, FasterThanFixedDelay) {
+    I2C_Eeprom_Writer writer(*bus);
+    I2C_Eeprom_Config config(0x50, 2, 32, 4096);
+    config.m_verify = false;
+    I2C_Eeprom_Report report;
+
+    ASSERT_FALSE(writer.write(config, 0, data, report).isError());
+    EXPECT_EQ(7, report.m_pageCount);
+    EXPECT_GT((int64_t) (report.m_pageCount * 5000), report.m_writeTimeUsec);
+    EXPECT_EQ(0, report.m_verifyTimeUsec);
+}
+
+// Test a page size larger than the chip's is caught by the read-back
+TEST_F(I2CEepromWriterTest, VerifyDetectsPageRollover) {
+    transport.setEepromModel(0x50, 16, 500);
+    I2C_Eeprom_Writer writer(*bus);
+    I2C_Eeprom_Config config(0x50, 2, 32, 4096);
+    I2C_Eeprom_Report report;
+
+    I2CError error = writer.write(config, 0, data, report);
+    EXPECT_EQ(VERIFY_ERROR, error.getCode());
+    EXPECT_LT(0, report.m_mismatchCount);
+    EXPECT_EQ(0, report.m_firstMismatchAddress);
+}
+
+// Test writes beyond the configured capacity are rejected up front
+TEST_F(I2CEepromWriterTest, CapacityChecked) {
+    I2C_Eeprom_Writer writer(*bus);
+    I2C_Eeprom_Config config(0x50, 2, 32, 128);
+    I2C_Eeprom_Report report;
+
+    EXPECT_TRUE(writer.write(config, 0, data, report).isError());
+    EXPECT_EQ(0, transport.getTransferCount());
+}
+
+// Test a missing chip fails after the write-cycle timeout
+TEST_F(I2CEepromWriterTest, MissingChipTimesOut) {
+    I2C_Eeprom_Writer writer(*bus);
+    I2C_Eeprom_Config config(0x51, 2, 32, 4096);
+    config.m_writeCycleTimeoutUsec = 2000;
+    I2C_Eeprom_Report report;
+
+    EXPECT_EQ(WRITE_ERROR, writer.write(config, 0, data, report).getCode());
+    EXPECT_EQ(0, report.m_pageCount);
+}
+
+// Test upper address bits select the chip on block-addressed parts
+TEST_F(I2CEepromWriterTest, BlockAddressedChip) {
+    for (uint8_t chip = 0x50; chip <= 0x57; chip++) {
+        transport.addDevice(chip, 1);
+        transport.setEepromModel(chip, 16, 1000);
+    }
+    I2C_Eeprom_Writer writer(*bus);
+    I2C_Eeprom_Config config(0x50, 1, 16, 2048);
+    I2C_Eeprom_Report report;
+
+    ASSERT_FALSE(writer.write(config, 250, data, report).isError());
+    EXPECT_EQ(vector<uint8_t>(data.begin(), data.begin() + 6),
+            transport.getRegisters(0x50, 250, 6));
+    EXPECT_EQ(vector<uint8_t>(data.begin() + 6, data.end()),
+            transport.getRegisters(0x51, 0, 194));
+}
+
+// Test the interface writes while its event polling keeps running
+TEST_F(I2CEepromWriterTest, WriteThroughInterface) {
+    I2C_Simulated_Transport interfaceTransport;
+    interfaceTransport.setLatencyModel(false, 0);
+    interfaceTransport.addDevice(0x20, 1);
+    interfaceTransport.addDevice(0x50, 2);
+    interfaceTransport.setEepromModel(0x50, 32, 2000);
+
+    I2C_Interface interface(&interfaceTransport, "eeprom_test", 1000, false);
+    I2C_Message read;
+    read.configureRead(vector<uint8_t>({ 0x00 }), 1);
+    I2C_Transaction_Message event(0x20, vector<I2C_Message>({ read }));
+    event.setPeriod(1000);
+    interface.registerEvent(event);
+    interface.begin();
+    usleep(5000);
+    uint64_t pollsBefore = interfaceTransport.getTransferCount(0x20);
+
+    I2C_Eeprom_Config config(0x50, 2, 32, 4096);
+    I2C_Eeprom_Report report;
+    I2CError error = interface.writeEeprom(config, 0, data, report);
+    uint64_t pollsDuring = interfaceTransport.getTransferCount(0x20)
+            - pollsBefore;
+    interface.end();
+
+    EXPECT_FALSE(error.isError());
+    EXPECT_EQ(data, interfaceTransport.getRegisters(0x50, 0, 200));
+    EXPECT_LT(3, pollsDuring);
+}
+
+// Test a write drops cached reads of every block it touched
+TEST_F(I2CEepromWriterTest, WriteInvalidatesBlockReads) {
+    I2C_Simulated_Transport interfaceTransport;
+    interfaceTransport.setLatencyModel(false, 0);
+    for (uint8_t chip = 0x50; chip <= 0x51; chip++) {
+        interfaceTransport.addDevice(chip, 1);
+        interfaceTransport.setEepromModel(chip, 16, 1000);
+    }
+    I2C_Interface interface(&interfaceTransport, "eeprom_cache_test", 1000,
+            false);
+    interface.setReadCoalescing(true, 10000000);
+    interface.setType(MESSAGE_AND_FREERUNNING);
+    I2C_Message read;
+    read.configureRead(vector<uint8_t>({ 0x00 }), 2);
+    I2C_Transaction_Message before(0x51, vector<I2C_Message>({ read }));
+    interface.enque(&before);
+    interface.begin();
+    usleep(20000);
+
+    I2C_Eeprom_Config config(0x50, 1, 16, 2048);
+    I2C_Eeprom_Report report;
+    ASSERT_FALSE(interface.writeEeprom(config, 250, data, report).isError());
+    I2C_Transaction_Message after(0x51, vector<I2C_Message>({ read }));
+    interface.enque(&after);
+    usleep(20000);
+    interface.end();
+
+    EXPECT_EQ(vector<uint8_t>({ 0x00, 0x00 }), before.m_messages[0].m_data);
+    EXPECT_EQ(vector<uint8_t>(data.begin() + 6, data.begin() + 8),
+            after.m_messages[0].m_data);
+}
+
+// Test an EEPROM behind a mux is reached while polling switches channels
+TEST_F(I2CEepromWriterTest, MuxRoutedWrite) {
+    I2C_Simulated_Transport interfaceTransport;
+    interfaceTransport.setLatencyModel(false, 0);
+    interfaceTransport.addDevice(0x70, 1);
+    interfaceTransport.addDevice(0x20, 1);
+    interfaceTransport.addDevice(0x50, 2);
+    interfaceTransport.setEepromModel(0x50, 32, 2000);
+    interfaceTransport.setMuxChannel(0x20, 0x70, 0);
+    interfaceTransport.setMuxChannel(0x50, 0x70, 1);
+
+    I2C_Interface interface(&interfaceTransport, "eeprom_mux_test", 1000,
+            false);
+    ASSERT_TRUE(interface.addMuxDevice(0x20, 0x70, 0));
+    ASSERT_TRUE(interface.addMuxDevice(0x50, 0x70, 1));
+    I2C_Message read;
+    read.configureRead(vector<uint8_t>({ 0x00 }), 1);
+    I2C_Transaction_Message event(0x20, vector<I2C_Message>({ read }));
+    event.setPeriod(1000);
+    interface.registerEvent(event);
+    interface.begin();
+    usleep(5000);
+    uint64_t pollsBefore = interfaceTransport.getTransferCount(0x20);
+
+    I2C_Eeprom_Config config(0x50, 2, 32, 4096);
+    I2C_Eeprom_Report report;
+    I2CError error = interface.writeEeprom(config, 0, data, report);
+    vector<uint8_t> readBack;
+    I2CError readError = interface.readEeprom(config, 0, data.size(),
+            readBack);
+    uint64_t pollsDuring = interfaceTransport.getTransferCount(0x20)
+            - pollsBefore;
+    interface.end();
+
+    EXPECT_FALSE(error.isError());
+    EXPECT_FALSE(readError.isError());
+    EXPECT_EQ(0, report.m_mismatchCount);
+    EXPECT_EQ(data, interfaceTransport.getRegisters(0x50, 0, 200));
+    EXPECT_EQ(data, readBack);
+    EXPECT_LT(3, pollsDuring);
+}
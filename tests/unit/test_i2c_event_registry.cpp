@@ -0,0 +1,128 @@
+/*
+ * test_i2c_event_registry.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "utils/I2CEventRegistry.h"
+#include "utils/I2CSimulatedTransport.h"
+
+using namespace apra;
+
+class I2CEventRegistryTest : public ::testing::Test {
+protected:
+    I2C_Transaction_Message createReadTransaction(uint16_t chip) {
+        I2C_Message readMsg;
+        readMsg.configureRead(0x10, 1, 2);
+        std::vector<I2C_Message> messages;
+        messages.push_back(readMsg);
+        return I2C_Transaction_Message(chip, messages);
+    }
+
+    static void* captureEvent(void *context,
+            const I2C_Transaction_Message &message) {
+        *static_cast<I2C_Transaction_Message*>(context) = message;
+        return NULL;
+    }
+};
+
+// Test that a new registry publishes an empty snapshot
+TEST_F(I2CEventRegistryTest, EmptyRegistry) {
+    I2C_Event_Registry registry;
+
+    EXPECT_EQ(0, registry.size());
+    EXPECT_EQ(0, registry.getVersion());
+    ASSERT_TRUE(registry.getSnapshot() != nullptr);
+    EXPECT_TRUE(registry.getSnapshot()->empty());
+}
+
+// Test that adding an event publishes a new snapshot and version
+TEST_F(I2CEventRegistryTest, AddPublishesNewSnapshot) {
+    I2C_Event_Registry registry;
+    I2C_Transaction_Message message = createReadTransaction(0x48);
+    std::shared_ptr<const I2C_Event_Map> before = registry.getSnapshot();
+
+    uint64_t handle = registry.add(message);
+
+    EXPECT_EQ(message.getHandle(), handle);
+    EXPECT_EQ(1, registry.getVersion());
+    EXPECT_TRUE(before->empty());
+    std::shared_ptr<const I2C_Event_Map> after = registry.getSnapshot();
+    ASSERT_EQ(1, after->size());
+    EXPECT_EQ(0x48, after->at(handle)->m_message.m_chipNumber);
+    EXPECT_FALSE(after->at(handle)->m_isScheduled);
+}
+
+// Test that snapshots share event entries instead of copying them
+TEST_F(I2CEventRegistryTest, SnapshotsShareEntries) {
+    I2C_Event_Registry registry;
+    uint64_t first = registry.add(createReadTransaction(0x48));
+    std::shared_ptr<const I2C_Event_Map> before = registry.getSnapshot();
+
+    registry.add(createReadTransaction(0x49));
+    std::shared_ptr<const I2C_Event_Map> after = registry.getSnapshot();
+
+    EXPECT_EQ(2, after->size());
+    EXPECT_EQ(before->at(first).get(), after->at(first).get());
+}
+
+// Test that removing keeps older snapshots alive and valid
+TEST_F(I2CEventRegistryTest, RemoveKeepsOldSnapshotValid) {
+    I2C_Event_Registry registry;
+    uint64_t handle = registry.add(createReadTransaction(0x48));
+    std::shared_ptr<const I2C_Event_Map> before = registry.getSnapshot();
+
+    EXPECT_TRUE(registry.remove(handle));
+
+    EXPECT_EQ(0, registry.size());
+    EXPECT_EQ(2, registry.getVersion());
+    ASSERT_EQ(1, before->size());
+    EXPECT_EQ(0x48, before->at(handle)->m_message.m_chipNumber);
+}
+
+// Test that removing an unknown handle does not publish
+TEST_F(I2CEventRegistryTest, RemoveUnknownHandle) {
+    I2C_Event_Registry registry;
+
+    EXPECT_FALSE(registry.remove(1234));
+    EXPECT_EQ(0, registry.getVersion());
+}
+
+// Test messages skipped after a failure do not keep the previous tick's data
+TEST_F(I2CEventRegistryTest, SkippedMessagesAreCleared) {
+    I2C_Simulated_Transport transport;
+    transport.setLatencyModel(false, 0);
+    transport.addDevice(0x20, 1);
+    transport.setRegisters(0x20, 0x00, vector<uint8_t>({ 0x11, 0x22 }));
+    I2C_Message first;
+    first.configureRead(vector<uint8_t>({ 0x00 }), 1);
+    I2C_Message second;
+    second.configureRead(vector<uint8_t>({ 0x01 }), 1);
+    I2C_Transaction_Message event(0x20,
+            vector<I2C_Message>({ first, second }));
+    event.m_stopOnAnyTransactionFailure = true;
+    event.setPeriod(2000);
+    I2C_Transaction_Message captured;
+    event.registerConstEventHandle((void*) captureEvent, &captured);
+
+    I2C_Interface interface(&transport, "registry_test", 1000, false);
+    interface.registerEvent(event);
+    interface.begin();
+    usleep(20000);
+    transport.injectNack(0x20, 1000000);
+    usleep(20000);
+    interface.end();
+
+    ASSERT_EQ(2, captured.m_messages.size());
+    EXPECT_TRUE(I2CError(captured.m_messages[0].m_error).isError());
+    EXPECT_TRUE(I2CError(captured.m_messages[1].m_error).isError());
+    EXPECT_TRUE(captured.m_messages[1].m_data.empty());
+}
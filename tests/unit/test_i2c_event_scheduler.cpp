@@ -0,0 +1,115 @@
+/*
+ * test_i2c_event_scheduler.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include "utils/I2CEventScheduler.h"
+
+using namespace apra;
+
+class I2CEventSchedulerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Setup code for each test
+    }
+
+    void TearDown() override {
+        // Cleanup code for each test
+    }
+};
+
+// Test that an empty scheduler has nothing due
+TEST_F(I2CEventSchedulerTest, EmptyScheduler) {
+    I2C_Event_Scheduler scheduler;
+    uint64_t handle = 0;
+    int64_t deadline = 0;
+
+    EXPECT_EQ(0, scheduler.size());
+    EXPECT_FALSE(scheduler.isDue(1000));
+    EXPECT_FALSE(scheduler.popDue(1000, handle, deadline));
+    EXPECT_FALSE(scheduler.getNextDeadline(deadline));
+}
+
+// Test that events pop in deadline order
+TEST_F(I2CEventSchedulerTest, PopsEarliestDeadlineFirst) {
+    I2C_Event_Scheduler scheduler;
+    scheduler.schedule(1, 300);
+    scheduler.schedule(2, 100);
+    scheduler.schedule(3, 200);
+
+    uint64_t handle = 0;
+    int64_t deadline = 0;
+    ASSERT_TRUE(scheduler.popDue(1000, handle, deadline));
+    EXPECT_EQ(2, handle);
+    EXPECT_EQ(100, deadline);
+    ASSERT_TRUE(scheduler.popDue(1000, handle, deadline));
+    EXPECT_EQ(3, handle);
+    ASSERT_TRUE(scheduler.popDue(1000, handle, deadline));
+    EXPECT_EQ(1, handle);
+    EXPECT_FALSE(scheduler.popDue(1000, handle, deadline));
+}
+
+// Test that events are not popped before their deadline
+TEST_F(I2CEventSchedulerTest, NotDueBeforeDeadline) {
+    I2C_Event_Scheduler scheduler;
+    scheduler.schedule(1, 500);
+
+    uint64_t handle = 0;
+    int64_t deadline = 0;
+    EXPECT_FALSE(scheduler.isDue(499));
+    EXPECT_FALSE(scheduler.popDue(499, handle, deadline));
+    EXPECT_TRUE(scheduler.isDue(500));
+    EXPECT_TRUE(scheduler.popDue(500, handle, deadline));
+}
+
+// Test that a removed event is never popped
+TEST_F(I2CEventSchedulerTest, RemovedEventIsDiscarded) {
+    I2C_Event_Scheduler scheduler;
+    scheduler.schedule(1, 100);
+    scheduler.schedule(2, 200);
+    scheduler.remove(1);
+
+    uint64_t handle = 0;
+    int64_t deadline = 0;
+    EXPECT_EQ(1, scheduler.size());
+    ASSERT_TRUE(scheduler.popDue(1000, handle, deadline));
+    EXPECT_EQ(2, handle);
+    EXPECT_FALSE(scheduler.popDue(1000, handle, deadline));
+}
+
+// Test that rescheduling supersedes the earlier deadline
+TEST_F(I2CEventSchedulerTest, RescheduleSupersedesEarlierDeadline) {
+    I2C_Event_Scheduler scheduler;
+    scheduler.schedule(1, 100);
+    scheduler.schedule(1, 400);
+
+    uint64_t handle = 0;
+    int64_t deadline = 0;
+    EXPECT_EQ(1, scheduler.size());
+    EXPECT_FALSE(scheduler.popDue(300, handle, deadline));
+    ASSERT_TRUE(scheduler.getNextDeadline(deadline));
+    EXPECT_EQ(400, deadline);
+}
+
+// Test first deadline alignment to the epoch and phase
+TEST_F(I2CEventSchedulerTest, FirstDeadlineHonoursPhase) {
+    EXPECT_EQ(1250, I2C_Event_Scheduler::getFirstDeadline(1000, 1000, 1000, 250));
+    EXPECT_EQ(3250, I2C_Event_Scheduler::getFirstDeadline(1000, 2300, 1000, 250));
+    EXPECT_EQ(2250, I2C_Event_Scheduler::getFirstDeadline(1000, 2250, 1000, 250));
+    EXPECT_EQ(2300, I2C_Event_Scheduler::getFirstDeadline(1000, 2300, 0, 0));
+}
+
+// Test next deadline keeps phase and skips missed periods
+TEST_F(I2CEventSchedulerTest, NextDeadlineSkipsMissedPeriods) {
+    EXPECT_EQ(2000, I2C_Event_Scheduler::getNextDeadline(1000, 1100, 1000));
+    EXPECT_EQ(5000, I2C_Event_Scheduler::getNextDeadline(1000, 4500, 1000));
+    EXPECT_EQ(5000, I2C_Event_Scheduler::getNextDeadline(1000, 4000, 1000));
+    EXPECT_EQ(4501, I2C_Event_Scheduler::getNextDeadline(1000, 4500, 0));
+}
@@ -0,0 +1,139 @@
+/*
+ * test_i2c_mux_topology.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "utils/I2CBus.h"
+#include "utils/I2CMuxTopology.h"
+#include "utils/I2CSimulatedTransport.h"
+
+using namespace apra;
+
+class I2CMuxTopologyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        transport.setLatencyModel(false, 0);
+        transport.addDevice(0x70, 1);
+        for (uint8_t chip = 0x20; chip <= 0x22; chip++) {
+            transport.addDevice(chip, 1);
+            transport.setRegisters(chip, 0x00, vector<uint8_t>({ chip }));
+        }
+        transport.setMuxChannel(0x20, 0x70, 0);
+        transport.setMuxChannel(0x21, 0x70, 1);
+        transport.setMuxChannel(0x22, 0x70, 0);
+        topology.addDevice(0x20, 0x70, 0);
+        topology.addDevice(0x21, 0x70, 1);
+        topology.addDevice(0x22, 0x70, 0);
+        bus = new I2C_Bus(&transport, false);
+        ASSERT_FALSE(bus->openBus().isError());
+    }
+
+    void TearDown() override {
+        bus->closeBus();
+        delete bus;
+    }
+
+    bool readChip(uint8_t chip) {
+        vector<uint8_t> data;
+        bus->setSize(1, 1);
+        return !bus->genericRead(chip, vector<uint8_t>({ 0x00 }), data).isError()
+                && (data == vector<uint8_t>({ chip }));
+    }
+
+    I2C_Simulated_Transport transport;
+    I2C_Mux_Topology topology;
+    I2C_Bus *bus;
+};
+
+// Test a select write goes out only when the channel changes
+TEST_F(I2CMuxTopologyTest, SelectSkipsRedundantWrites) {
+    EXPECT_FALSE(readChip(0x20));
+    EXPECT_FALSE(topology.isSelected(0x20));
+    EXPECT_FALSE(topology.select(0x20, *bus).isError());
+    EXPECT_TRUE(topology.isSelected(0x20));
+    EXPECT_TRUE(topology.isSelected(0x22));
+    EXPECT_TRUE(readChip(0x20));
+    EXPECT_FALSE(topology.select(0x22, *bus).isError());
+    EXPECT_TRUE(readChip(0x22));
+    EXPECT_EQ(1, transport.getTransferCount(0x70));
+
+    EXPECT_FALSE(topology.select(0x21, *bus).isError());
+    EXPECT_TRUE(readChip(0x21));
+    EXPECT_FALSE(readChip(0x20));
+    EXPECT_EQ(2, transport.getTransferCount(0x70));
+    EXPECT_EQ(2, topology.getSelectCount());
+    EXPECT_EQ(1, topology.getSkippedCount());
+
+    EXPECT_FALSE(topology.select(0x40, *bus).isError());
+    EXPECT_TRUE(topology.isSelected(0x40));
+    EXPECT_EQ(-1, topology.getGroup(0x40));
+    EXPECT_EQ((0x70 << 8) | 1, topology.getGroup(0x21));
+}
+
+// Test invalidation forces the next access to select again
+TEST_F(I2CMuxTopologyTest, InvalidateReselects) {
+    EXPECT_FALSE(topology.select(0x20, *bus).isError());
+    topology.invalidate();
+    EXPECT_FALSE(topology.isSelected(0x20));
+    EXPECT_FALSE(topology.select(0x20, *bus).isError());
+    topology.invalidate(0x22);
+    EXPECT_FALSE(topology.select(0x20, *bus).isError());
+    EXPECT_EQ(3, transport.getTransferCount(0x70));
+
+    transport.injectNack(0x70, 1);
+    topology.invalidate();
+    EXPECT_EQ(MUX_SELECT_ERROR, topology.select(0x20, *bus).getCode());
+    EXPECT_FALSE(topology.isSelected(0x20));
+}
+
+// Test a mux behind another mux is switched upstream first
+TEST_F(I2CMuxTopologyTest, NestedMux) {
+    transport.addDevice(0x71, 1);
+    transport.setMuxChannel(0x71, 0x70, 3);
+    transport.addDevice(0x30, 1);
+    transport.setRegisters(0x30, 0x00, vector<uint8_t>({ 0x30 }));
+    transport.setMuxChannel(0x30, 0x71, 2);
+    EXPECT_TRUE(topology.addDevice(0x71, 0x70, 3));
+    EXPECT_TRUE(topology.addDevice(0x30, 0x71, 2));
+    EXPECT_FALSE(topology.addDevice(0x70, 0x30, 0));
+    EXPECT_FALSE(topology.addDevice(0x31, 0x71, I2C_MUX_CHANNEL_COUNT));
+
+    EXPECT_FALSE(topology.select(0x30, *bus).isError());
+    EXPECT_TRUE(readChip(0x30));
+    EXPECT_EQ(1, transport.getTransferCount(0x70));
+    EXPECT_EQ(1, transport.getTransferCount(0x71));
+    EXPECT_FALSE(topology.select(0x20, *bus).isError());
+    EXPECT_FALSE(topology.isSelected(0x30));
+}
+
+// Test events due together are grouped so each tick switches at most once
+TEST_F(I2CMuxTopologyTest, InterfaceGroupsByChannel) {
+    I2C_Interface interface(&transport, "mux_test", 1000, false);
+    EXPECT_TRUE(interface.addMuxDevice(0x20, 0x70, 0));
+    EXPECT_TRUE(interface.addMuxDevice(0x21, 0x70, 1));
+    EXPECT_TRUE(interface.addMuxDevice(0x22, 0x70, 0));
+    for (uint8_t chip = 0x20; chip <= 0x22; chip++) {
+        I2C_Message read;
+        read.configureRead(vector<uint8_t>({ 0x00 }), 1);
+        I2C_Transaction_Message event(chip, vector<I2C_Message>({ read }));
+        event.setPeriod(2000);
+        interface.registerEvent(event);
+    }
+    interface.begin();
+    usleep(50000);
+    interface.end();
+
+    EXPECT_EQ(0, interface.getStatistics().m_total.m_errorCount);
+    EXPECT_LT(10, transport.getTransferCount(0x21));
+    EXPECT_LT(10, interface.getMuxSelectCount());
+    EXPECT_LT(interface.getMuxSelectCount(), interface.getMuxSkippedCount());
+}
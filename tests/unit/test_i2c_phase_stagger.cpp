@@ -0,0 +1,129 @@
+/*
+ * test_i2c_phase_stagger.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <set>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "utils/I2CPhaseStagger.h"
+#include "utils/I2CSimulatedTransport.h"
+#include "utils/Macro.h"
+
+using namespace apra;
+
+class I2CPhaseStaggerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        transport.setLatencyModel(false, 0);
+    }
+
+    void TearDown() override {
+        // Cleanup code for each test
+    }
+
+    I2C_Transaction_Message makeRead(uint8_t chip, uint64_t periodUsec) {
+        I2C_Message read;
+        read.configureRead(vector<uint8_t>({ 0x00 }), 1);
+        I2C_Transaction_Message message(chip, vector<I2C_Message>({ read }));
+        message.setPeriod(periodUsec);
+        return message;
+    }
+
+    I2C_Simulated_Transport transport;
+};
+
+// Test events sharing a period land in distinct slots and flatten the peak
+TEST_F(I2CPhaseStaggerTest, SpreadsEqualPeriods) {
+    I2C_Phase_Stagger stagger(1000);
+    set<uint64_t> phases;
+    for (uint64_t handle = 1; handle <= 4; handle++) {
+        uint64_t phaseUsec = stagger.assign(handle, 4000, 200);
+        EXPECT_EQ(0, phaseUsec % 1000);
+        EXPECT_GT(4000, phaseUsec);
+        phases.insert(phaseUsec);
+    }
+    EXPECT_EQ(4, phases.size());
+    EXPECT_EQ(200, stagger.getPeakLoadUsec());
+
+    stagger.assign(5, 4000, 200);
+    EXPECT_EQ(400, stagger.getPeakLoadUsec());
+    stagger.remove(5);
+    EXPECT_EQ(200, stagger.getPeakLoadUsec());
+}
+
+// Test a pinned phase is kept and newer events avoid it
+TEST_F(I2CPhaseStaggerTest, PinnedPhaseReserved) {
+    I2C_Phase_Stagger stagger(1000);
+    stagger.reserve(1, 2000, 0, 300);
+    uint64_t phaseUsec = 0;
+    ASSERT_TRUE(stagger.getPhase(1, phaseUsec));
+    EXPECT_EQ(0, phaseUsec);
+    EXPECT_EQ(1000, stagger.assign(2, 2000, 300));
+    EXPECT_FALSE(stagger.getPhase(3, phaseUsec));
+
+    stagger.clear();
+    EXPECT_EQ(0, stagger.getPeakLoadUsec());
+}
+
+// Test a slower event is placed where the faster ones leave room
+TEST_F(I2CPhaseStaggerTest, MixedPeriods) {
+    I2C_Phase_Stagger stagger(1000);
+    EXPECT_EQ(0, stagger.assign(1, 2000, 100));
+    EXPECT_EQ(1000, stagger.assign(2, 4000, 100));
+    EXPECT_EQ(3000, stagger.assign(3, 4000, 100));
+    EXPECT_EQ(100, stagger.getPeakLoadUsec());
+    EXPECT_EQ(0, stagger.assign(4, 500, 50));
+    EXPECT_EQ(150, stagger.getPeakLoadUsec());
+}
+
+// Test hour and day long periods stay within the capped timeline
+TEST_F(I2CPhaseStaggerTest, LongPeriods) {
+    I2C_Phase_Stagger stagger(1000);
+    MONOCURRTIME(startTs);
+    EXPECT_EQ(0, stagger.assign(1, 3600000000ULL, 500));
+    EXPECT_EQ(1000, stagger.assign(2, 10000, 500));
+    EXPECT_EQ(2000, stagger.assign(3, 86400000000ULL, 500));
+    MONOCURRTIME(endTs);
+    EXPECT_EQ(500, stagger.getPeakLoadUsec());
+    EXPECT_GT(100000, endTs - startTs);
+}
+
+// Test the interface staggers unpinned events without lowering their rates
+TEST_F(I2CPhaseStaggerTest, InterfaceStaggersEvents) {
+    I2C_Interface interface(&transport, "stagger_test", 1000, false);
+    interface.setPhaseStaggering(true);
+    I2C_Transaction_Message pinned = makeRead(0x24, 4000);
+    transport.addDevice(0x24, 1);
+    pinned.pinPhase(0);
+    uint64_t pinnedHandle = interface.registerEvent(pinned);
+    vector<uint64_t> handles;
+    for (uint8_t chip = 0x20; chip <= 0x23; chip++) {
+        transport.addDevice(chip, 1);
+        handles.push_back(interface.registerEvent(makeRead(chip, 4000)));
+    }
+    interface.begin();
+    usleep(60000);
+    interface.end();
+
+    EXPECT_EQ(0, interface.getEventPhaseUsec(pinnedHandle));
+    set<uint64_t> phases;
+    for (size_t index = 0; index < handles.size(); index++) {
+        phases.insert(interface.getEventPhaseUsec(handles[index]));
+    }
+    EXPECT_EQ(4, phases.size());
+    EXPECT_EQ(1, phases.count(1000));
+    EXPECT_EQ(1, phases.count(2000));
+    EXPECT_EQ(1, phases.count(3000));
+    for (uint8_t chip = 0x20; chip <= 0x24; chip++) {
+        EXPECT_LT(10, transport.getTransferCount(chip));
+    }
+    EXPECT_EQ(0, interface.getStatistics().m_total.m_errorCount);
+}
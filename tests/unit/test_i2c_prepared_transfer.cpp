@@ -0,0 +1,148 @@
+/*
+ * test_i2c_prepared_transfer.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "utils/I2CBus.h"
+#include "utils/I2CPreparedTransfer.h"
+#include "utils/I2CSimulatedTransport.h"
+
+using namespace apra;
+
+class I2CPreparedTransferTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        transport.setLatencyModel(false, 0);
+        transport.addDevice(0x20, 1);
+        transport.addDevice(0x50, 2);
+        transport.setRegisters(0x20, 0x10, vector<uint8_t>({ 0x11, 0x22 }));
+        transport.setRegisters(0x50, 0x0100,
+                vector<uint8_t>({ 0xA1, 0xA2, 0xA3 }));
+        bus = new I2C_Bus(&transport, false);
+        ASSERT_FALSE(bus->openBus().isError());
+    }
+
+    void TearDown() override {
+        bus->closeBus();
+        delete bus;
+    }
+
+    I2C_Simulated_Transport transport;
+    I2C_Bus *bus;
+};
+
+// Test a prepared read over I2C_RDWR returns the register contents
+TEST_F(I2CPreparedTransferTest, PreparedRead) {
+    I2C_Prepared_Transfer prepared;
+    EXPECT_FALSE(prepared.isPrepared());
+    bus->prepare(prepared, 0x50, vector<uint8_t>({ 0x01, 0x00 }), 3, true);
+    EXPECT_TRUE(prepared.isPrepared());
+    EXPECT_EQ(2, prepared.m_messageCount);
+    EXPECT_EQ(-1, prepared.m_smbusTransaction);
+
+    vector<uint8_t> data;
+    for (int count = 0; count < 3; count++) {
+        EXPECT_FALSE(bus->execute(prepared, data).isError());
+        EXPECT_EQ(vector<uint8_t>({ 0xA1, 0xA2, 0xA3 }), data);
+    }
+    EXPECT_EQ(3, transport.getTransferCount());
+    EXPECT_EQ(0, transport.getSMBusTransferCount());
+}
+
+// Test single-byte registers are prepared as SMBus transfers
+TEST_F(I2CPreparedTransferTest, PreparedSMBus) {
+    I2C_Prepared_Transfer prepared;
+    bus->prepare(prepared, 0x20, vector<uint8_t>({ 0x10 }), 2, true);
+    EXPECT_EQ(I2C_SMBUS_WORD_DATA, prepared.m_smbusTransaction);
+
+    vector<uint8_t> data;
+    EXPECT_FALSE(bus->execute(prepared, data).isError());
+    EXPECT_EQ(vector<uint8_t>({ 0x11, 0x22 }), data);
+    EXPECT_EQ(1, transport.getSMBusTransferCount());
+}
+
+// Test a prepared write follows a change of data length
+TEST_F(I2CPreparedTransferTest, PreparedWrite) {
+    I2C_Prepared_Transfer prepared;
+    bus->prepare(prepared, 0x50, vector<uint8_t>({ 0x02, 0x00 }), 2, false);
+    EXPECT_EQ(1, prepared.m_messageCount);
+
+    vector<uint8_t> data({ 0x01, 0x02 });
+    EXPECT_FALSE(bus->execute(prepared, data).isError());
+    vector<uint8_t> longer({ 0x05, 0x06, 0x07 });
+    EXPECT_FALSE(bus->execute(prepared, longer).isError());
+    EXPECT_EQ(3, prepared.m_dataSize);
+    EXPECT_EQ(longer, transport.getRegisters(0x50, 0x0200, 3));
+}
+
+// Test reopening the bus re-resolves the transfer against its functionality
+TEST_F(I2CPreparedTransferTest, ReopenReprepares) {
+    I2C_Prepared_Transfer prepared;
+    bus->prepare(prepared, 0x20, vector<uint8_t>({ 0x10 }), 2, true);
+    EXPECT_EQ(I2C_SMBUS_WORD_DATA, prepared.m_smbusTransaction);
+
+    bus->closeBus();
+    transport.setFunctionality(I2C_FUNC_I2C);
+    ASSERT_FALSE(bus->openBus().isError());
+    vector<uint8_t> data;
+    EXPECT_FALSE(bus->execute(prepared, data).isError());
+    EXPECT_EQ(-1, prepared.m_smbusTransaction);
+    EXPECT_EQ(vector<uint8_t>({ 0x11, 0x22 }), data);
+    EXPECT_EQ(0, transport.getSMBusTransferCount());
+}
+
+// Test copies keep their messages bound to their own buffer
+TEST_F(I2CPreparedTransferTest, CopyRebindsBuffers) {
+    I2C_Prepared_Transfer *original = new I2C_Prepared_Transfer();
+    bus->prepare(*original, 0x50, vector<uint8_t>({ 0x01, 0x00 }), 3, true);
+    I2C_Prepared_Transfer copy(*original);
+    vector<I2C_Prepared_Transfer> transfers(2);
+    transfers[1] = *original;
+    delete original;
+
+    EXPECT_EQ(copy.m_buffer.data(), copy.m_messages[0].buf);
+    vector<uint8_t> data;
+    EXPECT_FALSE(bus->execute(copy, data).isError());
+    EXPECT_EQ(vector<uint8_t>({ 0xA1, 0xA2, 0xA3 }), data);
+    EXPECT_FALSE(bus->execute(transfers[1], data).isError());
+    EXPECT_EQ(vector<uint8_t>({ 0xA1, 0xA2, 0xA3 }), data);
+}
+
+// Test failed prepared transfers report the operation and are counted
+TEST_F(I2CPreparedTransferTest, PreparedFailure) {
+    I2C_Prepared_Transfer prepared;
+    bus->prepare(prepared, 0x51, vector<uint8_t>({ 0x00, 0x00 }), 1, true);
+    vector<uint8_t> data;
+    EXPECT_EQ(READ_ERROR, bus->execute(prepared, data).getCode());
+    EXPECT_EQ(1, bus->getStatistics().m_total.m_errorCount);
+}
+
+// Test registered events run through transfers prepared at scheduling
+TEST_F(I2CPreparedTransferTest, EventsUsePreparedTransfers) {
+    I2C_Interface interface(&transport, "prepared_test", 1000, false);
+    I2C_Message read;
+    read.configureRead(vector<uint8_t>({ 0x01, 0x00 }), 3);
+    I2C_Message write;
+    write.configureWrite(vector<uint8_t>({ 0x03, 0x00 }),
+            vector<uint8_t>({ 0x5A }));
+    I2C_Transaction_Message event(0x50, vector<I2C_Message>({ read, write }));
+    event.setPeriod(2000);
+    interface.registerEvent(event);
+    interface.begin();
+    usleep(30000);
+    interface.end();
+
+    I2C_Bus_Statistics statistics = interface.getStatistics();
+    EXPECT_LT(4, transport.getTransferCount(0x50));
+    EXPECT_EQ(0, statistics.m_total.m_errorCount);
+    EXPECT_EQ(vector<uint8_t>({ 0x5A }), transport.getRegisters(0x50, 0x0300, 1));
+}
@@ -0,0 +1,131 @@
+/*
+ * test_i2c_publish_filter.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "models/I2CRegisteredEvent.h"
+#include "utils/I2CSimulatedTransport.h"
+
+using namespace apra;
+
+namespace
+{
+std::atomic<int> g_publishedCount(0);
+
+void* publishedCallback(void*, const I2C_Transaction_Message&) {
+    g_publishedCount++;
+    return NULL;
+}
+}
+
+class I2CPublishFilterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        g_publishedCount = 0;
+    }
+
+    void TearDown() override {
+        // Cleanup code for each test
+    }
+
+    I2C_Transaction_Message makeRead() {
+        I2C_Message read;
+        read.configureRead(vector<uint8_t>({ 0x00 }), 2);
+        I2C_Message write;
+        write.configureWrite(vector<uint8_t>({ 0x10 }),
+                vector<uint8_t>({ 0x01 }));
+        return I2C_Transaction_Message(0x20,
+                vector<I2C_Message>({ read, write }));
+    }
+
+    bool publish(I2C_Registered_Event &event, vector<uint8_t> data) {
+        event.m_message.m_messages[0].m_data = data;
+        return event.shouldPublish();
+    }
+};
+
+// Test unfiltered events publish every result
+TEST_F(I2CPublishFilterTest, Always) {
+    I2C_Registered_Event event(makeRead());
+    EXPECT_TRUE(publish(event, vector<uint8_t>({ 0x00, 0x01 })));
+    EXPECT_TRUE(publish(event, vector<uint8_t>({ 0x00, 0x01 })));
+    EXPECT_EQ(0, event.m_suppressedCount);
+}
+
+// Test on-change publishes the first result and then only differences
+TEST_F(I2CPublishFilterTest, OnChange) {
+    I2C_Transaction_Message message = makeRead();
+    message.setPublishFilter(I2C_PUBLISH_ON_CHANGE);
+    I2C_Registered_Event event(message);
+    EXPECT_TRUE(publish(event, vector<uint8_t>({ 0x00, 0x01 })));
+    EXPECT_FALSE(publish(event, vector<uint8_t>({ 0x00, 0x01 })));
+    EXPECT_TRUE(publish(event, vector<uint8_t>({ 0x00, 0x02 })));
+    EXPECT_FALSE(publish(event, vector<uint8_t>({ 0x00, 0x02 })));
+
+    event.m_message.setError(I2CError("read failed", READ_ERROR));
+    EXPECT_TRUE(publish(event, vector<uint8_t>({ 0x00, 0x02 })));
+    event.m_message.setError(I2CError());
+    EXPECT_TRUE(publish(event, vector<uint8_t>({ 0x00, 0x02 })));
+    EXPECT_EQ(2, event.m_suppressedCount);
+}
+
+// Test the deadband is measured from the last published value
+TEST_F(I2CPublishFilterTest, Deadband) {
+    I2C_Transaction_Message message = makeRead();
+    message.setPublishFilter(I2C_PUBLISH_DEADBAND, 4);
+    I2C_Registered_Event event(message);
+    EXPECT_TRUE(publish(event, vector<uint8_t>({ 0x01, 0x00 })));
+    EXPECT_FALSE(publish(event, vector<uint8_t>({ 0x01, 0x03 })));
+    EXPECT_FALSE(publish(event, vector<uint8_t>({ 0x01, 0x04 })));
+    EXPECT_TRUE(publish(event, vector<uint8_t>({ 0x01, 0x05 })));
+    EXPECT_FALSE(publish(event, vector<uint8_t>({ 0x01, 0x01 })));
+    EXPECT_TRUE(publish(event, vector<uint8_t>({ 0x00, 0xFF })));
+    EXPECT_EQ(3, event.m_suppressedCount);
+}
+
+// Test every Nth result is published starting with the first
+TEST_F(I2CPublishFilterTest, EveryNth) {
+    I2C_Transaction_Message message = makeRead();
+    message.setPublishFilter(I2C_PUBLISH_EVERY_NTH, 3);
+    I2C_Registered_Event event(message);
+    int published = 0;
+    for (int sample = 0; sample < 9; sample++) {
+        published += publish(event, vector<uint8_t>({ 0x00, 0x01 }));
+    }
+    EXPECT_EQ(3, published);
+    EXPECT_EQ(6, event.m_suppressedCount);
+}
+
+// Test a static register reaches the callback once while polling continues
+TEST_F(I2CPublishFilterTest, InterfaceSuppressesStaticValues) {
+    I2C_Simulated_Transport transport;
+    transport.setLatencyModel(false, 0);
+    transport.addDevice(0x20, 1);
+    transport.setRegisters(0x20, 0x00, vector<uint8_t>({ 0x12, 0x34 }));
+    I2C_Interface interface(&transport, "publish_filter", 1000, false);
+    I2C_Transaction_Message message = makeRead();
+    message.setPeriod(1000);
+    message.setPublishFilter(I2C_PUBLISH_ON_CHANGE);
+    message.registerConstEventHandle((void*) publishedCallback, NULL);
+    uint64_t handle = interface.registerEvent(message);
+    interface.begin();
+    usleep(30000);
+    EXPECT_EQ(1, g_publishedCount);
+    transport.setRegisters(0x20, 0x00, vector<uint8_t>({ 0x12, 0x35 }));
+    usleep(10000);
+    interface.end();
+
+    EXPECT_EQ(2, g_publishedCount);
+    EXPECT_LT(10, interface.getSuppressedCount(handle));
+    EXPECT_EQ(0, interface.getSuppressedCount(handle + 1000));
+}
@@ -0,0 +1,139 @@
+/*
+ * test_i2c_read_cache.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "utils/I2CReadCache.h"
+#include "utils/I2CSimulatedTransport.h"
+
+using namespace apra;
+
+class I2CReadCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        transport.setLatencyModel(false, 0);
+        transport.addDevice(0x20, 1);
+        transport.setRegisters(0x20, 0x00, vector<uint8_t>({ 0x5A, 0xA5 }));
+    }
+
+    void TearDown() override {
+        // Cleanup code for each test
+    }
+
+    I2C_Transaction_Message makeRead(uint8_t registerNumber) {
+        I2C_Message read;
+        read.configureRead(vector<uint8_t>({ registerNumber }), 2);
+        return I2C_Transaction_Message(0x20, vector<I2C_Message>({ read }));
+    }
+
+    I2C_Transaction_Message makeWrite(uint8_t value) {
+        I2C_Message write;
+        write.configureWrite(vector<uint8_t>({ 0x00 }),
+                vector<uint8_t>({ value, 0x00 }));
+        return I2C_Transaction_Message(0x20, vector<I2C_Message>({ write }));
+    }
+
+    void runQueued(I2C_Interface &interface,
+            vector<I2C_Transaction_Message> &messages) {
+        interface.setType(MESSAGE_AND_FREERUNNING);
+        for (size_t index = 0; index < messages.size(); index++) {
+            interface.enque(&messages[index]);
+        }
+        interface.begin();
+        usleep(20000);
+        interface.end();
+    }
+
+    I2C_Simulated_Transport transport;
+};
+
+// Test a result serves requests made before the read and stays fresh for the window
+TEST_F(I2CReadCacheTest, RequestTimeAndFreshness) {
+    I2C_Read_Cache cache;
+    vector<uint8_t> reg({ 0x00 });
+    vector<uint8_t> data;
+    EXPECT_FALSE(cache.lookup(0x20, reg, 2, 100, 100, data));
+    cache.store(0x20, reg, vector<uint8_t>({ 0x01, 0x02 }), 200);
+    EXPECT_TRUE(cache.lookup(0x20, reg, 2, 150, 300, data));
+    EXPECT_EQ(vector<uint8_t>({ 0x01, 0x02 }), data);
+    EXPECT_FALSE(cache.lookup(0x20, reg, 2, 250, 300, data));
+    EXPECT_FALSE(cache.lookup(0x20, reg, 1, 150, 300, data));
+
+    cache.setFreshness(2000);
+    EXPECT_TRUE(cache.lookup(0x20, reg, 2, 250, 2200, data));
+    EXPECT_FALSE(cache.lookup(0x20, reg, 2, 250, 2201, data));
+    EXPECT_EQ(2, cache.getHitCount());
+    EXPECT_EQ(4, cache.getMissCount());
+}
+
+// Test invalidating a chip keeps the other chips' results
+TEST_F(I2CReadCacheTest, InvalidateChip) {
+    I2C_Read_Cache cache;
+    cache.store(0x20, vector<uint8_t>({ 0x00 }), vector<uint8_t>({ 0x01 }), 0);
+    cache.store(0x20, vector<uint8_t>({ 0x01 }), vector<uint8_t>({ 0x01 }), 0);
+    cache.store(0x21, vector<uint8_t>({ 0x00 }), vector<uint8_t>({ 0x01 }), 0);
+    EXPECT_EQ(3, cache.size());
+    cache.invalidate(0x20);
+    EXPECT_EQ(1, cache.size());
+    vector<uint8_t> data;
+    EXPECT_TRUE(cache.lookup(0x21, vector<uint8_t>({ 0x00 }), 1, 0, 0, data));
+    cache.invalidate();
+    EXPECT_EQ(0, cache.size());
+}
+
+// Test identical queued reads share one bus read and a write forces a new one
+TEST_F(I2CReadCacheTest, InterfaceCoalescesQueuedReads) {
+    I2C_Interface interface(&transport, "coalesce_test", 1000, false);
+    interface.setReadCoalescing(true);
+    vector<I2C_Transaction_Message> messages;
+    for (int client = 0; client < 4; client++) {
+        messages.push_back(makeRead(0x00));
+    }
+    messages.push_back(makeRead(0x01));
+    messages.push_back(makeWrite(0x11));
+    messages.push_back(makeRead(0x00));
+    runQueued(interface, messages);
+
+    for (int client = 0; client < 4; client++) {
+        EXPECT_FALSE(messages[client].getError().isError());
+        EXPECT_EQ(vector<uint8_t>({ 0x5A, 0xA5 }),
+                messages[client].m_messages[0].m_data);
+    }
+    EXPECT_EQ(vector<uint8_t>({ 0x11, 0x00 }), messages[6].m_messages[0].m_data);
+    EXPECT_EQ(4, transport.getTransferCount(0x20));
+    EXPECT_EQ(3, interface.getCoalescedReadCount());
+}
+
+// Test the freshness window serves later requests and opted-out reads reach the bus
+TEST_F(I2CReadCacheTest, InterfaceFreshnessWindow) {
+    I2C_Interface interface(&transport, "freshness_test", 1000, false);
+    interface.setReadCoalescing(true, 1000000);
+    vector<I2C_Transaction_Message> messages;
+    messages.push_back(makeRead(0x00));
+    runQueued(interface, messages);
+    transport.setRegisters(0x20, 0x00, vector<uint8_t>({ 0x01, 0x02 }));
+
+    messages.clear();
+    messages.push_back(makeRead(0x00));
+    messages.push_back(makeRead(0x00));
+    messages[1].m_messages[0].m_allowCoalescing = false;
+    runQueued(interface, messages);
+    EXPECT_EQ(vector<uint8_t>({ 0x5A, 0xA5 }), messages[0].m_messages[0].m_data);
+    EXPECT_EQ(vector<uint8_t>({ 0x01, 0x02 }), messages[1].m_messages[0].m_data);
+    EXPECT_EQ(2, transport.getTransferCount(0x20));
+
+    interface.setReadCoalescing(false);
+    messages.clear();
+    messages.push_back(makeRead(0x00));
+    runQueued(interface, messages);
+    EXPECT_EQ(3, transport.getTransferCount(0x20));
+}
@@ -0,0 +1,152 @@
+/*
+ * test_i2c_register_map.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <type_traits>
+#include "utils/I2CRegisterMap.h"
+#include "utils/I2CSimulatedTransport.h"
+
+using namespace apra;
+
+typedef I2C_Register<0x01, 1, 2> ConfigRegister;
+typedef I2C_Register<0x1234, 2, 3, I2C_LITTLE_ENDIAN, false> CalibrationRegister;
+typedef I2C_Field<ConfigRegister, 13, 2> ResolutionField;
+typedef I2C_Field<ConfigRegister, 0, 1> ShutdownField;
+typedef I2C_Register_Device<0x48> Sensor;
+
+static_assert(std::is_same<ConfigRegister::value_type, uint16_t>::value,
+        "two data bytes map to uint16_t");
+static_assert(std::is_same<CalibrationRegister::value_type, uint32_t>::value,
+        "three data bytes map to uint32_t");
+static_assert(ResolutionField::MASK == 0x6000, "field mask is resolved at compile time");
+static_assert(ResolutionField::set(0xFFFF, 0) == 0x9FFF, "field set is constexpr");
+static_assert(!CalibrationRegister::IS_VOLATILE, "volatility is part of the declaration");
+
+class I2CRegisterMapTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Setup code for each test
+    }
+
+    void TearDown() override {
+        // Cleanup code for each test
+    }
+
+    static void* decodeConfig(void *context,
+            const I2C_Transaction_Message &message) {
+        ConfigRegister::value_type value = 0;
+        if (ConfigRegister::decode(message.m_messages[0], value)) {
+            *static_cast<ConfigRegister::value_type*>(context) = value;
+        }
+        return NULL;
+    }
+};
+
+// Test big-endian encode and decode
+TEST_F(I2CRegisterMapTest, BigEndianRoundTrip) {
+    ConfigRegister::data_bytes bytes = ConfigRegister::encode(0x60A0);
+    EXPECT_EQ(0x60, bytes[0]);
+    EXPECT_EQ(0xA0, bytes[1]);
+    EXPECT_EQ(0x60A0, ConfigRegister::decode(bytes));
+    EXPECT_EQ(1, ConfigRegister::encodeAddress().size());
+    EXPECT_EQ(0x01, ConfigRegister::encodeAddress()[0]);
+}
+
+// Test little-endian data with a multi-byte address
+TEST_F(I2CRegisterMapTest, LittleEndianRoundTrip) {
+    CalibrationRegister::address_bytes address = CalibrationRegister::encodeAddress();
+    EXPECT_EQ(0x12, address[0]);
+    EXPECT_EQ(0x34, address[1]);
+
+    CalibrationRegister::data_bytes bytes = CalibrationRegister::encode(0xABCDEF);
+    EXPECT_EQ(0xEF, bytes[0]);
+    EXPECT_EQ(0xCD, bytes[1]);
+    EXPECT_EQ(0xAB, bytes[2]);
+    EXPECT_EQ(0xABCDEF, CalibrationRegister::decode(bytes));
+}
+
+// Test decoding from a vector rejects size mismatches
+TEST_F(I2CRegisterMapTest, VectorDecode) {
+    uint16_t value = 0;
+    EXPECT_TRUE(ConfigRegister::decode(vector<uint8_t>({ 0x12, 0x34 }), value));
+    EXPECT_EQ(0x1234, value);
+    EXPECT_FALSE(ConfigRegister::decode(vector<uint8_t>({ 0x12 }), value));
+}
+
+// Test bit field get, set and make
+TEST_F(I2CRegisterMapTest, Fields) {
+    uint16_t value = 0x60A0;
+    EXPECT_EQ(3, ResolutionField::get(value));
+    value = ResolutionField::set(value, 1);
+    EXPECT_EQ(0x20A0, value);
+    value = ShutdownField::set(value, 1);
+    EXPECT_EQ(0x20A1, value);
+    EXPECT_EQ(0x4000, ResolutionField::make(2));
+    EXPECT_EQ(0x0000, ResolutionField::make(4));
+}
+
+// Test typed messages carry the declared register and data sizes
+TEST_F(I2CRegisterMapTest, TypedMessages) {
+    I2C_Message write = ConfigRegister::write(0x60A0);
+    EXPECT_EQ(I2C_WRITE, write.m_type);
+    EXPECT_EQ(vector<uint8_t>({ 0x01 }), write.m_registerNumber);
+    EXPECT_EQ(vector<uint8_t>({ 0x60, 0xA0 }), write.m_data);
+
+    I2C_Message read = CalibrationRegister::read();
+    EXPECT_EQ(I2C_READ, read.m_type);
+    EXPECT_EQ(vector<uint8_t>({ 0x12, 0x34 }), read.m_registerNumber);
+    EXPECT_EQ(3, read.getDataSize());
+
+    read.m_data = vector<uint8_t>({ 0x01, 0x02, 0x03 });
+    uint32_t value = 0;
+    EXPECT_TRUE(CalibrationRegister::decode(read, value));
+    EXPECT_EQ(0x030201, value);
+    read.m_error = I2CError("read failed", READ_ERROR);
+    EXPECT_FALSE(CalibrationRegister::decode(read, value));
+}
+
+// Test device helpers build transactions for the chip
+TEST_F(I2CRegisterMapTest, DeviceTransactions) {
+    I2C_Transaction_Message *write = Sensor::createWrite<ConfigRegister>(0x1234);
+    EXPECT_EQ(0x48, write->m_chipNumber);
+    ASSERT_EQ(1, write->m_messages.size());
+    EXPECT_EQ(vector<uint8_t>({ 0x12, 0x34 }), write->m_messages[0].m_data);
+    EXPECT_EQ(REQUEST_ONLY, write->getType());
+    delete write;
+
+    I2C_Transaction_Message read = Sensor::createRead<ConfigRegister>();
+    EXPECT_EQ(0x48, read.m_chipNumber);
+    EXPECT_EQ(I2C_READ, read.m_messages[0].m_type);
+}
+
+// Test writes are fire-and-forget and polls decode into the callback
+TEST_F(I2CRegisterMapTest, DeviceOnInterface) {
+    I2C_Simulated_Transport transport;
+    transport.setLatencyModel(false, 0);
+    transport.addDevice(0x48, 1);
+    I2C_Interface interface(&transport, "register_map_test", 1000, false);
+    interface.setType(MESSAGE_AND_FREERUNNING);
+    ConfigRegister::value_type polled = 0;
+    EXPECT_NE(0, Sensor::poll<ConfigRegister>(interface, 2000,
+            (void*) decodeConfig, &polled));
+    interface.begin();
+    for (int count = 0; count < 3; count++) {
+        Sensor::write<ConfigRegister>(interface, 0x6000 + count);
+    }
+    usleep(20000);
+    interface.end();
+
+    EXPECT_EQ(vector<uint8_t>({ 0x60, 0x02 }),
+            transport.getRegisters(0x48, 0x01, 2));
+    EXPECT_EQ(0x6002, polled);
+    EXPECT_EQ(NULL, interface.dequeue());
+}
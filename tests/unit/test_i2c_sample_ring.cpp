@@ -0,0 +1,152 @@
+/*
+ * test_i2c_sample_ring.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "utils/I2CSampleRing.h"
+#include "utils/I2CSimulatedTransport.h"
+
+using namespace apra;
+
+class I2CSampleRingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        channels.push_back(I2C_Sample_Channel(0));
+        channels.push_back(I2C_Sample_Channel(1, I2C_LITTLE_ENDIAN, true));
+    }
+
+    void TearDown() override {
+        // Cleanup code for each test
+    }
+
+    I2C_Transaction_Message makeReads() {
+        I2C_Message first;
+        first.configureRead(vector<uint8_t>({ 0x00 }), 2);
+        I2C_Message second;
+        second.configureRead(vector<uint8_t>({ 0x10 }), 2);
+        return I2C_Transaction_Message(0x20,
+                vector<I2C_Message>({ first, second }));
+    }
+
+    vector<I2C_Sample_Channel> channels;
+};
+
+// Test decoding honours byte order and sign
+TEST_F(I2CSampleRingTest, Decode) {
+    vector<uint8_t> data({ 0xFF, 0x10 });
+    EXPECT_EQ(0xFF10, I2C_Sample_Ring::decode(data, I2C_BIG_ENDIAN, false));
+    EXPECT_EQ(-240, I2C_Sample_Ring::decode(data, I2C_BIG_ENDIAN, true));
+    EXPECT_EQ(0x10FF, I2C_Sample_Ring::decode(data, I2C_LITTLE_ENDIAN, true));
+    EXPECT_EQ(-1, I2C_Sample_Ring::decode(vector<uint8_t>({ 0xFF }),
+            I2C_BIG_ENDIAN, true));
+    EXPECT_EQ(0, I2C_Sample_Ring::decode(vector<uint8_t>(), I2C_BIG_ENDIAN,
+            true));
+}
+
+// Test samples come back in columns across the wrap point
+TEST_F(I2CSampleRingTest, BatchReadWraps) {
+    I2C_Sample_Ring ring(6, channels);
+    EXPECT_EQ(8, ring.capacity());
+    I2C_Sample_Batch batch(8, 2);
+    for (int64_t sample = 0; sample < 20; sample++) {
+        int64_t values[2] = { sample, -sample };
+        ASSERT_TRUE(ring.push(1000 + sample, values));
+        if (ring.size() == 5) {
+            EXPECT_EQ(5, ring.read(batch, 8));
+            for (size_t index = 0; index < batch.size(); index++) {
+                int64_t expected = sample - 4 + index;
+                EXPECT_EQ(1000 + expected, batch.m_timestamps[index]);
+                EXPECT_EQ(expected, batch.m_values[0][index]);
+                EXPECT_EQ(-expected, batch.m_values[1][index]);
+            }
+        }
+    }
+    EXPECT_EQ(20, ring.getSampleCount());
+    EXPECT_EQ(0, ring.getOverrunCount());
+}
+
+// Test a full ring drops new samples and counts the overrun
+TEST_F(I2CSampleRingTest, Overrun) {
+    I2C_Sample_Ring ring(4, channels);
+    int64_t values[2] = { 1, 2 };
+    for (int count = 0; count < 6; count++) {
+        ring.push(count, values);
+    }
+    EXPECT_EQ(4, ring.size());
+    EXPECT_EQ(2, ring.getOverrunCount());
+
+    int64_t timestamps[3];
+    int64_t columns[6];
+    EXPECT_EQ(3, ring.read(timestamps, columns, 3));
+    EXPECT_EQ(0, timestamps[0]);
+    EXPECT_EQ(2, timestamps[2]);
+    EXPECT_EQ(1, columns[0]);
+    EXPECT_EQ(2, columns[3]);
+    EXPECT_EQ(1, ring.size());
+}
+
+// Test transactions are decoded per channel and failures are only counted
+TEST_F(I2CSampleRingTest, RecordTransaction) {
+    I2C_Sample_Ring ring(4, channels);
+    I2C_Transaction_Message message = makeReads();
+    message.m_messages[0].m_data = vector<uint8_t>({ 0x12, 0x34 });
+    message.m_messages[1].m_data = vector<uint8_t>({ 0xFE, 0xFF });
+    EXPECT_TRUE(ring.record(77, message));
+    message.setError(I2CError("read failed", READ_ERROR));
+    EXPECT_FALSE(ring.record(78, message));
+    EXPECT_EQ(1, ring.getErrorCount());
+
+    I2C_Sample_Batch batch;
+    ASSERT_EQ(1, ring.read(batch, 4));
+    EXPECT_EQ(77, batch.m_timestamps[0]);
+    EXPECT_EQ(0x1234, batch.m_values[0][0]);
+    EXPECT_EQ(-2, batch.m_values[1][0]);
+}
+
+// Test a streamed event fills the ring while a consumer drains it
+TEST_F(I2CSampleRingTest, StreamFromInterface) {
+    I2C_Simulated_Transport transport;
+    transport.setLatencyModel(false, 0);
+    transport.addDevice(0x20, 1);
+    transport.setRegisters(0x20, 0x00, vector<uint8_t>({ 0x01, 0x02 }));
+    transport.setRegisters(0x20, 0x10, vector<uint8_t>({ 0x00, 0x80 }));
+    shared_ptr<I2C_Sample_Ring> ring = make_shared<I2C_Sample_Ring>(1024,
+            channels);
+
+    I2C_Interface interface(&transport, "stream_test", 1000, false);
+    I2C_Transaction_Message stream = makeReads();
+    stream.setPeriod(500);
+    interface.registerStream(stream, ring);
+    interface.begin();
+    I2C_Sample_Batch batch(64, 2);
+    uint64_t received = 0;
+    int64_t lastTs = 0;
+    bool valuesMatch = true;
+    bool timestampsIncrease = true;
+    for (int round = 0; round < 100; round++) {
+        usleep(1000);
+        size_t count = ring->read(batch, 64);
+        for (size_t index = 0; index < count; index++) {
+            timestampsIncrease &= (batch.m_timestamps[index] > lastTs);
+            lastTs = batch.m_timestamps[index];
+            valuesMatch &= (batch.m_values[0][index] == 0x0102);
+            valuesMatch &= (batch.m_values[1][index] == -32768);
+        }
+        received += count;
+    }
+    interface.end();
+
+    EXPECT_LT(20, received);
+    EXPECT_TRUE(valuesMatch);
+    EXPECT_TRUE(timestampsIncrease);
+    EXPECT_EQ(0, ring->getErrorCount());
+}
@@ -0,0 +1,161 @@
+/*
+ * test_i2c_simulated_transport.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <errno.h>
+#include <stdexcept>
+#include <string>
+#include "controllers/I2CInterface.h"
+#include "utils/I2CSimulatedTransport.h"
+#include "utils/Macro.h"
+
+using namespace apra;
+
+class I2CSimulatedTransportTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        transport.setLatencyModel(false, 0);
+        transport.addDevice(0x50, 2);
+        ASSERT_FALSE(transport.openBus().isError());
+    }
+
+    void TearDown() override {
+        transport.closeBus();
+    }
+
+    I2C_Simulated_Transport transport;
+};
+
+// Test open failure injection and bus state
+TEST_F(I2CSimulatedTransportTest, OpenAndClose) {
+    EXPECT_TRUE(transport.isOpen());
+    transport.closeBus();
+    EXPECT_FALSE(transport.isOpen());
+    EXPECT_EQ(0, transport.getFunctionality());
+
+    transport.setOpenFailure(true);
+    I2CError error = transport.openBus();
+    EXPECT_TRUE(error.isError());
+    EXPECT_EQ(OPEN_BUS_ERROR, error.getCode());
+    EXPECT_FALSE(transport.isOpen());
+}
+
+// Test an interface on a failing transport names the transport, not its thread
+TEST_F(I2CSimulatedTransportTest, InterfaceOpenFailure) {
+    transport.setOpenFailure(true);
+    std::string error;
+    try {
+        I2C_Interface interface(&transport, "open_failure_test", 1000, false);
+    } catch (const std::invalid_argument &exception) {
+        error = exception.what();
+    }
+    EXPECT_NE(std::string::npos, error.find("custom transport"));
+    EXPECT_EQ(std::string::npos, error.find("open_failure_test"));
+}
+
+// Test combined write then read with register auto-increment
+TEST_F(I2CSimulatedTransportTest, WriteThenRead) {
+    uint8_t writeBuffer[] = { 0x01, 0x10, 0xAA, 0xBB };
+    struct i2c_msg writeMessage = { 0x50, 0, 4, writeBuffer };
+    EXPECT_EQ(1, transport.transfer(&writeMessage, 1));
+    EXPECT_EQ(vector<uint8_t>({ 0xAA, 0xBB }),
+            transport.getRegisters(0x50, 0x0110, 2));
+
+    uint8_t pointer[] = { 0x01, 0x10 };
+    uint8_t readBuffer[3] = { 0xFF, 0xFF, 0xFF };
+    struct i2c_msg messages[] = { { 0x50, 0, 2, pointer }, { 0x50, I2C_M_RD, 3,
+            readBuffer } };
+    EXPECT_EQ(2, transport.transfer(messages, 2));
+    EXPECT_EQ(0xAA, readBuffer[0]);
+    EXPECT_EQ(0xBB, readBuffer[1]);
+    EXPECT_EQ(0x00, readBuffer[2]);
+    EXPECT_EQ(2, transport.getTransferCount());
+    EXPECT_EQ(3, transport.getTransferCount(0x50));
+}
+
+// Test missing devices and injected NACKs fail with errno
+TEST_F(I2CSimulatedTransportTest, FaultInjection) {
+    uint8_t buffer[] = { 0x00, 0x00 };
+    struct i2c_msg message = { 0x51, 0, 2, buffer };
+    EXPECT_GT(0, transport.transfer(&message, 1));
+    EXPECT_EQ(ENXIO, errno);
+
+    message.addr = 0x50;
+    transport.injectNack(0x50, 2);
+    EXPECT_GT(0, transport.transfer(&message, 1));
+    EXPECT_EQ(EREMOTEIO, errno);
+    EXPECT_GT(0, transport.transfer(&message, 1));
+    EXPECT_EQ(1, transport.transfer(&message, 1));
+
+    transport.setBusStuck(true);
+    EXPECT_GT(0, transport.transfer(&message, 1));
+    EXPECT_EQ(ETIMEDOUT, errno);
+    transport.setBusStuck(false);
+
+    transport.setErrorRate(0x50, 1000);
+    EXPECT_GT(0, transport.transfer(&message, 1));
+    transport.setErrorRate(0x50, 0);
+    EXPECT_EQ(1, transport.transfer(&message, 1));
+}
+
+// Test SMBus byte and word transfers on the selected chip
+TEST_F(I2CSimulatedTransportTest, SMBusTransfers) {
+    transport.addDevice(0x20, 1);
+    ASSERT_TRUE(transport.selectChip(0x20));
+
+    union i2c_smbus_data data;
+    data.word = 0x1234;
+    struct i2c_smbus_ioctl_data args = { I2C_SMBUS_WRITE, 0x05,
+            I2C_SMBUS_WORD_DATA, &data };
+    EXPECT_EQ(0, transport.smbusTransfer(args));
+    EXPECT_EQ(vector<uint8_t>({ 0x34, 0x12 }),
+            transport.getRegisters(0x20, 0x05, 2));
+
+    data.byte = 0;
+    args.read_write = I2C_SMBUS_READ;
+    args.command = 0x06;
+    args.size = I2C_SMBUS_BYTE_DATA;
+    EXPECT_EQ(0, transport.smbusTransfer(args));
+    EXPECT_EQ(0x12, data.byte);
+    EXPECT_EQ(2, transport.getSMBusTransferCount());
+}
+
+// Test unsupported adapter functionality is rejected
+TEST_F(I2CSimulatedTransportTest, FunctionalityCheck) {
+    transport.setFunctionality(I2C_FUNC_SMBUS_BYTE_DATA);
+    uint8_t buffer[] = { 0x00, 0x00 };
+    struct i2c_msg message = { 0x50, 0, 2, buffer };
+    EXPECT_GT(0, transport.transfer(&message, 1));
+    EXPECT_EQ(EOPNOTSUPP, errno);
+
+    transport.selectChip(0x50);
+    union i2c_smbus_data data;
+    struct i2c_smbus_ioctl_data args = { I2C_SMBUS_READ, 0x00,
+            I2C_SMBUS_WORD_DATA, &data };
+    EXPECT_GT(0, transport.smbusTransfer(args));
+    EXPECT_EQ(EOPNOTSUPP, errno);
+}
+
+// Test simulated bus time follows the bus clock model
+TEST_F(I2CSimulatedTransportTest, SimulatedBusTime) {
+    uint8_t buffer[] = { 0x00, 0x00, 0x01, 0x02 };
+    struct i2c_msg message = { 0x50, 0, 4, buffer };
+    EXPECT_EQ(1, transport.transfer(&message, 1));
+    EXPECT_EQ(I2C_Bus_Statistics::estimateTransferUsec(I2C_DEFAULT_BUS_CLOCK_HZ,
+            4, 0), transport.getSimulatedBusTimeUsec());
+
+    transport.setLatencyModel(true, 0);
+    transport.setExtraLatency(0x50, 2000);
+    MONOCURRTIME(startTs);
+    EXPECT_EQ(1, transport.transfer(&message, 1));
+    MONOCURRTIME(endTs);
+    EXPECT_LE(2000, endTs - startTs);
+}
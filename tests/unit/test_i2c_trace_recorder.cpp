@@ -0,0 +1,128 @@
+/*
+ * test_i2c_trace_recorder.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "utils/I2CTraceRecorder.h"
+#include "utils/Macro.h"
+
+using namespace apra;
+
+class I2CTraceRecorderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        tracePath = "/tmp/aprautils_test_i2c_trace.bin";
+        unlink(tracePath.c_str());
+    }
+
+    void TearDown() override {
+        unlink(tracePath.c_str());
+    }
+
+    I2C_Trace_Record createRecord(int64_t timestampUsec, uint64_t transactionId) {
+        I2C_Trace_Record record;
+        record.m_timestampUsec = timestampUsec;
+        record.m_transactionId = transactionId;
+        record.m_chipNumber = 0x48;
+        record.m_type = I2C_READ;
+        record.m_isEvent = true;
+        record.m_errorCode = READ_ERROR;
+        record.m_latencyUsec = 250;
+        record.m_registerNumber = vector<uint8_t>({ 0x01, 0x02 });
+        record.m_data = vector<uint8_t>({ 0xAA, 0xBB, 0xCC });
+        return record;
+    }
+
+    string tracePath;
+};
+
+// Test varints round-trip across byte boundaries
+TEST_F(I2CTraceRecorderTest, VarintRoundTrip) {
+    vector<uint8_t> buffer;
+    uint64_t values[] = { 0, 127, 128, 300, UINT64_MAX };
+    for (uint64_t value : values) {
+        I2C_Trace_Record::putVarint(buffer, value);
+    }
+    EXPECT_EQ(1 + 1 + 2 + 2 + 10, buffer.size());
+
+    size_t offset = 0;
+    for (uint64_t value : values) {
+        uint64_t decoded = 0;
+        EXPECT_TRUE(I2C_Trace_Record::getVarint(buffer, offset, decoded));
+        EXPECT_EQ(value, decoded);
+    }
+    uint64_t decoded = 0;
+    EXPECT_FALSE(I2C_Trace_Record::getVarint(buffer, offset, decoded));
+}
+
+// Test a record encodes compactly and decodes unchanged
+TEST_F(I2CTraceRecorderTest, RecordRoundTrip) {
+    I2C_Trace_Record record = createRecord(1500, 7);
+    vector<uint8_t> buffer;
+    record.encode(buffer, 1000);
+    EXPECT_GT(20, buffer.size());
+
+    I2C_Trace_Record decoded;
+    size_t offset = 0;
+    ASSERT_TRUE(decoded.decode(buffer, offset, 1000));
+    EXPECT_EQ(buffer.size(), offset);
+    EXPECT_EQ(1500, decoded.m_timestampUsec);
+    EXPECT_EQ(7, decoded.m_transactionId);
+    EXPECT_EQ(0x48, decoded.m_chipNumber);
+    EXPECT_EQ(I2C_READ, decoded.m_type);
+    EXPECT_TRUE(decoded.m_isEvent);
+    EXPECT_EQ(READ_ERROR, decoded.m_errorCode);
+    EXPECT_EQ(250, decoded.m_latencyUsec);
+    EXPECT_EQ(record.m_registerNumber, decoded.m_registerNumber);
+    EXPECT_EQ(record.m_data, decoded.m_data);
+
+    buffer.pop_back();
+    offset = 0;
+    EXPECT_FALSE(decoded.decode(buffer, offset, 1000));
+}
+
+// Test records written to a trace file are loaded back in order
+TEST_F(I2CTraceRecorderTest, FileRoundTrip) {
+    I2C_Trace_Recorder recorder;
+    EXPECT_FALSE(recorder.isRecording());
+    ASSERT_TRUE(recorder.open(tracePath, 400000));
+    EXPECT_TRUE(recorder.isRecording());
+
+    MONOCURRTIME(timeNow);
+    recorder.record(createRecord(timeNow + 100, 1));
+    recorder.record(createRecord(timeNow + 50, 2));
+    EXPECT_EQ(2, recorder.getRecordCount());
+    recorder.close();
+    EXPECT_FALSE(recorder.isRecording());
+
+    vector<I2C_Trace_Record> records;
+    uint64_t busClockHz = 0;
+    ASSERT_TRUE(I2C_Trace_Recorder::load(tracePath, records, busClockHz));
+    EXPECT_EQ(400000, busClockHz);
+    ASSERT_EQ(2, records.size());
+    EXPECT_EQ(1, records[0].m_transactionId);
+    EXPECT_EQ(2, records[1].m_transactionId);
+    EXPECT_EQ(-50, records[1].m_timestampUsec - records[0].m_timestampUsec);
+    EXPECT_LE(100, records[0].m_timestampUsec);
+}
+
+// Test loading rejects missing and foreign files
+TEST_F(I2CTraceRecorderTest, LoadInvalidFile) {
+    vector<I2C_Trace_Record> records;
+    uint64_t busClockHz = 0;
+    EXPECT_FALSE(I2C_Trace_Recorder::load(tracePath, records, busClockHz));
+
+    FILE *file = fopen(tracePath.c_str(), "wb");
+    ASSERT_TRUE(file != NULL);
+    fputs("not a trace", file);
+    fclose(file);
+    EXPECT_FALSE(I2C_Trace_Recorder::load(tracePath, records, busClockHz));
+}
@@ -0,0 +1,197 @@
+/*
+ * test_i2c_trace_replayer.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "controllers/I2CTraceReplayer.h"
+
+using namespace apra;
+
+class I2CTraceReplayerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        tracePath = "/tmp/aprautils_test_i2c_replay.bin";
+        unlink(tracePath.c_str());
+    }
+
+    void TearDown() override {
+        unlink(tracePath.c_str());
+    }
+
+    I2C_Trace_Record createRecord(int64_t timestampUsec, uint64_t transactionId,
+            I2C_MESSAGE_TYPE type, uint8_t registerNumber, uint8_t data) {
+        I2C_Trace_Record record;
+        record.m_timestampUsec = timestampUsec;
+        record.m_transactionId = transactionId;
+        record.m_chipNumber = 0x48;
+        record.m_type = type;
+        record.m_registerNumber = vector<uint8_t>({ registerNumber });
+        record.m_data = vector<uint8_t>({ data });
+        return record;
+    }
+
+    string tracePath;
+};
+
+// Test records are grouped into transactions by id
+TEST_F(I2CTraceReplayerTest, GroupsTransactions) {
+    vector<I2C_Trace_Record> records;
+    records.push_back(createRecord(0, 1, I2C_WRITE, 0x01, 0x10));
+    records.push_back(createRecord(10, 1, I2C_READ, 0x02, 0x20));
+    records.push_back(createRecord(20, 2, I2C_READ, 0x03, 0x30));
+    I2C_Trace_Replayer replayer(records);
+    EXPECT_EQ(2, replayer.getTransactionCount());
+
+    I2C_Simulated_Transport transport;
+    replayer.primeTransport(transport);
+    EXPECT_TRUE(transport.hasDevice(0x48));
+}
+
+// Test a captured workload replays against a simulated bus
+TEST_F(I2CTraceReplayerTest, CaptureAndReplay) {
+    I2C_Simulated_Transport fieldBus;
+    fieldBus.setLatencyModel(false, 0);
+    fieldBus.addDevice(0x48, 1);
+    fieldBus.setRegisters(0x48, 0x00, vector<uint8_t>({ 0x12, 0x34 }));
+    {
+        I2C_Interface interface(&fieldBus, "trace_capture", 1000, false);
+        interface.setType(MESSAGE_AND_FREERUNNING);
+        ASSERT_TRUE(interface.startTrace(tracePath));
+        interface.begin();
+        for (uint8_t index = 0; index < 5; index++) {
+            I2C_Message write;
+            write.configureWrite(vector<uint8_t>({ 0x10 }),
+                    vector<uint8_t>({ index }));
+            I2C_Message read;
+            read.configureRead(vector<uint8_t>({ 0x00 }), 2);
+            I2C_Transaction_Message *transaction = new I2C_Transaction_Message(
+                    0x48, vector<I2C_Message>({ write, read }));
+            interface.enque(transaction);
+            usleep(2000);
+        }
+        usleep(20000);
+        interface.end();
+        interface.stopTrace();
+    }
+
+    I2C_Trace_Replayer replayer;
+    ASSERT_TRUE(replayer.load(tracePath));
+    ASSERT_EQ(5, replayer.getTransactionCount());
+
+    I2C_Simulated_Transport labBus;
+    labBus.setLatencyModel(false, 0);
+    replayer.primeTransport(labBus);
+    I2C_Interface interface(&labBus, "trace_replay", 1000, false);
+    interface.setType(MESSAGE_AND_FREERUNNING);
+    interface.begin();
+    I2C_Replay_Report report = replayer.replay(interface, 4.0, &labBus);
+    interface.end();
+
+    EXPECT_EQ(5, report.m_transactionCount);
+    EXPECT_EQ(5, report.m_completedCount);
+    EXPECT_EQ(0, report.m_errorCount);
+    EXPECT_EQ(0, report.m_mismatchCount);
+    EXPECT_LT(0, report.m_recordedDurationUsec);
+    EXPECT_EQ(vector<uint8_t>({ 0x04 }), labBus.getRegisters(0x48, 0x10, 1));
+}
+
+// Test replay keeps compare reads and leaves other clients' responses alone
+TEST_F(I2CTraceReplayerTest, OwnResponsePath) {
+    vector<I2C_Trace_Record> records;
+    records.push_back(createRecord(0, 1, I2C_READ_COMPARE_EQUAL, 0x01, 0x5A));
+    records[0].m_compareData = vector<uint8_t>({ 0x5A });
+    records.push_back(createRecord(100, 2, I2C_READ, 0x02, 0x20));
+    I2C_Trace_Replayer replayer(records);
+
+    I2C_Simulated_Transport labBus;
+    labBus.setLatencyModel(false, 0);
+    replayer.primeTransport(labBus);
+    I2C_Interface interface(&labBus, "trace_replay", 1000, false);
+    interface.setType(MESSAGE_AND_FREERUNNING);
+    ASSERT_TRUE(interface.startTrace(tracePath));
+    I2C_Message read;
+    read.configureRead(vector<uint8_t>({ 0x02 }), 1);
+    I2C_Transaction_Message *other = new I2C_Transaction_Message(0x48,
+            vector<I2C_Message>({ read }));
+    interface.enque(other);
+    interface.begin();
+    I2C_Replay_Report report = replayer.replay(interface, 0, &labBus);
+    usleep(10000);
+    interface.end();
+    interface.stopTrace();
+
+    EXPECT_EQ(2, report.m_completedCount);
+    EXPECT_EQ(0, report.m_mismatchCount);
+    EXPECT_EQ(other, interface.dequeue());
+    EXPECT_EQ(NULL, interface.dequeue());
+    delete other;
+
+    uint64_t busClockHz = 0;
+    vector<I2C_Trace_Record> traced;
+    ASSERT_TRUE(I2C_Trace_Recorder::load(tracePath, traced, busClockHz));
+    size_t compareCount = 0;
+    for (size_t index = 0; index < traced.size(); index++) {
+        if (traced[index].m_type == I2C_READ_COMPARE_EQUAL) {
+            EXPECT_EQ(vector<uint8_t>({ 0x5A }), traced[index].m_compareData);
+            compareCount++;
+        }
+    }
+    EXPECT_EQ(1, compareCount);
+}
+
+// Test repeated reads of one register at full speed each see their own data
+TEST_F(I2CTraceReplayerTest, SameRegisterReads) {
+    vector<I2C_Trace_Record> records;
+    for (uint8_t index = 0; index < 50; index++) {
+        records.push_back(createRecord(index * 10, index, I2C_READ, 0x10,
+                index));
+    }
+    I2C_Trace_Replayer replayer(records);
+
+    I2C_Simulated_Transport labBus;
+    labBus.setLatencyModel(false, 0);
+    replayer.primeTransport(labBus);
+    I2C_Interface interface(&labBus, "trace_replay", 1000, false);
+    interface.setType(MESSAGE_AND_FREERUNNING);
+    interface.begin();
+    I2C_Replay_Report report = replayer.replay(interface, 0, &labBus);
+    interface.end();
+
+    EXPECT_EQ(50, report.m_transactionCount);
+    EXPECT_EQ(50, report.m_completedCount);
+    EXPECT_EQ(0, report.m_mismatchCount);
+}
+
+// Test transactions abandoned by a destroyed replayer are freed on completion
+TEST_F(I2CTraceReplayerTest, AbandonedTransactions) {
+    vector<I2C_Trace_Record> records;
+    records.push_back(createRecord(0, 1, I2C_READ, 0x01, 0x10));
+    records.push_back(createRecord(10, 2, I2C_READ, 0x02, 0x20));
+    records.push_back(createRecord(20, 3, I2C_READ, 0x03, 0x30));
+
+    I2C_Simulated_Transport labBus;
+    labBus.setLatencyModel(false, 0);
+    I2C_Interface interface(&labBus, "trace_replay", 1000, false);
+    interface.setType(MESSAGE_AND_FREERUNNING);
+    {
+        I2C_Trace_Replayer replayer(records);
+        replayer.primeTransport(labBus);
+        I2C_Replay_Report report = replayer.replay(interface, 0, &labBus,
+                1000);
+        EXPECT_EQ(3, report.m_transactionCount);
+        EXPECT_EQ(0, report.m_completedCount);
+    }
+    interface.begin();
+    usleep(10000);
+    interface.end();
+
+    EXPECT_EQ(NULL, interface.dequeue());
+}
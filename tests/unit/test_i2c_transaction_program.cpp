@@ -0,0 +1,161 @@
+/*
+ * test_i2c_transaction_program.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "models/I2CTransactionProgram.h"
+#include "utils/I2CSimulatedTransport.h"
+
+using namespace apra;
+
+class I2CTransactionProgramTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        transport.setLatencyModel(false, 0);
+        transport.addDevice(0x68, 1);
+        transport.setRegisters(0x68, 0x00, vector<uint8_t>({ 0x08, 0x03 }));
+        transport.setRegisters(0x68, 0x10,
+                vector<uint8_t>({ 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 }));
+    }
+
+    void TearDown() override {
+        // Cleanup code for each test
+    }
+
+    // Status bit 3 gates a burst read of FIFO count * 2 bytes
+    shared_ptr<I2C_Transaction_Program> makeFifoDrain() {
+        shared_ptr<I2C_Transaction_Program> program = make_shared<
+                I2C_Transaction_Program>();
+        program->read(vector<uint8_t>({ 0x00 }), 1, 0);
+        program->andValue(0, 0x08);
+        size_t skip = program->jumpIfZero(0, 0);
+        program->read(vector<uint8_t>({ 0x01 }), 1, 1);
+        program->multiply(1, 2);
+        program->readVariable(vector<uint8_t>({ 0x10 }), 1, 32);
+        program->setTarget(skip, program->label());
+        return program;
+    }
+
+    I2C_Transaction_Message run(shared_ptr<I2C_Transaction_Program> program,
+            uint8_t chip = 0x68) {
+        I2C_Transaction_Message message;
+        message.m_chipNumber = chip;
+        message.setProgram(program);
+        I2C_Interface interface(&transport, "program_test", 1000, false);
+        interface.setType(MESSAGE_AND_FREERUNNING);
+        interface.enque(&message);
+        interface.begin();
+        usleep(20000);
+        interface.end();
+        executedCount = interface.getExecutedCount(I2C_PRIORITY_NORMAL);
+        return message;
+    }
+
+    I2C_Simulated_Transport transport;
+    uint64_t executedCount = 0;
+};
+
+// Test malformed programs are refused before touching the bus
+TEST_F(I2CTransactionProgramTest, Validation) {
+    I2C_Transaction_Program program;
+    program.read(vector<uint8_t>({ 0x00 }), 1, 0);
+    program.jumpIfNotZero(0, 2);
+    EXPECT_TRUE(program.isValid());
+    program.setTarget(1, 3);
+    EXPECT_FALSE(program.isValid());
+
+    I2C_Transaction_Program badVariable;
+    badVariable.load(I2C_PROGRAM_VARIABLE_COUNT, 1);
+    EXPECT_FALSE(badVariable.isValid());
+    I2C_Transaction_Program emptyRead;
+    emptyRead.read(vector<uint8_t>({ 0x00 }), 0);
+    EXPECT_FALSE(emptyRead.isValid());
+
+    shared_ptr<I2C_Transaction_Program> invalid = make_shared<
+            I2C_Transaction_Program>(badVariable);
+    I2C_Transaction_Message message = run(invalid);
+    EXPECT_EQ(PROGRAM_ERROR, message.getError().getCode());
+    EXPECT_EQ(0, transport.getTransferCount());
+}
+
+// Test a read into a variable must fit the variable
+TEST_F(I2CTransactionProgramTest, VariableReadSize) {
+    I2C_Transaction_Program fits;
+    fits.read(vector<uint8_t>({ 0x00 }), sizeof(uint64_t), 0);
+    EXPECT_TRUE(fits.isValid());
+    I2C_Transaction_Program unnamed;
+    unnamed.read(vector<uint8_t>({ 0x00 }), 300);
+    EXPECT_TRUE(unnamed.isValid());
+
+    I2C_Transaction_Program wide;
+    wide.read(vector<uint8_t>({ 0x00 }), sizeof(uint64_t) + 1, 0);
+    EXPECT_FALSE(wide.isValid());
+    I2C_Transaction_Program huge;
+    huge.read(vector<uint8_t>({ 0x00 }), 300, 0);
+    EXPECT_FALSE(huge.isValid());
+
+    I2C_Transaction_Message message = run(
+            make_shared<I2C_Transaction_Program>(huge));
+    EXPECT_EQ(PROGRAM_ERROR, message.getError().getCode());
+    EXPECT_EQ(0, transport.getTransferCount());
+}
+
+// Test a FIFO drain runs as one transaction and skips the burst when idle
+TEST_F(I2CTransactionProgramTest, ConditionalFifoDrain) {
+    I2C_Transaction_Message message = run(makeFifoDrain());
+    EXPECT_FALSE(message.getError().isError());
+    EXPECT_EQ(1, executedCount);
+    ASSERT_EQ(3, message.m_messages.size());
+    EXPECT_EQ(vector<uint8_t>({ 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 }),
+            message.m_messages[2].m_data);
+
+    transport.setRegisters(0x68, 0x00, vector<uint8_t>({ 0x00 }));
+    message = run(makeFifoDrain());
+    EXPECT_FALSE(message.getError().isError());
+    EXPECT_EQ(1, message.m_messages.size());
+    EXPECT_EQ(4, transport.getTransferCount());
+}
+
+// Test a loop bounded by a read count and the step limit on runaway loops
+TEST_F(I2CTransactionProgramTest, BoundedLoop) {
+    shared_ptr<I2C_Transaction_Program> program = make_shared<
+            I2C_Transaction_Program>();
+    program->read(vector<uint8_t>({ 0x01 }), 1, 0);
+    size_t loop = program->label();
+    size_t exit = program->jumpIfZero(0, 0);
+    program->read(vector<uint8_t>({ 0x10 }), 1);
+    program->add(0, -1);
+    program->jump(loop);
+    program->setTarget(exit, program->label());
+    program->write(vector<uint8_t>({ 0x20 }), vector<uint8_t>({ 0xAA }));
+    I2C_Transaction_Message message = run(program);
+    EXPECT_FALSE(message.getError().isError());
+    ASSERT_EQ(5, message.m_messages.size());
+    EXPECT_EQ(I2C_WRITE, message.m_messages[4].m_type);
+    EXPECT_EQ(vector<uint8_t>({ 0xAA }), transport.getRegisters(0x68, 0x20, 1));
+
+    shared_ptr<I2C_Transaction_Program> runaway = make_shared<
+            I2C_Transaction_Program>();
+    runaway->load(0, 1);
+    runaway->jumpIfNotZero(0, 1);
+    message = run(runaway);
+    EXPECT_EQ(PROGRAM_ERROR, message.getError().getCode());
+}
+
+// Test a bus error ends the program with the failing read recorded last
+TEST_F(I2CTransactionProgramTest, StopsOnBusError) {
+    shared_ptr<I2C_Transaction_Program> program = makeFifoDrain();
+    I2C_Transaction_Message message = run(program, 0x40);
+    EXPECT_TRUE(message.getError().isError());
+    ASSERT_EQ(1, message.m_messages.size());
+    EXPECT_TRUE(I2CError(message.m_messages[0].m_error).isError());
+}
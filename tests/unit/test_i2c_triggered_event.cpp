@@ -0,0 +1,149 @@
+/*
+ * test_i2c_triggered_event.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <fcntl.h>
+#include <unistd.h>
+#include "controllers/I2CInterface.h"
+#include "utils/I2CSampleRing.h"
+#include "utils/I2CSimulatedTransport.h"
+#include "utils/Macro.h"
+
+using namespace apra;
+
+namespace
+{
+std::atomic<int> g_triggeredCount(0);
+std::atomic<int64_t> g_triggerTs(0);
+std::atomic<int64_t> g_completionTs(0);
+std::atomic<uint64_t> g_lastValue(0);
+
+void* triggeredCallback(void*, const I2C_Transaction_Message &message) {
+    MONOCURRTIME(timeNow);
+    g_triggerTs = message.m_triggerTs;
+    g_completionTs = timeNow;
+    g_lastValue = message.m_messages[0].m_data.empty() ?
+            0 : message.m_messages[0].m_data[0];
+    g_triggeredCount++;
+    return NULL;
+}
+}
+
+class I2CTriggeredEventTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        g_triggeredCount = 0;
+        g_triggerTs = 0;
+        g_completionTs = 0;
+        g_lastValue = 0;
+        ASSERT_EQ(0, pipe2(fds, O_NONBLOCK));
+        transport.setLatencyModel(false, 0);
+        transport.addDevice(0x20, 1);
+        transport.setRegisters(0x20, 0x00, vector<uint8_t>({ 0x42 }));
+    }
+
+    void TearDown() override {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    I2C_Transaction_Message makeRead() {
+        I2C_Message read;
+        read.configureRead(vector<uint8_t>({ 0x00 }), 1);
+        return I2C_Transaction_Message(0x20, vector<I2C_Message>({ read }));
+    }
+
+    void fire() {
+        char edge = '1';
+        ASSERT_EQ(1, write(fds[1], &edge, 1));
+    }
+
+    int fds[2];
+    I2C_Simulated_Transport transport;
+};
+
+// Test an invalid trigger descriptor is rejected
+TEST_F(I2CTriggeredEventTest, InvalidDescriptor) {
+    I2C_Interface interface(&transport, "trigger_invalid", 100, false);
+    EXPECT_EQ(0, interface.registerTriggeredEvent(makeRead(), -1, POLLIN));
+}
+
+// Test a triggered read runs on the edge only, well within one period
+TEST_F(I2CTriggeredEventTest, ReadRunsOnEdge) {
+    I2C_Interface interface(&transport, "trigger_test", 50, false);
+    I2C_Transaction_Message message = makeRead();
+    message.registerConstEventHandle((void*) triggeredCallback, NULL);
+    EXPECT_NE(0, interface.registerTriggeredEvent(message, fds[0], POLLIN));
+    interface.begin();
+    usleep(60000);
+    EXPECT_EQ(0, g_triggeredCount);
+    EXPECT_EQ(0, transport.getTransferCount());
+
+    for (int edge = 0; edge < 3; edge++) {
+        MONOCURRTIME(edgeTs);
+        fire();
+        for (int wait = 0; (wait < 100) && (g_triggeredCount <= edge);
+                wait++) {
+            usleep(500);
+        }
+        ASSERT_EQ(edge + 1, g_triggeredCount);
+        EXPECT_LE(edgeTs, g_triggerTs);
+        EXPECT_LE(g_triggerTs, g_completionTs);
+        EXPECT_GT(10000, g_completionTs - edgeTs);
+        usleep(5000);
+    }
+    interface.end();
+
+    EXPECT_EQ(0x42, g_lastValue);
+    EXPECT_EQ(0, interface.getMissedTriggerCount());
+}
+
+// Test triggered samples carry the edge timestamp into the ring
+TEST_F(I2CTriggeredEventTest, TriggeredStream) {
+    vector<I2C_Sample_Channel> channels({ I2C_Sample_Channel(0) });
+    shared_ptr<I2C_Sample_Ring> ring = make_shared<I2C_Sample_Ring>(16,
+            channels);
+    I2C_Interface interface(&transport, "trigger_stream", 50, false);
+    interface.registerTriggeredEvent(makeRead(), fds[0], POLLIN, ring);
+    interface.begin();
+    usleep(10000);
+    MONOCURRTIME(edgeTs);
+    fire();
+    for (int wait = 0; (wait < 100) && !ring->size(); wait++) {
+        usleep(500);
+    }
+    interface.end();
+
+    I2C_Sample_Batch batch;
+    ASSERT_EQ(1, ring->read(batch, 16));
+    EXPECT_LE(edgeTs, batch.m_timestamps[0]);
+    EXPECT_GT(edgeTs + 10000, batch.m_timestamps[0]);
+    EXPECT_EQ(0x42, batch.m_values[0][0]);
+}
+
+// Test periodic events keep running alongside a trigger wait
+TEST_F(I2CTriggeredEventTest, PeriodicEventsUnaffected) {
+    transport.addDevice(0x21, 1);
+    I2C_Interface interface(&transport, "trigger_periodic", 1000, false);
+    interface.registerTriggeredEvent(makeRead(), fds[0], POLLIN);
+    I2C_Message read;
+    read.configureRead(vector<uint8_t>({ 0x00 }), 1);
+    I2C_Transaction_Message periodic(0x21, vector<I2C_Message>({ read }));
+    periodic.setPeriod(2000);
+    interface.registerEvent(periodic);
+    interface.begin();
+    usleep(50000);
+    interface.end();
+
+    EXPECT_LT(10, transport.getTransferCount(0x21));
+    EXPECT_EQ(0, transport.getTransferCount(0x20));
+}
@@ -0,0 +1,104 @@
+/*
+ * test_lock_free_queue.cpp
+ *
+ * Copyright (c) 2024 Apra Labs
+ *
+ * This file is part of ApraUtils.
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file in the project root for full license information.
+ */
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include "utils/LockFreeQueue.h"
+
+using namespace apra;
+
+class LockFreeQueueTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Setup code for each test
+    }
+
+    void TearDown() override {
+        // Cleanup code for each test
+    }
+};
+
+// Test that capacity is rounded up to a power of two
+TEST_F(LockFreeQueueTest, CapacityRoundsUp) {
+    LockFreeQueue<int> queue(5);
+    EXPECT_EQ(8, queue.capacity());
+    EXPECT_TRUE(queue.empty());
+}
+
+// Test FIFO order of push and pop
+TEST_F(LockFreeQueueTest, PushPopOrder) {
+    LockFreeQueue<int> queue(4);
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    EXPECT_TRUE(queue.push(3));
+    EXPECT_EQ(3, queue.size());
+
+    int value = 0;
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(1, value);
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(2, value);
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(3, value);
+    EXPECT_FALSE(queue.pop(value));
+}
+
+// Test that push fails instead of blocking when full
+TEST_F(LockFreeQueueTest, PushFailsWhenFull) {
+    LockFreeQueue<int> queue(2);
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    EXPECT_FALSE(queue.push(3));
+
+    int value = 0;
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_TRUE(queue.push(3));
+}
+
+// Test that popped slots release shared ownership
+TEST_F(LockFreeQueueTest, PopReleasesSlot) {
+    LockFreeQueue<std::shared_ptr<int> > queue(2);
+    std::shared_ptr<int> item = std::make_shared<int>(7);
+    EXPECT_TRUE(queue.push(item));
+    EXPECT_EQ(2, item.use_count());
+
+    std::shared_ptr<int> popped;
+    ASSERT_TRUE(queue.pop(popped));
+    popped.reset();
+    EXPECT_EQ(1, item.use_count());
+}
+
+// Test ordered delivery between a producer and a consumer thread
+TEST_F(LockFreeQueueTest, ProducerConsumer) {
+    LockFreeQueue<int> queue(16);
+    const int count = 10000;
+    std::thread producer([&queue, count]() {
+        for (int i = 0; i < count; i++) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    while (expected < count) {
+        int value = -1;
+        if (queue.pop(value)) {
+            ASSERT_EQ(expected, value);
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(queue.empty());
+}